@@ -2,13 +2,7 @@
 
 layout(location = 0) out vec4 FragColor;
 layout(location = 1) in vec2 vTexCoords;
-
-layout(push_constant) uniform Push 
-{
-    mat4 modelMatrix;
-    mat4 viewProjectionMatrix;
-    int entId;
-} push;
+layout(location = 2) flat in uint vTexture;
 
 layout(binding = 0) uniform sampler2D texSampler;
 layout(binding = 1) uniform sampler2D texSampler1;
@@ -21,15 +15,15 @@ void main()
 {
     vec4 tex;
 
-    if(push.entId == 0) {tex = texture(texSampler, vTexCoords).rgba;}
-    else if(push.entId == 1) {tex = texture(texSampler1, vTexCoords).rgba;}
-    else if(push.entId == 2) {tex = texture(texSampler1, vTexCoords).rgba;}
-    else if(push.entId == 3) {tex = texture(texSampler1, vTexCoords).rgba;}
-    else if(push.entId == 4) {tex = texture(texSampler1, vTexCoords).rgba;}
-    else if(push.entId == 5) {tex = texture(texSampler2, vTexCoords).rgba;}
-    else if(push.entId == 6) {tex = texture(texSampler3, vTexCoords).rgba;}
-    else if(push.entId == 7) {tex = texture(texSampler4, vTexCoords).rgba;}
-    else if(push.entId == 8) {tex = texture(texSampler5, vTexCoords).rgba;}
+    if(vTexture == 0u) {tex = texture(texSampler, vTexCoords).rgba;}
+    else if(vTexture == 1u) {tex = texture(texSampler1, vTexCoords).rgba;}
+    else if(vTexture == 2u) {tex = texture(texSampler1, vTexCoords).rgba;}
+    else if(vTexture == 3u) {tex = texture(texSampler1, vTexCoords).rgba;}
+    else if(vTexture == 4u) {tex = texture(texSampler1, vTexCoords).rgba;}
+    else if(vTexture == 5u) {tex = texture(texSampler2, vTexCoords).rgba;}
+    else if(vTexture == 6u) {tex = texture(texSampler3, vTexCoords).rgba;}
+    else if(vTexture == 7u) {tex = texture(texSampler4, vTexCoords).rgba;}
+    else if(vTexture == 8u) {tex = texture(texSampler5, vTexCoords).rgba;}
 
 
     if(tex.a < 1.0)
@@ -3,18 +3,61 @@
 layout(location = 0) in vec2 aPosition;
 layout(location = 1) in vec2 aTexCoords;
 
+// Only where this draw's instances start and which frame in flight it's for, everything else is
+// in buffers (see Sprite2DSystem).
 layout(push_constant) uniform Push 
 {
-    mat4 modelMatrix;
-    mat4 viewProjectionMatrix;
-    int entId;
+    uint baseInstance;
+    uint frameIndex;
 } push;
 
+// Every frame of every sprite sheet as a UV rect (xy: offset, zw: size), see SpriteAnimationLibrary.
+layout(set = 0, binding = 6) readonly buffer FrameTable
+{
+    vec4 rects[];
+} frameTable;
+
+// The animation frame each instance is on, written by the CPU every frame.
+layout(set = 0, binding = 7) readonly buffer InstanceFrames
+{
+    uint frames[];
+} instanceFrames;
+
+// Shared by every draw in a frame, one per frame in flight (SwapChain::FRAMES_IN_FLIGHT).
+layout(set = 0, binding = 8) uniform Frames
+{
+    mat4 viewProjectionMatrix[2];
+} frames;
+
+// Everything that used to be pushed per draw, see SpriteInstance.
+struct Instance
+{
+    mat4 modelMatrix;
+    uint texture;
+};
+
+layout(set = 0, binding = 9) readonly buffer Instances
+{
+    Instance instances[];
+} instances;
+
+// The instances that survived culling, in the order they were submitted (see cull.comp). Each
+// frame in flight has its own slice, starting at the base instance.
+layout(set = 0, binding = 10) readonly buffer VisibleInstances
+{
+    uint indices[];
+} visibleInstances;
+
 layout(location = 1) out vec2 vTexCoords;
+layout(location = 2) flat out uint vTexture;
 
 void main() 
 {
-    vTexCoords = aTexCoords;
-    gl_Position = push.viewProjectionMatrix * push.modelMatrix * vec4(aPosition, 0.0, 1.0);
-}
+    uint instance = visibleInstances.indices[push.baseInstance + gl_InstanceIndex];
 
+    vec4 rect = frameTable.rects[instanceFrames.frames[instance]];
+    vTexCoords = rect.xy + aTexCoords * rect.zw;
+    vTexture = instances.instances[instance].texture;
+
+    gl_Position = frames.viewProjectionMatrix[push.frameIndex] * instances.instances[instance].modelMatrix * vec4(aPosition, 0.0, 1.0);
+}
@@ -0,0 +1,45 @@
+#version 450
+
+// Samples a virtual texture (see Graphics/Shader/VirtualTexture.hpp): the page table says which
+// atlas slot holds each page, or the closest coarser page that's resident while it streams in.
+
+layout(location = 0) out vec4 FragColor;
+layout(location = 1) in vec2 vTexCoords;
+
+layout(push_constant) uniform Push
+{
+    // After the vertex stage's block (see simple.vert).
+    layout(offset = 16) vec4 virtualInfo;   // xy: size of level 0 in texels, z: level count, w: page size.
+    vec4 atlasInfo;                         // x: page border, y: slot size, zw: 1 / atlas size.
+} push;
+
+layout(set = 0, binding = 0) uniform usampler2D pageTable;
+layout(set = 0, binding = 1) uniform sampler2D pageAtlas;
+
+void main()
+{
+    vec2 texel = vTexCoords * push.virtualInfo.xy;
+    float pageSize = push.virtualInfo.w;
+
+    // Same level the CPU requests: one level per doubling of texels per pixel.
+    vec2 dx = dFdx(texel);
+    vec2 dy = dFdy(texel);
+    float lod = clamp(floor(0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1.0))), 0.0, push.virtualInfo.z - 1.0);
+
+    ivec2 page = ivec2(texel / (pageSize * exp2(lod)));
+    uvec4 entry = texelFetch(pageTable, page, int(lod));
+
+    if(entry.a == 0u)
+        discard;
+
+    // Offset within the page of the level that's actually resident.
+    vec2 levelTexel = texel / exp2(float(entry.b));
+    vec2 inPage = levelTexel - floor(levelTexel / pageSize) * pageSize;
+
+    vec2 atlasTexel = vec2(entry.rg) * push.atlasInfo.y + push.atlasInfo.x + inPage;
+    vec4 tex = textureLod(pageAtlas, atlasTexel * push.atlasInfo.zw, 0.0);
+
+    if(tex.a < 1.0)
+        discard;
+    FragColor = tex;
+}
@@ -0,0 +1,204 @@
+#include "SpriteAnimation.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define MAMMOTH_ANIMATION_SSE2
+#endif
+
+namespace mt
+{
+
+// Helper Functions.
+//---
+
+// std::floor() is a library call unless SSE4.1 is enabled, this is a couple of instructions.
+static inline float Floor(float value)
+{
+    float truncated = static_cast<float>(static_cast<int32_t>(value));
+    return truncated > value ? truncated - 1.0f : truncated;
+}
+
+// Written without branches on the loop mode: scenes mix modes freely, and mispredicting
+// them costs more than computing both outcomes.
+static inline uint32_t Animate(const AnimationClip& clip, float deltaTime, SpriteAnimationComp& animation)
+{
+    float rate = clip.framesPerSecond;
+    float frameCount = static_cast<float>(clip.frameCount);
+    float frames = (animation.time + deltaTime * animation.speed) * rate;
+
+    bool isOnce = animation.loop == AnimationLoop::Once;
+    bool isPingPong = animation.loop == AnimationLoop::PingPong && clip.frameCount > 1;
+    float period = isPingPong ? frameCount * 2.0f - 2.0f : frameCount;
+
+    // Wrapping the time keeps it precise however long the clip has been playing.
+    float wrapped = frames - Floor(frames / period) * period;
+    float clamped = std::min(std::max(frames, 0.0f), frameCount);
+
+    frames = isOnce ? clamped : wrapped;
+    animation.time = frames / rate;
+
+    float frame = std::min(Floor(frames), period - 1.0f);
+    frame = frame >= frameCount ? period - frame : frame;
+
+    return clip.firstFrame + static_cast<uint32_t>(frame);
+}
+
+#ifdef MAMMOTH_ANIMATION_SSE2
+static inline __m128 Floor(__m128 value)
+{
+    __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(value));
+    return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, value), _mm_set1_ps(1.0f)));
+}
+
+static inline __m128 Select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static_assert(sizeof(SpriteAnimationComp) == 16, "Animate4() loads each SpriteAnimationComp as one vector!");
+
+// Animate() for four sprites at once, with identical results.
+static inline void Animate4(const AnimationClip* clips, __m128 deltaTime, SpriteAnimationComp* animations, uint32_t* frames)
+{
+    // Rows are sprites, columns are clip, time, speed and loop (plus padding).
+    __m128 clip = _mm_loadu_ps(reinterpret_cast<const float*>(&animations[0]));
+    __m128 time = _mm_loadu_ps(reinterpret_cast<const float*>(&animations[1]));
+    __m128 speed = _mm_loadu_ps(reinterpret_cast<const float*>(&animations[2]));
+    __m128 loopBits = _mm_loadu_ps(reinterpret_cast<const float*>(&animations[3]));
+    _MM_TRANSPOSE4_PS(clip, time, speed, loopBits);
+
+    const AnimationClip& c0 = clips[animations[0].clip];
+    const AnimationClip& c1 = clips[animations[1].clip];
+    const AnimationClip& c2 = clips[animations[2].clip];
+    const AnimationClip& c3 = clips[animations[3].clip];
+
+    __m128 rate = _mm_setr_ps(c0.framesPerSecond, c1.framesPerSecond, c2.framesPerSecond, c3.framesPerSecond);
+    __m128 frameCount = _mm_cvtepi32_ps(_mm_setr_epi32(static_cast<int32_t>(c0.frameCount), static_cast<int32_t>(c1.frameCount),
+        static_cast<int32_t>(c2.frameCount), static_cast<int32_t>(c3.frameCount)));
+    __m128i firstFrame = _mm_setr_epi32(static_cast<int32_t>(c0.firstFrame), static_cast<int32_t>(c1.firstFrame),
+        static_cast<int32_t>(c2.firstFrame), static_cast<int32_t>(c3.firstFrame));
+
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    __m128i loop = _mm_and_si128(_mm_castps_si128(loopBits), _mm_set1_epi32(0xFF));
+    __m128 isOnce = _mm_castsi128_ps(_mm_cmpeq_epi32(loop, _mm_set1_epi32(static_cast<int32_t>(AnimationLoop::Once))));
+    __m128 isPingPong = _mm_and_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(loop, _mm_set1_epi32(static_cast<int32_t>(AnimationLoop::PingPong)))),
+        _mm_cmpgt_ps(frameCount, one));
+
+    __m128 elapsed = _mm_mul_ps(_mm_add_ps(time, _mm_mul_ps(deltaTime, speed)), rate);
+    __m128 period = Select(isPingPong, _mm_sub_ps(_mm_add_ps(frameCount, frameCount), _mm_set1_ps(2.0f)), frameCount);
+
+    __m128 wrapped = _mm_sub_ps(elapsed, _mm_mul_ps(Floor(_mm_div_ps(elapsed, period)), period));
+    __m128 clamped = _mm_min_ps(_mm_max_ps(elapsed, _mm_setzero_ps()), frameCount);
+    elapsed = Select(isOnce, clamped, wrapped);
+
+    alignas(16) float times[4];
+    _mm_store_ps(times, _mm_div_ps(elapsed, rate));
+    for(int i = 0; i < 4; i++)
+    {
+        animations[i].time = times[i];
+    }
+
+    __m128 frame = _mm_min_ps(Floor(elapsed), _mm_sub_ps(period, one));
+    frame = Select(_mm_cmpge_ps(frame, frameCount), _mm_sub_ps(period, frame), frame);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(frames), _mm_add_epi32(_mm_cvttps_epi32(frame), firstFrame));
+}
+#endif
+
+//---
+
+SpriteAnimationLibrary::SpriteAnimationLibrary()
+{
+    mFrames.push_back(glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+}
+
+uint32_t SpriteAnimationLibrary::AddFrame(const glm::vec4& uvRect)
+{
+    mFrames.push_back(uvRect);
+    return static_cast<uint32_t>(mFrames.size() - 1);
+}
+
+uint32_t SpriteAnimationLibrary::AddGrid(uint32_t columns, uint32_t rows, uint32_t count)
+{
+    if(columns == 0 || rows == 0)
+    {
+        throw std::runtime_error("A sprite sheet needs at least one row and column!");
+    }
+
+    count = count == 0 ? columns * rows : std::min(count, columns * rows);
+
+    uint32_t first = static_cast<uint32_t>(mFrames.size());
+    glm::vec2 size{1.0f / columns, 1.0f / rows};
+
+    for(uint32_t i = 0; i < count; i++)
+    {
+        uint32_t column = i % columns;
+        uint32_t row = i / columns;
+
+        // The first row is the top of the image, which is the end of the texture's V axis.
+        mFrames.push_back(glm::vec4(column * size.x, 1.0f - (row + 1) * size.y, size.x, size.y));
+    }
+
+    return first;
+}
+
+uint32_t SpriteAnimationLibrary::AddClip(const std::string& name, const AnimationClip& clip)
+{
+    if(clip.frameCount == 0 || clip.firstFrame + clip.frameCount > mFrames.size() || !(clip.framesPerSecond > 0.0f))
+    {
+        throw std::runtime_error("Animation clip " + name + " refers to frames that don't exist, or has no frame rate!");
+    }
+    if(mClipNames.count(name))
+    {
+        throw std::runtime_error("There's already an animation clip called " + name);
+    }
+
+    mClips.push_back(clip);
+    mClipNames[name] = static_cast<uint32_t>(mClips.size() - 1);
+
+    return static_cast<uint32_t>(mClips.size() - 1);
+}
+
+uint32_t SpriteAnimationLibrary::FindClip(const std::string& name) const
+{
+    auto clip = mClipNames.find(name);
+    if(clip == mClipNames.end())
+    {
+        throw std::runtime_error("No animation clip called " + name);
+    }
+
+    return clip->second;
+}
+
+void AnimateSprites(const AnimationClip* clips, float deltaTime, SpriteAnimationComp* animations, uint32_t* frames, size_t count)
+{
+    size_t i = 0;
+
+#ifdef MAMMOTH_ANIMATION_SSE2
+    __m128 step = _mm_set1_ps(deltaTime);
+    for(; i + 4 <= count; i += 4)
+    {
+        Animate4(clips, step, animations + i, frames + i);
+    }
+#endif
+
+    for(; i < count; i++)
+    {
+        frames[i] = Animate(clips[animations[i].clip], deltaTime, animations[i]);
+    }
+}
+
+void AnimateSprites(JobSystem& jobSystem, const AnimationClip* clips, float deltaTime, SpriteAnimationComp* animations, uint32_t* frames, size_t count)
+{
+    // Each chunk is a few microseconds of work, enough to dwarf the cost of scheduling it.
+    jobSystem.ParallelFor(0, count, 16384, [=](size_t begin, size_t end)
+    {
+        AnimateSprites(clips, deltaTime, animations + begin, frames + begin, end - begin);
+    });
+}
+
+}
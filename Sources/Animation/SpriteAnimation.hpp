@@ -0,0 +1,101 @@
+#ifndef MAMMOTH_2D_SPRITE_ANIMATION_HPP
+#define MAMMOTH_2D_SPRITE_ANIMATION_HPP
+
+#include "Jobs/JobSystem.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mt
+{
+
+enum class AnimationLoop : uint8_t
+{
+    Once = 0,       // Holds the last frame.
+    Loop = 1,
+    PingPong = 2    // Forwards, then backwards, without repeating the end frames.
+};
+
+/**
+ * @brief A run of consecutive frames in a SpriteAnimationLibrary.
+*/
+struct AnimationClip
+{
+    uint32_t firstFrame = 0;
+    uint32_t frameCount = 1;
+    float framesPerSecond = 12.0f;
+};
+
+/**
+ * @brief Per-entity playback state, the ECS component animated by AnimateSprites().
+*/
+struct SpriteAnimationComp
+{
+    uint32_t clip = 0;
+    float time = 0.0f;      // Seconds into the clip, kept within one period for looping clips.
+    float speed = 1.0f;     // Negative plays backwards.
+    AnimationLoop loop = AnimationLoop::Loop;
+};
+
+/**
+ * @brief The frames of every sprite sheet and the clips that play them. Frames are UV rects
+ * (xy: offset, zw: size) into their sheet, and are what the sprite shader reads from its frame
+ * table, so a sprite only needs its frame index on the GPU. Frame 0 is always the whole texture,
+ * which is what sprites without an animation use.
+*/
+class SpriteAnimationLibrary
+{
+public:
+    SpriteAnimationLibrary();
+
+    uint32_t AddFrame(const glm::vec4& uvRect);
+
+    /**
+     * @brief Adds the cells of a sheet laid out in a grid, row by row starting from the top left
+     * of the image as drawn (images are loaded bottom-up, see Image::Decode()).
+     * @param count Cells to add, 0 for all of them.
+     * @return The index of the first frame added.
+    */
+    uint32_t AddGrid(uint32_t columns, uint32_t rows, uint32_t count = 0);
+
+    /**
+     * @return The clip's index, which is what SpriteAnimationComp::clip refers to. Throws if the
+     * frames don't exist or the name is taken.
+    */
+    uint32_t AddClip(const std::string& name, const AnimationClip& clip);
+
+    /**
+     * @return The clip's index. Throws if there's no clip with that name.
+    */
+    uint32_t FindClip(const std::string& name) const;
+
+    inline const std::vector<glm::vec4>& GetFrames() const { return mFrames; }
+    inline const std::vector<AnimationClip>& GetClips() const { return mClips; }
+
+private:
+    std::vector<glm::vec4> mFrames{};
+    std::vector<AnimationClip> mClips{};
+    std::unordered_map<std::string, uint32_t> mClipNames{};
+};
+
+/**
+ * @brief Advances count animations by deltaTime and writes the frame each one is on. Meant to
+ * run over the component columns of every animated entity at once: branch-light, no
+ * allocation, and the clips are small enough to stay in cache.
+ * @param frames Receives one frame index per animation, ready to be uploaded as is.
+*/
+void AnimateSprites(const AnimationClip* clips, float deltaTime, SpriteAnimationComp* animations, uint32_t* frames, size_t count);
+
+/**
+ * @brief The same, split over the job system - only worth it for tens of thousands of sprites.
+*/
+void AnimateSprites(JobSystem& jobSystem, const AnimationClip* clips, float deltaTime, SpriteAnimationComp* animations, uint32_t* frames, size_t count);
+
+}
+
+#endif
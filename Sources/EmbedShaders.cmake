@@ -0,0 +1,52 @@
+# Writes the SPIR-V binaries given in INPUTS (separated by '|') into OUTPUT as constexpr uint32_t
+# arrays, plus a table of them sorted by name for EmbeddedShaders.cpp to search.
+# Run as a script: cmake -DINPUTS=<a.spv|b.spv> -DOUTPUT=<header> -P EmbedShaders.cmake
+
+string(REPLACE "|" ";" INPUTS "${INPUTS}")
+list(SORT INPUTS)
+
+set(ARRAYS "")
+set(TABLE "")
+set(COUNT 0)
+
+foreach(INPUT ${INPUTS})
+  # simple.vert.spv -> "simple.vert", sShader_simple_vert.
+  get_filename_component(FILE_NAME ${INPUT} NAME)
+  string(REGEX REPLACE "\\.spv$" "" NAME ${FILE_NAME})
+  string(MAKE_C_IDENTIFIER "sShader_${NAME}" IDENTIFIER)
+
+  file(READ ${INPUT} HEX HEX)
+  string(LENGTH "${HEX}" HEX_LENGTH)
+  math(EXPR REMAINDER "${HEX_LENGTH} % 8")
+  if(HEX_LENGTH EQUAL 0 OR NOT REMAINDER EQUAL 0)
+    message(FATAL_ERROR "${INPUT} isn't a valid SPIR-V binary!")
+  endif()
+
+  # SPIR-V is a stream of little endian words.
+  string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1u, " WORDS "${HEX}")
+  # Eight words to a line (CMake's regular expressions have no {n} repetition).
+  set(LINE_PATTERN "")
+  foreach(I RANGE 1 8)
+    string(APPEND LINE_PATTERN "0x[0-9a-f]+u, ")
+  endforeach()
+  string(REGEX REPLACE "(${LINE_PATTERN})" "\\1\n    " WORDS "${WORDS}")
+  string(REPLACE " \n" "\n" WORDS "${WORDS}")
+  string(STRIP "${WORDS}" WORDS)
+
+  string(APPEND ARRAYS "static constexpr uint32_t ${IDENTIFIER}[] =\n{\n    ${WORDS}\n};\n\n")
+  string(APPEND TABLE "    {\"${NAME}\", ${IDENTIFIER}, sizeof(${IDENTIFIER}) / sizeof(uint32_t)},\n")
+  math(EXPR COUNT "${COUNT} + 1")
+endforeach()
+
+file(WRITE ${OUTPUT}.tmp
+  "// Generated by EmbedShaders.cmake from the compiled shaders - do not edit.\n"
+  "// Only included by EmbeddedShaders.cpp, inside namespace mt.\n\n"
+  "${ARRAYS}"
+  "static constexpr size_t sEmbeddedShaderCount = ${COUNT};\n\n"
+  "// Sorted by name. The empty entry at the end keeps the array valid when there are no shaders.\n"
+  "static constexpr EmbeddedShader sEmbeddedShaders[] =\n{\n${TABLE}    {\"\", nullptr, 0}\n};\n"
+)
+
+# Only touch the header when it actually changes, so unchanged shaders don't trigger a rebuild.
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different ${OUTPUT}.tmp ${OUTPUT})
+file(REMOVE ${OUTPUT}.tmp)
@@ -1,4 +1,8 @@
 #include "Engine.hpp"
+#include "Game.hpp"
+#include "Profiler/Profiler.hpp"
+#include "Graphics/Shader/Image.hpp"
+#include "Graphics/Shader/Shader.hpp"
 
 #include <chrono>
 #include <stdexcept>
@@ -8,14 +12,72 @@ namespace mt
 {
 
 Engine::Engine(EngineDesc* config)
-    : mWindow{config->windowName, config->windowWidth, config->windowHeight}
+    : mJobSystem{config->workerCount},
+    mFrameAllocator{mJobSystem, SwapChain::FRAMES_IN_FLIGHT, config->frameArenaSize, config->workerArenaSize},
+    mResourceManager{mJobSystem, config->uploadsPerFrame},
+    mWindow{config->windowName, config->windowWidth, config->windowHeight, config->headless},
+    mTracePath{config->tracePath},
+    mCapturePath{config->capturePath},
+    mFrameTimesPath{config->frameTimesPath},
+    mFrameLimit{config->frameLimit}
 {
-    mGraphics = std::make_unique<Graphics>(mWindow);
+    MT_PROFILE_THREAD("Main");
+
+    Logger::Get().Configure(config->log);
+
+    mGraphics = std::make_unique<Graphics>(mWindow, mJobSystem, config->headlessSurface, config->depthBuffer);
+
+    // Nothing that's loaded becomes Resident until these exist.
+    Device& device = mGraphics->GetDevice();
+    mResourceManager.SetImageBatchUploader([&device](const std::vector<const ImageData*>& data)
+    {
+        return Image::UploadBatch(device, data);
+    });
+    mResourceManager.SetShaderFactory([&device](const std::string& vertexPath, const std::string& fragmentPath)
+    {
+        return std::make_unique<Shader>(device, vertexPath.c_str(), fragmentPath.c_str());
+    });
+
+    VkPhysicalDevice physicalDevice = mGraphics->GetPhysicalDevice().GetPhysicalDevice();
+    mResourceManager.SetTextureCodecs(Image::GetSupportedCodecs(physicalDevice));
+    mResourceManager.SetCpuMipmaps(!Image::SupportsLinearBlit(physicalDevice, VK_FORMAT_R8G8B8A8_SRGB));
+
+    if(config->packPath) 
+    {
+        mResourceManager.MountPack(config->packPath, config->packRoot);
+    }
+
+    mResourceManager.SetRetireQueue(&mRetireQueue);
+    mGraphics->GetRenderer()->GetPipelineBuildQueue().SetRetireQueue(&mRetireQueue);
+
+    if(config->hotReloadDirectory) 
+    {
+        mResourceManager.EnableHotReload(config->hotReloadDirectory, config->shaderCompiler);
+        mGraphics->GetRenderer()->EnableShaderReload(mResourceManager);
+        Shader::SetEmbeddedShadersEnabled(false);
+    }
+
+    if(config->replayPath) 
+    {
+        mReplayer = std::make_unique<InputReplayer>(config->replayPath);
+        mInput.SetReplaying(true);
+    }
+    else if(config->recordPath) 
+    {
+        mRecorder = std::make_unique<InputRecorder>(config->recordPath);
+        mInput.SetRecorder(mRecorder.get());
+    }
 }
 
 Engine::~Engine()
 {
-    
+    mInput.SetRecorder(nullptr);
+
+    // GPU resources have to go before the device does.
+    mResourceManager.UnloadAll();
+    mRetireQueue.Flush();
+
+    Logger::Get().Flush();
 }
 
 void Engine::SetGame(std::unique_ptr<IGame>&& game) 
@@ -26,26 +88,89 @@ void Engine::SetGame(std::unique_ptr<IGame>&& game)
 
 void Engine::Update() 
 {
-    mWindow.ListenToEvents();
-
-    mInput.ListenToKeyboard(mWindow.GetNativeWindow());
-
     auto previousFrame = std::chrono::high_resolution_clock::now();
 
-    while(mWindow.IsRunning()) 
+    RecordedFrame replayFrame{};
+
+    while(mWindow.IsRunning() && (mFrameLimit == 0 || mFrameNumber < mFrameLimit)) 
     {
+        MT_PROFILE_FRAME();
+        MT_PROFILE_SCOPE("Engine::Update");
+
         auto currentFrame = std::chrono::high_resolution_clock::now();
 
+        // Everything allocated from the frame arenas two frames ago is released here.
+        mFrameAllocator.BeginFrame(mFrameNumber % SwapChain::FRAMES_IN_FLIGHT);
+        mRetireQueue.BeginFrame(mFrameNumber);
+
         std::chrono::duration<double> ts = currentFrame - previousFrame;
+        previousFrame = currentFrame;
+
+        // Still polled while replaying so that the window can be closed, but Input drops
+        // the live keys.
+        mWindow.ListenToEvents();
+        mInput.ListenToKeyboard(mWindow.GetNativeWindow());
+
+        // A replay replaces both sources of non-determinism - live input and wall-clock time.
+        if(mReplayer) 
+        {
+            if(!mReplayer->ReadFrame(replayFrame)) 
+            {
+                MT_LOG_INFO("Replay finished after {} frames", mFrameNumber);
+                break;
+            }
+
+            for(const auto& key : replayFrame.keys) 
+            {
+                mInput.InjectKey(key.key, key.action, key.mods);
+            }
+
+            ts = std::chrono::duration<double>(replayFrame.timestep);
+        }
+
+        if(mRecorder) 
+        {
+            mRecorder->CommitFrame(mFrameNumber, ts.count());
+        }
+
+        // Uploads whatever the workers finished decoding since last frame.
+        mResourceManager.Update();
 
         // Purely game logic being updated here - no rendering of sorts.
-        mGame->Run(ts);
+        // This is where games run their ECS systems, hence the zone name.
+        {
+            MT_PROFILE_SCOPE("ECS::RunSystems");
+            mGame->Run(ts);
+        }
+
+        // Sprite animations are played from what the game set this frame.
+        mGraphics->GetRenderer()->Update(static_cast<float>(ts.count()));
 
         // Renders all Entities. 
         mGraphics->Update();
+
+        std::chrono::duration<double> cpuTime = std::chrono::high_resolution_clock::now() - currentFrame;
+        mFrameTimes.Record(mFrameNumber, ts.count(), cpuTime.count());
+
+        mFrameNumber++;
     }
 
     WaitDevice();
+
+    if(mCapturePath) 
+    {
+        mGraphics->CaptureFrame(mCapturePath);
+    }
+
+    if(mTracePath) 
+    {
+        MT_PROFILE_EXPORT(mTracePath);
+    }
+
+    if(mFrameTimesPath) 
+    {
+        mFrameTimes.WriteCSV(mFrameTimesPath);
+    }
 }
 
 void Engine::WaitDevice() 
@@ -6,7 +6,12 @@
 #include "Input.hpp"
 #include "Events/Bus.hpp"
 #include "ResourceManager.hpp"
-#include "Game.hpp"
+#include "Jobs/JobSystem.hpp"
+#include "Memory/FrameAllocator.hpp"
+#include "Memory/RetireQueue.hpp"
+#include "Logging.hpp"
+#include "Profiler/FrameTimes.hpp"
+#include "Replay/InputRecording.hpp"
 #include <Delta/ECS.hpp>
 
 #include <vector>
@@ -14,11 +19,56 @@
 namespace mt
 {
 
+// Game.hpp includes this header, since games are built around the engine.
+class IGame;
+
 struct EngineDesc 
 {
     uint32_t windowWidth;
     uint32_t windowHeight;
     const char* windowName;
+    // Number of job system worker threads on top of the main thread (0 picks one per spare core).
+    uint32_t workerCount = 0;
+    // Per-frame scratch memory for the main thread and for each worker, in bytes.
+    size_t frameArenaSize = 4 * 1024 * 1024;
+    size_t workerArenaSize = 512 * 1024;
+    // Maximum number of decoded images handed to the GPU per frame while assets stream in.
+    uint32_t uploadsPerFrame = 8;
+    // Asset pack (built by the AssetPack target) to read assets from, mounted at packRoot. Assets
+    // that aren't in it are still loaded from disk.
+    const char* packPath = nullptr;
+    const char* packRoot = ".";
+    // Development only: watches this directory (e.g: "Resources") and hot reloads the shaders
+    // and images in it as they're edited. GLSL is recompiled with shaderCompiler.
+    const char* hotReloadDirectory = nullptr;
+    const char* shaderCompiler = "glslangValidator";
+    // Where to write a Chrome trace once the game loop exits (requires the MAMMOTH_PROFILER option).
+    const char* tracePath = nullptr;
+    // Log output (console, text file or binary file) and runtime severity filter.
+    LogDesc log{};
+    // Runs without GLFW (no window, no input), rendering windowWidth x windowHeight offscreen.
+    // Meant for servers and CI, including GPU-less machines running a software ICD (lavapipe).
+    bool headless = false;
+    // Headless only: present to a VK_EXT_headless_surface swapchain when the driver has one.
+    bool headlessSurface = false;
+    // Sprites overlap in the order they're drawn in: by the layer in their render queue key, then
+    // by index within the sprite system's draw (see Sprite2DSystem::Submit()). Nothing needs
+    // depth to sort them, so by default there's no depth buffer at all. With one, it's a single
+    // transient image that's never stored (and lazily allocated where the device supports it),
+    // and pipelines depth test as usual.
+    bool depthBuffer = false;
+    // Stops the game loop after this many frames (0 runs until the window is closed). Headless
+    // runs have no window to close, so they should always set this.
+    uint64_t frameLimit = 0;
+    // Headless only: writes the final frame to this path as a PPM image once the loop exits.
+    const char* capturePath = nullptr;
+    // Records every key transition and timestep to this file (see Replay/InputRecording.hpp).
+    const char* recordPath = nullptr;
+    // Replays a recording instead of live input and wall-clock time, ending the loop once it
+    // runs out. Takes precedence over recordPath.
+    const char* replayPath = nullptr;
+    // Writes per-frame CPU times as CSV once the loop exits, for comparing replays across builds.
+    const char* frameTimesPath = nullptr;
 };
 
 
@@ -49,18 +99,21 @@ public:
     */
     void SetGame(std::unique_ptr<IGame>&& game);
 
-    inline const Window& GetWindow() const { return mWindow; }
-    inline dt::ECS& GetECS() { return mECS; }
-    inline ResourceManager& GetResourceManager() { return mResourceManager; }
-
-private:
     /**
      * @brief Begins the render loop and coordinates any runtime functions
-     * (event listeners, draw commands etc...).
-     * Please note that only a porton of the body of this function is within the render loop.  
+     * (event listeners, draw commands etc...), until the window is closed or frameLimit is hit.
+     * Call it once the game has been set.
     */
     void Update();
 
+    inline const Window& GetWindow() const { return mWindow; }
+    inline Graphics& GetGraphics() { return *mGraphics; }
+    inline dt::ECS& GetECS() { return mECS; }
+    inline ResourceManager& GetResourceManager() { return mResourceManager; }
+    inline JobSystem& GetJobSystem() { return mJobSystem; }
+    inline FrameAllocator& GetFrameAllocator() { return mFrameAllocator; }
+
+private:
     /**
      * @brief Blocks all commands to the logical device until the current commands have been
      * processed in full. This is required before any cleanup calls are made, since attempting
@@ -71,8 +124,16 @@ private:
     void WaitDevice();
 
 private:
+    // Declared first so that it's constructed before, and destroyed after, anything that
+    // might submit jobs to it.
+    JobSystem mJobSystem;
+    FrameAllocator mFrameAllocator;
+
     EventBus mEventBus{};
-    ResourceManager mResourceManager{};
+    // Assets replaced by hot reloads wait here until no frame in flight uses them.
+    RetireQueue mRetireQueue{SwapChain::FRAMES_IN_FLIGHT + 1};
+    // Decodes on mJobSystem, so must be declared after it.
+    ResourceManager mResourceManager;
 
     Window mWindow;
     Input mInput{&mEventBus, &mWindow};
@@ -82,6 +143,16 @@ private:
     std::unique_ptr<Graphics> mGraphics = nullptr;
     
     std::unique_ptr<IGame> mGame = nullptr;
+
+    const char* mTracePath = nullptr;
+    const char* mCapturePath = nullptr;
+    const char* mFrameTimesPath = nullptr;
+
+    std::unique_ptr<InputRecorder> mRecorder = nullptr;
+    std::unique_ptr<InputReplayer> mReplayer = nullptr;
+    FrameTimes mFrameTimes{};
+    uint64_t mFrameLimit = 0;
+    uint64_t mFrameNumber = 0;
 };
 }
 
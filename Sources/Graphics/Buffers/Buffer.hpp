@@ -2,7 +2,7 @@
 #define MAMMOTH_2D_BUFFER_HPP
 
 #include <vulkan/vulkan.hpp>
-#include "Device.hpp"
+#include "Graphics/Devices/Device.hpp"
 
 namespace mt 
 {
@@ -1,7 +1,7 @@
 #ifndef MAMMOTH_2D_BUFFER_LAYOUT_HPP
 #define MAMMOTH_2D_BUFFER_LAYOUT_HPP
 
-#include "Device.hpp"
+#include "Graphics/Devices/Device.hpp"
 
 #include <vector>
 #include <cassert>
@@ -0,0 +1,160 @@
+#include "DescriptorAllocator.hpp"
+#include "Logging.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace mt
+{
+
+DescriptorAllocator::DescriptorAllocator(LogicalDevice& logicalDevice, uint32_t setsPerPool, const std::vector<DescriptorPoolRatio>& ratios)
+    : mLogicalDevice{logicalDevice}, mRatios{ratios.empty() ? GetDefaultRatios() : ratios}, mSetsPerPool{std::max(setsPerPool, 1u)}
+{
+
+}
+
+DescriptorAllocator::~DescriptorAllocator()
+{
+    for(VkDescriptorPool pool : mAllPools)
+    {
+        vkDestroyDescriptorPool(mLogicalDevice.GetDevice(), pool, nullptr);
+    }
+}
+
+const std::vector<DescriptorPoolRatio>& DescriptorAllocator::GetDefaultRatios()
+{
+    // Roughly what a 2D renderer's sets hold: a few buffers and textures each.
+    static const std::vector<DescriptorPoolRatio> ratios = {
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f},
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f},
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f},
+        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f}
+    };
+
+    return ratios;
+}
+
+VkDescriptorSet DescriptorAllocator::Allocate(VkDescriptorSetLayout layout)
+{
+    VkDescriptorSet set = Allocate(mPersistentPools, layout);
+    mStats.persistentSets++;
+
+    return set;
+}
+
+VkDescriptorSet DescriptorAllocator::AllocateTransient(uint32_t frameIndex, VkDescriptorSetLayout layout)
+{
+    VkDescriptorSet set = Allocate(mTransientPools[frameIndex], layout);
+    mStats.transientSets++;
+    mStats.totalTransientSets++;
+
+    return set;
+}
+
+void DescriptorAllocator::BeginFrame(uint32_t frameIndex)
+{
+    PoolList& pools = mTransientPools[frameIndex];
+
+    if(pools.current != VK_NULL_HANDLE)
+    {
+        pools.full.push_back(pools.current);
+        pools.current = VK_NULL_HANDLE;
+    }
+
+    for(VkDescriptorPool pool : pools.full)
+    {
+        vkResetDescriptorPool(mLogicalDevice.GetDevice(), pool, 0);
+        mFreePools.push_back(pool);
+        mStats.poolResets++;
+    }
+
+    mStats.transientSets -= pools.setCount;
+    pools.full.clear();
+    pools.setCount = 0;
+}
+
+VkDescriptorSet DescriptorAllocator::Allocate(PoolList& pools, VkDescriptorSetLayout layout)
+{
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &layout;
+
+    // A full pool fails with one of these, anything else is a real error. A fresh pool can
+    // still be too small for a single huge set, so only try once more.
+    for(int attempt = 0; attempt < 2; attempt++)
+    {
+        if(pools.current == VK_NULL_HANDLE)
+        {
+            pools.current = GetPool();
+        }
+
+        allocInfo.descriptorPool = pools.current;
+
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        VkResult result = vkAllocateDescriptorSets(mLogicalDevice.GetDevice(), &allocInfo, &set);
+
+        if(result == VK_SUCCESS)
+        {
+            pools.setCount++;
+            return set;
+        }
+        if(result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+        {
+            break;
+        }
+
+        pools.full.push_back(pools.current);
+        pools.current = VK_NULL_HANDLE;
+        mStats.exhaustedPools++;
+    }
+
+    throw std::runtime_error("Failed to allocate descriptor sets");
+}
+
+VkDescriptorPool DescriptorAllocator::GetPool()
+{
+    if(!mFreePools.empty())
+    {
+        VkDescriptorPool pool = mFreePools.back();
+        mFreePools.pop_back();
+        return pool;
+    }
+
+    VkDescriptorPool pool = CreatePool(mSetsPerPool);
+    mSetsPerPool = std::min(mSetsPerPool * 2, MAX_SETS_PER_POOL);
+
+    return pool;
+}
+
+VkDescriptorPool DescriptorAllocator::CreatePool(uint32_t setCount)
+{
+    std::vector<VkDescriptorPoolSize> poolSizes{};
+    for(const DescriptorPoolRatio& ratio : mRatios)
+    {
+        uint32_t count = std::max(static_cast<uint32_t>(ratio.ratio * setCount), 1u);
+        poolSizes.push_back(VkDescriptorPoolSize{ratio.type, count});
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = setCount;
+
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    if(vkCreateDescriptorPool(mLogicalDevice.GetDevice(), &poolInfo, nullptr, &pool) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create descriptor pool");
+    }
+
+    mAllPools.push_back(pool);
+    mStats.poolCount++;
+
+    MT_LOG_INFO("Created a descriptor pool for {} sets ({} pools in total)", setCount, mStats.poolCount);
+
+    return pool;
+}
+
+}
@@ -0,0 +1,101 @@
+#ifndef MAMMOTH_2D_DESCRIPTOR_ALLOCATOR_HPP
+#define MAMMOTH_2D_DESCRIPTOR_ALLOCATOR_HPP
+
+#include "Graphics/Devices/LogicalDevice.hpp"
+#include "Graphics/Renderer/SwapChain.hpp"
+
+#include <vector>
+
+namespace mt
+{
+
+/**
+ * @brief How many descriptors of a type a pool holds per set it can allocate.
+*/
+struct DescriptorPoolRatio
+{
+    VkDescriptorType type;
+    float ratio;
+};
+
+struct DescriptorAllocatorStats
+{
+    uint32_t poolCount = 0;             // Created so far, whether in use or waiting to be reused.
+    uint32_t persistentSets = 0;
+    uint32_t transientSets = 0;         // Allocated since the last reset, across every frame in flight.
+    uint32_t totalTransientSets = 0;
+    uint32_t poolResets = 0;
+    uint32_t exhaustedPools = 0;        // Allocations that found their pool full and moved on to another.
+};
+
+/**
+ * @brief Allocates descriptor sets of any layout without knowing up front how many there will be.
+ * Pools are created (each one bigger than the last, up to a limit) as the previous ones fill up,
+ * and reused once they're reset.
+ *
+ * Persistent sets live as long as the allocator. Transient sets belong to a frame in flight and
+ * are all freed at once with vkResetDescriptorPool() when that frame comes around again, which
+ * is far cheaper than freeing sets one by one. Not thread safe.
+*/
+class DescriptorAllocator
+{
+public:
+    /**
+     * @param setsPerPool Sets the first pool can allocate, later pools double it.
+     * @param ratios Descriptors per set in each pool, GetDefaultRatios() if empty.
+    */
+    DescriptorAllocator(LogicalDevice& logicalDevice, uint32_t setsPerPool = 64, const std::vector<DescriptorPoolRatio>& ratios = {});
+    ~DescriptorAllocator();
+
+    DescriptorAllocator(const DescriptorAllocator& other) = delete;
+    DescriptorAllocator& operator=(const DescriptorAllocator& other) = delete;
+
+    VkDescriptorSet Allocate(VkDescriptorSetLayout layout);
+
+    /**
+     * @return A set that's valid until the next BeginFrame() with the same frameIndex.
+    */
+    VkDescriptorSet AllocateTransient(uint32_t frameIndex, VkDescriptorSetLayout layout);
+
+    /**
+     * @brief Frees every transient set of frameIndex. Only call it once the GPU has finished
+     * with that frame, i.e. after waiting on its fence.
+    */
+    void BeginFrame(uint32_t frameIndex);
+
+    inline const DescriptorAllocatorStats& GetStats() const { return mStats; }
+
+    static const std::vector<DescriptorPoolRatio>& GetDefaultRatios();
+
+    static constexpr uint32_t MAX_SETS_PER_POOL = 4096;
+
+private:
+    // The pool being allocated from, and the ones that are already full.
+    struct PoolList
+    {
+        VkDescriptorPool current = VK_NULL_HANDLE;
+        std::vector<VkDescriptorPool> full{};
+        uint32_t setCount = 0;
+    };
+
+    VkDescriptorSet Allocate(PoolList& pools, VkDescriptorSetLayout layout);
+    VkDescriptorPool GetPool();
+    VkDescriptorPool CreatePool(uint32_t setCount);
+
+    LogicalDevice& mLogicalDevice;
+
+    std::vector<DescriptorPoolRatio> mRatios{};
+    uint32_t mSetsPerPool = 0;
+
+    PoolList mPersistentPools{};
+    PoolList mTransientPools[SwapChain::FRAMES_IN_FLIGHT]{};
+
+    // Reset pools, ready to be handed out again.
+    std::vector<VkDescriptorPool> mFreePools{};
+    std::vector<VkDescriptorPool> mAllPools{};
+
+    DescriptorAllocatorStats mStats{};
+};
+}
+
+#endif
@@ -0,0 +1,142 @@
+#include "DescriptorLayoutCache.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace mt
+{
+
+DescriptorLayoutCache::DescriptorLayoutCache(LogicalDevice& logicalDevice)
+    : mLogicalDevice{logicalDevice}
+{
+
+}
+
+DescriptorLayoutCache::~DescriptorLayoutCache()
+{
+    for(const auto& [key, layout] : mPipelineLayouts)
+    {
+        vkDestroyPipelineLayout(mLogicalDevice.GetDevice(), layout, nullptr);
+    }
+
+    for(const auto& [key, layout] : mSetLayouts)
+    {
+        vkDestroyDescriptorSetLayout(mLogicalDevice.GetDevice(), layout, nullptr);
+    }
+}
+
+VkDescriptorSetLayout DescriptorLayoutCache::GetSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+{
+    std::vector<VkDescriptorSetLayoutBinding> sorted = bindings;
+    std::sort(sorted.begin(), sorted.end(), [](const VkDescriptorSetLayoutBinding& a, const VkDescriptorSetLayoutBinding& b) { return a.binding < b.binding; });
+
+    Key key{};
+    key.reserve(sorted.size() * 4);
+
+    for(const auto& binding : sorted)
+    {
+        key.insert(key.end(), {binding.binding, static_cast<uint32_t>(binding.descriptorType), binding.descriptorCount, binding.stageFlags});
+    }
+
+    std::lock_guard<std::mutex> lock{mMutex};
+
+    auto existing = mSetLayouts.find(key);
+    if(existing != mSetLayouts.end())
+    {
+        return existing->second;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(sorted.size());
+    layoutInfo.pBindings = sorted.data();
+
+    VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+    if(vkCreateDescriptorSetLayout(mLogicalDevice.GetDevice(), &layoutInfo, nullptr, &layout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create descriptor set layout!");
+    }
+
+    mSetLayouts.emplace(std::move(key), layout);
+    return layout;
+}
+
+VkPipelineLayout DescriptorLayoutCache::GetPipelineLayout(const std::vector<VkDescriptorSetLayout>& setLayouts, const std::vector<VkPushConstantRange>& pushConstants)
+{
+    Key key{};
+    key.reserve(setLayouts.size() * 2 + pushConstants.size() * 3 + 1);
+
+    key.push_back(static_cast<uint32_t>(setLayouts.size()));
+    for(VkDescriptorSetLayout setLayout : setLayouts)
+    {
+        AppendHandle(key, setLayout);
+    }
+
+    for(const auto& range : pushConstants)
+    {
+        key.insert(key.end(), {range.stageFlags, range.offset, range.size});
+    }
+
+    std::lock_guard<std::mutex> lock{mMutex};
+
+    auto existing = mPipelineLayouts.find(key);
+    if(existing != mPipelineLayouts.end())
+    {
+        return existing->second;
+    }
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = setLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstants.size());
+    pipelineLayoutInfo.pPushConstantRanges = pushConstants.data();
+
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    if(vkCreatePipelineLayout(mLogicalDevice.GetDevice(), &pipelineLayoutInfo, nullptr, &layout) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create pipeline layout!");
+    }
+
+    mPipelineLayouts.emplace(std::move(key), layout);
+    return layout;
+}
+
+VkPipelineLayout DescriptorLayoutCache::GetPipelineLayout(const ShaderReflection& reflection, std::vector<VkDescriptorSetLayout>& setLayouts)
+{
+    std::vector<std::vector<VkDescriptorSetLayoutBinding>> sets(reflection.GetSetCount());
+
+    for(const auto& binding : reflection.bindings)
+    {
+        VkDescriptorSetLayoutBinding layoutBinding{};
+        layoutBinding.binding = binding.binding;
+        layoutBinding.descriptorType = binding.type;
+        layoutBinding.descriptorCount = binding.count;
+        layoutBinding.stageFlags = binding.stages;
+        layoutBinding.pImmutableSamplers = nullptr;
+
+        sets[binding.set].push_back(layoutBinding);
+    }
+
+    setLayouts.clear();
+    for(const auto& bindings : sets)
+    {
+        setLayouts.push_back(GetSetLayout(bindings));
+    }
+
+    return GetPipelineLayout(setLayouts, reflection.pushConstants);
+}
+
+size_t DescriptorLayoutCache::GetSetLayoutCount()
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    return mSetLayouts.size();
+}
+
+size_t DescriptorLayoutCache::GetPipelineLayoutCount()
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    return mPipelineLayouts.size();
+}
+
+}
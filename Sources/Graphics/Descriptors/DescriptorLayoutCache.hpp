@@ -0,0 +1,61 @@
+#ifndef MAMMOTH_2D_DESCRIPTOR_LAYOUT_CACHE_HPP
+#define MAMMOTH_2D_DESCRIPTOR_LAYOUT_CACHE_HPP
+
+#include "Graphics/Devices/LogicalDevice.hpp"
+#include "Graphics/Shader/ShaderReflection.hpp"
+#include "Hashing.hpp"
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace mt
+{
+
+/**
+ * @brief Owns every descriptor set layout and pipeline layout, and hands out the same handle
+ * for identical descriptions - shaders that share a set (or a whole interface) share the layout,
+ * which also keeps their descriptor sets compatible across pipelines. Layouts live until the
+ * cache is destroyed. Thread safe, since pipelines are built on worker jobs (see PipelineBuildQueue).
+*/
+class DescriptorLayoutCache
+{
+public:
+    DescriptorLayoutCache(LogicalDevice& logicalDevice);
+    ~DescriptorLayoutCache();
+
+    DescriptorLayoutCache(const DescriptorLayoutCache& other) = delete;
+    DescriptorLayoutCache& operator=(const DescriptorLayoutCache& other) = delete;
+
+    /**
+     * @param bindings In any order, immutable samplers aren't supported.
+    */
+    VkDescriptorSetLayout GetSetLayout(const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+
+    VkPipelineLayout GetPipelineLayout(const std::vector<VkDescriptorSetLayout>& setLayouts, const std::vector<VkPushConstantRange>& pushConstants);
+
+    /**
+     * @brief Builds the whole layout of a reflected shader. Sets it doesn't use (below the highest
+     * one it does) get an empty layout, as Vulkan requires.
+     * @param setLayouts Receives one layout per set, indexed by set number.
+    */
+    VkPipelineLayout GetPipelineLayout(const ShaderReflection& reflection, std::vector<VkDescriptorSetLayout>& setLayouts);
+
+    size_t GetSetLayoutCount();
+    size_t GetPipelineLayoutCount();
+
+private:
+    // Descriptions are flattened into words, which makes them trivial to hash and compare.
+    using Key = std::vector<uint32_t>;
+
+    using KeyHash = WordKeyHash;
+
+    LogicalDevice& mLogicalDevice;
+
+    std::mutex mMutex{};
+    std::unordered_map<Key, VkDescriptorSetLayout, KeyHash> mSetLayouts{};
+    std::unordered_map<Key, VkPipelineLayout, KeyHash> mPipelineLayouts{};
+};
+}
+
+#endif
@@ -5,25 +5,22 @@
 namespace mt 
 {
 
-DescriptorSet::DescriptorSet(Device& device, Pipeline* pipeline)
-    : mDevice{device}, mPipelineLayout{pipeline->GetPipelineLayout()}, mDescriptorPool{pipeline->GetDecsriptorPool()}, mPipelineBindPoint{pipeline->GetPipelineBindPoint()}
+DescriptorSet::DescriptorSet(DescriptorAllocator& allocator, Pipeline* pipeline)
+    : mPipelineLayout{pipeline->GetPipelineLayout()}, mPipelineBindPoint{pipeline->GetPipelineBindPoint()}
 {
-    VkDescriptorSetAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    allocInfo.descriptorPool = mDescriptorPool;
-    allocInfo.descriptorSetCount = 1;
-    allocInfo.pSetLayouts = &pipeline->GetDescriptorSetLayout();
+    mDescriptorSet = allocator.Allocate(pipeline->GetDescriptorSetLayout());
+}
 
-    if(vkAllocateDescriptorSets(mDevice.GetDevice(), &allocInfo, &mDescriptorSet) != VK_SUCCESS) 
-    {
-        throw std::runtime_error("Failed to allocate descriptor sets");
-    }
+DescriptorSet::DescriptorSet(DescriptorAllocator& allocator, Pipeline* pipeline, uint32_t frameIndex)
+    : mPipelineLayout{pipeline->GetPipelineLayout()}, mPipelineBindPoint{pipeline->GetPipelineBindPoint()}
+{
+    mDescriptorSet = allocator.AllocateTransient(frameIndex, pipeline->GetDescriptorSetLayout());
 }
 
 DescriptorSet::~DescriptorSet() 
 {
     // Desciptor sets are automatically destroyed by vulkan when the descriptor pool
-    // is destroyed by the Pipeline class.
+    // is destroyed by the DescriptorAllocator.
 }
 
 void DescriptorSet::Bind(VkCommandBuffer commandBuffer) 
@@ -1,8 +1,8 @@
 #ifndef MAMMOTH_2D_DESCRIPTOR_SET_HPP
 #define MAMMOTH_2D_DESCRIPTOR_SET_HPP
 
-#include "Device.hpp"
 #include "Graphics/Pipelines/Pipeline.hpp"
+#include "DescriptorAllocator.hpp"
 
 #include <vector>
 
@@ -11,7 +11,16 @@ namespace mt
 class DescriptorSet 
 {
 public:
-    DescriptorSet(Device& device, Pipeline* pipeline);
+    /**
+     * @brief Allocates set 0 of the pipeline's layout, which lives as long as the allocator.
+    */
+    DescriptorSet(DescriptorAllocator& allocator, Pipeline* pipeline);
+
+    /**
+     * @brief Allocates a transient set 0 of the pipeline's layout, which is freed by the
+     * allocator's next BeginFrame() with the same frameIndex.
+    */
+    DescriptorSet(DescriptorAllocator& allocator, Pipeline* pipeline, uint32_t frameIndex);
     ~DescriptorSet();
 
     inline const VkDescriptorSet GetDescriptorSet() const { return mDescriptorSet; }
@@ -19,11 +28,8 @@ public:
     void Bind(VkCommandBuffer commandBuffer);
 
 private:    
-    Device& mDevice;
-
     VkPipelineLayout mPipelineLayout;
     VkPipelineBindPoint mPipelineBindPoint;
-    VkDescriptorPool mDescriptorPool;
     VkDescriptorSet mDescriptorSet = VK_NULL_HANDLE;
 };
 }
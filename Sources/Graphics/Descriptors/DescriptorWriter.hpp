@@ -34,6 +34,12 @@ public:
         mWriteDescriptor[index].pTexelBufferView = nullptr;
     }
 
+    void WriteToStorageBuffer(uint32_t index, uint32_t binding, VkDescriptorBufferInfo& bufferInfo, DescriptorSet& descriptorSet) 
+    {
+        WriteToBuffer(index, binding, bufferInfo, descriptorSet);
+        mWriteDescriptor[index].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    }
+
     void WriteToImage(std::vector<VkDescriptorImageInfo>& imageInfo, DescriptorSet& descriptorSet) 
     {
         for(int i = 0; i < imageInfo.size(); i++)  
@@ -52,11 +58,21 @@ public:
 
     void UpdateDescriptorSet(Device& device) 
     {
-        vkUpdateDescriptorSets(device.GetDevice(), mWriteDescriptor.size(), mWriteDescriptor.data(), 0, nullptr);
+        // Only submit the bindings that have been written, the rest are still zeroed.
+        std::vector<VkWriteDescriptorSet> writes{};
+        for(const VkWriteDescriptorSet& write : mWriteDescriptor)
+        {
+            if(write.sType == VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET)
+            {
+                writes.push_back(write);
+            }
+        }
+
+        vkUpdateDescriptorSets(device.GetDevice(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
     }
 
 private:
-    std::vector<VkWriteDescriptorSet> mWriteDescriptor{6};
+    std::vector<VkWriteDescriptorSet> mWriteDescriptor{16};
 };
 }
 
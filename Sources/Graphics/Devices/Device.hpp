@@ -0,0 +1,43 @@
+#ifndef MAMMOTH_2D_DEVICE_HPP
+#define MAMMOTH_2D_DEVICE_HPP
+
+#include "Graphics/Devices/LogicalDevice.hpp"
+#include "Graphics/Devices/PhysicalDevice.hpp"
+#include "Graphics/Commands/CommandPool.hpp"
+
+namespace mt
+{
+
+/**
+ * @brief Everything buffers, images, shaders and pipelines need from the device in one place:
+ * the logical device to create them with, the physical device to query formats and memory on,
+ * and the command pool their one-off uploads are recorded from. Doesn't own any of them, Graphics
+ * does.
+*/
+class Device
+{
+public:
+    Device(const PhysicalDevice& physicalDevice, LogicalDevice& logicalDevice, const CommandPool& commandPool)
+        : mPhysicalDevice{physicalDevice}, mLogicalDevice{logicalDevice}, mCommandPool{commandPool}
+    {}
+
+    inline const VkDevice& GetDevice() const { return mLogicalDevice.GetDevice(); }
+    inline const VkPhysicalDevice& GetPhysicalDevice() const { return mPhysicalDevice.GetPhysicalDevice(); }
+    inline const VkQueue& GetGraphicsQueue() const { return mLogicalDevice.GetGraphicsQueue(); }
+    inline const VkCommandPool& GetCommandPool() const { return mCommandPool.GetCommandPool(); }
+
+    inline uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+    {
+        return mLogicalDevice.FindMemoryType(typeFilter, properties);
+    }
+
+    inline LogicalDevice& GetLogicalDevice() const { return mLogicalDevice; }
+
+private:
+    const PhysicalDevice& mPhysicalDevice;
+    LogicalDevice& mLogicalDevice;
+    const CommandPool& mCommandPool;
+};
+}
+
+#endif
\ No newline at end of file
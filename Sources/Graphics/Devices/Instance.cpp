@@ -1,6 +1,6 @@
 #include "Instance.hpp"
+#include "Logging.hpp"
 
-#include <iostream>
 #include <unordered_set>
 
 namespace mt 
@@ -14,7 +14,13 @@ static VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(
     const VkDebugUtilsMessengerCallbackDataEXT *pCallbackData,
     void *pUserData) 
 {
-  std::cerr << "validation layer: " << pCallbackData->pMessage << std::endl;
+  if(messageSeverity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT) 
+  {
+    MT_LOG_ERROR("validation layer: {}", pCallbackData->pMessage);
+  }
+  else {
+    MT_LOG_WARN("validation layer: {}", pCallbackData->pMessage);
+  }
 
   return VK_FALSE;
 }
@@ -35,8 +41,21 @@ VkResult CreateDebugUtilsMessengerEXT(
   }
 }
 
-Instance::Instance() 
+Instance::Instance(const Window& window, bool headlessSurface) 
+    : mWindow{window}
 {
+    // Software ICDs like lavapipe implement VK_EXT_headless_surface, most GPU drivers don't,
+    // so it's only ever a preference.
+    if(mWindow.IsHeadless() && headlessSurface) 
+    {
+        mHeadlessSurfaceEnabled = IsExtensionAvailable(VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME);
+
+        if(!mHeadlessSurfaceEnabled) 
+        {
+            MT_LOG_WARN("{} is unavailable, rendering offscreen without a surface", VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME);
+        }
+    }
+
     CreateInstance();
 }
 
@@ -58,7 +77,11 @@ void Instance::CreateInstance()
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = "No Engine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    // Dynamic rendering needs 1.2 (for VK_KHR_depth_stencil_resolve), older loaders still get 1.0.
+    uint32_t loaderVersion = VK_API_VERSION_1_0;
+    vkEnumerateInstanceVersion(&loaderVersion);
+    mApiVersion = loaderVersion >= VK_API_VERSION_1_2 ? VK_API_VERSION_1_2 : VK_API_VERSION_1_0;
+    appInfo.apiVersion = mApiVersion;
 
     VkInstanceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -144,19 +167,19 @@ void Instance::HasGLFWRequiredExtensions() const
     std::vector<VkExtensionProperties> extensions(extensionCount);
     vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
 
-    std::cout << "available extensions:" << std::endl;
+    MT_LOG_DEBUG("available extensions:");
     std::unordered_set<std::string> available;
     for (const auto &extension : extensions) 
     {
-        std::cout << "\t" << extension.extensionName << std::endl;
+        MT_LOG_DEBUG("\t{}", extension.extensionName);
         available.insert(extension.extensionName);
     }
 
-    std::cout << "required extensions:" << std::endl;
+    MT_LOG_DEBUG("required extensions:");
     auto requiredExtensions = GetAllRequiredExtensions();
     for (const auto &required : requiredExtensions) 
     {
-        std::cout << "\t" << required << std::endl;
+        MT_LOG_DEBUG("\t{}", required);
         if (available.find(required) == available.end()) 
         {
             throw std::runtime_error("Missing required glfw extension");
@@ -164,12 +187,41 @@ void Instance::HasGLFWRequiredExtensions() const
     }
 }
 
+bool Instance::IsExtensionAvailable(const char* name) const 
+{
+    uint32_t extensionCount = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
+
+    for (const auto &extension : extensions) 
+    {
+        if (strcmp(extension.extensionName, name) == 0) 
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 const std::vector<const char*> Instance::GetAllRequiredExtensions() const 
 {
-    uint32_t glfwExtensionCount = 0;
-    const char** glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-    std::vector<const char *> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    std::vector<const char *> extensions{};
+
+    // GLFW can't even be initialised without a display, so headless windows never ask it.
+    if (!mWindow.IsHeadless()) 
+    {
+        uint32_t glfwExtensionCount = 0;
+        const char** glfwExtensions;
+        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
+    else if (mHeadlessSurfaceEnabled) 
+    {
+        extensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
+        extensions.push_back(VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME);
+    }
 
     if (mEnableValidationLayers) 
     {
@@ -2,6 +2,7 @@
 #define MAMMOTH_2D_INSTANCE_HPP
 
 #include "Graphics/Renderer/SwapChain.hpp"
+#include "Window.hpp"
 
 namespace mt 
 {
@@ -21,12 +22,30 @@ public:
     #endif
 
 public:
-    Instance();
+    /**
+     * @param window Decides which surface extensions we need - GLFW's for a regular window,
+     * VK_EXT_headless_surface (if requested and available) or none at all for a headless one.
+     * @param headlessSurface Whether a headless window should try to present to a headless surface.
+    */
+    Instance(const Window& window, bool headlessSurface = false);
     ~Instance();
 
     inline const VkInstance& GetInstance() const { return mInstance; }
     inline const std::vector<const char*>& GeValidationLayers() const { return mValidationLayers; }
-    const std::vector<const char*> Instance::GetAllRequiredExtensions() const;
+    const std::vector<const char*> GetAllRequiredExtensions() const;
+
+    /**
+     * @brief Whether surfaces can be created at all. False for headless windows that render
+     * purely offscreen, in which case there's no surface, swapchain or presentation.
+    */
+    inline bool HasSurfaceSupport() const { return !mWindow.IsHeadless() || mHeadlessSurfaceEnabled; }
+    inline bool IsHeadlessSurfaceEnabled() const { return mHeadlessSurfaceEnabled; }
+
+    /**
+     * @brief Vulkan 1.2 when the loader supports it, 1.0 otherwise. Device features newer than
+     * this can't be used, whatever the device itself supports.
+    */
+    inline uint32_t GetApiVersion() const { return mApiVersion; }
 
 private:
     /**
@@ -50,9 +69,19 @@ private:
     */
     void HasGLFWRequiredExtensions() const;
 
+    /**
+     * @brief Checks whether the loader/ICDs expose an instance extension.
+    */
+    bool IsExtensionAvailable(const char* name) const;
+
 private:
+    const Window& mWindow;
+
     VkInstance mInstance;
 
+    bool mHeadlessSurfaceEnabled = false;
+    uint32_t mApiVersion = VK_API_VERSION_1_0;
+
     const std::vector<const char *> mValidationLayers = {"VK_LAYER_KHRONOS_validation"};
 };
 }
@@ -38,6 +38,10 @@ void LogicalDevice::CreateLogicalDevice()
 
     VkPhysicalDeviceFeatures deviceFeatures = {};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
+    // Whichever block compression families exist are enabled, cooked textures pick between them.
+    deviceFeatures.textureCompressionBC = mPhysicalDevice.GetFeatures().textureCompressionBC;
+    deviceFeatures.textureCompressionETC2 = mPhysicalDevice.GetFeatures().textureCompressionETC2;
+    deviceFeatures.textureCompressionASTC_LDR = mPhysicalDevice.GetFeatures().textureCompressionASTC_LDR;
 
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -46,6 +50,15 @@ void LogicalDevice::CreateLogicalDevice()
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
     createInfo.pEnabledFeatures = &deviceFeatures;
+
+    VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRendering{};
+    dynamicRendering.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+    dynamicRendering.dynamicRendering = VK_TRUE;
+    if(mPhysicalDevice.SupportsDynamicRendering()) 
+    {
+        createInfo.pNext = &dynamicRendering;
+    }
+
     createInfo.enabledExtensionCount = static_cast<uint32_t>(mPhysicalDevice.GetDeviceExtensions().size());
     createInfo.ppEnabledExtensionNames = mPhysicalDevice.GetDeviceExtensions().data();
 
@@ -67,6 +80,27 @@ void LogicalDevice::CreateLogicalDevice()
 
     vkGetDeviceQueue(mLogicalDevice, indices.graphicsFamily, 0, &mGraphicsQueue);
     vkGetDeviceQueue(mLogicalDevice, indices.presentFamily, 0, &mPresentQueue);
+
+    if(mPhysicalDevice.SupportsDynamicRendering()) 
+    {
+        mCmdBeginRendering = reinterpret_cast<PFN_vkCmdBeginRenderingKHR>(vkGetDeviceProcAddr(mLogicalDevice, "vkCmdBeginRenderingKHR"));
+        mCmdEndRendering = reinterpret_cast<PFN_vkCmdEndRenderingKHR>(vkGetDeviceProcAddr(mLogicalDevice, "vkCmdEndRenderingKHR"));
+
+        if(!mCmdBeginRendering || !mCmdEndRendering) 
+        {
+            throw std::runtime_error("failed to load the dynamic rendering commands!");
+        }
+    }
+
+    if(mPhysicalDevice.SupportsDrawIndirectCount()) 
+    {
+        mCmdDrawIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndirectCountKHR>(vkGetDeviceProcAddr(mLogicalDevice, "vkCmdDrawIndirectCountKHR"));
+
+        if(!mCmdDrawIndirectCount) 
+        {
+            throw std::runtime_error("failed to load vkCmdDrawIndirectCountKHR!");
+        }
+    }
 }
 
 // Helper Functions for interacting with buffers from outside of this class.
@@ -88,6 +122,23 @@ uint32_t LogicalDevice::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlag
     throw std::runtime_error("failed to find suitable memory type!");
 }
 
+bool LogicalDevice::HasMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+{
+    VkPhysicalDeviceMemoryProperties memProperties;
+
+    vkGetPhysicalDeviceMemoryProperties(mPhysicalDevice.GetPhysicalDevice(), &memProperties);
+
+    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) 
+    {
+        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) 
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 VkFormat LogicalDevice::FindSupportedFormat(const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features) const
 {
   for (VkFormat format : candidates) 
@@ -28,8 +28,34 @@ public:
     inline const VkQueue& GetPresentQueue() const { return mPresentQueue; }
     inline const VkQueue& GetGraphicsQueue() const { return mGraphicsQueue; }
 
+    /**
+     * @brief See PhysicalDevice::SupportsDynamicRendering(). When it does, CmdBeginRendering()
+     * and CmdEndRendering() replace render passes entirely.
+    */
+    inline bool SupportsDynamicRendering() const { return mCmdBeginRendering != nullptr; }
+
+    inline void CmdBeginRendering(VkCommandBuffer commandBuffer, const VkRenderingInfoKHR& renderingInfo) const { mCmdBeginRendering(commandBuffer, &renderingInfo); }
+    inline void CmdEndRendering(VkCommandBuffer commandBuffer) const { mCmdEndRendering(commandBuffer); }
+
+    /**
+     * @brief See PhysicalDevice::SupportsDrawIndirectCount(). Without it, draw with
+     * vkCmdDrawIndirect() and a fixed draw count instead.
+    */
+    inline bool SupportsDrawIndirectCount() const { return mCmdDrawIndirectCount != nullptr; }
+
+    inline void CmdDrawIndirectCount(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, uint32_t maxDrawCount, uint32_t stride) const
+    {
+        mCmdDrawIndirectCount(commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+    }
+
     uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
 
+    /**
+     * @brief Like FindMemoryType(), but for optional properties (e.g. lazily allocated memory).
+     * @return Whether any type in the filter has every property.
+    */
+    bool HasMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+
     VkFormat FindSupportedFormat(
         const std::vector<VkFormat> &candidates, 
         VkImageTiling tiling, 
@@ -78,6 +104,11 @@ private:
 
     VkQueue mGraphicsQueue = VK_NULL_HANDLE;
     VkQueue mPresentQueue = VK_NULL_HANDLE;
+
+    // Extension commands aren't exported by the loader, so they're looked up once the device exists.
+    PFN_vkCmdBeginRenderingKHR mCmdBeginRendering = nullptr;
+    PFN_vkCmdEndRenderingKHR mCmdEndRendering = nullptr;
+    PFN_vkCmdDrawIndirectCountKHR mCmdDrawIndirectCount = nullptr;
 };
 }
 
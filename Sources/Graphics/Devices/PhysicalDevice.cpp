@@ -1,6 +1,6 @@
 #include "PhysicalDevice.hpp"
+#include "Logging.hpp"
 
-#include <iostream>
 #include <set>
 
 namespace mt 
@@ -19,7 +19,18 @@ PhysicalDevice::~PhysicalDevice()
 
 void PhysicalDevice::CreateWindowSurface() 
 {
-    mWindow.CreateWindowSurface(mInstance.GetInstance(), &mSurface);
+    if(!mInstance.HasSurfaceSupport()) 
+    {
+        return;
+    }
+
+    if(mWindow.IsHeadless()) 
+    {
+        mWindow.CreateHeadlessSurface(mInstance.GetInstance(), &mSurface);
+    }
+    else {
+        mWindow.CreateWindowSurface(mInstance.GetInstance(), &mSurface);
+    }
 }
 
 void PhysicalDevice::ChoosePhysicalDevice() 
@@ -32,7 +43,7 @@ void PhysicalDevice::ChoosePhysicalDevice()
         throw std::runtime_error("failed to find GPUs with Vulkan support!");
     }
 
-    std::cout << "Device count: " << deviceCount << std::endl;
+    MT_LOG_INFO("Device count: {}", deviceCount);
 
     std::vector<VkPhysicalDevice> devices(deviceCount);
 
@@ -52,10 +63,51 @@ void PhysicalDevice::ChoosePhysicalDevice()
         throw std::runtime_error("failed to find a suitable GPU!");
     }
 
+    auto available = GetAvailableDeviceExtensions(mPhysicalDevice);
+
     vkGetPhysicalDeviceProperties(mPhysicalDevice, &mPhysicalDeviceProps);
-    std::cout << "physical device: " << mPhysicalDeviceProps.deviceName << std::endl;
-    std::cout << "max push constant size: " << mPhysicalDeviceProps.limits.maxPushConstantsSize << std::endl; 
+    MT_LOG_INFO("physical device: {}", mPhysicalDeviceProps.deviceName);
+    MT_LOG_INFO("max push constant size: {}", mPhysicalDeviceProps.limits.maxPushConstantsSize);
 
+    // Both the instance and the device need 1.2, which VK_KHR_dynamic_rendering depends on.
+    mSupportsDynamicRendering = false;
+    if(mInstance.GetApiVersion() >= VK_API_VERSION_1_2 && mPhysicalDeviceProps.apiVersion >= VK_API_VERSION_1_2 &&
+        available.count(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME)) 
+    {
+        VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRendering{};
+        dynamicRendering.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+
+        VkPhysicalDeviceFeatures2 features{};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = &dynamicRendering;
+        vkGetPhysicalDeviceFeatures2(mPhysicalDevice, &features);
+
+        mSupportsDynamicRendering = dynamicRendering.dynamicRendering == VK_TRUE;
+    }
+    MT_LOG_INFO("dynamic rendering: {}", mSupportsDynamicRendering ? "yes" : "no");
+
+    // Lets GPU culling decide how many indirect draws there are, not just what's in them.
+    mSupportsDrawIndirectCount = available.count(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) > 0;
+    MT_LOG_INFO("draw indirect count: {}", mSupportsDrawIndirectCount ? "yes" : "no");
+
+    mDeviceExtensions.clear();
+    if(HasSurface()) 
+    {
+        mDeviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        mSwapChainSupportDetails = CheckSwapChainSupport(mPhysicalDevice);
+    }
+    if(available.count(VK_KHR_PORTABILITY_SUBSET_EXTENSION_NAME)) 
+    {
+        mDeviceExtensions.push_back(VK_KHR_PORTABILITY_SUBSET_EXTENSION_NAME);
+    }
+    if(mSupportsDynamicRendering) 
+    {
+        mDeviceExtensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+    }
+    if(mSupportsDrawIndirectCount) 
+    {
+        mDeviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+    }
 }
 
 bool PhysicalDevice::IsDeviceSuitable(VkPhysicalDevice device)  
@@ -64,8 +116,9 @@ bool PhysicalDevice::IsDeviceSuitable(VkPhysicalDevice device)
 
     bool extensionsSupported = CheckDeviceExtensionSupport(device);
 
-    bool swapChainAdequate = false;
-    if (extensionsSupported) 
+    // Offscreen rendering has no swapchain to be adequate for.
+    bool swapChainAdequate = !HasSurface();
+    if (extensionsSupported && HasSurface()) 
     {
         SwapChainSupportDetails swapChainSupport = CheckSwapChainSupport(device);
         swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
@@ -96,8 +149,15 @@ QueueFamilyIndices PhysicalDevice::FindQueueFamilies(VkPhysicalDevice device)
             indices.graphicsFamilyHasValue = true;
         }
 
+        // Without a surface nothing is presented, so the "present" queue is just the graphics queue.
         VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, mSurface, &presentSupport);
+        if (HasSurface()) 
+        {
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, mSurface, &presentSupport);
+        }
+        else {
+            presentSupport = indices.graphicsFamilyHasValue && indices.graphicsFamily == static_cast<uint32_t>(i);
+        }
 
         if (queueFamily.queueCount > 0 && presentSupport) 
         {
@@ -117,6 +177,16 @@ QueueFamilyIndices PhysicalDevice::FindQueueFamilies(VkPhysicalDevice device)
 }
 
 bool PhysicalDevice::CheckDeviceExtensionSupport(VkPhysicalDevice device)  
+{
+    if (!HasSurface()) 
+    {
+        return true;
+    }
+
+    return GetAvailableDeviceExtensions(device).count(VK_KHR_SWAPCHAIN_EXTENSION_NAME) > 0;
+}
+
+std::set<std::string> PhysicalDevice::GetAvailableDeviceExtensions(VkPhysicalDevice device)  
 {
     uint32_t extensionCount = 0;
     vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
@@ -129,14 +199,14 @@ bool PhysicalDevice::CheckDeviceExtensionSupport(VkPhysicalDevice device)
         availableExtensions.data()
     );
 
-    std::set<std::string> requiredExtensions(mDeviceExtensions.begin(), mDeviceExtensions.end());
+    std::set<std::string> extensions{};
 
     for (const auto &extension : availableExtensions) 
     {
-        requiredExtensions.erase(extension.extensionName);
+        extensions.insert(extension.extensionName);
     }
 
-    return requiredExtensions.empty();
+    return extensions;
 }
 
 SwapChainSupportDetails PhysicalDevice::CheckSwapChainSupport(VkPhysicalDevice device)  
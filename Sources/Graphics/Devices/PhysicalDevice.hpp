@@ -5,6 +5,9 @@
 #include "Window.hpp"
 #include "Instance.hpp"
 
+#include <set>
+#include <string>
+
 namespace mt 
 {
 
@@ -29,11 +32,31 @@ public:
     inline const QueueFamilyIndices& GetQueueFamilyIndices() const { return mQueueFamilyIndices; }
     inline const std::vector<const char*>& GetDeviceExtensions() const { return mDeviceExtensions; }
     inline const SwapChainSupportDetails& GetSwapChainSupport() const { return mSwapChainSupportDetails; }
+    inline const VkPhysicalDeviceFeatures& GetFeatures() const { return mFeatures; }
+
+    /**
+     * @brief False when rendering headless without VK_EXT_headless_surface, in which case
+     * there's no swapchain and the SwapChain class renders into its own offscreen images.
+    */
+    inline bool HasSurface() const { return mSurface != VK_NULL_HANDLE; }
+
+    /**
+     * @brief Whether VK_KHR_dynamic_rendering is available (and so enabled), in which case we
+     * render without any VkRenderPass or VkFramebuffer.
+    */
+    inline bool SupportsDynamicRendering() const { return mSupportsDynamicRendering; }
+
+    /**
+     * @brief Whether VK_KHR_draw_indirect_count is available (and so enabled), in which case
+     * the GPU can write the number of indirect draws too.
+    */
+    inline bool SupportsDrawIndirectCount() const { return mSupportsDrawIndirectCount; }
     
 private:
     /**
      * @brief Simple call to the member function of the Window class that 
-     * calls glfwCreatewindowSurface().
+     * calls glfwCreatewindowSurface() (or creates a headless surface). Does nothing for 
+     * headless windows that have no surface support at all.
     */
     void CreateWindowSurface();
     
@@ -60,6 +83,8 @@ private:
     */
     bool CheckDeviceExtensionSupport(VkPhysicalDevice device);
 
+    std::set<std::string> GetAvailableDeviceExtensions(VkPhysicalDevice device);
+
     /**
      * @brief Checks whether the Swapchain supports the physical device.
      * @param device The physical device that we're checking against. 
@@ -81,7 +106,13 @@ private:
     SwapChainSupportDetails mSwapChainSupportDetails{};
     QueueFamilyIndices mQueueFamilyIndices{};
 
-    const std::vector<const char *> mDeviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME, VK_KHR_PORTABILITY_SUBSET_EXTENSION_NAME};
+    // Filled in once a device has been chosen: VK_KHR_swapchain only if we have a surface to
+    // present to, VK_KHR_portability_subset only where the device exposes it (MoltenVK), and
+    // VK_KHR_dynamic_rendering and VK_KHR_draw_indirect_count whenever they're supported.
+    std::vector<const char *> mDeviceExtensions{};
+
+    bool mSupportsDynamicRendering = false;
+    bool mSupportsDrawIndirectCount = false;
 
 };
 }
@@ -1,22 +1,38 @@
 #include "Graphics.hpp"
+#include "Game.hpp"
+#include "Profiler/Profiler.hpp"
+#include "Logging.hpp"
+
+#include <fstream>
 
 namespace mt 
 {
 
-Graphics::Graphics(Window& window)
+Graphics::Graphics(Window& window, JobSystem& jobSystem, bool headlessSurface, bool depthBuffer)
     : mWindow{window},
-    mInstance{std::make_unique<Instance>(mWindow)},
-    mPhysicalDevice{std::make_unique<PhysicalDevice>(*mInstance)},
+    mInstance{std::make_unique<Instance>(mWindow, headlessSurface)},
+    mPhysicalDevice{std::make_unique<PhysicalDevice>(mWindow, *mInstance)},
     mLogicalDevice{std::make_unique<LogicalDevice>(*mPhysicalDevice)},
-    mSwapChain{std::make_unique<SwapChain>(*mPhysicalDevice, *mLogicalDevice, mWindow.GetExtent())},
     mCommandPool{std::make_unique<CommandPool>(*mPhysicalDevice, *mLogicalDevice)},
-    mCommandBuffers{{std::make_unique<CommandBuffer>(*mLogicalDevice, *mCommandPool)}}
+    mDevice{std::make_unique<Device>(*mPhysicalDevice, *mLogicalDevice, *mCommandPool)},
+    mDepthBuffer{depthBuffer}
 {
+    // One per frame in flight, since Begin() records into the current frame's.
+    for(int i = 0; i < SwapChain::FRAMES_IN_FLIGHT; i++) 
+    {
+        mCommandBuffers.push_back(std::make_unique<CommandBuffer>(*mLogicalDevice, *mCommandPool));
+    }
+
+    // Creates the first swap chain, once the window has a size.
     RecreateSwapChain();
+
+    mRenderer = std::make_unique<Renderer>(*mDevice, mWindow, jobSystem, *mSwapChain);
 }
 
 VkCommandBuffer Graphics::Begin() 
 {
+    MT_PROFILE_FUNCTION();
+
     assert(!mHasFrameStarted && "Can't call begin frame while already in progress");
 
     auto result = mSwapChain->AcquireNextImage(&mCurrentImageIndex);
@@ -34,26 +50,45 @@ VkCommandBuffer Graphics::Begin()
 
     mHasFrameStarted = true;
 
-    mCommandBuffers[mCurrentFrameIndex]->Begin();
+    // Acquiring waited on this frame's fence, so its transient descriptor sets are free again.
+    mRenderer->BeginFrame(static_cast<uint32_t>(mCurrentFrameIndex));
+
+    return mCommandBuffers[mCurrentFrameIndex]->Begin();
 }
 
 
 void Graphics::End() 
 {
+    MT_PROFILE_FUNCTION();
+
     auto commandBuffer = mCommandBuffers[mCurrentFrameIndex]->End();
 
     auto result = mSwapChain->SubmitCommandBuffers(&commandBuffer, &mCurrentImageIndex);
 
-    // Window Resize handling - TODO
-    //
     mHasFrameStarted = false;
     mCurrentFrameIndex = (mCurrentFrameIndex + 1) % SwapChain::FRAMES_IN_FLIGHT;
+
+    // The window was resized (or moved to another display), the frame was still submitted.
+    if(result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) 
+    {
+        RecreateSwapChain();
+    }
+    else if(result != VK_SUCCESS) 
+    {
+        throw std::runtime_error("Failed to present swapchain image");
+    }
 }
 
 
 void Graphics::RecreateSwapChain() 
 {
     auto extent = mWindow.GetExtent();
+
+    if(mWindow.IsHeadless() && (extent.width == 0 || extent.height == 0)) 
+    {
+        throw std::runtime_error("Headless rendering requires a non-zero window size!");
+    }
+
     while(extent.width == 0 || extent.height == 0) 
     {
         extent = mWindow.GetExtent();
@@ -64,36 +99,29 @@ void Graphics::RecreateSwapChain()
 
     if(mSwapChain == nullptr) 
     {
-        mSwapChain = std::make_unique<SwapChain>(mPhysicalDevice, mLogicalDevice, extent);   
+        mSwapChain = std::make_unique<SwapChain>(*mPhysicalDevice, *mLogicalDevice, extent, mDepthBuffer);   
     } 
     else {
         std::shared_ptr<SwapChain> oldSwapChain = std::move(mSwapChain);
-        mSwapChain = std::make_unique<SwapChain>(mPhysicalDevice, mLogicalDevice, extent, oldSwapChain);
+        mSwapChain = std::make_unique<SwapChain>(*mPhysicalDevice, *mLogicalDevice, extent, mDepthBuffer, oldSwapChain);
 
         if(!oldSwapChain->compareSwapFormats(*mSwapChain.get())) 
         {
             throw std::runtime_error("Swap chain image(or depth) format has changed!");
         }
     }
+
+    // The render graph's framebuffers point at the old swap chain's image views.
+    if(mRenderer) 
+    {
+        mRenderer->OnSwapChainRecreated();
+    }
 }
 
 void Graphics::PrepareGraphics(IGame& game) 
 {
 
-    uint32_t nCameraComps;
-    uint32_t nTextureComps;
-    uint32_t nTransformComps;
-
-    for(const auto& renderable : game.GetObj()) 
-    {
-        // Create a shader Prefab here.
-        if(renderable.camera) nCameraComps += 1;
-        if(renderable.transform) nTransformComps += 1;
-        if(renderable.material) nTextureComps += 1;
-    }
-
-    mRenderer->CreateDescriptorPool(nCameraComps + nTransformComps, nTextureComps);
-    
+    // The renderer's descriptor allocator grows as needed, so there's no need to count sets first.
     for(const auto& renderable : game.GetObj()) 
     {
         if(renderable.camera) 
@@ -115,24 +143,86 @@ void Graphics::PrepareGraphics(IGame& game)
         }
     } 
 
-
-    // 1 descriptor set for camera
-    // numOfTextures descripor sets for each texture
-    // numOfRenderables descriptor sets for each renderable.
-    // 1 pipeline layout per shader file.
-
 }
 
 void Graphics::Update() 
 {
     if(auto commandBuffer = Begin()) 
     {
-        mRenderer->BeginRenderPass(commandBuffer, mSwapChain, mHasFrameStarted, mCurrentImageIndex);
+        mRenderer->RenderFrame(commandBuffer, *mSwapChain, mCurrentImageIndex);
+        End();
+    }
+}
 
-        
+void Graphics::CaptureFrame(const char* path) 
+{
+    if(!mSwapChain->IsOffscreen()) 
+    {
+        MT_LOG_WARN("Frame captures are only supported when rendering offscreen, skipping {}", path);
+        return;
+    }
 
-        mRenderer->EndRenderPass(commandBuffer);
-        End();
+    vkDeviceWaitIdle(mLogicalDevice->GetDevice());
+
+    // The image that was submitted last, which End() leaves in mCurrentImageIndex.
+    VkImage image = mSwapChain->GetImage(mCurrentImageIndex);
+    VkExtent2D extent = mSwapChain->GetSwapChainExtent();
+    VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+
+    VkBuffer stagingBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+    mLogicalDevice->CreateBuffer(
+        size,
+        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        stagingBuffer,
+        stagingMemory);
+
+    // The render graph already left the image in TRANSFER_SRC_OPTIMAL, so no barrier is needed.
+    VkCommandBuffer commandBuffer = mLogicalDevice->BeginSingleTimeCommands();
+
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = {extent.width, extent.height, 1};
+
+    vkCmdCopyImageToBuffer(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, stagingBuffer, 1, &region);
+
+    mLogicalDevice->EndSingleTimeCommands(commandBuffer);
+
+    void* data = nullptr;
+    vkMapMemory(mLogicalDevice->GetDevice(), stagingMemory, 0, size, 0, &data);
+
+    VkFormat format = mSwapChain->GetSwapChainImageFormat();
+    bool isBGRA = format == VK_FORMAT_B8G8R8A8_SRGB || format == VK_FORMAT_B8G8R8A8_UNORM;
+
+    std::ofstream file{path, std::ios::out | std::ios::binary | std::ios::trunc};
+    if(file.is_open()) 
+    {
+        file << "P6\n" << extent.width << " " << extent.height << "\n255\n";
+
+        const uint8_t* pixels = static_cast<const uint8_t*>(data);
+        std::vector<uint8_t> row(extent.width * 3);
+        for(uint32_t y = 0; y < extent.height; y++) 
+        {
+            for(uint32_t x = 0; x < extent.width; x++) 
+            {
+                const uint8_t* pixel = pixels + (static_cast<size_t>(y) * extent.width + x) * 4;
+                row[x * 3 + 0] = pixel[isBGRA ? 2 : 0];
+                row[x * 3 + 1] = pixel[1];
+                row[x * 3 + 2] = pixel[isBGRA ? 0 : 2];
+            }
+            file.write(reinterpret_cast<const char*>(row.data()), row.size());
+        }
+
+        MT_LOG_INFO("Captured frame to {}", path);
     }
+    else {
+        MT_LOG_ERROR("Failed to open {} for the frame capture", path);
+    }
+
+    vkUnmapMemory(mLogicalDevice->GetDevice(), stagingMemory);
+    vkDestroyBuffer(mLogicalDevice->GetDevice(), stagingBuffer, nullptr);
+    vkFreeMemory(mLogicalDevice->GetDevice(), stagingMemory, nullptr);
 }
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define MAMMOTH_2D_GRAPHICS_HPP
 
 #include "Graphics/Renderer/Renderer.hpp"
+#include "Graphics/Devices/Device.hpp"
 #include "Graphics/Devices/LogicalDevice.hpp"
 #include "Graphics/Devices/Instance.hpp"
 #include "Graphics/Devices/PhysicalDevice.hpp"
@@ -12,10 +13,19 @@
 
 namespace mt 
 {
+
+class IGame;
+
 class Graphics  
 {
 public:
-    Graphics(Window& window);
+    /**
+     * @param jobSystem What the renderer builds pipelines and sorts draws on.
+     * @param headlessSurface Headless windows only - present to a VK_EXT_headless_surface
+     * swapchain when the driver supports one, instead of rendering to plain offscreen images.
+     * @param depthBuffer Whether frames get a depth attachment, see EngineDesc::depthBuffer.
+    */
+    Graphics(Window& window, JobSystem& jobSystem, bool headlessSurface = false, bool depthBuffer = false);
     ~Graphics() {}
 
     const std::unique_ptr<Renderer>& GetRenderer() const { return mRenderer; }
@@ -30,27 +40,41 @@ public:
 
     void Update();
 
+    /**
+     * @brief Reads back the most recently rendered frame and writes it to a binary PPM file,
+     * which is what CI regression captures diff against. Only supported when rendering offscreen,
+     * since presented swapchain images can't be read back. Waits for the device to go idle.
+    */
+    void CaptureFrame(const char* path);
+
     inline const PhysicalDevice& GetPhysicalDevice() const { return *mPhysicalDevice; }
     inline const LogicalDevice& GetLogicalDevice() const { return *mLogicalDevice; }
     inline const Instance& GetInstance() const { return *mInstance; }
 
+    /**
+     * @brief What buffers, images and shaders are created with.
+    */
+    inline Device& GetDevice() const { return *mDevice; }
+
 private:
     Window& mWindow;
 
-    std::unique_ptr<Renderer> mRenderer = nullptr;
-    
-    std::unique_ptr<SwapChain> mSwapChain = nullptr;
-
-    std::unique_ptr<LogicalDevice> mLogicalDevice = nullptr;
-    std::unique_ptr<PhysicalDevice> mPhysicalDevice = nullptr;
+    // Declared in the order they're created in, so that they're destroyed the other way round.
     std::unique_ptr<Instance> mInstance = nullptr;
+    std::unique_ptr<PhysicalDevice> mPhysicalDevice = nullptr;
+    std::unique_ptr<LogicalDevice> mLogicalDevice = nullptr;
+    std::unique_ptr<SwapChain> mSwapChain = nullptr;
     std::unique_ptr<CommandPool> mCommandPool = nullptr;
+    std::unique_ptr<Device> mDevice = nullptr;
 
     std::vector<std::unique_ptr<CommandBuffer>> mCommandBuffers{};
 
+    std::unique_ptr<Renderer> mRenderer = nullptr;
+
     uint32_t mCurrentImageIndex = 0;
     int mCurrentFrameIndex = 0;  
     bool mHasFrameStarted = false;  
+    bool mDepthBuffer = false;
 };
 
 }
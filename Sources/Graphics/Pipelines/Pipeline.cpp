@@ -1,162 +1,73 @@
 #include <cassert>
 #include <iostream>
 #include "Pipeline.hpp"
-#include "Graphics/Renderer/RenderSystem.hpp"
 
 namespace mt 
 {
 
-Pipeline::Pipeline(Device& device, VkRenderPass renderPass, uint32_t width, uint32_t height, std::unique_ptr<Shader> shader, VkPipelineBindPoint bindPoint)
-    : mDevice{device}
+Pipeline::Pipeline(DescriptorLayoutCache& layoutCache, PipelineCache& pipelineCache, VkRenderPass renderPass, const RenderPassFormats& formats, std::unique_ptr<Shader> shader, VkPipelineBindPoint bindPoint)
+    : mPipelineBindPoint{bindPoint}
 {
     mShader = std::move(shader);
     
-    CreateDescriptorPool();
-    CreateDescriptorLayout();
-    CreatePipelineLayout();
-    CreateGraphicsPipeline(renderPass, width, height);
-}
+    CreatePipelineLayout(layoutCache);
 
-Pipeline::~Pipeline() 
-{
-    vkDestroyDescriptorPool(mDevice.GetDevice(), mDescriptorPool, nullptr);
-    vkDestroyPipelineLayout(mDevice.GetDevice(), mPipelineLayout, nullptr);
-    vkDestroyPipeline(mDevice.GetDevice(), mPipeline, nullptr);
-}
-
-void Pipeline::CreateDescriptorPool() 
-{
-    std::array<VkDescriptorPoolSize, 6> poolSizes{};
-    poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[0].descriptorCount = 1;
-    poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[1].descriptorCount = 1;
-    poolSizes[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[2].descriptorCount = 1;
-    poolSizes[3].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[3].descriptorCount = 1;
-    poolSizes[4].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[4].descriptorCount = 1;
-    poolSizes[5].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[5].descriptorCount = 1;
-
-    VkDescriptorPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = poolSizes.size();
-    poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = 6;
-
-    if(vkCreateDescriptorPool(mDevice.GetDevice(), &poolInfo, nullptr, &mDescriptorPool) != VK_SUCCESS) 
+    if(mPipelineBindPoint == VK_PIPELINE_BIND_POINT_COMPUTE) 
     {
-        throw std::runtime_error("Failed to create descriptor pool");
+        CreateComputePipeline(pipelineCache);
+    }
+    else {
+        CreateGraphicsPipeline(pipelineCache, renderPass, formats);
     }
 }
 
-
-void Pipeline::CreateDescriptorLayout() 
+Pipeline::~Pipeline() 
 {
-    const auto& uniforms = mShader->GetUniform();
-    
-    VkDescriptorSetLayoutBinding uboLayoutBinding[6];
-    
-    for(int i = 0; i < 6; i++) 
-    {
-        uboLayoutBinding[i].binding = i;
-        uboLayoutBinding[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        uboLayoutBinding[i].descriptorCount = 1;
-        uboLayoutBinding[i].stageFlags = uniforms[0].GetFlags();
-        uboLayoutBinding[i].pImmutableSamplers = nullptr;
-    }
-
-    VkDescriptorSetLayoutCreateInfo layoutInfo{};
-    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = 6;
-    layoutInfo.pBindings = uboLayoutBinding;
-
-    if(vkCreateDescriptorSetLayout(mDevice.GetDevice(), &layoutInfo, nullptr, &mDescriptorSetLayout) != VK_SUCCESS) 
-    {
-        throw std::runtime_error("Failed to create descriptor set layout!");
-    }
+    // mPipeline belongs to the PipelineCache, and may well be used by other Pipelines.
 }
 
-void Pipeline::CreatePipelineLayout() 
+void Pipeline::CreatePipelineLayout(DescriptorLayoutCache& layoutCache) 
 { 
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 1;
-    pipelineLayoutInfo.pSetLayouts = &mDescriptorSetLayout;
-    pipelineLayoutInfo.pushConstantRangeCount = 1;
-    pipelineLayoutInfo.pPushConstantRanges = &mShader->GetPushConstant().GetPushConstantRange();
-    
-    if(vkCreatePipelineLayout(mDevice.GetDevice(), &pipelineLayoutInfo, nullptr, &mPipelineLayout) != VK_SUCCESS) 
-    {
-        throw std::runtime_error("Failed to create pipeline layout!");
-    }
+    mPipelineLayout = layoutCache.GetPipelineLayout(mShader->GetReflection(), mDescriptorSetLayouts);
 }
 
-void Pipeline::CreateGraphicsPipeline(VkRenderPass renderPass, uint32_t width, uint32_t height) 
+void Pipeline::CreateGraphicsPipeline(PipelineCache& pipelineCache, VkRenderPass renderPass, const RenderPassFormats& formats) 
 {
 
-    PipelineDesc desc = SetDefaultPipelineDesc(width, height);
+    PipelineDesc desc = SetDefaultPipelineDesc();
 
     // Vertex Info.
     //
-    const auto& vertexInput = mShader->GetVertexInput();
+    VertexInput vertexInput = VertexInput(mShader->GetReflection().vertexAttributes);
     desc.vertexInfo.vertexAttributeDescriptionCount = vertexInput.GetAttribDescriptions().size();
-    desc.vertexInfo.vertexBindingDescriptionCount = 1;
+    desc.vertexInfo.vertexBindingDescriptionCount = vertexInput.GetBindingDescriptions().size();
     desc.vertexInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    desc.vertexInfo.pVertexBindingDescriptions = &vertexInput.GetBindingDescriptions()[0];
+    desc.vertexInfo.pVertexBindingDescriptions = vertexInput.GetBindingDescriptions().data();
     desc.vertexInfo.pVertexAttributeDescriptions = vertexInput.GetAttribDescriptions().data();
 
     desc.renderPass = renderPass;
     desc.pipelineLayout = mPipelineLayout;
 
-    // Before we begin to create the pipeline, make sure that a layout and render pass was properly
-    // defined in the pipeline descriptor, since by default they're set to nullptrs.
+    // Before we begin to create the pipeline, make sure that a layout was properly defined in the
+    // pipeline descriptor, since by default it's set to nullptr. The render pass may well be
+    // VK_NULL_HANDLE with dynamic rendering (see PipelineCache).
     //
     assert(desc.pipelineLayout != VK_NULL_HANDLE 
         && "Attempting to create a pipeline from a Pipeline_Desc with a layout set to VK_NULL_HANDLE!"); 
 
-    assert(desc.renderPass != VK_NULL_HANDLE 
-        && "Attempting to create a pipeline from a Pipeline_Desc with a renderPass set to VK_NULL_HANDLE!"); 
-
-
-    VkPipelineViewportStateCreateInfo viewportInfo{};
-    viewportInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    viewportInfo.viewportCount = 1;
-    viewportInfo.pViewports = &desc.viewport;
-    viewportInfo.scissorCount = 1;
-    viewportInfo.pScissors = &desc.scissor;
-
-    VkGraphicsPipelineCreateInfo pipelineInfo{};
-    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = 2;
-    pipelineInfo.pStages = mShader->GetShaderStages().data();
-    pipelineInfo.pVertexInputState = &desc.vertexInfo;
-    pipelineInfo.pInputAssemblyState = &desc.inputAssemblyInfo;
-    pipelineInfo.pViewportState = &viewportInfo;
-    pipelineInfo.pRasterizationState = &desc.rasterizationInfo;
-    pipelineInfo.pMultisampleState = &desc.multisampleInfo;
-    pipelineInfo.pColorBlendState = &desc.colorBlendInfo;
-    pipelineInfo.pDepthStencilState = &desc.depthStencilInfo;
-    pipelineInfo.pDynamicState = nullptr;
-
-    pipelineInfo.layout = desc.pipelineLayout;
-    pipelineInfo.renderPass = desc.renderPass;
-    pipelineInfo.subpass = desc.subpass;
-
-    pipelineInfo.basePipelineIndex = -1;
-    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-
-    if(vkCreateGraphicsPipelines(mDevice.GetDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &mPipeline) != VK_SUCCESS) 
-    {
-        throw std::runtime_error("Failed to create graphics pipeline!");
-    }
 
+    // Identical state is only ever compiled once, whichever system asks for it.
+    mPipeline = pipelineCache.GetGraphicsPipeline(desc, *mShader, formats);
+}
+
+void Pipeline::CreateComputePipeline(PipelineCache& pipelineCache) 
+{
+    // Nothing to configure, the shader and the layout are the whole pipeline.
+    mPipeline = pipelineCache.GetComputePipeline(mPipelineLayout, *mShader);
 }
 
 
-PipelineDesc Pipeline::SetDefaultPipelineDesc(uint32_t width, uint32_t height) 
+PipelineDesc Pipeline::SetDefaultPipelineDesc() 
 {
     PipelineDesc desc{};
 
@@ -164,17 +75,6 @@ PipelineDesc Pipeline::SetDefaultPipelineDesc(uint32_t width, uint32_t height)
     desc.inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
     desc.inputAssemblyInfo.primitiveRestartEnable = VK_FALSE;
 
-    desc.viewport.x = 0.0f;
-    desc.viewport.y = 0.0f;
-    desc.viewport.width = static_cast<float>(width);
-    desc.viewport.height = static_cast<float>(height);
-    desc.viewport.minDepth = 0.0f;
-    desc.viewport.maxDepth = 1.0f;
-
-    desc.scissor.offset = {0, 0};
-    desc.scissor.extent = {width, height};
-
-
     desc.rasterizationInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
     desc.rasterizationInfo.depthClampEnable = VK_FALSE;
     desc.rasterizationInfo.rasterizerDiscardEnable = VK_FALSE;
@@ -224,7 +124,7 @@ PipelineDesc Pipeline::SetDefaultPipelineDesc(uint32_t width, uint32_t height)
     desc.depthStencilInfo.depthTestEnable = VK_TRUE;
     desc.depthStencilInfo.depthWriteEnable = VK_TRUE;
     desc.depthStencilInfo.depthCompareOp = VK_COMPARE_OP_LESS;
-    desc.depthStencilInfo.stencilTestEnable = VK_TRUE;
+    desc.depthStencilInfo.stencilTestEnable = VK_FALSE;
     desc.depthStencilInfo.depthBoundsTestEnable = VK_FALSE;
     desc.depthStencilInfo.minDepthBounds = 0.0f;
     desc.depthStencilInfo.maxDepthBounds = 1.0f;
@@ -236,7 +136,7 @@ PipelineDesc Pipeline::SetDefaultPipelineDesc(uint32_t width, uint32_t height)
 
 void Pipeline::Bind(VkCommandBuffer commandBuffer) 
 {
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, mPipeline);
+    vkCmdBindPipeline(commandBuffer, mPipelineBindPoint, mPipeline);
 }
 
 }
\ No newline at end of file
@@ -1,9 +1,10 @@
 #ifndef MAMMOTH_2D_PIPELINE_HPP
 #define MAMMOTH_2D_PIPELINE_HPP
 
-#include "Device.hpp"
-#include "VertexInput.hpp"
-#include "Shader.hpp"
+#include "Graphics/Shader/VertexInput.hpp"
+#include "Graphics/Shader/Shader.hpp"
+#include "PipelineCache.hpp"
+#include "Graphics/Descriptors/DescriptorLayoutCache.hpp"
 #include "Graphics/Renderer/SwapChain.hpp"
 
 #include <fstream>
@@ -14,9 +15,8 @@ namespace mt
 
 struct PipelineDesc 
 {
-    // A static member funciton of Pipeline configures these to their default values.
-    VkViewport viewport;
-    VkRect2D scissor;
+    // A static member funciton of Pipeline configures these to their default values. Viewport
+    // and scissor are dynamic, see PipelineCache.
     VkPipelineInputAssemblyStateCreateInfo inputAssemblyInfo;
     VkPipelineRasterizationStateCreateInfo rasterizationInfo;
     VkPipelineMultisampleStateCreateInfo multisampleInfo;
@@ -35,7 +35,16 @@ struct PipelineDesc
 class Pipeline 
 {
 public:
-    Pipeline(Device& device, VkRenderPass renderPass, uint32_t width, uint32_t height, std::unique_ptr<Shader> shader, VkPipelineBindPoint bindPoint);
+    /**
+     * @brief Creates the pipeline with exactly the layout its shader declares (see Shader::GetReflection()):
+     * set layouts, push constant range and vertex input all come from the SPIR-V, and the layouts
+     * are shared with other pipelines through layoutCache, which must outlive this pipeline.
+     * Descriptor sets for it come from a DescriptorAllocator. The VkPipeline itself comes from
+     * pipelineCache (which must also outlive it), and works with any render pass with the same
+     * formats as renderPass, at any size. Compute pipelines (bindPoint VK_PIPELINE_BIND_POINT_COMPUTE)
+     * ignore renderPass and formats.
+    */
+    Pipeline(DescriptorLayoutCache& layoutCache, PipelineCache& pipelineCache, VkRenderPass renderPass, const RenderPassFormats& formats, std::unique_ptr<Shader> shader, VkPipelineBindPoint bindPoint);
     ~Pipeline();
 
     Pipeline(const Pipeline& other) = delete;
@@ -46,22 +55,18 @@ public:
     // Getters.
     //
     inline const VkPipelineLayout GetPipelineLayout() const { return mPipelineLayout; }
-    inline const VkDescriptorSetLayout& GetDescriptorSetLayout() const { return mDescriptorSetLayout; }
+    inline const VkDescriptorSetLayout& GetDescriptorSetLayout(uint32_t set = 0) const { return mDescriptorSetLayouts[set]; }
+    inline const std::vector<VkDescriptorSetLayout>& GetDescriptorSetLayouts() const { return mDescriptorSetLayouts; }
     inline const VkPipelineBindPoint GetPipelineBindPoint() const { return mPipelineBindPoint; }
-    inline const VkDescriptorPool GetDecsriptorPool() const { return mDescriptorPool; }
-    inline const uint32_t& GetMaxDescriptorSets() const { return mMaxSets; }
     inline const std::unique_ptr<Shader>& GetShader() const { return mShader; }
 
 
 private:
-    PipelineDesc SetDefaultPipelineDesc(uint32_t width, uint32_t height);
+    PipelineDesc SetDefaultPipelineDesc();
 
-    void CreateDescriptorPool();
-    void CreateDescriptorLayout();
-    void CreatePipelineLayout();
-    void CreateGraphicsPipeline(VkRenderPass renderPass, uint32_t width, uint32_t height);
-
-    Device& mDevice;
+    void CreatePipelineLayout(DescriptorLayoutCache& layoutCache);
+    void CreateGraphicsPipeline(PipelineCache& pipelineCache, VkRenderPass renderPass, const RenderPassFormats& formats);
+    void CreateComputePipeline(PipelineCache& pipelineCache);
 
     std::unique_ptr<Shader> mShader = nullptr;
 
@@ -69,7 +74,8 @@ private:
     VkPipelineLayout mPipelineLayout = VK_NULL_HANDLE;
     VkPipelineBindPoint mPipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     
-    VkDescriptorSetLayout mDescriptorSetLayout = VK_NULL_HANDLE;
+    // Owned by the DescriptorLayoutCache, as is mPipelineLayout.
+    std::vector<VkDescriptorSetLayout> mDescriptorSetLayouts{};
 };
 }
 
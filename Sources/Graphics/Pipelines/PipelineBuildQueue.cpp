@@ -0,0 +1,164 @@
+#include "PipelineBuildQueue.hpp"
+#include "Memory/RetireQueue.hpp"
+#include "Resources/AssetRegistry.hpp"
+#include "Profiler/Profiler.hpp"
+#include "Logging.hpp"
+
+namespace mt
+{
+
+PipelineBuildQueue::PipelineBuildQueue(Device& device, JobSystem& jobSystem, DescriptorLayoutCache& layoutCache, PipelineCache& pipelineCache)
+    : mDevice{device}, mJobSystem{jobSystem}, mLayoutCache{layoutCache}, mPipelineCache{pipelineCache}
+{
+
+}
+
+PipelineBuildQueue::~PipelineBuildQueue()
+{
+    Wait();
+}
+
+PipelineHandle PipelineBuildQueue::Enqueue(const PipelineRequest& request)
+{
+    PipelineHandle handle{};
+    handle.mState = std::make_shared<PipelineHandle::State>();
+
+    mQueued.push_back(QueuedBuild{request, handle.mState});
+    mBuilds.push_back(handle.mState);
+    mRequests.push_back(request);
+
+    return handle;
+}
+
+void PipelineBuildQueue::Rebuild(const PipelineHandle& handle)
+{
+    for(size_t i = 0; i < mBuilds.size(); i++)
+    {
+        if(mBuilds[i] == handle.mState)
+        {
+            mQueued.push_back(QueuedBuild{mRequests[i], mBuilds[i]});
+            return;
+        }
+    }
+
+    throw std::runtime_error("Can't rebuild a pipeline that wasn't enqueued on this queue!");
+}
+
+size_t PipelineBuildQueue::Rebuild(const std::string& shaderPath)
+{
+    std::string path = NormaliseAssetPath(shaderPath);
+
+    size_t count = 0;
+    for(size_t i = 0; i < mBuilds.size(); i++)
+    {
+        const PipelineRequest& request = mRequests[i];
+        for(const std::string* stage : {&request.vertexShader, &request.fragmentShader, &request.computeShader})
+        {
+            if(!stage->empty() && NormaliseAssetPath(*stage) == path)
+            {
+                mQueued.push_back(QueuedBuild{request, mBuilds[i]});
+                count++;
+                break;
+            }
+        }
+    }
+
+    return count;
+}
+
+void PipelineBuildQueue::RetireReplaced()
+{
+    if(!mRetireQueue)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock{mReplacedMutex};
+    for(auto& pipeline : mReplaced)
+    {
+        mRetireQueue->Retire(std::move(pipeline));
+    }
+    mReplaced.clear();
+}
+
+void PipelineBuildQueue::Replace(PipelineHandle::State& state, std::unique_ptr<Pipeline> pipeline)
+{
+    std::lock_guard<std::mutex> lock{mReplacedMutex};
+
+    // Whoever still has the old pointer this frame keeps using it, it's only retired.
+    state.pipeline.store(pipeline.get(), std::memory_order_release);
+    if(state.owner)
+    {
+        mReplaced.push_back(std::move(state.owner));
+    }
+    state.owner = std::move(pipeline);
+    state.failed.store(false, std::memory_order_release);
+}
+
+void PipelineBuildQueue::Build()
+{
+    MT_PROFILE_FUNCTION();
+
+    for(QueuedBuild& build : mQueued)
+    {
+        mJobSystem.Submit([this, build]()
+        {
+            BuildPipeline(build.request, *build.state);
+        }, &mCounter);
+    }
+
+    mQueued.clear();
+}
+
+void PipelineBuildQueue::Wait()
+{
+    mJobSystem.Wait(mCounter);
+}
+
+void PipelineBuildQueue::BuildPipeline(const PipelineRequest& request, PipelineHandle::State& state)
+{
+    MT_PROFILE_SCOPE("BuildPipeline");
+
+    // Jobs can't throw, so a broken shader only costs its own pipeline.
+    try
+    {
+        std::unique_ptr<Shader> shader{};
+        if(request.bindPoint == VK_PIPELINE_BIND_POINT_COMPUTE)
+        {
+            shader = std::make_unique<Shader>(mDevice, request.computeShader.c_str());
+        }
+        else {
+            shader = std::make_unique<Shader>(
+                mDevice,
+                request.vertexShader.c_str(),
+                request.fragmentShader.c_str()
+            );
+        }
+
+        Replace(state, std::make_unique<Pipeline>(
+            mLayoutCache,
+            mPipelineCache,
+            request.renderPass,
+            request.formats,
+            std::move(shader),
+            request.bindPoint
+        ));
+    }
+    catch(const std::exception& e)
+    {
+        if(request.bindPoint == VK_PIPELINE_BIND_POINT_COMPUTE)
+        {
+            MT_LOG_ERROR("Failed to build the pipeline for {}: {}", request.computeShader, e.what());
+        }
+        else {
+            MT_LOG_ERROR("Failed to build the pipeline for {} and {}: {}", request.vertexShader, request.fragmentShader, e.what());
+        }
+        // A failed rebuild keeps drawing with the pipeline it was meant to replace.
+        if(!state.pipeline.load(std::memory_order_acquire))
+        {
+            state.failed.store(true, std::memory_order_release);
+        }
+    }
+}
+
+}
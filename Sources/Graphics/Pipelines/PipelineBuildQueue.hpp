@@ -0,0 +1,172 @@
+#ifndef MAMMOTH_2D_PIPELINE_BUILD_QUEUE_HPP
+#define MAMMOTH_2D_PIPELINE_BUILD_QUEUE_HPP
+
+#include "Pipeline.hpp"
+#include "PipelineCache.hpp"
+#include "Jobs/JobSystem.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mt
+{
+
+class RetireQueue;
+
+/**
+ * @brief Everything needed to build a Pipeline, shaders included. Compute pipelines only need
+ * their compute shader, and graphics pipelines everything but.
+*/
+struct PipelineRequest
+{
+    std::string vertexShader{};
+    std::string fragmentShader{};
+    std::string computeShader{};
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    RenderPassFormats formats{};
+    VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+};
+
+/**
+ * @brief A pipeline that may still be building. Cheap to copy, and safe to check from any thread.
+*/
+class PipelineHandle
+{
+public:
+    PipelineHandle() = default;
+
+    /**
+     * @return The pipeline, or nullptr while it's building (or if it failed to build).
+    */
+    inline Pipeline* Get() const { return mState ? mState->pipeline.load(std::memory_order_acquire) : nullptr; }
+    inline bool IsReady() const { return Get() != nullptr; }
+    inline bool HasFailed() const { return mState && mState->failed.load(std::memory_order_acquire); }
+
+    /**
+     * @return The pipeline if it's ready, otherwise whatever fallback has (e.g. a generic variant).
+    */
+    inline Pipeline* GetOr(const PipelineHandle& fallback) const
+    {
+        Pipeline* pipeline = Get();
+        return pipeline ? pipeline : fallback.Get();
+    }
+
+private:
+    friend class PipelineBuildQueue;
+
+    struct State
+    {
+        std::unique_ptr<Pipeline> owner{};
+        std::atomic<Pipeline*> pipeline{nullptr};
+        std::atomic<bool> failed{false};
+    };
+
+    std::shared_ptr<State> mState{};
+};
+
+/**
+ * @brief Builds pipelines in parallel. Render systems Enqueue() every pipeline they'll need while
+ * they're constructed, then Build() compiles them all at once over the job system - shader
+ * modules, reflection, layouts and the pipelines themselves - instead of one after the other on
+ * the main thread. Everything shares one PipelineCache (and so one VkPipelineCache).
+ *
+ * Frames can be drawn while pipelines build: a draw whose pipeline isn't ready yet should be
+ * skipped, or use a fallback through PipelineHandle::GetOr(). Pipelines live as long as the queue,
+ * or until they're rebuilt: a rebuilt pipeline is swapped in behind the same handle, and the old
+ * one is handed to the retire queue by RetireReplaced().
+*/
+class PipelineBuildQueue
+{
+public:
+    PipelineBuildQueue(Device& device, JobSystem& jobSystem, DescriptorLayoutCache& layoutCache, PipelineCache& pipelineCache);
+
+    /**
+     * @brief Waits for the pipelines that are still building.
+    */
+    ~PipelineBuildQueue();
+
+    PipelineBuildQueue(const PipelineBuildQueue& other) = delete;
+    PipelineBuildQueue& operator=(const PipelineBuildQueue& other) = delete;
+
+    /**
+     * @brief Adds a pipeline to the next Build(), nothing is compiled yet.
+    */
+    PipelineHandle Enqueue(const PipelineRequest& request);
+
+    /**
+     * @brief Starts building everything enqueued so far, one job per pipeline, and returns
+     * straight away.
+    */
+    void Build();
+
+    /**
+     * @brief Adds an already built pipeline to the next Build() again, e.g. because one of its
+     * shaders changed. Its handle keeps returning the old pipeline until the new one is ready,
+     * and keeps it if the rebuild fails.
+    */
+    void Rebuild(const PipelineHandle& handle);
+
+    /**
+     * @brief Rebuild()s every pipeline built from shaderPath (a compiled stage, compared after
+     * NormaliseAssetPath()).
+     * @return How many were queued, nothing's compiled until the next Build().
+    */
+    size_t Rebuild(const std::string& shaderPath);
+
+    /**
+     * @brief Where pipelines replaced by rebuilds go to be destroyed once no frame in flight
+     * uses them. Without one they're kept until the queue is destroyed.
+    */
+    inline void SetRetireQueue(RetireQueue* retireQueue) { mRetireQueue = retireQueue; }
+
+    /**
+     * @brief Hands the pipelines that rebuilds have replaced since the last call over to the retire
+     * queue. Main thread only, called once per frame by the Renderer.
+    */
+    void RetireReplaced();
+
+    /**
+     * @brief Blocks until every pipeline that's been built so far is ready (or has failed),
+     * running build jobs on the calling thread meanwhile.
+    */
+    void Wait();
+
+    inline bool IsBuilding() const { return !mCounter.IsDone(); }
+    inline size_t GetQueuedCount() const { return mQueued.size(); }
+
+private:
+    struct QueuedBuild
+    {
+        PipelineRequest request;
+        std::shared_ptr<PipelineHandle::State> state;
+    };
+
+    void BuildPipeline(const PipelineRequest& request, PipelineHandle::State& state);
+
+    // Build jobs never destroy a pipeline the GPU may still be using, so the ones they replace
+    // wait here for RetireReplaced().
+    void Replace(PipelineHandle::State& state, std::unique_ptr<Pipeline> pipeline);
+
+    Device& mDevice;
+    JobSystem& mJobSystem;
+    DescriptorLayoutCache& mLayoutCache;
+    PipelineCache& mPipelineCache;
+
+    std::vector<QueuedBuild> mQueued{};
+
+    // Keeps every pipeline alive, whether or not anyone still holds its handle. The requests
+    // they were built from are kept alongside for rebuilds.
+    std::vector<std::shared_ptr<PipelineHandle::State>> mBuilds{};
+    std::vector<PipelineRequest> mRequests{};
+    JobCounter mCounter{};
+
+    std::mutex mReplacedMutex{};
+    std::vector<std::unique_ptr<Pipeline>> mReplaced{};
+    RetireQueue* mRetireQueue = nullptr;
+};
+}
+
+#endif
@@ -0,0 +1,327 @@
+#include "PipelineCache.hpp"
+#include "Pipeline.hpp"
+#include "Graphics/Devices/LogicalDevice.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace mt
+{
+
+// Helper Functions.
+//---
+
+static void AppendFloat(std::vector<uint32_t>& key, float value)
+{
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(value));
+    key.push_back(bits);
+}
+
+static void AppendStencil(std::vector<uint32_t>& key, const VkStencilOpState& state)
+{
+    key.push_back(state.failOp);
+    key.push_back(state.passOp);
+    key.push_back(state.depthFailOp);
+    key.push_back(state.compareOp);
+    key.push_back(state.compareMask);
+    key.push_back(state.writeMask);
+    key.push_back(state.reference);
+}
+
+//---
+
+PipelineCache::PipelineCache(LogicalDevice& logicalDevice)
+    : mLogicalDevice{logicalDevice}
+{
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = 0;
+    cacheInfo.pInitialData = nullptr;
+
+    if(vkCreatePipelineCache(mLogicalDevice.GetDevice(), &cacheInfo, nullptr, &mVulkanCache) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create pipeline cache!");
+    }
+}
+
+PipelineCache::~PipelineCache()
+{
+    for(const auto& [key, pipeline] : mPipelines)
+    {
+        vkDestroyPipeline(mLogicalDevice.GetDevice(), pipeline, nullptr);
+    }
+
+    vkDestroyPipelineCache(mLogicalDevice.GetDevice(), mVulkanCache, nullptr);
+}
+
+template<class F>
+VkPipeline PipelineCache::GetOrCreate(Key key, F&& create)
+{
+    {
+        std::lock_guard<std::mutex> lock{mMutex};
+
+        auto existing = mPipelines.find(key);
+        if(existing != mPipelines.end())
+        {
+            mHits++;
+            return existing->second;
+        }
+    }
+
+    // Compiling takes milliseconds, so other threads carry on meanwhile. VkPipelineCache is
+    // internally synchronised.
+    VkPipeline pipeline = create();
+
+    std::lock_guard<std::mutex> lock{mMutex};
+
+    // Another thread may have compiled the same state in the meantime, theirs wins.
+    auto [existing, inserted] = mPipelines.emplace(std::move(key), pipeline);
+    if(!inserted)
+    {
+        vkDestroyPipeline(mLogicalDevice.GetDevice(), pipeline, nullptr);
+        mHits++;
+    }
+
+    return existing->second;
+}
+
+VkPipeline PipelineCache::GetGraphicsPipeline(const PipelineDesc& desc, const Shader& shader, const RenderPassFormats& formats)
+{
+    return GetOrCreate(MakeKey(desc, shader, formats), [&]()
+    {
+        return CreateGraphicsPipeline(desc, shader, formats);
+    });
+}
+
+VkPipeline PipelineCache::GetComputePipeline(VkPipelineLayout layout, const Shader& shader)
+{
+    // Shorter than any graphics key, so the two never collide.
+    Key key{};
+    AppendHandle(key, shader.GetId());
+    AppendHandle(key, layout);
+
+    return GetOrCreate(std::move(key), [&]()
+    {
+        return CreateComputePipeline(layout, shader);
+    });
+}
+
+size_t PipelineCache::GetPipelineCount()
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    return mPipelines.size();
+}
+
+uint32_t PipelineCache::GetHitCount()
+{
+    std::lock_guard<std::mutex> lock{mMutex};
+    return mHits;
+}
+
+PipelineCache::Key PipelineCache::MakeKey(const PipelineDesc& desc, const Shader& shader, const RenderPassFormats& formats)
+{
+    Key key{};
+    key.reserve(96);
+
+    // Shader modules are recreated on reload, so shaders are identified by their code instead.
+    AppendHandle(key, shader.GetId());
+    AppendHandle(key, desc.pipelineLayout);
+    key.push_back(desc.subpass);
+
+    key.push_back(static_cast<uint32_t>(formats.colorFormats.size()));
+    for(VkFormat format : formats.colorFormats)
+    {
+        key.push_back(format);
+    }
+    key.push_back(formats.depthFormat);
+    key.push_back(formats.samples);
+
+    const VkPipelineVertexInputStateCreateInfo& vertexInfo = desc.vertexInfo;
+    key.push_back(vertexInfo.vertexBindingDescriptionCount);
+    for(uint32_t i = 0; i < vertexInfo.vertexBindingDescriptionCount; i++)
+    {
+        const VkVertexInputBindingDescription& binding = vertexInfo.pVertexBindingDescriptions[i];
+        key.push_back(binding.binding);
+        key.push_back(binding.stride);
+        key.push_back(binding.inputRate);
+    }
+    key.push_back(vertexInfo.vertexAttributeDescriptionCount);
+    for(uint32_t i = 0; i < vertexInfo.vertexAttributeDescriptionCount; i++)
+    {
+        const VkVertexInputAttributeDescription& attribute = vertexInfo.pVertexAttributeDescriptions[i];
+        key.push_back(attribute.location);
+        key.push_back(attribute.binding);
+        key.push_back(attribute.format);
+        key.push_back(attribute.offset);
+    }
+
+    key.push_back(desc.inputAssemblyInfo.topology);
+    key.push_back(desc.inputAssemblyInfo.primitiveRestartEnable);
+
+    // From here on, state that's disabled contributes nothing, so descs that only differ in
+    // values Vulkan ignores share a pipeline.
+    const VkPipelineRasterizationStateCreateInfo& rasterization = desc.rasterizationInfo;
+    key.push_back(rasterization.depthClampEnable);
+    key.push_back(rasterization.rasterizerDiscardEnable);
+    key.push_back(rasterization.polygonMode);
+    key.push_back(rasterization.cullMode);
+    key.push_back(rasterization.cullMode == VK_CULL_MODE_NONE ? 0 : rasterization.frontFace);
+    key.push_back(rasterization.depthBiasEnable);
+    if(rasterization.depthBiasEnable)
+    {
+        AppendFloat(key, rasterization.depthBiasConstantFactor);
+        AppendFloat(key, rasterization.depthBiasClamp);
+        AppendFloat(key, rasterization.depthBiasSlopeFactor);
+    }
+    AppendFloat(key, rasterization.lineWidth);
+
+    const VkPipelineMultisampleStateCreateInfo& multisample = desc.multisampleInfo;
+    key.push_back(multisample.rasterizationSamples);
+    key.push_back(multisample.sampleShadingEnable);
+    if(multisample.sampleShadingEnable)
+    {
+        AppendFloat(key, multisample.minSampleShading);
+    }
+    key.push_back(multisample.pSampleMask ? multisample.pSampleMask[0] : ~0u);
+    key.push_back(multisample.alphaToCoverageEnable);
+    key.push_back(multisample.alphaToOneEnable);
+
+    const VkPipelineColorBlendStateCreateInfo& colorBlend = desc.colorBlendInfo;
+    const VkPipelineColorBlendAttachmentState& attachment = desc.colorBlendAttachment;
+    key.push_back(colorBlend.logicOpEnable);
+    key.push_back(colorBlend.logicOpEnable ? colorBlend.logicOp : 0);
+    key.push_back(attachment.colorWriteMask);
+    key.push_back(attachment.blendEnable);
+    if(attachment.blendEnable)
+    {
+        key.push_back(attachment.srcColorBlendFactor);
+        key.push_back(attachment.dstColorBlendFactor);
+        key.push_back(attachment.colorBlendOp);
+        key.push_back(attachment.srcAlphaBlendFactor);
+        key.push_back(attachment.dstAlphaBlendFactor);
+        key.push_back(attachment.alphaBlendOp);
+        for(float constant : colorBlend.blendConstants)
+        {
+            AppendFloat(key, constant);
+        }
+    }
+
+    // Without a depth attachment there's nothing to test against.
+    const VkPipelineDepthStencilStateCreateInfo& depthStencil = desc.depthStencilInfo;
+    if(formats.depthFormat != VK_FORMAT_UNDEFINED)
+    {
+        key.push_back(depthStencil.depthTestEnable);
+        if(depthStencil.depthTestEnable)
+        {
+            key.push_back(depthStencil.depthWriteEnable);
+            key.push_back(depthStencil.depthCompareOp);
+        }
+        key.push_back(depthStencil.depthBoundsTestEnable);
+        if(depthStencil.depthBoundsTestEnable)
+        {
+            AppendFloat(key, depthStencil.minDepthBounds);
+            AppendFloat(key, depthStencil.maxDepthBounds);
+        }
+        key.push_back(depthStencil.stencilTestEnable);
+        if(depthStencil.stencilTestEnable)
+        {
+            AppendStencil(key, depthStencil.front);
+            AppendStencil(key, depthStencil.back);
+        }
+    }
+
+    return key;
+}
+
+VkPipeline PipelineCache::CreateGraphicsPipeline(const PipelineDesc& desc, const Shader& shader, const RenderPassFormats& formats)
+{
+    // The blend state points at the desc's own attachment, which may have been copied since.
+    VkPipelineColorBlendStateCreateInfo colorBlendInfo = desc.colorBlendInfo;
+    colorBlendInfo.attachmentCount = 1;
+    colorBlendInfo.pAttachments = &desc.colorBlendAttachment;
+
+    // Set when recording (see RenderGraphResources::Execute()), so resizing doesn't touch pipelines.
+    VkPipelineViewportStateCreateInfo viewportInfo{};
+    viewportInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewportInfo.viewportCount = 1;
+    viewportInfo.pViewports = nullptr;
+    viewportInfo.scissorCount = 1;
+    viewportInfo.pScissors = nullptr;
+
+    VkDynamicState dynamicStates[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+
+    VkPipelineDynamicStateCreateInfo dynamicInfo{};
+    dynamicInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicInfo.dynamicStateCount = 2;
+    dynamicInfo.pDynamicStates = dynamicStates;
+
+    VkGraphicsPipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineInfo.stageCount = static_cast<uint32_t>(shader.GetShaderStages().size());
+    pipelineInfo.pStages = shader.GetShaderStages().data();
+    pipelineInfo.pVertexInputState = &desc.vertexInfo;
+    pipelineInfo.pInputAssemblyState = &desc.inputAssemblyInfo;
+    pipelineInfo.pViewportState = &viewportInfo;
+    pipelineInfo.pRasterizationState = &desc.rasterizationInfo;
+    pipelineInfo.pMultisampleState = &desc.multisampleInfo;
+    pipelineInfo.pColorBlendState = &colorBlendInfo;
+    pipelineInfo.pDepthStencilState = &desc.depthStencilInfo;
+    pipelineInfo.pDynamicState = &dynamicInfo;
+
+    pipelineInfo.layout = desc.pipelineLayout;
+
+    // With dynamic rendering there are no render passes to be compatible with, only formats.
+    VkPipelineRenderingCreateInfoKHR renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+    renderingInfo.colorAttachmentCount = static_cast<uint32_t>(formats.colorFormats.size());
+    renderingInfo.pColorAttachmentFormats = formats.colorFormats.data();
+    renderingInfo.depthAttachmentFormat = formats.depthFormat;
+    renderingInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+
+    if(mLogicalDevice.SupportsDynamicRendering())
+    {
+        pipelineInfo.pNext = &renderingInfo;
+        pipelineInfo.renderPass = VK_NULL_HANDLE;
+        pipelineInfo.subpass = 0;
+    }
+    else if(desc.renderPass != VK_NULL_HANDLE)
+    {
+        pipelineInfo.renderPass = desc.renderPass;
+        pipelineInfo.subpass = desc.subpass;
+    }
+    else {
+        throw std::runtime_error("Graphics pipelines need a render pass without dynamic rendering!");
+    }
+
+    pipelineInfo.basePipelineIndex = -1;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if(vkCreateGraphicsPipelines(mLogicalDevice.GetDevice(), mVulkanCache, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create graphics pipeline!");
+    }
+
+    return pipeline;
+}
+
+VkPipeline PipelineCache::CreateComputePipeline(VkPipelineLayout layout, const Shader& shader)
+{
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage = shader.GetShaderStages()[0];
+    pipelineInfo.layout = layout;
+    pipelineInfo.basePipelineIndex = -1;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if(vkCreateComputePipelines(mLogicalDevice.GetDevice(), mVulkanCache, 1, &pipelineInfo, nullptr, &pipeline) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create compute pipeline!");
+    }
+
+    return pipeline;
+}
+
+}
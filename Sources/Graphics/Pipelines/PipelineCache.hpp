@@ -0,0 +1,90 @@
+#ifndef MAMMOTH_2D_PIPELINE_CACHE_HPP
+#define MAMMOTH_2D_PIPELINE_CACHE_HPP
+
+#include "Hashing.hpp"
+
+#include <vulkan/vulkan.hpp>
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace mt
+{
+
+class LogicalDevice;
+struct PipelineDesc;
+class Shader;
+
+/**
+ * @brief What makes render passes compatible as far as a pipeline is concerned (the attachments'
+ * formats and sample counts), so pipelines can be shared between passes and survive the
+ * swap chain being recreated.
+*/
+struct RenderPassFormats
+{
+    std::vector<VkFormat> colorFormats{};
+    VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+};
+
+/**
+ * @brief Owns every pipeline and compiles each unique state exactly once. Pipelines are
+ * keyed by their PipelineDesc (with state that has no effect normalised away), the contents of
+ * their shaders and the formats of the render pass, and live until the cache is destroyed.
+ * Viewport and scissor are always dynamic, so they're not part of the key.
+ *
+ * Thread safe: pipelines are compiled outside the lock, so worker jobs (see PipelineBuildQueue)
+ * compile in parallel, and they all share one VkPipelineCache so the driver can reuse work
+ * between them.
+*/
+class PipelineCache
+{
+public:
+    PipelineCache(LogicalDevice& logicalDevice);
+    ~PipelineCache();
+
+    PipelineCache(const PipelineCache& other) = delete;
+    PipelineCache& operator=(const PipelineCache& other) = delete;
+
+    /**
+     * @param desc Its render pass is only used to create the pipeline, which then works with any
+     * compatible pass (see RenderPassFormats). Ignored with dynamic rendering, where the formats
+     * are all a pipeline is built against.
+    */
+    VkPipeline GetGraphicsPipeline(const PipelineDesc& desc, const Shader& shader, const RenderPassFormats& formats);
+
+    /**
+     * @brief Keyed by the shader's code and the layout alone, compute has no other state.
+    */
+    VkPipeline GetComputePipeline(VkPipelineLayout layout, const Shader& shader);
+
+    size_t GetPipelineCount();
+    uint32_t GetHitCount();
+
+    inline VkPipelineCache GetVulkanCache() const { return mVulkanCache; }
+
+private:
+    using Key = std::vector<uint32_t>;
+
+    using KeyHash = WordKeyHash;
+
+    static Key MakeKey(const PipelineDesc& desc, const Shader& shader, const RenderPassFormats& formats);
+
+    // Looks the key up, and otherwise creates the pipeline with create() outside the lock.
+    template<class F>
+    VkPipeline GetOrCreate(Key key, F&& create);
+
+    VkPipeline CreateGraphicsPipeline(const PipelineDesc& desc, const Shader& shader, const RenderPassFormats& formats);
+    VkPipeline CreateComputePipeline(VkPipelineLayout layout, const Shader& shader);
+
+    LogicalDevice& mLogicalDevice;
+    VkPipelineCache mVulkanCache = VK_NULL_HANDLE;
+
+    std::mutex mMutex{};
+    std::unordered_map<Key, VkPipeline, KeyHash> mPipelines{};
+    uint32_t mHits = 0;
+};
+}
+
+#endif
@@ -0,0 +1,583 @@
+#include "RenderGraph.hpp"
+#include "Profiler/Profiler.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace mt
+{
+
+// Helper Functions.
+//---
+
+static constexpr VkAccessFlags WRITE_ACCESS =
+    VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+    VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+static bool IsAttachment(RenderGraphAccess access)
+{
+    return access == RenderGraphAccess::ColorAttachment ||
+        access == RenderGraphAccess::DepthAttachment ||
+        access == RenderGraphAccess::DepthReadOnly;
+}
+
+/**
+ * @brief Whether the use overwrites the whole image, so whatever was in it before is dead.
+*/
+static bool Overwrites(const RenderGraphImageUse& use)
+{
+    return (use.access == RenderGraphAccess::ColorAttachment || use.access == RenderGraphAccess::DepthAttachment) &&
+        use.loadOp != RenderGraphLoadOp::Load;
+}
+
+/**
+ * @brief Whether the use depends on what was in the image before. Storage and transfer writes
+ * may only touch part of it, so they count too.
+*/
+static bool NeedsContents(const RenderGraphImageUse& use)
+{
+    return !Overwrites(use);
+}
+
+//---
+
+RenderGraphAccessInfo GetRenderGraphAccessInfo(RenderGraphAccess access)
+{
+    switch(access)
+    {
+        case RenderGraphAccess::ColorAttachment:
+            return {VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, true};
+        case RenderGraphAccess::DepthAttachment:
+            return {VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, true};
+        case RenderGraphAccess::DepthReadOnly:
+            return {VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, false};
+        case RenderGraphAccess::FragmentSampled:
+            return {VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_USAGE_SAMPLED_BIT, false};
+        case RenderGraphAccess::ComputeSampled:
+            return {VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_USAGE_SAMPLED_BIT, false};
+        case RenderGraphAccess::ComputeStorageRead:
+            return {VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_USAGE_STORAGE_BIT, false};
+        case RenderGraphAccess::ComputeStorageWrite:
+            return {VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_USAGE_STORAGE_BIT, true};
+        case RenderGraphAccess::TransferRead:
+            return {VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_USAGE_TRANSFER_SRC_BIT, false};
+        case RenderGraphAccess::TransferWrite:
+            return {VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_USAGE_TRANSFER_DST_BIT, true};
+    }
+
+    throw std::runtime_error("Unknown render graph access!");
+}
+
+RenderGraphPass::RenderGraphPass(const std::string& name)
+    : mName{name}
+{
+
+}
+
+RenderGraphPass& RenderGraphPass::ReadImage(RenderGraphResource resource, RenderGraphAccess access)
+{
+    if(GetRenderGraphAccessInfo(access).writes)
+    {
+        throw std::runtime_error("Pass " + mName + " reads an image with a write access!");
+    }
+
+    return Use(RenderGraphImageUse{resource, access, RenderGraphLoadOp::Load, {}});
+}
+
+RenderGraphPass& RenderGraphPass::WriteImage(RenderGraphResource resource, RenderGraphAccess access)
+{
+    if(!GetRenderGraphAccessInfo(access).writes || IsAttachment(access))
+    {
+        throw std::runtime_error("Pass " + mName + " writes an image with a read access, use WriteColor() or WriteDepth() for attachments!");
+    }
+
+    return Use(RenderGraphImageUse{resource, access, RenderGraphLoadOp::Load, {}});
+}
+
+RenderGraphPass& RenderGraphPass::WriteColor(RenderGraphResource resource, RenderGraphLoadOp loadOp, VkClearColorValue clearValue)
+{
+    RenderGraphImageUse use{resource, RenderGraphAccess::ColorAttachment, loadOp, {}};
+    use.clearValue.color = clearValue;
+
+    return Use(use);
+}
+
+RenderGraphPass& RenderGraphPass::WriteDepth(RenderGraphResource resource, RenderGraphLoadOp loadOp, VkClearDepthStencilValue clearValue)
+{
+    RenderGraphImageUse use{resource, RenderGraphAccess::DepthAttachment, loadOp, {}};
+    use.clearValue.depthStencil = clearValue;
+
+    return Use(use);
+}
+
+RenderGraphPass& RenderGraphPass::SetSideEffects()
+{
+    mSideEffects = true;
+    return *this;
+}
+
+RenderGraphPass& RenderGraphPass::SetExecute(ExecuteFn execute)
+{
+    mExecute = std::move(execute);
+    return *this;
+}
+
+bool RenderGraphPass::IsRaster() const
+{
+    return std::any_of(mUses.begin(), mUses.end(), [](const RenderGraphImageUse& use) { return IsAttachment(use.access); });
+}
+
+RenderGraphPass& RenderGraphPass::Use(const RenderGraphImageUse& use)
+{
+    // One layout per image per pass, so an image can't be read and written by the same pass.
+    for(const RenderGraphImageUse& existing : mUses)
+    {
+        if(existing.resource == use.resource)
+        {
+            throw std::runtime_error("Pass " + mName + " uses the same image twice!");
+        }
+    }
+
+    mUses.push_back(use);
+    return *this;
+}
+
+RenderGraphResource RenderGraph::CreateImage(const std::string& name, const RenderGraphImageDesc& desc)
+{
+    RenderGraphImage image{};
+    image.name = name;
+    image.desc = desc;
+
+    mImages.push_back(image);
+    mCompiled = false;
+
+    return static_cast<RenderGraphResource>(mImages.size() - 1);
+}
+
+RenderGraphResource RenderGraph::ImportImage(const std::string& name, const RenderGraphImageDesc& desc, VkImage image, VkImageView view, const RenderGraphImport& import)
+{
+    RenderGraphImage imported{};
+    imported.name = name;
+    imported.desc = desc;
+    imported.imported = true;
+    imported.import = import;
+    imported.image = image;
+    imported.view = view;
+
+    mImages.push_back(imported);
+    mCompiled = false;
+
+    return static_cast<RenderGraphResource>(mImages.size() - 1);
+}
+
+RenderGraphPass& RenderGraph::AddPass(const std::string& name)
+{
+    mPasses.emplace_back(name);
+    mCompiled = false;
+
+    return mPasses.back();
+}
+
+void RenderGraph::Reset()
+{
+    mPasses.clear();
+    mImages.clear();
+    mSteps.clear();
+    mFinalBarriers = RenderGraphStep{};
+    mAliasSlotCount = 0;
+    mCompiled = false;
+}
+
+void RenderGraph::Compile()
+{
+    MT_PROFILE_FUNCTION();
+
+    for(const RenderGraphPass& pass : mPasses)
+    {
+        for(const RenderGraphImageUse& use : pass.GetUses())
+        {
+            if(use.resource >= mImages.size())
+            {
+                throw std::runtime_error("Pass " + pass.GetName() + " uses an image from another graph!");
+            }
+        }
+    }
+
+    for(RenderGraphImage& image : mImages)
+    {
+        image.usage = 0;
+        image.firstStep = ~0u;
+        image.lastStep = 0;
+        image.aliasSlot = ~0u;
+        image.memoryless = false;
+    }
+
+    mSteps.clear();
+    mFinalBarriers = RenderGraphStep{};
+
+    std::vector<bool> live = CullPasses();
+
+    for(uint32_t i = 0; i < mPasses.size(); i++)
+    {
+        if(!live[i])
+        {
+            continue;
+        }
+
+        uint32_t stepIndex = static_cast<uint32_t>(mSteps.size());
+
+        RenderGraphStep step{};
+        step.pass = i;
+        mSteps.push_back(step);
+
+        for(const RenderGraphImageUse& use : mPasses[i].GetUses())
+        {
+            RenderGraphImage& image = mImages[use.resource];
+            image.usage |= GetRenderGraphAccessInfo(use.access).usage;
+            image.firstStep = std::min(image.firstStep, stepIndex);
+            image.lastStep = std::max(image.lastStep, stepIndex);
+        }
+    }
+
+    AssignAliasSlots();
+    PlaceBarriers();
+
+    mCompiled = true;
+}
+
+std::vector<bool> RenderGraph::CullPasses() const
+{
+    // Walk backwards from the outputs: a pass lives if it writes something a later live pass (or
+    // the frame's output) still needs, and then everything it reads is needed in turn.
+    std::vector<bool> needed(mImages.size(), false);
+    for(size_t i = 0; i < mImages.size(); i++)
+    {
+        needed[i] = mImages[i].imported;
+    }
+
+    std::vector<bool> live(mPasses.size(), false);
+
+    for(size_t i = mPasses.size(); i-- > 0;)
+    {
+        const RenderGraphPass& pass = mPasses[i];
+
+        bool isLive = pass.HasSideEffects();
+        for(const RenderGraphImageUse& use : pass.GetUses())
+        {
+            if(GetRenderGraphAccessInfo(use.access).writes && needed[use.resource])
+            {
+                isLive = true;
+            }
+        }
+
+        if(!isLive)
+        {
+            continue;
+        }
+
+        live[i] = true;
+
+        for(const RenderGraphImageUse& use : pass.GetUses())
+        {
+            needed[use.resource] = NeedsContents(use);
+        }
+    }
+
+    return live;
+}
+
+void RenderGraph::AssignAliasSlots()
+{
+    // Transients that are never alive at the same time can share memory. Greedy by first use,
+    // which is optimal for intervals.
+    std::vector<RenderGraphResource> transients{};
+    for(RenderGraphResource i = 0; i < mImages.size(); i++)
+    {
+        if(!mImages[i].imported && mImages[i].firstStep != ~0u)
+        {
+            transients.push_back(i);
+        }
+    }
+
+    std::sort(transients.begin(), transients.end(), [this](RenderGraphResource a, RenderGraphResource b)
+    {
+        return mImages[a].firstStep < mImages[b].firstStep;
+    });
+
+    std::vector<uint32_t> slotLastSteps{};
+    for(RenderGraphResource resource : transients)
+    {
+        RenderGraphImage& image = mImages[resource];
+
+        for(uint32_t slot = 0; slot < slotLastSteps.size(); slot++)
+        {
+            if(slotLastSteps[slot] < image.firstStep)
+            {
+                image.aliasSlot = slot;
+                break;
+            }
+        }
+
+        if(image.aliasSlot == ~0u)
+        {
+            image.aliasSlot = static_cast<uint32_t>(slotLastSteps.size());
+            slotLastSteps.push_back(0);
+        }
+
+        slotLastSteps[image.aliasSlot] = image.lastStep;
+    }
+
+    mAliasSlotCount = static_cast<uint32_t>(slotLastSteps.size());
+}
+
+void RenderGraph::PlaceBarriers()
+{
+    // What still has to be waited on before an image can be used differently: the stages that
+    // touched it since its last barrier, and whether any of them wrote it.
+    struct State
+    {
+        VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags stages = 0;
+        VkAccessFlags writeAccess = 0;
+        bool hasContents = false;
+        bool touched = false;
+    };
+
+    std::vector<State> states(mImages.size());
+    for(size_t i = 0; i < mImages.size(); i++)
+    {
+        if(mImages[i].imported)
+        {
+            states[i].layout = mImages[i].import.initialLayout;
+            states[i].stages = mImages[i].import.initialStages;
+            states[i].hasContents = mImages[i].import.initialLayout != VK_IMAGE_LAYOUT_UNDEFINED;
+        }
+    }
+
+    // A transient's first use has to wait for whichever image used its memory last, which isn't
+    // known until the whole frame has been walked.
+    struct FirstUse
+    {
+        uint32_t step;
+        size_t barrier;
+        RenderGraphResource resource;
+    };
+    std::vector<FirstUse> firstUses{};
+
+    for(uint32_t stepIndex = 0; stepIndex < mSteps.size(); stepIndex++)
+    {
+        RenderGraphStep& step = mSteps[stepIndex];
+        const RenderGraphPass& pass = mPasses[step.pass];
+
+        for(const RenderGraphImageUse& use : pass.GetUses())
+        {
+            const RenderGraphImage& image = mImages[use.resource];
+            RenderGraphAccessInfo info = GetRenderGraphAccessInfo(use.access);
+            State& state = states[use.resource];
+
+            // Attachments are transitioned here rather than by the render pass, so they keep
+            // the same layout for the whole pass.
+            if(IsAttachment(use.access))
+            {
+                RenderGraphAttachment attachment{};
+                attachment.resource = use.resource;
+                attachment.layout = info.layout;
+                attachment.clearValue = use.clearValue;
+
+                if(use.loadOp == RenderGraphLoadOp::Clear)
+                {
+                    attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+                }
+                else if(use.loadOp == RenderGraphLoadOp::Load && state.hasContents) {
+                    attachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+                }
+
+                if(use.access == RenderGraphAccess::ColorAttachment)
+                {
+                    step.colorAttachments.push_back(attachment);
+                }
+                else {
+                    if(step.hasDepthAttachment)
+                    {
+                        throw std::runtime_error("Pass " + pass.GetName() + " has more than one depth attachment!");
+                    }
+                    step.hasDepthAttachment = true;
+                    step.depthAttachment = attachment;
+                }
+
+                VkExtent2D extent{image.desc.width, image.desc.height};
+                if(step.extent.width == 0 && step.extent.height == 0)
+                {
+                    step.extent = extent;
+                }
+                else if(step.extent.width != extent.width || step.extent.height != extent.height) {
+                    throw std::runtime_error("The attachments of pass " + pass.GetName() + " aren't the same size!");
+                }
+            }
+
+            if(!image.imported && !state.touched)
+            {
+                // Nothing worth keeping in there yet, whatever aliased the memory can be discarded.
+                firstUses.push_back(FirstUse{stepIndex, step.barriers.size(), use.resource});
+                step.barriers.push_back(RenderGraphBarrier{use.resource, VK_IMAGE_LAYOUT_UNDEFINED, info.layout, 0, info.access});
+                step.dstStages |= info.stages;
+            }
+            else if(state.layout != info.layout || state.writeAccess != 0 || info.writes) {
+                VkImageLayout oldLayout = state.hasContents ? state.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+                step.barriers.push_back(RenderGraphBarrier{use.resource, oldLayout, info.layout, state.writeAccess, info.access});
+                step.srcStages |= state.stages;
+                step.dstStages |= info.stages;
+            }
+            else {
+                // Read after read in the same layout, just remember that the next write has to
+                // wait for this reader too.
+                state.stages |= info.stages;
+                continue;
+            }
+
+            state.layout = info.layout;
+            state.stages = info.stages;
+            state.writeAccess = info.writes ? (info.access & WRITE_ACCESS) : 0;
+            state.hasContents = state.hasContents || info.writes;
+            state.touched = true;
+        }
+    }
+
+    for(const FirstUse& firstUse : firstUses)
+    {
+        // The image that used the memory last: the one before this in the same slot, or the last
+        // one in it, from the previous frame.
+        const RenderGraphImage& image = mImages[firstUse.resource];
+        RenderGraphResource previous = INVALID_RENDER_GRAPH_RESOURCE;
+        RenderGraphResource last = firstUse.resource;
+
+        for(RenderGraphResource i = 0; i < mImages.size(); i++)
+        {
+            const RenderGraphImage& other = mImages[i];
+            if(other.imported || other.aliasSlot != image.aliasSlot)
+            {
+                continue;
+            }
+
+            if(other.lastStep < image.firstStep && (previous == INVALID_RENDER_GRAPH_RESOURCE || other.lastStep > mImages[previous].lastStep))
+            {
+                previous = i;
+            }
+            if(other.lastStep > mImages[last].lastStep)
+            {
+                last = i;
+            }
+        }
+
+        if(previous == INVALID_RENDER_GRAPH_RESOURCE)
+        {
+            previous = last;
+        }
+
+        RenderGraphStep& step = mSteps[firstUse.step];
+        step.barriers[firstUse.barrier].srcAccess = states[previous].writeAccess;
+        step.srcStages |= states[previous].stages;
+    }
+
+    for(RenderGraphStep& step : mSteps)
+    {
+        if(!step.barriers.empty() && step.srcStages == 0)
+        {
+            step.srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        }
+    }
+
+    // Attachments only need storing if something after the pass reads them.
+    for(uint32_t stepIndex = 0; stepIndex < mSteps.size(); stepIndex++)
+    {
+        RenderGraphStep& step = mSteps[stepIndex];
+
+        auto setStoreOp = [&](RenderGraphAttachment& attachment)
+        {
+            bool store = mImages[attachment.resource].imported;
+
+            for(uint32_t later = stepIndex + 1; later < mSteps.size(); later++)
+            {
+                const std::vector<RenderGraphImageUse>& uses = mPasses[mSteps[later].pass].GetUses();
+                auto use = std::find_if(uses.begin(), uses.end(), [&](const RenderGraphImageUse& u) { return u.resource == attachment.resource; });
+
+                if(use != uses.end())
+                {
+                    store = NeedsContents(*use);
+                    break;
+                }
+            }
+
+            attachment.storeOp = store ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        };
+
+        for(RenderGraphAttachment& attachment : step.colorAttachments)
+        {
+            setStoreOp(attachment);
+        }
+        if(step.hasDepthAttachment)
+        {
+            setStoreOp(step.depthAttachment);
+        }
+    }
+
+    // Attachments whose contents never leave the pass that wrote them.
+    const VkImageUsageFlags attachmentUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+    for(RenderGraphImage& image : mImages)
+    {
+        image.memoryless = !image.imported && image.aliasSlot != ~0u && (image.usage & ~attachmentUsage) == 0;
+    }
+
+    for(const RenderGraphStep& step : mSteps)
+    {
+        auto keepsContents = [&](const RenderGraphAttachment& attachment)
+        {
+            if(attachment.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD || attachment.storeOp == VK_ATTACHMENT_STORE_OP_STORE)
+            {
+                mImages[attachment.resource].memoryless = false;
+            }
+        };
+
+        for(const RenderGraphAttachment& attachment : step.colorAttachments)
+        {
+            keepsContents(attachment);
+        }
+        if(step.hasDepthAttachment)
+        {
+            keepsContents(step.depthAttachment);
+        }
+    }
+
+    // Hand imported images back in the layout they're expected in (e.g. ready to present).
+    for(RenderGraphResource i = 0; i < mImages.size(); i++)
+    {
+        const RenderGraphImage& image = mImages[i];
+        const State& state = states[i];
+
+        if(!image.imported || state.layout == image.import.finalLayout)
+        {
+            continue;
+        }
+
+        VkImageLayout oldLayout = state.hasContents ? state.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+        mFinalBarriers.barriers.push_back(RenderGraphBarrier{i, oldLayout, image.import.finalLayout, state.writeAccess, 0});
+        mFinalBarriers.srcStages |= state.stages;
+    }
+
+    if(!mFinalBarriers.barriers.empty())
+    {
+        mFinalBarriers.srcStages = mFinalBarriers.srcStages ? mFinalBarriers.srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+        mFinalBarriers.dstStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+    }
+}
+
+}
@@ -0,0 +1,265 @@
+#ifndef MAMMOTH_2D_RENDER_GRAPH_HPP
+#define MAMMOTH_2D_RENDER_GRAPH_HPP
+
+#include <vulkan/vulkan.hpp>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace mt
+{
+
+class RenderGraphResources;
+
+/**
+ * @brief An image in a RenderGraph, only valid for the graph that created it.
+*/
+using RenderGraphResource = uint32_t;
+
+constexpr RenderGraphResource INVALID_RENDER_GRAPH_RESOURCE = ~0u;
+
+/**
+ * @brief How a pass uses an image. Each one implies the layout, stages and access the image
+ * needs, which is all the graph needs to place barriers.
+*/
+enum class RenderGraphAccess : uint8_t
+{
+    ColorAttachment,
+    DepthAttachment,
+    DepthReadOnly,
+    FragmentSampled,
+    ComputeSampled,
+    ComputeStorageRead,
+    ComputeStorageWrite,
+    TransferRead,
+    TransferWrite
+};
+
+/**
+ * @brief What happens to an attachment's previous contents when a pass writes it.
+*/
+enum class RenderGraphLoadOp : uint8_t
+{
+    Clear,
+    Load,
+    DontCare
+};
+
+struct RenderGraphAccessInfo
+{
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkPipelineStageFlags stages = 0;
+    VkAccessFlags access = 0;
+    VkImageUsageFlags usage = 0;
+    bool writes = false;
+};
+
+RenderGraphAccessInfo GetRenderGraphAccessInfo(RenderGraphAccess access);
+
+struct RenderGraphImageDesc
+{
+    VkFormat format = VK_FORMAT_UNDEFINED;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    VkSampleCountFlagBits samples = VK_SAMPLE_COUNT_1_BIT;
+};
+
+/**
+ * @brief The state an imported image (e.g. the swap chain's) is in before the frame, and the
+ * layout it has to be left in.
+*/
+struct RenderGraphImport
+{
+    VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+    // The stages the image becomes available at, e.g. where the acquire semaphore is waited on.
+    VkPipelineStageFlags initialStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+
+    VkImageLayout finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+};
+
+struct RenderGraphImage
+{
+    std::string name{};
+    RenderGraphImageDesc desc{};
+
+    bool imported = false;
+    RenderGraphImport import{};
+    VkImage image = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+
+    // Filled in by RenderGraph::Compile().
+    VkImageUsageFlags usage = 0;
+    uint32_t firstStep = ~0u;
+    uint32_t lastStep = 0;
+    uint32_t aliasSlot = ~0u;
+
+    // A transient that's only ever an attachment, and never loaded or stored, so its contents
+    // never have to leave tile memory (e.g. a depth buffer). RenderGraphResources backs these
+    // with lazily allocated memory where the device has any.
+    bool memoryless = false;
+};
+
+struct RenderGraphImageUse
+{
+    RenderGraphResource resource = INVALID_RENDER_GRAPH_RESOURCE;
+    RenderGraphAccess access = RenderGraphAccess::FragmentSampled;
+    RenderGraphLoadOp loadOp = RenderGraphLoadOp::Load;
+    VkClearValue clearValue{};
+};
+
+/**
+ * @brief A pass declares every image it reads and writes, and records its commands in a
+ * callback once the graph has put everything in place.
+*/
+class RenderGraphPass
+{
+public:
+    using ExecuteFn = std::function<void(VkCommandBuffer, const RenderGraphResources&)>;
+
+    RenderGraphPass(const std::string& name);
+
+    RenderGraphPass& ReadImage(RenderGraphResource resource, RenderGraphAccess access);
+    RenderGraphPass& WriteImage(RenderGraphResource resource, RenderGraphAccess access);
+
+    RenderGraphPass& WriteColor(RenderGraphResource resource, RenderGraphLoadOp loadOp, VkClearColorValue clearValue = {});
+    RenderGraphPass& WriteDepth(RenderGraphResource resource, RenderGraphLoadOp loadOp, VkClearDepthStencilValue clearValue = {1.0f, 0});
+
+    /**
+     * @brief Never culled, even when nothing reads what it writes (e.g. GPU readbacks).
+    */
+    RenderGraphPass& SetSideEffects();
+
+    RenderGraphPass& SetExecute(ExecuteFn execute);
+
+    inline const std::string& GetName() const { return mName; }
+    inline const std::vector<RenderGraphImageUse>& GetUses() const { return mUses; }
+    inline bool HasSideEffects() const { return mSideEffects; }
+    inline const ExecuteFn& GetExecute() const { return mExecute; }
+
+    /**
+     * @return Whether the pass draws into attachments, and so runs inside a render pass.
+    */
+    bool IsRaster() const;
+
+private:
+    RenderGraphPass& Use(const RenderGraphImageUse& use);
+
+    std::string mName{};
+    std::vector<RenderGraphImageUse> mUses{};
+    bool mSideEffects = false;
+    ExecuteFn mExecute{};
+};
+
+struct RenderGraphBarrier
+{
+    RenderGraphResource resource = INVALID_RENDER_GRAPH_RESOURCE;
+    VkImageLayout oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkImageLayout newLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkAccessFlags srcAccess = 0;
+    VkAccessFlags dstAccess = 0;
+};
+
+struct RenderGraphAttachment
+{
+    RenderGraphResource resource = INVALID_RENDER_GRAPH_RESOURCE;
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    VkAttachmentStoreOp storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    VkClearValue clearValue{};
+};
+
+/**
+ * @brief A pass that survived culling, with the one vkCmdPipelineBarrier() it needs first (if any).
+*/
+struct RenderGraphStep
+{
+    uint32_t pass = ~0u;
+
+    VkPipelineStageFlags srcStages = 0;
+    VkPipelineStageFlags dstStages = 0;
+    std::vector<RenderGraphBarrier> barriers{};
+
+    std::vector<RenderGraphAttachment> colorAttachments{};
+    bool hasDepthAttachment = false;
+    RenderGraphAttachment depthAttachment{};
+    VkExtent2D extent{};
+};
+
+/**
+ * @brief Describes a frame as passes and the images they read and write, then Compile() works
+ * out everything that's tedious and easy to get wrong by hand:
+ *  - Passes whose results nothing uses are culled. Imported images are the frame's outputs.
+ *  - Passes run in the order they were added, each with at most one barrier batch in front of
+ *    it. Reads that follow reads in the same layout need no barrier at all.
+ *  - Transient images (CreateImage()) whose lifetimes don't overlap share an alias slot, so
+ *    RenderGraphResources backs them with the same memory.
+ *  - Attachments are only stored if a later pass, or the frame's output, needs them. Transients
+ *    that are never loaded or stored are marked memoryless.
+ *
+ * Rebuild it every frame (Reset(), add passes, Compile()): compiling is cheap, and the GPU objects
+ * behind it are cached by RenderGraphResources for as long as the graph's shape stays the same.
+ * Compiling doesn't touch the device.
+*/
+class RenderGraph
+{
+public:
+    RenderGraph() = default;
+
+    RenderGraph(const RenderGraph& other) = delete;
+    RenderGraph& operator=(const RenderGraph& other) = delete;
+
+    /**
+     * @brief A transient image that only lives for the frame, created (and aliased) by the graph.
+    */
+    RenderGraphResource CreateImage(const std::string& name, const RenderGraphImageDesc& desc);
+
+    /**
+     * @brief An image that outlives the frame, like the swap chain image. Never culled.
+    */
+    RenderGraphResource ImportImage(const std::string& name, const RenderGraphImageDesc& desc, VkImage image, VkImageView view, const RenderGraphImport& import = {});
+
+    /**
+     * @brief The returned pass is only valid until the next AddPass().
+    */
+    RenderGraphPass& AddPass(const std::string& name);
+
+    void Compile();
+
+    /**
+     * @brief Forgets every pass and image, ready for the next frame.
+    */
+    void Reset();
+
+    inline const std::vector<RenderGraphPass>& GetPasses() const { return mPasses; }
+    inline const std::vector<RenderGraphImage>& GetImages() const { return mImages; }
+    inline const RenderGraphImage& GetImage(RenderGraphResource resource) const { return mImages[resource]; }
+
+    inline const std::vector<RenderGraphStep>& GetSteps() const { return mSteps; }
+    inline uint32_t GetCulledPassCount() const { return static_cast<uint32_t>(mPasses.size() - mSteps.size()); }
+
+    /**
+     * @return The barriers that leave imported images in their final layouts, after the last step.
+    */
+    inline const RenderGraphStep& GetFinalBarriers() const { return mFinalBarriers; }
+
+    inline uint32_t GetAliasSlotCount() const { return mAliasSlotCount; }
+    inline bool IsCompiled() const { return mCompiled; }
+
+private:
+    std::vector<bool> CullPasses() const;
+    void PlaceBarriers();
+    void AssignAliasSlots();
+
+    std::vector<RenderGraphPass> mPasses{};
+    std::vector<RenderGraphImage> mImages{};
+
+    std::vector<RenderGraphStep> mSteps{};
+    RenderGraphStep mFinalBarriers{};
+    uint32_t mAliasSlotCount = 0;
+    bool mCompiled = false;
+};
+}
+
+#endif
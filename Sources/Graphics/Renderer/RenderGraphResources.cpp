@@ -0,0 +1,579 @@
+#include "RenderGraphResources.hpp"
+#include "Profiler/Profiler.hpp"
+#include "Logging.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace mt
+{
+
+// Helper Functions.
+//---
+
+static VkImageAspectFlags GetAspectMask(VkFormat format)
+{
+    switch(format)
+    {
+        case VK_FORMAT_D32_SFLOAT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT;
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        default:
+            return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+}
+
+static VkAttachmentDescription MakeAttachmentDescription(const RenderGraphImage& image, const RenderGraphAttachment& attachment)
+{
+    // The graph's barriers do every transition, so the render pass leaves layouts alone.
+    VkAttachmentDescription description{};
+    description.format = image.desc.format;
+    description.samples = image.desc.samples;
+    description.loadOp = attachment.loadOp;
+    description.storeOp = attachment.storeOp;
+    description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    description.initialLayout = attachment.layout;
+    description.finalLayout = attachment.layout;
+
+    return description;
+}
+
+//---
+
+RenderGraphResources::RenderGraphResources(LogicalDevice& logicalDevice)
+    : mLogicalDevice{logicalDevice}
+{
+
+}
+
+RenderGraphResources::~RenderGraphResources()
+{
+    Clear();
+}
+
+void RenderGraphResources::Clear()
+{
+    DestroyTransients();
+
+    for(const auto& [key, renderPass] : mRenderPasses)
+    {
+        vkDestroyRenderPass(mLogicalDevice.GetDevice(), renderPass, nullptr);
+    }
+    mRenderPasses.clear();
+}
+
+void RenderGraphResources::DestroyTransients()
+{
+    VkDevice device = mLogicalDevice.GetDevice();
+
+    // Framebuffers may point at transient views, so they go too.
+    for(const auto& [key, framebuffer] : mFramebuffers)
+    {
+        vkDestroyFramebuffer(device, framebuffer, nullptr);
+    }
+    mFramebuffers.clear();
+
+    for(TransientImage& transient : mTransients)
+    {
+        if(transient.image != VK_NULL_HANDLE)
+        {
+            vkDestroyImageView(device, transient.view, nullptr);
+            vkDestroyImage(device, transient.image, nullptr);
+        }
+    }
+    mTransients.clear();
+    mTransientKey.clear();
+    mTransientCount = 0;
+
+    for(VkDeviceMemory memory : mMemory)
+    {
+        vkFreeMemory(device, memory, nullptr);
+    }
+    mMemory.clear();
+    mAllocatedBytes = 0;
+    mLazyAllocationCount = 0;
+}
+
+VkImage RenderGraphResources::GetImage(RenderGraphResource resource) const
+{
+    const RenderGraphImage& image = mGraph->GetImage(resource);
+    return image.imported ? image.image : mTransients[resource].image;
+}
+
+VkImageView RenderGraphResources::GetImageView(RenderGraphResource resource) const
+{
+    const RenderGraphImage& image = mGraph->GetImage(resource);
+    return image.imported ? image.view : mTransients[resource].view;
+}
+
+void RenderGraphResources::Execute(const RenderGraph& graph, VkCommandBuffer commandBuffer)
+{
+    MT_PROFILE_FUNCTION();
+
+    if(!graph.IsCompiled())
+    {
+        throw std::runtime_error("Render graphs have to be compiled before they're executed!");
+    }
+
+    Realize(graph);
+    mGraph = &graph;
+
+    for(const RenderGraphStep& step : graph.GetSteps())
+    {
+        const RenderGraphPass& pass = graph.GetPasses()[step.pass];
+
+        RecordBarriers(graph, step, commandBuffer);
+
+        if(!pass.IsRaster())
+        {
+            if(pass.GetExecute())
+            {
+                pass.GetExecute()(commandBuffer, *this);
+            }
+            continue;
+        }
+
+        if(mLogicalDevice.SupportsDynamicRendering())
+        {
+            BeginRendering(step, commandBuffer);
+        }
+        else {
+            BeginRenderPass(graph, step, commandBuffer);
+        }
+
+        // Pipelines leave viewport and scissor dynamic (see PipelineCache).
+        VkViewport viewport{};
+        viewport.x = 0.0f;
+        viewport.y = 0.0f;
+        viewport.width = static_cast<float>(step.extent.width);
+        viewport.height = static_cast<float>(step.extent.height);
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        VkRect2D scissor{{0, 0}, step.extent};
+
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+        if(pass.GetExecute())
+        {
+            pass.GetExecute()(commandBuffer, *this);
+        }
+
+        if(mLogicalDevice.SupportsDynamicRendering())
+        {
+            mLogicalDevice.CmdEndRendering(commandBuffer);
+        }
+        else {
+            vkCmdEndRenderPass(commandBuffer);
+        }
+    }
+
+    RecordBarriers(graph, graph.GetFinalBarriers(), commandBuffer);
+
+    mGraph = nullptr;
+}
+
+void RenderGraphResources::BeginRenderPass(const RenderGraph& graph, const RenderGraphStep& step, VkCommandBuffer commandBuffer)
+{
+    VkRenderPass renderPass = GetRenderPass(graph, step);
+
+    std::vector<VkClearValue> clearValues{};
+    for(const RenderGraphAttachment& attachment : step.colorAttachments)
+    {
+        clearValues.push_back(attachment.clearValue);
+    }
+    if(step.hasDepthAttachment)
+    {
+        clearValues.push_back(step.depthAttachment.clearValue);
+    }
+
+    VkRenderPassBeginInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassInfo.renderPass = renderPass;
+    renderPassInfo.framebuffer = GetFramebuffer(renderPass, step);
+    renderPassInfo.renderArea.offset = {0, 0};
+    renderPassInfo.renderArea.extent = step.extent;
+    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+    renderPassInfo.pClearValues = clearValues.data();
+
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+}
+
+void RenderGraphResources::BeginRendering(const RenderGraphStep& step, VkCommandBuffer commandBuffer)
+{
+    // The graph's barriers already put every attachment in its layout, same as with render passes.
+    auto toAttachmentInfo = [this](const RenderGraphAttachment& attachment)
+    {
+        VkRenderingAttachmentInfoKHR info{};
+        info.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+        info.imageView = GetImageView(attachment.resource);
+        info.imageLayout = attachment.layout;
+        info.resolveMode = VK_RESOLVE_MODE_NONE;
+        info.loadOp = attachment.loadOp;
+        info.storeOp = attachment.storeOp;
+        info.clearValue = attachment.clearValue;
+        return info;
+    };
+
+    std::vector<VkRenderingAttachmentInfoKHR> colorAttachments{};
+    for(const RenderGraphAttachment& attachment : step.colorAttachments)
+    {
+        colorAttachments.push_back(toAttachmentInfo(attachment));
+    }
+
+    VkRenderingAttachmentInfoKHR depthAttachment{};
+    if(step.hasDepthAttachment)
+    {
+        depthAttachment = toAttachmentInfo(step.depthAttachment);
+    }
+
+    VkRenderingInfoKHR renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+    renderingInfo.renderArea.offset = {0, 0};
+    renderingInfo.renderArea.extent = step.extent;
+    renderingInfo.layerCount = 1;
+    renderingInfo.colorAttachmentCount = static_cast<uint32_t>(colorAttachments.size());
+    renderingInfo.pColorAttachments = colorAttachments.data();
+    renderingInfo.pDepthAttachment = step.hasDepthAttachment ? &depthAttachment : nullptr;
+
+    mLogicalDevice.CmdBeginRendering(commandBuffer, renderingInfo);
+}
+
+void RenderGraphResources::Realize(const RenderGraph& graph)
+{
+    const std::vector<RenderGraphImage>& images = graph.GetImages();
+
+    Key key{};
+    key.reserve(images.size() * 7);
+    for(const RenderGraphImage& image : images)
+    {
+        // Imported and culled images don't need anything from us.
+        if(image.imported || image.aliasSlot == ~0u)
+        {
+            key.push_back(~0u);
+            continue;
+        }
+
+        key.push_back(image.desc.format);
+        key.push_back(image.desc.width);
+        key.push_back(image.desc.height);
+        key.push_back(image.desc.samples);
+        key.push_back(image.usage);
+        key.push_back(image.aliasSlot);
+        key.push_back(image.memoryless);
+    }
+
+    if(key == mTransientKey)
+    {
+        return;
+    }
+
+    MT_PROFILE_SCOPE("RenderGraphResources::Realize");
+
+    // Only happens when the graph changes shape (e.g. a resize), the previous frames may still be
+    // using the old images.
+    vkDeviceWaitIdle(mLogicalDevice.GetDevice());
+    DestroyTransients();
+
+    VkDevice device = mLogicalDevice.GetDevice();
+    mTransients.resize(images.size());
+
+    std::vector<VkMemoryRequirements> requirements(images.size());
+
+    for(size_t i = 0; i < images.size(); i++)
+    {
+        const RenderGraphImage& image = images[i];
+        if(image.imported || image.aliasSlot == ~0u)
+        {
+            continue;
+        }
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent.width = image.desc.width;
+        imageInfo.extent.height = image.desc.height;
+        imageInfo.extent.depth = 1;
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = image.desc.format;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = image.usage;
+        if(image.memoryless)
+        {
+            imageInfo.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        }
+        imageInfo.samples = image.desc.samples;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.flags = 0;
+
+        if(vkCreateImage(device, &imageInfo, nullptr, &mTransients[i].image) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create the render graph image " + image.name + "!");
+        }
+
+        vkGetImageMemoryRequirements(device, mTransients[i].image, &requirements[i]);
+        mTransientCount++;
+    }
+
+    // Everything in an alias slot shares one allocation, as big as its biggest image. An image
+    // that can't live in the same memory type as the rest of its slot gets its own, and so does a
+    // memoryless one when there's lazily allocated memory for it, which tilers may never back at all.
+    for(uint32_t slot = 0; slot < graph.GetAliasSlotCount(); slot++)
+    {
+        std::vector<size_t> shared{};
+        std::vector<size_t> dedicated{};
+        std::vector<size_t> lazy{};
+        uint32_t typeBits = ~0u;
+        VkDeviceSize size = 0;
+
+        for(size_t i = 0; i < images.size(); i++)
+        {
+            if(images[i].imported || images[i].aliasSlot != slot)
+            {
+                continue;
+            }
+
+            if(images[i].memoryless && mLogicalDevice.HasMemoryType(requirements[i].memoryTypeBits, VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT))
+            {
+                lazy.push_back(i);
+                continue;
+            }
+
+            if((typeBits & requirements[i].memoryTypeBits) == 0)
+            {
+                dedicated.push_back(i);
+                continue;
+            }
+
+            typeBits &= requirements[i].memoryTypeBits;
+            size = std::max(size, requirements[i].size);
+            shared.push_back(i);
+        }
+
+        auto allocate = [&](VkDeviceSize allocationSize, uint32_t memoryTypeBits, VkMemoryPropertyFlags properties, const std::vector<size_t>& users)
+        {
+            VkMemoryAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            allocInfo.allocationSize = allocationSize;
+            allocInfo.memoryTypeIndex = mLogicalDevice.FindMemoryType(memoryTypeBits, properties);
+
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            if(vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+            {
+                throw std::runtime_error("Failed to allocate render graph memory!");
+            }
+
+            for(size_t user : users)
+            {
+                vkBindImageMemory(device, mTransients[user].image, memory, 0);
+            }
+
+            mMemory.push_back(memory);
+        };
+
+        if(!shared.empty())
+        {
+            allocate(size, typeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, shared);
+            mAllocatedBytes += size;
+        }
+        for(size_t i : dedicated)
+        {
+            allocate(requirements[i].size, requirements[i].memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, {i});
+            mAllocatedBytes += requirements[i].size;
+        }
+        // Not counted in the allocated bytes, the driver only commits memory to these if it has to.
+        for(size_t i : lazy)
+        {
+            allocate(requirements[i].size, requirements[i].memoryTypeBits, VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, {i});
+            mLazyAllocationCount++;
+        }
+    }
+
+    for(size_t i = 0; i < images.size(); i++)
+    {
+        if(mTransients[i].image == VK_NULL_HANDLE)
+        {
+            continue;
+        }
+
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = mTransients[i].image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = images[i].desc.format;
+        viewInfo.subresourceRange.aspectMask = GetAspectMask(images[i].desc.format);
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = 1;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        if(vkCreateImageView(device, &viewInfo, nullptr, &mTransients[i].view) != VK_SUCCESS)
+        {
+            throw std::runtime_error("Failed to create the render graph image view " + images[i].name + "!");
+        }
+    }
+
+    mTransientKey = std::move(key);
+
+    MT_LOG_INFO("Render graph: {} transient images in {} allocations ({} KB, {} lazily allocated)", mTransientCount, mMemory.size(), mAllocatedBytes / 1024, mLazyAllocationCount);
+}
+
+VkRenderPass RenderGraphResources::GetRenderPass(const RenderGraph& graph, const RenderGraphStep& step)
+{
+    std::vector<VkAttachmentDescription> descriptions{};
+    for(const RenderGraphAttachment& attachment : step.colorAttachments)
+    {
+        descriptions.push_back(MakeAttachmentDescription(graph.GetImage(attachment.resource), attachment));
+    }
+    if(step.hasDepthAttachment)
+    {
+        descriptions.push_back(MakeAttachmentDescription(graph.GetImage(step.depthAttachment.resource), step.depthAttachment));
+    }
+
+    Key key{};
+    key.push_back(static_cast<uint32_t>(step.colorAttachments.size()));
+    key.push_back(step.hasDepthAttachment);
+    for(const VkAttachmentDescription& description : descriptions)
+    {
+        key.push_back(description.format);
+        key.push_back(description.samples);
+        key.push_back(description.loadOp);
+        key.push_back(description.storeOp);
+        key.push_back(description.initialLayout);
+    }
+
+    auto existing = mRenderPasses.find(key);
+    if(existing != mRenderPasses.end())
+    {
+        return existing->second;
+    }
+
+    std::vector<VkAttachmentReference> colorReferences{};
+    for(uint32_t i = 0; i < step.colorAttachments.size(); i++)
+    {
+        colorReferences.push_back(VkAttachmentReference{i, step.colorAttachments[i].layout});
+    }
+
+    VkAttachmentReference depthReference{};
+    depthReference.attachment = static_cast<uint32_t>(step.colorAttachments.size());
+    depthReference.layout = step.depthAttachment.layout;
+
+    VkSubpassDescription subpass{};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = static_cast<uint32_t>(colorReferences.size());
+    subpass.pColorAttachments = colorReferences.data();
+    subpass.pDepthStencilAttachment = step.hasDepthAttachment ? &depthReference : nullptr;
+
+    // No dependencies, the barrier in front of the pass already covers them.
+    VkRenderPassCreateInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassInfo.attachmentCount = static_cast<uint32_t>(descriptions.size());
+    renderPassInfo.pAttachments = descriptions.data();
+    renderPassInfo.subpassCount = 1;
+    renderPassInfo.pSubpasses = &subpass;
+    renderPassInfo.dependencyCount = 0;
+    renderPassInfo.pDependencies = nullptr;
+
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    if(vkCreateRenderPass(mLogicalDevice.GetDevice(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create render pass!");
+    }
+
+    mRenderPasses.emplace(std::move(key), renderPass);
+    return renderPass;
+}
+
+VkFramebuffer RenderGraphResources::GetFramebuffer(VkRenderPass renderPass, const RenderGraphStep& step)
+{
+    std::vector<VkImageView> views{};
+    for(const RenderGraphAttachment& attachment : step.colorAttachments)
+    {
+        views.push_back(GetImageView(attachment.resource));
+    }
+    if(step.hasDepthAttachment)
+    {
+        views.push_back(GetImageView(step.depthAttachment.resource));
+    }
+
+    Key key{};
+    AppendHandle(key, renderPass);
+    for(VkImageView view : views)
+    {
+        AppendHandle(key, view);
+    }
+    key.push_back(step.extent.width);
+    key.push_back(step.extent.height);
+
+    auto existing = mFramebuffers.find(key);
+    if(existing != mFramebuffers.end())
+    {
+        return existing->second;
+    }
+
+    VkFramebufferCreateInfo framebufferInfo{};
+    framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferInfo.renderPass = renderPass;
+    framebufferInfo.attachmentCount = static_cast<uint32_t>(views.size());
+    framebufferInfo.pAttachments = views.data();
+    framebufferInfo.width = step.extent.width;
+    framebufferInfo.height = step.extent.height;
+    framebufferInfo.layers = 1;
+
+    VkFramebuffer framebuffer = VK_NULL_HANDLE;
+    if(vkCreateFramebuffer(mLogicalDevice.GetDevice(), &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create framebuffer!");
+    }
+
+    mFramebuffers.emplace(std::move(key), framebuffer);
+    return framebuffer;
+}
+
+void RenderGraphResources::RecordBarriers(const RenderGraph& graph, const RenderGraphStep& step, VkCommandBuffer commandBuffer)
+{
+    if(step.barriers.empty())
+    {
+        return;
+    }
+
+    std::vector<VkImageMemoryBarrier> barriers{};
+    barriers.reserve(step.barriers.size());
+
+    for(const RenderGraphBarrier& graphBarrier : step.barriers)
+    {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = graphBarrier.srcAccess;
+        barrier.dstAccessMask = graphBarrier.dstAccess;
+        barrier.oldLayout = graphBarrier.oldLayout;
+        barrier.newLayout = graphBarrier.newLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = GetImage(graphBarrier.resource);
+        barrier.subresourceRange.aspectMask = GetAspectMask(graph.GetImage(graphBarrier.resource).desc.format);
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = 1;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount = 1;
+
+        barriers.push_back(barrier);
+    }
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        step.srcStages,
+        step.dstStages,
+        0,
+        0, nullptr,
+        0, nullptr,
+        static_cast<uint32_t>(barriers.size()), barriers.data()
+    );
+}
+
+}
@@ -0,0 +1,94 @@
+#ifndef MAMMOTH_2D_RENDER_GRAPH_RESOURCES_HPP
+#define MAMMOTH_2D_RENDER_GRAPH_RESOURCES_HPP
+
+#include "RenderGraph.hpp"
+#include "Graphics/Devices/LogicalDevice.hpp"
+#include "Hashing.hpp"
+
+#include <unordered_map>
+#include <vector>
+
+namespace mt
+{
+
+/**
+ * @brief Everything a compiled RenderGraph needs on the GPU: its transient images (aliased
+ * through shared memory, one allocation per alias slot, memoryless ones in lazily allocated
+ * memory where there is some), and a render pass and framebuffer for
+ * each raster pass unless the device supports dynamic rendering, which needs neither. Objects are cached across frames and only recreated when the graph's shape
+ * changes, which waits for the device to go idle. Transient images are shared by every frame in
+ * flight, the barriers in front of their first use order them against the previous frame.
+*/
+class RenderGraphResources
+{
+public:
+    RenderGraphResources(LogicalDevice& logicalDevice);
+    ~RenderGraphResources();
+
+    RenderGraphResources(const RenderGraphResources& other) = delete;
+    RenderGraphResources& operator=(const RenderGraphResources& other) = delete;
+
+    /**
+     * @brief Records the graph into commandBuffer: each step's barriers, then its pass, inside a
+     * render pass (or vkCmdBeginRenderingKHR()) if it has attachments. The graph has to be compiled.
+    */
+    void Execute(const RenderGraph& graph, VkCommandBuffer commandBuffer);
+
+    /**
+     * @brief For passes to look up the images they use, only valid while executing.
+    */
+    VkImage GetImage(RenderGraphResource resource) const;
+    VkImageView GetImageView(RenderGraphResource resource) const;
+
+    /**
+     * @brief Destroys every cached object. Framebuffers hold on to imported views, so call it
+     * whenever those are destroyed (e.g. the swap chain is recreated), once the device is idle.
+    */
+    void Clear();
+
+    inline size_t GetTransientImageCount() const { return mTransientCount; }
+    inline size_t GetMemoryBlockCount() const { return mMemory.size(); }
+    inline VkDeviceSize GetAllocatedBytes() const { return mAllocatedBytes; }
+    inline size_t GetLazyAllocationCount() const { return mLazyAllocationCount; }
+    inline size_t GetRenderPassCount() const { return mRenderPasses.size(); }
+
+private:
+    using Key = std::vector<uint32_t>;
+
+    using KeyHash = WordKeyHash;
+
+    struct TransientImage
+    {
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView view = VK_NULL_HANDLE;
+    };
+
+    void Realize(const RenderGraph& graph);
+    void DestroyTransients();
+
+    void BeginRenderPass(const RenderGraph& graph, const RenderGraphStep& step, VkCommandBuffer commandBuffer);
+    void BeginRendering(const RenderGraphStep& step, VkCommandBuffer commandBuffer);
+
+    VkRenderPass GetRenderPass(const RenderGraph& graph, const RenderGraphStep& step);
+    VkFramebuffer GetFramebuffer(VkRenderPass renderPass, const RenderGraphStep& step);
+
+    void RecordBarriers(const RenderGraph& graph, const RenderGraphStep& step, VkCommandBuffer commandBuffer);
+
+    LogicalDevice& mLogicalDevice;
+    const RenderGraph* mGraph = nullptr;
+
+    // The transients' descs and alias slots when they were created, by resource.
+    Key mTransientKey{};
+    std::vector<TransientImage> mTransients{};
+    size_t mTransientCount = 0;
+
+    std::vector<VkDeviceMemory> mMemory{};
+    VkDeviceSize mAllocatedBytes = 0;
+    size_t mLazyAllocationCount = 0;
+
+    std::unordered_map<Key, VkRenderPass, KeyHash> mRenderPasses{};
+    std::unordered_map<Key, VkFramebuffer, KeyHash> mFramebuffers{};
+};
+}
+
+#endif
@@ -0,0 +1,340 @@
+#include "RenderQueue.hpp"
+#include "Profiler/Profiler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace mt
+{
+
+// Helper Functions.
+//---
+namespace
+{
+    constexpr uint32_t PIPELINE_BITS = 12;
+    constexpr uint32_t MATERIAL_BITS = 19;
+    constexpr uint32_t DEPTH_BITS = 24;
+    constexpr uint64_t MAX_DEPTH = (1ull << DEPTH_BITS) - 1;
+
+    constexpr uint32_t RADIX_BITS = 8;
+    constexpr uint32_t RADIX_SIZE = 1u << RADIX_BITS;
+    constexpr uint32_t RADIX_PASSES = 64 / RADIX_BITS;
+
+    // Below this many entries per chunk, scheduling jobs costs more than the sort itself.
+    constexpr size_t SORT_CHUNK_SIZE = 16384;
+
+    using Histogram = std::array<uint32_t, RADIX_SIZE>;
+
+    inline uint32_t Digit(uint64_t key, uint32_t pass)
+    {
+        return static_cast<uint32_t>(key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1);
+    }
+
+    uint64_t QuantizeDepth(float depth)
+    {
+        // Also catches NaN.
+        if(!(depth > 0.0f))
+        {
+            return 0;
+        }
+        if(depth >= 1.0f)
+        {
+            return MAX_DEPTH;
+        }
+        return static_cast<uint64_t>(static_cast<double>(depth) * MAX_DEPTH + 0.5);
+    }
+
+    // Runs function(chunk) for every chunk, in parallel when there's a job system.
+    template<class F>
+    void ForEachChunk(JobSystem* jobSystem, size_t chunkCount, F&& function)
+    {
+        if(jobSystem && chunkCount > 1)
+        {
+            jobSystem->ParallelFor(0, chunkCount, 1, [&function](size_t begin, size_t end)
+            {
+                for(size_t chunk = begin; chunk < end; chunk++)
+                {
+                    function(chunk);
+                }
+            });
+            return;
+        }
+
+        for(size_t chunk = 0; chunk < chunkCount; chunk++)
+        {
+            function(chunk);
+        }
+    }
+}
+//---
+
+uint64_t MakeRenderKey(const RenderSubmission& submission)
+{
+    if(submission.pipeline >= RenderQueue::MAX_PIPELINES)
+    {
+        throw std::runtime_error("Render queue pipeline id " + std::to_string(submission.pipeline) + " is out of range!");
+    }
+    if(submission.material >= RenderQueue::MAX_MATERIALS)
+    {
+        throw std::runtime_error("Render queue material id " + std::to_string(submission.material) + " is out of range!");
+    }
+
+    uint64_t state = (static_cast<uint64_t>(submission.pipeline) << MATERIAL_BITS) | submission.material;
+    uint64_t depth = QuantizeDepth(submission.depth);
+
+    uint64_t key = static_cast<uint64_t>(submission.layer) << 56;
+
+    if(submission.translucent)
+    {
+        key |= 1ull << 55;
+        key |= (MAX_DEPTH - depth) << (PIPELINE_BITS + MATERIAL_BITS);
+        key |= state;
+    }
+    else {
+        key |= state << DEPTH_BITS;
+        key |= depth;
+    }
+
+    return key;
+}
+
+void RenderQueue::Submit(const RenderSubmission& submission)
+{
+    mEntries.push_back(Entry{MakeRenderKey(submission), static_cast<uint32_t>(mSubmissions.size())});
+    mSubmissions.push_back(submission);
+    mSorted = false;
+}
+
+void RenderQueue::Append(RenderQueue& other)
+{
+    uint32_t offset = static_cast<uint32_t>(mSubmissions.size());
+
+    mSubmissions.insert(mSubmissions.end(), other.mSubmissions.begin(), other.mSubmissions.end());
+    for(const Entry& entry : other.mEntries)
+    {
+        mEntries.push_back(Entry{entry.key, entry.submission + offset});
+    }
+    mSorted = false;
+
+    other.Clear();
+}
+
+void RenderQueue::Sort(JobSystem* jobSystem)
+{
+    MT_PROFILE_FUNCTION();
+
+    mStats = RenderQueueStats{};
+
+    // Nothing to histogram, and no jobs worth scheduling for it.
+    if(mEntries.empty())
+    {
+        mSorted = true;
+        return;
+    }
+
+    size_t count = mEntries.size();
+    size_t chunkCount = 1;
+    if(jobSystem)
+    {
+        chunkCount = std::max<size_t>(1, std::min<size_t>(jobSystem->GetThreadCount(), count / SORT_CHUNK_SIZE));
+    }
+    size_t chunkSize = (count + chunkCount - 1) / std::max<size_t>(chunkCount, 1);
+
+    // Every digit's histogram, per chunk, in a single read of the keys. Summed up they tell which
+    // passes can be skipped, and they're what the first pass that isn't skipped scatters with.
+    std::vector<std::array<Histogram, RADIX_PASSES>> histograms(chunkCount);
+
+    ForEachChunk(jobSystem, chunkCount, [&](size_t chunk)
+    {
+        auto& histogram = histograms[chunk];
+        for(auto& digits : histogram)
+        {
+            digits.fill(0);
+        }
+
+        size_t end = std::min(count, (chunk + 1) * chunkSize);
+        for(size_t i = chunk * chunkSize; i < end; i++)
+        {
+            for(uint32_t pass = 0; pass < RADIX_PASSES; pass++)
+            {
+                histogram[pass][Digit(mEntries[i].key, pass)]++;
+            }
+        }
+    });
+
+    mScratch.resize(count);
+    std::vector<Entry>* source = &mEntries;
+    std::vector<Entry>* destination = &mScratch;
+    bool reordered = false;
+
+    std::vector<Histogram> offsets(chunkCount);
+
+    for(uint32_t pass = 0; pass < RADIX_PASSES && count > 1; pass++)
+    {
+        // Every key has the same digit, so this pass wouldn't move anything.
+        uint32_t firstDigit = Digit((*source)[0].key, pass);
+        uint32_t total = 0;
+        for(size_t chunk = 0; chunk < chunkCount; chunk++)
+        {
+            total += histograms[chunk][pass][firstDigit];
+        }
+        if(total == count)
+        {
+            continue;
+        }
+
+        // Chunks' histograms only hold for the order they were counted in.
+        if(reordered)
+        {
+            ForEachChunk(jobSystem, chunkCount, [&](size_t chunk)
+            {
+                Histogram& histogram = histograms[chunk][pass];
+                histogram.fill(0);
+
+                size_t end = std::min(count, (chunk + 1) * chunkSize);
+                for(size_t i = chunk * chunkSize; i < end; i++)
+                {
+                    histogram[Digit((*source)[i].key, pass)]++;
+                }
+            });
+        }
+
+        // Digit by digit, then chunk by chunk, which keeps the sort stable.
+        uint32_t offset = 0;
+        for(uint32_t digit = 0; digit < RADIX_SIZE; digit++)
+        {
+            for(size_t chunk = 0; chunk < chunkCount; chunk++)
+            {
+                offsets[chunk][digit] = offset;
+                offset += histograms[chunk][pass][digit];
+            }
+        }
+
+        ForEachChunk(jobSystem, chunkCount, [&](size_t chunk)
+        {
+            Histogram& chunkOffsets = offsets[chunk];
+
+            size_t end = std::min(count, (chunk + 1) * chunkSize);
+            for(size_t i = chunk * chunkSize; i < end; i++)
+            {
+                const Entry& entry = (*source)[i];
+                (*destination)[chunkOffsets[Digit(entry.key, pass)]++] = entry;
+            }
+        });
+
+        std::swap(source, destination);
+        reordered = true;
+        mStats.sortPasses++;
+    }
+
+    if(source != &mEntries)
+    {
+        std::swap(mEntries, mScratch);
+    }
+
+    mSorted = true;
+}
+
+void RenderQueue::Execute(const RenderQueueCommands& commands)
+{
+    MT_PROFILE_FUNCTION();
+
+    if(!mSorted)
+    {
+        throw std::runtime_error("Render queue has to be sorted before it's executed!");
+    }
+
+    mStats.submissions = static_cast<uint32_t>(mSubmissions.size());
+
+    uint32_t pipeline = ~0u;
+    uint32_t material = ~0u;
+    bool pipelineReady = false;
+
+    RenderDraw pending{};
+    bool hasPending = false;
+
+    auto flush = [&]()
+    {
+        if(hasPending)
+        {
+            commands.draw(pending);
+            mStats.draws++;
+            hasPending = false;
+        }
+    };
+
+    for(const Entry& entry : mEntries)
+    {
+        const RenderSubmission& submission = mSubmissions[entry.submission];
+
+        if(submission.pipeline != pipeline)
+        {
+            flush();
+
+            pipeline = submission.pipeline;
+            pipelineReady = commands.bindPipeline(pipeline);
+            if(pipelineReady)
+            {
+                mStats.pipelineBinds++;
+            }
+
+            // Whatever was bound may not be compatible with the new pipeline's layout.
+            material = ~0u;
+        }
+
+        if(!pipelineReady)
+        {
+            mStats.skipped++;
+            continue;
+        }
+
+        if(submission.material != material)
+        {
+            flush();
+
+            material = submission.material;
+            commands.bindMaterial(pipeline, material);
+            mStats.materialBinds++;
+        }
+
+        // Consecutive instances of the same mesh become one instanced draw.
+        const RenderDraw& draw = submission.draw;
+        if(hasPending &&
+            pending.indirect == 0 && draw.indirect == 0 &&
+            pending.vertexCount == draw.vertexCount &&
+            pending.firstVertex == draw.firstVertex &&
+            pending.firstInstance + pending.instanceCount == draw.firstInstance)
+        {
+            pending.instanceCount += draw.instanceCount;
+            continue;
+        }
+
+        flush();
+        pending = draw;
+        hasPending = true;
+    }
+
+    flush();
+}
+
+void RenderQueue::Clear()
+{
+    mSubmissions.clear();
+    mEntries.clear();
+    mSorted = false;
+}
+
+std::vector<RenderSubmission> RenderQueue::GetSortedSubmissions() const
+{
+    std::vector<RenderSubmission> submissions{};
+    submissions.reserve(mEntries.size());
+    for(const Entry& entry : mEntries)
+    {
+        submissions.push_back(mSubmissions[entry.submission]);
+    }
+    return submissions;
+}
+
+}
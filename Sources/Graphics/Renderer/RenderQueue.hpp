@@ -0,0 +1,151 @@
+#ifndef MAMMOTH_2D_RENDER_QUEUE_HPP
+#define MAMMOTH_2D_RENDER_QUEUE_HPP
+
+#include "Jobs/JobSystem.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace mt
+{
+
+/**
+ * @brief The parameters of one vkCmdDraw().
+*/
+struct RenderDraw
+{
+    uint32_t vertexCount = 6;
+    uint32_t instanceCount = 1;
+    uint32_t firstVertex = 0;
+    uint32_t firstInstance = 0;
+
+    // Non-zero for draws the fields above don't describe (e.g. Sprite2DSystem's, whose instance
+    // count cull.comp writes), which are recorded by whatever was registered under this id (see
+    // Renderer::RegisterIndirectDraw()). They're never merged.
+    uint32_t indirect = 0;
+};
+
+/**
+ * @brief One draw submitted to a RenderQueue, and the state it needs bound. Pipelines and
+ * materials are ids the caller hands out (see Renderer::RegisterPipeline()).
+*/
+struct RenderSubmission
+{
+    uint8_t layer = 0;              // Lower layers draw first.
+    bool translucent = false;       // Drawn after every opaque draw of the same layer.
+    uint32_t pipeline = 0;
+    uint32_t material = 0;
+    float depth = 0.0f;             // 0 (near) to 1 (far), clamped.
+    RenderDraw draw{};
+};
+
+/**
+ * @brief Packs the submission into its 64-bit sort key, from the most significant bit:
+ *  layer (8) | translucent (1) | pipeline (12) | material (19) | depth (24)  when opaque,
+ *  layer (8) | translucent (1) | depth (24) | pipeline (12) | material (19)  when translucent.
+ * Opaque draws are grouped by state and drawn front to back within it. Translucent draws have to
+ * blend in order, so they're drawn back to front first and grouped by state second.
+ * Throws if the pipeline or material doesn't fit in its bits.
+*/
+uint64_t MakeRenderKey(const RenderSubmission& submission);
+
+/**
+ * @brief What sorting and executing a queue cost, reset by every Sort(). Draws count the vkCmdDraw()s
+ * and indirect draws issued, after consecutive submissions that continue each other's instances
+ * have been merged.
+*/
+struct RenderQueueStats
+{
+    uint32_t submissions = 0;
+    uint32_t draws = 0;
+    uint32_t pipelineBinds = 0;
+    uint32_t materialBinds = 0;
+    uint32_t skipped = 0;       // Submissions whose pipeline wasn't ready.
+    uint32_t sortPasses = 0;    // Radix passes that weren't skipped, out of 8.
+};
+
+/**
+ * @brief Records the actual commands while a RenderQueue is executed.
+*/
+struct RenderQueueCommands
+{
+    // Returns false if the pipeline can't be used yet (e.g. it's still building), which skips
+    // every draw that needs it.
+    std::function<bool(uint32_t pipeline)> bindPipeline{};
+    std::function<void(uint32_t pipeline, uint32_t material)> bindMaterial{};
+    std::function<void(const RenderDraw& draw)> draw{};
+};
+
+/**
+ * @brief Collects a frame's draws, in any order and from any system, then sorts them by their
+ * key (see MakeRenderKey()) so that draws sharing state end up next to each other. Executing walks the sorted
+ * draws and only binds a pipeline or material when it differs from the one that's bound.
+ *
+ * Submit() isn't thread safe, each thread should fill its own queue and Append() them.
+*/
+class RenderQueue
+{
+public:
+    RenderQueue() = default;
+
+    RenderQueue(const RenderQueue& other) = delete;
+    RenderQueue& operator=(const RenderQueue& other) = delete;
+
+    static constexpr uint32_t MAX_PIPELINES = 1u << 12;
+    static constexpr uint32_t MAX_MATERIALS = 1u << 19;
+
+    /**
+     * @brief Throws if the submission's key can't be made (see MakeRenderKey()).
+    */
+    void Submit(const RenderSubmission& submission);
+
+    /**
+     * @brief Moves every submission of other into this queue, leaving other empty.
+    */
+    void Append(RenderQueue& other);
+
+    /**
+     * @brief Sorts by key with an LSD radix sort, 8 bits at a time. Passes where every key has
+     * the same digit are skipped, e.g. the layer's when everything is on one layer. With a job system,
+     * large queues are histogrammed and scattered in parallel. Stable, so draws with the same key
+     * keep the order they were submitted in.
+    */
+    void Sort(JobSystem* jobSystem = nullptr);
+
+    /**
+     * @brief Walks the sorted queue. The queue has to be sorted first.
+    */
+    void Execute(const RenderQueueCommands& commands);
+
+    /**
+     * @brief Forgets every submission, keeping the memory (and the stats) for next frame.
+    */
+    void Clear();
+
+    inline size_t GetSize() const { return mSubmissions.size(); }
+    inline bool IsSorted() const { return mSorted; }
+    inline const RenderQueueStats& GetStats() const { return mStats; }
+
+    /**
+     * @return The submissions in sorted order, for debugging and tests.
+    */
+    std::vector<RenderSubmission> GetSortedSubmissions() const;
+
+private:
+    struct Entry
+    {
+        uint64_t key;
+        uint32_t submission;
+    };
+
+    std::vector<RenderSubmission> mSubmissions{};
+    std::vector<Entry> mEntries{};
+    std::vector<Entry> mScratch{};
+    bool mSorted = false;
+
+    RenderQueueStats mStats{};
+};
+}
+
+#endif
@@ -1,12 +1,21 @@
 #include "Renderer.hpp"
-#include <cassert>
+#include "Sprite2DSystem.hpp"
+#include "Graphics/Descriptors/DescriptorSet.hpp"
+#include "ResourceManager.hpp"
+#include "Logging.hpp"
+#include "Profiler/Profiler.hpp"
 
 namespace mt 
 {
-Renderer::Renderer(LogicalDevice& logicalDevice, Window& window) 
-    : mLogicalDevice{logicalDevice}, mWindow{window}
+Renderer::Renderer(Device& device, Window& window, JobSystem& jobSystem, const SwapChain& swapChain) 
+    : mLogicalDevice{device.GetLogicalDevice()}, mWindow{window}, mJobSystem{jobSystem}, mLayoutCache{mLogicalDevice}, mDescriptorAllocator{mLogicalDevice}, mPipelineCache{mLogicalDevice}, 
+    mPipelineBuildQueue{device, jobSystem, mLayoutCache, mPipelineCache}, mRenderGraphResources{mLogicalDevice}
 {
+    // Every system enqueues its pipelines first, so that they're all built at once. Frames are
+    // drawn without them until they're ready.
+    mSprites = std::make_unique<Sprite2DSystem>(device, mDescriptorAllocator, mPipelineBuildQueue, swapChain.GetRenderPass(), swapChain.GetRenderPassFormats());
 
+    mPipelineBuildQueue.Build();
 }
 
 Renderer::~Renderer() 
@@ -14,30 +23,33 @@ Renderer::~Renderer()
 
 }
 
-void Renderer::CreateDescriptorPool(uint32_t uniformCount, uint32_t imageCount) 
+void Renderer::Update(float deltaTime) 
 {
-    std::array<VkDescriptorPoolSize, 2> poolSizes{};
-    poolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    poolSizes[0].descriptorCount = imageCount;
-    poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    poolSizes[1].descriptorCount = uniformCount;
-
-    VkDescriptorPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = poolSizes.size();
-    poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = (uniformCount + imageCount) * 2;
-
-    if(vkCreateDescriptorPool(mLogicalDevice.GetDevice(), &poolInfo, nullptr, &mDescriptorPool) != VK_SUCCESS) 
+    mSprites->Animate(mJobSystem, deltaTime);
+}
+
+void Renderer::BeginFrame(uint32_t frameIndex) 
+{
+    mDescriptorAllocator.BeginFrame(frameIndex);
+    mPipelineBuildQueue.RetireReplaced();
+    mFrameIndex = frameIndex;
+}
+
+void Renderer::EnableShaderReload(ResourceManager& resources)
+{
+    resources.AddShaderReloadListener([this](const std::string& spirvPath)
     {
-        throw std::runtime_error("Failed to create descriptor pool");
-    }
+        size_t count = mPipelineBuildQueue.Rebuild(spirvPath);
+        if(count > 0)
+        {
+            MT_LOG_INFO("Rebuilding {} pipeline(s) using {}", count, spirvPath);
+            mPipelineBuildQueue.Build();
+        }
+    });
 }
 
 void Renderer::CreateDescriptorSet(VkDescriptorSet* descriptorSet, VkDescriptorType type, VkShaderStageFlags flags) 
 {
-    VkDescriptorSetLayout layout = nullptr;
-
     VkDescriptorSetLayoutBinding uboLayoutBinding{};
     uboLayoutBinding.binding = 0;
     uboLayoutBinding.descriptorType = type;
@@ -45,73 +57,137 @@ void Renderer::CreateDescriptorSet(VkDescriptorSet* descriptorSet, VkDescriptorT
     uboLayoutBinding.stageFlags = flags;
     uboLayoutBinding.pImmutableSamplers = nullptr;
 
-    VkDescriptorSetLayoutCreateInfo layoutInfo{};
-    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = 1;
-    layoutInfo.pBindings = &uboLayoutBinding;
+    // Every renderable with the same component shares one layout.
+    VkDescriptorSetLayout layout = mLayoutCache.GetSetLayout({uboLayoutBinding});
 
-    if(vkCreateDescriptorSetLayout(mLogicalDevice.GetDevice(), &layoutInfo, nullptr, &layout) != VK_SUCCESS) 
+    *descriptorSet = mDescriptorAllocator.Allocate(layout);
+}
+
+
+uint32_t Renderer::RegisterPipeline(const PipelineHandle& pipeline) 
+{
+    if(mPipelines.size() >= RenderQueue::MAX_PIPELINES) 
     {
-        throw std::runtime_error("Failed to create descriptor set layout!");
+        throw std::runtime_error("Too many pipelines registered with the renderer!");
     }
 
-    mDescriptorSetLayouts.push_back(layout);
-
-    VkDescriptorSetAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    allocInfo.descriptorPool = mDescriptorPool;
-    allocInfo.descriptorSetCount = 1;
-    allocInfo.pSetLayouts = &layout;
+    mPipelines.push_back(pipeline);
+    return static_cast<uint32_t>(mPipelines.size() - 1);
+}
 
-    if(vkAllocateDescriptorSets(mLogicalDevice.GetDevice(), &allocInfo, descriptorSet) != VK_SUCCESS) 
+uint32_t Renderer::RegisterMaterial(DescriptorSet* descriptorSet) 
+{
+    if(mMaterials.size() >= RenderQueue::MAX_MATERIALS) 
     {
-        throw std::runtime_error("Failed to allocate descriptor sets");
+        throw std::runtime_error("Too many materials registered with the renderer!");
     }
+
+    mMaterials.push_back(descriptorSet);
+    return static_cast<uint32_t>(mMaterials.size() - 1);
 }
 
+uint32_t Renderer::RegisterIndirectDraw(IndirectDraw draw) 
+{
+    // Zero means a plain vkCmdDraw().
+    mIndirectDraws.push_back(std::move(draw));
+    return static_cast<uint32_t>(mIndirectDraws.size());
+}
 
 void Renderer::Render(VkCommandBuffer commandBuffer) 
 {
+    MT_PROFILE_FUNCTION();
+
+    // Sorted even when empty, since that's what resets the stats of the last frame that drew.
+    mRenderQueue.Sort(&mJobSystem);
+
+    if(mRenderQueue.GetSize() == 0) 
+    {
+        return;
+    }
 
+    RenderQueueCommands commands{};
+    commands.bindPipeline = [this, commandBuffer](uint32_t pipeline) 
+    {
+        Pipeline* bound = mPipelines[pipeline].Get();
+        if(!bound) 
+        {
+            return false;
+        }
+        bound->Bind(commandBuffer);
+        return true;
+    };
+    commands.bindMaterial = [this, commandBuffer](uint32_t, uint32_t material) 
+    {
+        mMaterials[material]->Bind(commandBuffer);
+    };
+    commands.draw = [this, commandBuffer](const RenderDraw& draw) 
+    {
+        if(draw.indirect != 0) 
+        {
+            mIndirectDraws[draw.indirect - 1](commandBuffer, mFrameIndex);
+            return;
+        }
+        vkCmdDraw(commandBuffer, draw.vertexCount, draw.instanceCount, draw.firstVertex, draw.firstInstance);
+    };
+
+    mRenderQueue.Execute(commands);
+    mRenderQueue.Clear();
 }
 
-void Renderer::BeginRenderPass(VkCommandBuffer commandBuffer, std::unique_ptr<SwapChain>& swapChain, bool started, uint32_t currentImageIndex) 
+void Renderer::RenderFrame(VkCommandBuffer commandBuffer, const SwapChain& swapChain, uint32_t currentImageIndex) 
 {
-    assert(started && "Can't call beginSwapchainProgess() if frame is not in progress!");
-
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = swapChain->GetRenderPass();
-    renderPassInfo.framebuffer = swapChain->GetFrameBuffer(currentImageIndex);
-
-    renderPassInfo.renderArea.offset = {0, 0};
-    renderPassInfo.renderArea.extent = swapChain->GetSwapChainExtent();
-
-    std::array<VkClearValue, 2> clearValues{};
-    clearValues[0].color = {0.01, 0.01f, 0.01f, 1.0f};
-    clearValues[1].depthStencil = {1.0f, 0};
-    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-    renderPassInfo.pClearValues = clearValues.data();
-
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-    
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = static_cast<float>(swapChain->GetSwapChainExtent().width);
-    viewport.height = static_cast<float>(swapChain->GetSwapChainExtent().height);
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-    VkRect2D scissor{{0,0}, swapChain->GetSwapChainExtent()};
-    
-    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
-    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+    MT_PROFILE_FUNCTION();
+
+    VkExtent2D extent = swapChain.GetSwapChainExtent();
+
+    mRenderGraph.Reset();
+
+    RenderGraphImport present{};
+    present.finalLayout = swapChain.IsOffscreen() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+    RenderGraphResource backBuffer = mRenderGraph.ImportImage(
+        "BackBuffer",
+        RenderGraphImageDesc{swapChain.GetSwapChainImageFormat(), extent.width, extent.height},
+        swapChain.GetImage(currentImageIndex),
+        swapChain.GetImageView(currentImageIndex),
+        present
+    );
+
+    // Only touches buffers, which the graph doesn't track, so it's kept by its side effects and
+    // records its own barriers. Added first, since passes run in the order they're added.
+    mRenderGraph.AddPass("Cull")
+        .SetSideEffects()
+        .SetExecute([this](VkCommandBuffer commandBuffer, const RenderGraphResources&)
+        {
+            mSprites->Cull(commandBuffer, static_cast<int>(mFrameIndex));
+        });
+
+    // Compatible with the swap chain's render pass (or formats), which pipelines are created against.
+    RenderGraphPass& main = mRenderGraph.AddPass("Main")
+        .WriteColor(backBuffer, RenderGraphLoadOp::Clear, VkClearColorValue{{0.01f, 0.01f, 0.01f, 1.0f}})
+        .SetExecute([this](VkCommandBuffer commandBuffer, const RenderGraphResources&)
+        {
+            mSprites->Submit(*this, static_cast<int>(mFrameIndex));
+            Render(commandBuffer);
+        });
+
+    // Cleared and never stored, so it's memoryless where the device can do that (see RenderGraph).
+    if(swapChain.HasDepthBuffer()) 
+    {
+        RenderGraphResource depth = mRenderGraph.CreateImage(
+            "Depth",
+            RenderGraphImageDesc{swapChain.GetSwapChainDepthFormat(), extent.width, extent.height}
+        );
+        main.WriteDepth(depth, RenderGraphLoadOp::Clear);
+    }
+
+    mRenderGraph.Compile();
+    mRenderGraphResources.Execute(mRenderGraph, commandBuffer);
 }
 
-void Renderer::EndRenderPass(VkCommandBuffer commandBuffer) 
+void Renderer::OnSwapChainRecreated() 
 {
-    vkCmdEndRenderPass(commandBuffer);
+    mRenderGraphResources.Clear();
 }
 
-
 }
\ No newline at end of file
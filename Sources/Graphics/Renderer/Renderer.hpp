@@ -2,38 +2,128 @@
 #define MAMMOTH_2D_RENDERER_HPP
 
 #include "SwapChain.hpp"
-#include "Game.hpp"
+#include "Window.hpp"
+#include "Graphics/Descriptors/DescriptorLayoutCache.hpp"
+#include "Graphics/Descriptors/DescriptorAllocator.hpp"
+#include "Graphics/Pipelines/PipelineCache.hpp"
+#include "Graphics/Pipelines/PipelineBuildQueue.hpp"
+#include "RenderGraphResources.hpp"
+#include "RenderQueue.hpp"
 
 #include <glm/glm.hpp>
 
+#include <functional>
 #include <iostream>
+#include <memory>
 
 namespace mt 
 {
+
+class DescriptorSet;
+class ResourceManager;
+class Sprite2DSystem;
+
+/**
+ * @brief Records a draw that the render queue can't describe with a RenderDraw (e.g. one that
+ * pushes its own constants), with its pipeline and material already bound.
+*/
+typedef std::function<void(VkCommandBuffer commandBuffer, uint32_t frameIndex)> IndirectDraw;
+
 class Renderer 
 {
 public:
-    Renderer(LogicalDevice& logicalDevice, Window& window);
+    /**
+     * @brief Creates the render systems and starts building their pipelines.
+     * @param jobSystem Builds the pipelines and sorts the render queue.
+     * @param swapChain What the pipelines are created against.
+    */
+    Renderer(Device& device, Window& window, JobSystem& jobSystem, const SwapChain& swapChain);
     ~Renderer();
 
-    void BeginRenderPass(VkCommandBuffer commandBuffer, std::unique_ptr<SwapChain>& swapChain, bool started, uint32_t currentImageIndex);
-    
+    /**
+     * @brief Builds the frame's render graph around the swap chain image, compiles it and
+     * records it into commandBuffer: the sprites are culled in a compute pass, then drawn by Main.
+    */
+    void RenderFrame(VkCommandBuffer commandBuffer, const SwapChain& swapChain, uint32_t currentImageIndex);
+
+    /**
+     * @brief Sorts and draws everything submitted to the render queue this frame, then clears it.
+    */
     void Render(VkCommandBuffer commandBuffer);
-    
-    void EndRenderPass(VkCommandBuffer commandBuffer);
 
-    void CreateDescriptorPool(uint32_t uniformCount, uint32_t imageCount);
+    /**
+     * @brief Forgets every GPU object the render graph cached for the old swap chain's images.
+     * The device has to be idle.
+    */
+    void OnSwapChainRecreated();
+
+    /**
+     * @brief Development only: rebuilds every pipeline using a shader that resources hot reloads,
+     * swapping it in behind the same handle once it's ready. Needs hot reload enabled on resources.
+    */
+    void EnableShaderReload(ResourceManager& resources);
+
+    /**
+     * @brief Advances everything the render systems animate by deltaTime (in seconds), before
+     * the frame is rendered.
+    */
+    void Update(float deltaTime);
+
+    /**
+     * @brief Frees the transient descriptor sets of the frame in flight that's about to be
+     * recorded, and makes it the one the render systems record for. Pipelines replaced by
+     * rebuilds are retired here too.
+    */
+    void BeginFrame(uint32_t frameIndex);
 
     void CreateDescriptorSet(VkDescriptorSet* descriptorSet, VkDescriptorType type, VkShaderStageFlags flags);
 
+    /**
+     * @return The id render queue submissions refer to the pipeline by. Draws are skipped while
+     * it's still building.
+    */
+    uint32_t RegisterPipeline(const PipelineHandle& pipeline);
+
+    /**
+     * @return The id render queue submissions refer to the set by. It has to outlive the renderer.
+    */
+    uint32_t RegisterMaterial(DescriptorSet* descriptorSet);
+
+    /**
+     * @return The id submissions set RenderDraw::indirect to, to be drawn by draw instead of vkCmdDraw().
+    */
+    uint32_t RegisterIndirectDraw(IndirectDraw draw);
+
+    inline DescriptorLayoutCache& GetLayoutCache() { return mLayoutCache; }
+    inline DescriptorAllocator& GetDescriptorAllocator() { return mDescriptorAllocator; }
+    inline PipelineCache& GetPipelineCache() { return mPipelineCache; }
+    inline const RenderGraph& GetRenderGraph() const { return mRenderGraph; }
+    inline const RenderGraphResources& GetRenderGraphResources() const { return mRenderGraphResources; }
+    inline RenderQueue& GetRenderQueue() { return mRenderQueue; }
+    inline PipelineBuildQueue& GetPipelineBuildQueue() { return mPipelineBuildQueue; }
+    inline Sprite2DSystem& GetSprites() { return *mSprites; }
+
 private:
     LogicalDevice& mLogicalDevice;
     Window& mWindow;
+    JobSystem& mJobSystem;
+
+    DescriptorLayoutCache mLayoutCache;
+    DescriptorAllocator mDescriptorAllocator;
+    PipelineCache mPipelineCache;
+    PipelineBuildQueue mPipelineBuildQueue;
+
+    RenderGraph mRenderGraph{};
+    RenderGraphResources mRenderGraphResources;
 
-    VkDescriptorPool mDescriptorPool = VK_NULL_HANDLE;
-    uint32_t mMaxSets = SwapChain::FRAMES_IN_FLIGHT;
+    RenderQueue mRenderQueue{};
+    std::vector<PipelineHandle> mPipelines{};
+    std::vector<DescriptorSet*> mMaterials{};
+    std::vector<IndirectDraw> mIndirectDraws{};
 
-    std::vector<VkDescriptorSetLayout> mDescriptorSetLayouts{};
+    // Declared last, so that it's destroyed before everything it allocated from.
+    std::unique_ptr<Sprite2DSystem> mSprites{};
+    uint32_t mFrameIndex = 0;
 };
 }
 
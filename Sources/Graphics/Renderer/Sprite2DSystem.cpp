@@ -1,68 +1,60 @@
-#include "Graphics/Pipelines/VertexInput.hpp"
+#include "Sprite2DSystem.hpp"
+#include "Renderer.hpp"
+#include "Graphics/Buffers/BufferLayout.hpp"
 #include "Logging.hpp"
+#include "Profiler/Profiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
 
 namespace mt 
 {
-Sprite2DSystem::Sprite2DSystem(Device& device, VkRenderPass renderPass, uint32_t width, uint32_t height)
-    : RenderSystem(device, renderPass, width, height)
-{
-
-    // mImages.push_back(std::make_unique<Image>(mDevice, "Resources/Textures/Player.png"));
-    // mImages.push_back(std::make_unique<Image>(mDevice, "Resources/Textures/Box.png"));
-    // mImages.push_back(std::make_unique<Image>(mDevice, "Resources/Textures/Platform.png"));
-    // mImages.push_back(std::make_unique<Image>(mDevice, "Resources/Textures/Platform.png"));
-    // mImages.push_back(std::make_unique<Image>(mDevice, "Resources/Textures/Platform.png"));
-    // mImages.push_back(std::make_unique<Image>(mDevice, "Resources/Textures/Background.png"));
-
-    mPipelines = std::make_unique<std::unordered_map<std::string, Pipeline*>>();
-
-    std::vector<BufferAttribute> attribs = 
-    {
-        BufferAttribute(0, VK_FORMAT_R32G32_SFLOAT),
-        BufferAttribute(1, VK_FORMAT_R32G32_SFLOAT),
-    };
 
-    TexturePushConstant pushConstantData{};
-    BufferLayout bufferLayout = BufferLayout(attribs);
-    VertexInput vertexInput = VertexInput(bufferLayout);
-    Constant pushConstant = Constant(pushConstantData, sizeof(TexturePushConstant), 0, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
-
-    std::vector<Uniform> uniforms{6};
-    for(int i = 0; i < mImages.size(); i++) 
+// Helper Functions.
+//---
+namespace
+{
+    // Both sprite shaders declare a push block, but a shader that's been hot reloaded without one
+    // would otherwise be read out of bounds.
+    const VkPushConstantRange& GetPushConstantRange(const Pipeline& pipeline, const char* shaderName)
     {
-        uniforms.emplace_back(Uniform(i, sizeof(SimpleUniformBuffer), 0, VK_SHADER_STAGE_FRAGMENT_BIT));
+        const std::vector<VkPushConstantRange>& ranges = pipeline.GetShader()->GetReflection().pushConstants;
+        if(ranges.empty())
+        {
+            throw std::runtime_error(std::string(shaderName) + " has no push constants, Sprite2DSystem needs them!");
+        }
+        return ranges[0];
     }
+}
 
-    std::unique_ptr<Shader> shader = std::make_unique<Shader>(
-        mDevice,    
-        "Resources/Shaders/simple.vert.spv",
-        "Resources/Shaders/simple.frag.spv",
-        vertexInput,
-        pushConstant,
-        uniforms
-    );
-
+Sprite2DSystem::Sprite2DSystem(Device& device, DescriptorAllocator& descriptorAllocator, PipelineBuildQueue& buildQueue, VkRenderPass renderPass, const RenderPassFormats& formats)
+    : mDevice{device}, mDescriptorAllocator{descriptorAllocator}
+{
 
     // Pipeline
     //
-    // Memory is deleted in the destructor of the base RenderSystem class.
-    Pipeline* playerPipeline = new Pipeline(
-        device, 
-        renderPass,
-        width,
-        height,
-        std::move(shader),
-        VK_PIPELINE_BIND_POINT_GRAPHICS
-    );
+    // Built on the job system along with every other system's pipelines (see PipelineBuildQueue).
+    // The vertex format, push constants and samplers are all reflected from the SPIR-V.
+    PipelineRequest request{};
+    request.vertexShader = "Resources/Shaders/simple.vert.spv";
+    request.fragmentShader = "Resources/Shaders/simple.frag.spv";
+    request.renderPass = renderPass;
+    request.formats = formats;
+    request.bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
 
-    // At the moment, all pipelines are the same, since we're only rendering simple squares,
-    // but eventually this will change.
-    //
-    mPipelines->operator[]("playerPipeline") = playerPipeline;
+    mPipeline = buildQueue.Enqueue(request);
+
+    // Culls on the GPU before the sprites are drawn, see Cull().
+    PipelineRequest cullRequest{};
+    cullRequest.computeShader = "Resources/Shaders/cull.comp.spv";
+    cullRequest.bindPoint = VK_PIPELINE_BIND_POINT_COMPUTE;
 
-    mDescriptorHandler = std::make_unique<DescriptorHandler>(std::move(DescriptorSet(mDevice, playerPipeline)));
+    mCullPipeline = buildQueue.Enqueue(cullRequest);
 
     mDescriptorWriter = std::make_unique<DescriptorWriter>();
+    mCullDescriptorWriter = std::make_unique<DescriptorWriter>();
 
     // Create the vertex buffer which handled the entire creation and mapping of memory
     // (in this case an array of vertices) into a conveniant place in GPU VRAM.
@@ -77,56 +69,488 @@ Sprite2DSystem::Sprite2DSystem(Device& device, VkRenderPass renderPass, uint32_t
     vkBindBufferMemory(mDevice.GetDevice(), mVertexBuffer->GetBuffer(), mVertexBuffer->GetBufferMemory(), 0);
 
 
-    // Uniform image buffer
+    // Animation frames
+    //
+    // Sprites only upload the index of the frame they're on, the vertex shader looks up its UVs.
+    // Everything starts on frame 0 of an otherwise empty library, the whole texture.
+    VkDeviceSize instanceFramesSize = sizeof(uint32_t) * MAX_INSTANCES * SwapChain::FRAMES_IN_FLIGHT;
+    mInstanceFrames = std::make_unique<Buffer>(
+        mDevice, 
+        instanceFramesSize, 
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    );
+
+    vkBindBufferMemory(mDevice.GetDevice(), mInstanceFrames->GetBuffer(), mInstanceFrames->GetBufferMemory(), 0);
+
+    void* mapped = nullptr;
+    mInstanceFrames->MapMemory(&mapped);
+    mMappedInstanceFrames = static_cast<uint32_t*>(mapped);
+    std::memset(mMappedInstanceFrames, 0, static_cast<size_t>(instanceFramesSize));
+
+    mInstanceFramesInfo.buffer = mInstanceFrames->GetBuffer();
+    mInstanceFramesInfo.offset = 0;
+    mInstanceFramesInfo.range = VK_WHOLE_SIZE;
+
+
+    // Instances
     //
+    // Transforms and textures used to be pushed before every draw (132 bytes, over the 128 bytes
+    // Vulkan guarantees). Now they're only written when they change, and read by instance index.
+    VkDeviceSize instancesSize = sizeof(SpriteInstance) * MAX_INSTANCES * SwapChain::FRAMES_IN_FLIGHT;
+    mInstances = std::make_unique<Buffer>(
+        mDevice, 
+        instancesSize, 
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    );
+
+    vkBindBufferMemory(mDevice.GetDevice(), mInstances->GetBuffer(), mInstances->GetBufferMemory(), 0);
+
+    mapped = nullptr;
+    mInstances->MapMemory(&mapped);
+    mMappedInstances = static_cast<SpriteInstance*>(mapped);
+
+    mInstancesInfo.buffer = mInstances->GetBuffer();
+    mInstancesInfo.offset = 0;
+    mInstancesInfo.range = VK_WHOLE_SIZE;
+
+
+    // Camera
+    //
+    VkDeviceSize frameUniformsSize = sizeof(glm::mat4) * SwapChain::FRAMES_IN_FLIGHT;
+    mFrameUniforms = std::make_unique<Buffer>(
+        mDevice, 
+        frameUniformsSize, 
+        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    );
+
+    vkBindBufferMemory(mDevice.GetDevice(), mFrameUniforms->GetBuffer(), mFrameUniforms->GetBufferMemory(), 0);
+
+    mapped = nullptr;
+    mFrameUniforms->MapMemory(&mapped);
+    mMappedFrameUniforms = static_cast<glm::mat4*>(mapped);
+    for(int i = 0; i < SwapChain::FRAMES_IN_FLIGHT; i++)
+    {
+        mMappedFrameUniforms[i] = glm::mat4{1.0f};
+    }
+
+    mFrameUniformsInfo.buffer = mFrameUniforms->GetBuffer();
+    mFrameUniformsInfo.offset = 0;
+    mFrameUniformsInfo.range = VK_WHOLE_SIZE;
+
+
+    // Culling
+    //
+    // Visibility is decided on the GPU, which lists the visible instances and writes the indirect
+    // draw for them, so the CPU never walks the sprites.
+    static_assert(SwapChain::FRAMES_IN_FLIGHT == 2, "cull.comp and simple.vert have an array per frame in flight");
+    static_assert(CULL_MAX_GROUPS <= CULL_GROUP_SIZE, "cull.comp sums the counts of every earlier workgroup in one go");
+
+    mVisibleInstances = std::make_unique<Buffer>(
+        mDevice, 
+        sizeof(uint32_t) * MAX_INSTANCES * SwapChain::FRAMES_IN_FLIGHT, 
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+    );
+
+    vkBindBufferMemory(mDevice.GetDevice(), mVisibleInstances->GetBuffer(), mVisibleInstances->GetBufferMemory(), 0);
+
+    mDrawCommands = std::make_unique<Buffer>(
+        mDevice, 
+        (sizeof(VkDrawIndirectCommand) + sizeof(uint32_t)) * SwapChain::FRAMES_IN_FLIGHT, 
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+    );
+
+    vkBindBufferMemory(mDevice.GetDevice(), mDrawCommands->GetBuffer(), mDrawCommands->GetBufferMemory(), 0);
+
+    mGroupCounts = std::make_unique<Buffer>(
+        mDevice, 
+        sizeof(uint32_t) * CULL_MAX_GROUPS * SwapChain::FRAMES_IN_FLIGHT, 
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+    );
+
+    vkBindBufferMemory(mDevice.GetDevice(), mGroupCounts->GetBuffer(), mGroupCounts->GetBufferMemory(), 0);
+
+    mVisibleInstancesInfo.buffer = mVisibleInstances->GetBuffer();
+    mVisibleInstancesInfo.offset = 0;
+    mVisibleInstancesInfo.range = VK_WHOLE_SIZE;
+
+    mDrawCommandsInfo.buffer = mDrawCommands->GetBuffer();
+    mDrawCommandsInfo.offset = 0;
+    mDrawCommandsInfo.range = VK_WHOLE_SIZE;
+
+    mGroupCountsInfo.buffer = mGroupCounts->GetBuffer();
+    mGroupCountsInfo.offset = 0;
+    mGroupCountsInfo.range = VK_WHOLE_SIZE;
+
+    SetAnimationLibrary(SpriteAnimationLibrary{});
+}
+
+Sprite2DSystem::~Sprite2DSystem() 
+{
+    mInstanceFrames->UnMapMemory();
+    mInstances->UnMapMemory();
+    mFrameUniforms->UnMapMemory();
+}
+
+void Sprite2DSystem::SetAnimationLibrary(const SpriteAnimationLibrary& library) 
+{
+    const std::vector<glm::vec4>& frames = library.GetFrames();
+
+    mFrameTable = std::make_unique<Buffer>(
+        mDevice, 
+        frames.size() * sizeof(glm::vec4), 
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        frames.data()
+    );
+
+    vkBindBufferMemory(mDevice.GetDevice(), mFrameTable->GetBuffer(), mFrameTable->GetBufferMemory(), 0);
+
+    mFrameTableInfo.buffer = mFrameTable->GetBuffer();
+    mFrameTableInfo.offset = 0;
+    mFrameTableInfo.range = VK_WHOLE_SIZE;
+
+    // The clips the old animations refer to are gone, so they stop on their current frames.
+    mClips = library.GetClips();
+    mAnimations.clear();
+    mAnimatedFrames.clear();
+}
+
+void Sprite2DSystem::SetTextures(const ResourceManager& resources, const std::vector<ImageHandle>& textures) 
+{
+    if(textures.empty())
+    {
+        throw std::runtime_error("Sprites need at least one texture!");
+    }
+
+    if(textures.size() > TEXTURE_BINDINGS)
+    {
+        MT_LOG_WARN("Only the first {} of {} sprite textures will be bound!", TEXTURE_BINDINGS, textures.size());
+    }
+
     std::vector<VkDescriptorImageInfo> imageInfos{};
-    for(int i = 0; i < mImages.size(); i++) 
+    for(size_t i = 0; i < std::min<size_t>(textures.size(), TEXTURE_BINDINGS); i++)
     {
-        imageInfos.push_back(mImages[i]->GetUniformBuffer()->GetDescriptorImageInfo());
+        Image* image = resources.GetImage(textures[i]);
+        if(!image)
+        {
+            throw std::runtime_error("Sprite textures have to be resident before they're bound!");
+        }
+        imageInfos.push_back(image->GetDescriptorImageInfo());
     }
 
-    auto& descriptorSet = mDescriptorHandler->GetDescriptorSet();
+    // Every sampler simple.frag declares has to be valid, so the ones past the last texture
+    // repeat the first.
+    mImageInfos.assign(TEXTURE_BINDINGS, imageInfos[0]);
+    std::copy(imageInfos.begin(), imageInfos.end(), mImageInfos.begin());
+}
 
-    mDescriptorWriter->WriteToImage(imageInfos, descriptorSet);
+void Sprite2DSystem::MarkDirty(DirtyRange (&ranges)[SwapChain::FRAMES_IN_FLIGHT], uint32_t begin, uint32_t end) 
+{
+    for(DirtyRange& range : ranges)
+    {
+        if(range.begin == range.end)
+        {
+            range = DirtyRange{begin, end};
+        }
+        else {
+            range.begin = std::min(range.begin, begin);
+            range.end = std::max(range.end, end);
+        }
+    }
+}
+
+void Sprite2DSystem::SetInstanceCount(uint32_t count) 
+{
+    if(count > MAX_INSTANCES)
+    {
+        MT_LOG_WARN("Only the first {} of {} sprites will be drawn!", MAX_INSTANCES, count);
+        count = MAX_INSTANCES;
+    }
+
+    uint32_t previous = GetInstanceCount();
+    mInstanceData.resize(count);
+    mInstanceFrameData.resize(count, 0);
+
+    if(count > previous)
+    {
+        MarkDirty(mDirtyInstances, previous, count);
+        MarkDirty(mDirtyInstanceFrames, previous, count);
+    }
+}
+
+void Sprite2DSystem::SetInstance(uint32_t index, const SpriteInstance& instance) 
+{
+    if(index >= GetInstanceCount())
+    {
+        throw std::runtime_error("Sprite instance " + std::to_string(index) + " is out of range!");
+    }
+
+    mInstanceData[index] = instance;
+    MarkDirty(mDirtyInstances, index, index + 1);
+}
+
+void Sprite2DSystem::SetInstances(const SpriteInstance* instances, uint32_t count) 
+{
+    SetInstanceCount(count);
+    count = GetInstanceCount();
+
+    std::copy_n(instances, count, mInstanceData.begin());
+    MarkDirty(mDirtyInstances, 0, count);
+}
+
+void Sprite2DSystem::SetInstanceFrames(const uint32_t* frames, uint32_t count) 
+{
+    count = std::min(count, GetInstanceCount());
+
+    std::copy_n(frames, count, mInstanceFrameData.begin());
+    MarkDirty(mDirtyInstanceFrames, 0, count);
+}
+
+void Sprite2DSystem::SetAnimations(const SpriteAnimationComp* animations, uint32_t count) 
+{
+    for(uint32_t i = 0; i < count; i++)
+    {
+        if(animations[i].clip >= mClips.size())
+        {
+            throw std::runtime_error("Sprite " + std::to_string(i) + " plays clip " + std::to_string(animations[i].clip) + ", which isn't in the animation library!");
+        }
+    }
+
+    mAnimations.assign(animations, animations + count);
+    mAnimatedFrames.resize(count);
+}
+
+void Sprite2DSystem::Animate(JobSystem& jobSystem, float deltaTime) 
+{
+    MT_PROFILE_FUNCTION();
+
+    if(mAnimations.empty())
+    {
+        return;
+    }
+
+    AnimateSprites(jobSystem, mClips.data(), deltaTime, mAnimations.data(), mAnimatedFrames.data(), mAnimations.size());
+    SetInstanceFrames(mAnimatedFrames.data(), static_cast<uint32_t>(mAnimatedFrames.size()));
+}
+
+void Sprite2DSystem::SetCamera(const glm::mat4& viewProjectionMatrix) 
+{
+    mCamera = viewProjectionMatrix;
+}
+
+void Sprite2DSystem::Upload(int frameIndex) 
+{
+    uint32_t count = GetInstanceCount();
+
+    // Whatever was dropped since it was marked doesn't need uploading anymore.
+    DirtyRange& instances = mDirtyInstances[frameIndex];
+    instances.end = std::min(instances.end, count);
+    if(instances.begin < instances.end)
+    {
+        std::memcpy(
+            mMappedInstances + frameIndex * MAX_INSTANCES + instances.begin, 
+            mInstanceData.data() + instances.begin, 
+            (instances.end - instances.begin) * sizeof(SpriteInstance)
+        );
+    }
+    instances = DirtyRange{};
+
+    DirtyRange& frames = mDirtyInstanceFrames[frameIndex];
+    frames.end = std::min(frames.end, count);
+    if(frames.begin < frames.end)
+    {
+        std::memcpy(
+            mMappedInstanceFrames + frameIndex * MAX_INSTANCES + frames.begin, 
+            mInstanceFrameData.data() + frames.begin, 
+            (frames.end - frames.begin) * sizeof(uint32_t)
+        );
+    }
+    frames = DirtyRange{};
+
+    mMappedFrameUniforms[frameIndex] = mCamera;
+    mInstanceCounts[frameIndex] = count;
+}
+
+void Sprite2DSystem::WriteDescriptors(DescriptorSet& descriptorSet) 
+{
+    mDescriptorWriter->WriteToImage(mImageInfos, descriptorSet);
+    mDescriptorWriter->WriteToStorageBuffer(6, 6, mFrameTableInfo, descriptorSet);
+    mDescriptorWriter->WriteToStorageBuffer(7, 7, mInstanceFramesInfo, descriptorSet);
+    mDescriptorWriter->WriteToBuffer(8, 8, mFrameUniformsInfo, descriptorSet);
+    mDescriptorWriter->WriteToStorageBuffer(9, 9, mInstancesInfo, descriptorSet);
+    mDescriptorWriter->WriteToStorageBuffer(10, 10, mVisibleInstancesInfo, descriptorSet);
 
     mDescriptorWriter->UpdateDescriptorSet(mDevice);
-    
 }
 
-Sprite2DSystem::~Sprite2DSystem() 
+void Sprite2DSystem::CreateCullDescriptors(Pipeline* pipeline) 
 {
+    mCullDescriptorHandler = std::make_unique<DescriptorHandler>(std::move(DescriptorSet(mDescriptorAllocator, pipeline)));
+
+    auto& descriptorSet = mCullDescriptorHandler->GetDescriptorSet();
+
+    mCullDescriptorWriter->WriteToBuffer(0, 8, mFrameUniformsInfo, descriptorSet);
+    mCullDescriptorWriter->WriteToStorageBuffer(1, 9, mInstancesInfo, descriptorSet);
+    mCullDescriptorWriter->WriteToStorageBuffer(2, 10, mVisibleInstancesInfo, descriptorSet);
+    mCullDescriptorWriter->WriteToStorageBuffer(3, 11, mDrawCommandsInfo, descriptorSet);
+    mCullDescriptorWriter->WriteToStorageBuffer(4, 12, mGroupCountsInfo, descriptorSet);
+
+    mCullDescriptorWriter->UpdateDescriptorSet(mDevice);
+}
+
+void Sprite2DSystem::Cull(VkCommandBuffer commandBuffer, int frameIndex) 
+{
+    mCulled[frameIndex] = false;
+
+    Upload(frameIndex);
+
+    uint32_t instanceCount = mInstanceCounts[frameIndex];
+    Pipeline* pipeline = mCullPipeline.Get();
+    if(!pipeline || instanceCount == 0) 
+    {
+        return;
+    }
+    pipeline->Bind(commandBuffer);
+
+    if(!mCullDescriptorHandler) 
+    {
+        CreateCullDescriptors(pipeline);
+    }
+    mCullDescriptorHandler->GetDescriptorSet().Bind(commandBuffer);
+
+    mCullPushConstant.baseInstance = static_cast<uint32_t>(frameIndex) * MAX_INSTANCES;
+    mCullPushConstant.frameIndex = static_cast<uint32_t>(frameIndex);
+    mCullPushConstant.instanceCount = instanceCount;
+
+    const VkPushConstantRange& pushConstantRange = GetPushConstantRange(*pipeline, "cull.comp");
+    uint32_t groupCount = (instanceCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE;
+
+    // Count the visible sprites of every workgroup, then list them where those counts put them.
+    for(uint32_t phase = 0; phase < 2; phase++) 
+    {
+        mCullPushConstant.phase = phase;
+        vkCmdPushConstants(
+            commandBuffer, 
+            pipeline->GetPipelineLayout(), 
+            pushConstantRange.stageFlags, 
+            pushConstantRange.offset, 
+            pushConstantRange.size, 
+            reinterpret_cast<const uint8_t*>(&mCullPushConstant) + pushConstantRange.offset
+        );
+        vkCmdDispatch(commandBuffer, groupCount, 1, 1);
 
+        // The counts for the second phase, then the list and the draw for the vertex shader
+        // and the indirect draw.
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = phase == 0 ? VK_ACCESS_SHADER_READ_BIT : VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(
+            commandBuffer, 
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
+            phase == 0 ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 
+            0, 
+            1, &barrier, 
+            0, nullptr, 
+            0, nullptr
+        );
+    }
+
+    mCulled[frameIndex] = true;
 }
 
-void Sprite2DSystem::Run(VkCommandBuffer commandBuffer, int frameIndex) 
+void Sprite2DSystem::Submit(Renderer& renderer, int frameIndex) 
 {
 
     // Pipeline.
     //
-    const auto& pipeline = mPipelines->operator[]("playerPipeline");
-    pipeline->Bind(commandBuffer);
+    // Skip drawing until it's been built, rather than stalling the frame on the compiler.
+    Pipeline* pipeline = mPipeline.Get();
+    if(!pipeline || !mCulled[frameIndex] || mImageInfos.empty()) 
+    {
+        return;
+    }
+    mCulled[frameIndex] = false;
 
     // Uniforms and Descriptor sets.
     //
-    mDescriptorHandler->GetDescriptorSet().Bind(commandBuffer);
-    
+    // The renderer binds both, so they're registered as soon as the sets can be created. The
+    // frame's transient pools were reset when it began, so its set is allocated afresh.
+    std::unique_ptr<DescriptorSet>& descriptorSet = mDescriptorSets[frameIndex];
+    if(descriptorSet) 
+    {
+        *descriptorSet = DescriptorSet(mDescriptorAllocator, pipeline, static_cast<uint32_t>(frameIndex));
+    }
+    else {
+        descriptorSet = std::make_unique<DescriptorSet>(mDescriptorAllocator, pipeline, static_cast<uint32_t>(frameIndex));
+        mMaterialIds[frameIndex] = renderer.RegisterMaterial(descriptorSet.get());
+    }
+    WriteDescriptors(*descriptorSet);
+
+    if(!mRegistered) 
+    {
+        mPipelineId = renderer.RegisterPipeline(mPipeline);
+        mIndirectDrawId = renderer.RegisterIndirectDraw([this](VkCommandBuffer commandBuffer, uint32_t frameInFlight)
+        {
+            Draw(commandBuffer, static_cast<int>(frameInFlight));
+        });
+        mRegistered = true;
+    }
+
+    RenderSubmission submission{};
+    submission.layer = mLayer;
+    submission.pipeline = mPipelineId;
+    submission.material = mMaterialIds[frameIndex];
+    submission.draw.indirect = mIndirectDrawId;
+
+    renderer.GetRenderQueue().Submit(submission);
+}
+
+void Sprite2DSystem::Draw(VkCommandBuffer commandBuffer, int frameIndex) 
+{
+    Pipeline* pipeline = mPipeline.Get();
+
     // Vertex Buffers.
     //
     VkBuffer buffers[] = {mVertexBuffer->GetBuffer()};
     VkDeviceSize offsets[] = {0};
     vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
 
+    // Every instance of the frame is drawn at once, so this is pushed once per frame rather than
+    // once per sprite.
+    mPushConstant.baseInstance = static_cast<uint32_t>(frameIndex) * MAX_INSTANCES;
+    mPushConstant.frameIndex = static_cast<uint32_t>(frameIndex);
+
+    const VkPushConstantRange& pushConstantRange = GetPushConstantRange(*pipeline, "simple.vert");
     vkCmdPushConstants(
         commandBuffer, 
         pipeline->GetPipelineLayout(), 
-        VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 
-        0, 
-        sizeof(TexturePushConstant), 
-        pipeline->GetShader()->GetPushConstant().GetData()
+        pushConstantRange.stageFlags, 
+        pushConstantRange.offset, 
+        pushConstantRange.size, 
+        reinterpret_cast<const uint8_t*>(&mPushConstant) + pushConstantRange.offset
     );
 
     // Finally Draw.
     //
-    vkCmdDraw(commandBuffer, 6, 1, 0, 0);
+    // The base instance pushed above picks this frame's slice of the visible instances, and
+    // cull.comp wrote how many there are.
+    VkDeviceSize commandOffset = static_cast<VkDeviceSize>(frameIndex) * sizeof(VkDrawIndirectCommand);
+    if(mDevice.GetLogicalDevice().SupportsDrawIndirectCount()) 
+    {
+        VkDeviceSize countOffset = sizeof(VkDrawIndirectCommand) * SwapChain::FRAMES_IN_FLIGHT + static_cast<VkDeviceSize>(frameIndex) * sizeof(uint32_t);
+        mDevice.GetLogicalDevice().CmdDrawIndirectCount(commandBuffer, mDrawCommands->GetBuffer(), commandOffset, mDrawCommands->GetBuffer(), countOffset, 1, sizeof(VkDrawIndirectCommand));
+    }
+    else {
+        // Always issued, but with no instances when nothing is visible.
+        vkCmdDrawIndirect(commandBuffer, mDrawCommands->GetBuffer(), commandOffset, 1, sizeof(VkDrawIndirectCommand));
+    }
 }
 }
\ No newline at end of file
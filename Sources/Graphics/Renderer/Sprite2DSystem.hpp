@@ -1,20 +1,233 @@
 #pragma once
-#include "RenderSystem.hpp"
-#include "Graphics/Images/Image.hpp"
+#include "Graphics/Devices/Device.hpp"
+#include "Graphics/Buffers/Buffer.hpp"
+#include "Graphics/Shader/Image.hpp"
+#include "Graphics/Descriptors/DescriptorWriter.hpp"
+#include "Graphics/Renderer/SwapChain.hpp"
+#include "Graphics/Pipelines/PipelineBuildQueue.hpp"
+#include "Animation/SpriteAnimation.hpp"
+#include "ResourceManager.hpp"
 
 namespace mt 
 {
-class Sprite2DSystem : public RenderSystem 
+
+class Renderer;
+
+/**
+ * @brief Everything simple.vert needs per sprite, read from a storage buffer by instance index
+ * (std430, so the texture is padded out to 80 bytes).
+*/
+struct SpriteInstance
+{
+    glm::mat4 modelMatrix{1.0f};
+    uint32_t texture = 0;
+    uint32_t padding[3]{};
+};
+
+/**
+ * @brief The only push constants left, 8 bytes instead of 132 per draw.
+*/
+struct SpritePushConstant
+{
+    uint32_t baseInstance = 0;
+    uint32_t frameIndex = 0;
+};
+
+/**
+ * @brief cull.comp's push constants. Phase 0 counts the visible sprites, phase 1 lists them.
+*/
+struct SpriteCullPushConstant
+{
+    uint32_t baseInstance = 0;
+    uint32_t frameIndex = 0;
+    uint32_t instanceCount = 0;
+    uint32_t phase = 0;
+};
+
+class Sprite2DSystem 
 {
 public:
-    Sprite2DSystem(Device& device, VkRenderPass renderPass, uint32_t width, uint32_t height);
+    /**
+     * @brief Queues the sprite and culling pipelines on buildQueue, nothing is drawn until both
+     * have been built.
+    */
+    Sprite2DSystem(Device& device, DescriptorAllocator& descriptorAllocator, PipelineBuildQueue& buildQueue, VkRenderPass renderPass, const RenderPassFormats& formats);
     ~Sprite2DSystem();
     
-    void Run(VkCommandBuffer commandBuffer, int frameIndex) override;
+    /**
+     * @brief Submits whatever Cull() found visible this frame to the renderer's queue, as a single
+     * indirect draw whose instance count never comes back to the CPU. Sprites overlap in index
+     * order within it, and it's ordered against other systems' draws by its layer.
+    */
+    void Submit(Renderer& renderer, int frameIndex);
+
+    /**
+     * @brief Uploads whatever changed since the frame's slice was last culled, then culls every
+     * sprite against the camera on the GPU and writes the draw Submit() queues. Has to be
+     * recorded once the frame's fence has been waited on, outside any render pass and before the
+     * one that draws the queue (Renderer does it in a compute pass of the render graph). Records
+     * its own barriers, the render graph only tracks images. Nothing is drawn for frames that
+     * weren't culled.
+    */
+    void Cull(VkCommandBuffer commandBuffer, int frameIndex);
+
+    /**
+     * @brief The render queue layer the sprites are submitted on, lower layers draw first.
+    */
+    inline void SetLayer(uint8_t layer) { mLayer = layer; }
+
+    /**
+     * @brief Uploads the frame table the vertex shader resolves UVs from, and keeps the clips
+     * SetAnimations() refers to, stopping the animations that were playing. Replaces the previous
+     * one, so only call it while the GPU isn't using the system (e.g. when loading a level).
+    */
+    void SetAnimationLibrary(const SpriteAnimationLibrary& library);
+
+    /**
+     * @brief Binds the textures SpriteInstance::texture picks from (see simple.frag), and nothing
+     * is drawn until it's been called. Every one of them has to be resident in resources (e.g.
+     * after FinishLoading()) and stay loaded until the frames in flight that drew with them are
+     * done. They're bound from the next frame on.
+    */
+    void SetTextures(const ResourceManager& resources, const std::vector<ImageHandle>& textures);
+
+    /**
+     * @brief How many sprites there are. New ones start out as default SpriteInstances on frame 0,
+     * the whole texture.
+    */
+    void SetInstanceCount(uint32_t count);
+
+    /**
+     * @brief Sets the transform and texture of one sprite, which it keeps until it's set again.
+     * Sprites are drawn in index order, so later ones end up on top.
+    */
+    void SetInstance(uint32_t index, const SpriteInstance& instance);
+
+    /**
+     * @brief Replaces every sprite at once, for when most of them changed.
+    */
+    void SetInstances(const SpriteInstance* instances, uint32_t count);
+
+    /**
+     * @brief Sets the frame of the first count sprites, in instance order, usually straight from
+     * AnimateSprites(). Sprites without an animation stay on frame 0.
+    */
+    void SetInstanceFrames(const uint32_t* frames, uint32_t count);
+
+    /**
+     * @brief Plays animations on the first count sprites, in instance order, replacing whatever
+     * they were playing. Throws if one refers to a clip the library doesn't have.
+    */
+    void SetAnimations(const SpriteAnimationComp* animations, uint32_t count);
+
+    /**
+     * @brief Advances every animation set by SetAnimations() and moves their sprites to the
+     * frames they're on. Called once per frame by the Renderer.
+    */
+    void Animate(JobSystem& jobSystem, float deltaTime);
+
+    void SetCamera(const glm::mat4& viewProjectionMatrix);
+
+    inline uint32_t GetInstanceCount() const { return static_cast<uint32_t>(mInstanceData.size()); }
+
+    static constexpr uint32_t MAX_INSTANCES = 65536;
+
+    // The samplers simple.frag declares.
+    static constexpr uint32_t TEXTURE_BINDINGS = 6;
+
+    // Have to match GROUP_SIZE and MAX_GROUPS in cull.comp.
+    static constexpr uint32_t CULL_GROUP_SIZE = 256;
+    static constexpr uint32_t CULL_MAX_GROUPS = MAX_INSTANCES / CULL_GROUP_SIZE;
 
 private:
-    glm::vec2 mTexCoords[6][6];
+    // Indices of the sprites a frame in flight's slice is missing, as one range that covers them all.
+    struct DirtyRange
+    {
+        uint32_t begin = 0;
+        uint32_t end = 0;
+    };
+
+    static void MarkDirty(DirtyRange (&ranges)[SwapChain::FRAMES_IN_FLIGHT], uint32_t begin, uint32_t end);
+
+    // Records the draw Submit() queued, with the pipeline and descriptor set already bound.
+    void Draw(VkCommandBuffer commandBuffer, int frameIndex);
+
+    // Copies what changed into the frame's slices, whose fence has been waited on. The other
+    // frame in flight's slices may still be read by the GPU, so they catch up when it's their turn.
+    void Upload(int frameIndex);
+
+    // The descriptor sets need the pipeline's layout, so they're created once it's ready. The
+    // draw's is allocated again every frame from the frame's transient pools, so it always has
+    // the latest textures and the layout of whichever pipeline is current.
+    void WriteDescriptors(DescriptorSet& descriptorSet);
+    void CreateCullDescriptors(Pipeline* pipeline);
+
+    Device& mDevice;
+    DescriptorAllocator& mDescriptorAllocator;
+    PipelineHandle mPipeline{};
+    PipelineHandle mCullPipeline{};
+
+    // The writer keeps pointers to these until the set is updated.
+    std::vector<VkDescriptorImageInfo> mImageInfos{};
+
+    // One per frame in flight, each registered with the renderer as that frame's material.
+    std::unique_ptr<DescriptorSet> mDescriptorSets[SwapChain::FRAMES_IN_FLIGHT]{};
+    std::unique_ptr<DescriptorWriter> mDescriptorWriter{};
+    std::unique_ptr<Buffer> mVertexBuffer{};
+
+    // What the sprites were set to, which stays resident so that only what changes is uploaded.
+    std::vector<SpriteInstance> mInstanceData{};
+    std::vector<uint32_t> mInstanceFrameData{};
+    glm::mat4 mCamera{1.0f};
+
+    // What Animate() plays, and the frames it writes before they're handed to SetInstanceFrames().
+    std::vector<AnimationClip> mClips{};
+    std::vector<SpriteAnimationComp> mAnimations{};
+    std::vector<uint32_t> mAnimatedFrames{};
+    DirtyRange mDirtyInstances[SwapChain::FRAMES_IN_FLIGHT]{};
+    DirtyRange mDirtyInstanceFrames[SwapChain::FRAMES_IN_FLIGHT]{};
+
+    // One slice of MAX_INSTANCES per frame in flight, persistently mapped.
+    std::unique_ptr<Buffer> mInstanceFrames{};
+    uint32_t* mMappedInstanceFrames = nullptr;
+
+    // Same slicing as the instance frames.
+    std::unique_ptr<Buffer> mInstances{};
+    SpriteInstance* mMappedInstances = nullptr;
+    uint32_t mInstanceCounts[SwapChain::FRAMES_IN_FLIGHT]{};
+
+    // One camera per frame in flight, persistently mapped.
+    std::unique_ptr<Buffer> mFrameUniforms{};
+    glm::mat4* mMappedFrameUniforms = nullptr;
+
+    std::unique_ptr<Buffer> mFrameTable{};
+    VkDescriptorBufferInfo mFrameTableInfo{};
+    VkDescriptorBufferInfo mInstanceFramesInfo{};
+    VkDescriptorBufferInfo mFrameUniformsInfo{};
+    VkDescriptorBufferInfo mInstancesInfo{};
+
+    // Written by cull.comp and only ever read by the GPU, so they're device local. Visible
+    // instances are sliced like the instances, the draw commands hold one VkDrawIndirectCommand
+    // per frame in flight followed by their draw counts.
+    std::unique_ptr<Buffer> mVisibleInstances{};
+    std::unique_ptr<Buffer> mDrawCommands{};
+    std::unique_ptr<Buffer> mGroupCounts{};
+    VkDescriptorBufferInfo mVisibleInstancesInfo{};
+    VkDescriptorBufferInfo mDrawCommandsInfo{};
+    VkDescriptorBufferInfo mGroupCountsInfo{};
+
+    std::unique_ptr<DescriptorHandler> mCullDescriptorHandler{};
+    std::unique_ptr<DescriptorWriter> mCullDescriptorWriter{};
+    bool mCulled[SwapChain::FRAMES_IN_FLIGHT]{};
+
+    // What the renderer knows the pipeline, descriptor sets and Draw() by, once they exist.
+    bool mRegistered = false;
+    uint32_t mPipelineId = 0;
+    uint32_t mMaterialIds[SwapChain::FRAMES_IN_FLIGHT]{};
+    uint32_t mIndirectDrawId = 0;
+    uint8_t mLayer = 0;
 
-    std::vector<std::unique_ptr<Image>> mImages{};
+    SpritePushConstant mPushConstant{};
+    SpriteCullPushConstant mCullPushConstant{};
 };
 }
\ No newline at end of file
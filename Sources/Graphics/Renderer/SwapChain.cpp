@@ -1,16 +1,19 @@
 #include "SwapChain.hpp"
-#include <iostream>
+#include "Graphics/Devices/PhysicalDevice.hpp"
+#include "Graphics/Devices/LogicalDevice.hpp"
+#include "Profiler/Profiler.hpp"
+#include "Logging.hpp"
 
 namespace mt 
 {
-SwapChain::SwapChain(const PhysicalDevice& physicalDevice, const LogicalDevice& logicalDevice, VkExtent2D extent)
-    : mPhysicalDevice{physicalDevice}, mLogicalDevice{logicalDevice}, mWindowExtent{extent}
+SwapChain::SwapChain(const PhysicalDevice& physicalDevice, const LogicalDevice& logicalDevice, VkExtent2D extent, bool depthBuffer)
+    : mPhysicalDevice{physicalDevice}, mLogicalDevice{logicalDevice}, mWindowExtent{extent}, mDepthBuffer{depthBuffer}
 {
     Init();
 }   
 
-SwapChain::SwapChain(const PhysicalDevice& physicalDevice, const LogicalDevice& logicalDevice, VkExtent2D extent, std::shared_ptr<SwapChain>& previous)
-    : mPhysicalDevice{physicalDevice}, mLogicalDevice{logicalDevice}, mWindowExtent{extent}, mPreviousSwapChain{previous}
+SwapChain::SwapChain(const PhysicalDevice& physicalDevice, const LogicalDevice& logicalDevice, VkExtent2D extent, bool depthBuffer, std::shared_ptr<SwapChain>& previous)
+    : mPhysicalDevice{physicalDevice}, mLogicalDevice{logicalDevice}, mWindowExtent{extent}, mPreviousSwapChain{previous}, mDepthBuffer{depthBuffer}
 {
     Init();
     mPreviousSwapChain = nullptr;
@@ -30,16 +33,11 @@ SwapChain::~SwapChain()
         mSwapChain = nullptr;
     }
 
-    for (int i = 0; i < mDepthImages.size(); i++) 
+    // Swapchain images belong to the swapchain, but offscreen ones are ours to free.
+    for (size_t i = 0; i < mOffscreenImageMemorys.size(); i++) 
     {
-        vkDestroyImageView(mLogicalDevice.GetDevice(), mDepthImageViews[i], nullptr);
-        vkDestroyImage(mLogicalDevice.GetDevice(), mDepthImages[i], nullptr);
-        vkFreeMemory(mLogicalDevice.GetDevice(), mDepthImageMemorys[i], nullptr);
-    }
-
-    for (auto framebuffer : mSwapChainFramebuffers) 
-    {
-        vkDestroyFramebuffer(mLogicalDevice.GetDevice(), framebuffer, nullptr);
+        vkDestroyImage(mLogicalDevice.GetDevice(), mSwapChainImages[i], nullptr);
+        vkFreeMemory(mLogicalDevice.GetDevice(), mOffscreenImageMemorys[i], nullptr);
     }
 
     vkDestroyRenderPass(mLogicalDevice.GetDevice(), mRenderPass, nullptr);
@@ -55,11 +53,27 @@ SwapChain::~SwapChain()
 
 void SwapChain::Init() 
 {
-    CreateSwapChain();
+    mIsOffscreen = !mPhysicalDevice.HasSurface();
+
+    if (mIsOffscreen) 
+    {
+        CreateOffscreenImages();
+    }
+    else {
+        CreateSwapChain();
+    }
+
     CreateImageViews();
-    CreateRenderPass();
-    CreateDepthResources();
-    CreateFramebuffers();
+
+    // The depth buffer and framebuffers are the render graph's, we only pick the format. 2D games
+    // are ordered by their render queue keys and usually go without depth entirely.
+    mSwapChainDepthFormat = mDepthBuffer ? FindDepthFormat() : VK_FORMAT_UNDEFINED;
+
+    // Pipelines are built against the formats alone with dynamic rendering.
+    if(!mLogicalDevice.SupportsDynamicRendering()) 
+    {
+        CreateRenderPass();
+    }
     CreateSyncObjects();
 }
 
@@ -128,54 +142,35 @@ void SwapChain::CreateSwapChain()
     mSwapChainExtent = extent;
 }
 
-void SwapChain::CreateImageViews() 
+void SwapChain::CreateOffscreenImages() 
 {
-  mSwapChainImageViews.resize(mSwapChainImages.size());
-  for (size_t i = 0; i < mSwapChainImages.size(); i++) 
-  {
-        VkImageViewCreateInfo viewInfo{};
-        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-        viewInfo.image = mSwapChainImages[i];
-        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-        viewInfo.format = mSwapChainImageFormat;
-        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        viewInfo.subresourceRange.baseMipLevel = 0;
-        viewInfo.subresourceRange.levelCount = 1;
-        viewInfo.subresourceRange.baseArrayLayer = 0;
-        viewInfo.subresourceRange.layerCount = 1;
+    // One image per frame in flight is all we need, since nothing is ever waiting on a
+    // presentation engine to hand images back.
+    uint32_t imageCount = FRAMES_IN_FLIGHT;
 
-        if (vkCreateImageView(mLogicalDevice.GetDevice(), &viewInfo, nullptr, &mSwapChainImageViews[i]) !=
-            VK_SUCCESS) 
-        {
-            throw std::runtime_error("failed to create texture image view!");
-        }
-  }
-}
+    mSwapChainImageFormat = mLogicalDevice.FindSupportedFormat(
+        {VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_R8G8B8A8_SRGB, VK_FORMAT_B8G8R8A8_UNORM, VK_FORMAT_R8G8B8A8_UNORM},
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_TRANSFER_SRC_BIT);
+    mSwapChainExtent = mWindowExtent;
 
-void SwapChain::CreateDepthResources() 
-{
-    VkFormat depthFormat = FindDepthFormat();
-    mSwapChainDepthFormat = depthFormat;
-    VkExtent2D swapChainExtent = GetSwapChainExtent();
-
-    mDepthImages.resize(GetImageCount());
-    mDepthImageMemorys.resize(GetImageCount());
-    mDepthImageViews.resize(GetImageCount());
+    mSwapChainImages.resize(imageCount);
+    mOffscreenImageMemorys.resize(imageCount);
 
-    for (int i = 0; i < mDepthImages.size(); i++) 
+    for (uint32_t i = 0; i < imageCount; i++) 
     {
         VkImageCreateInfo imageInfo{};
         imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
         imageInfo.imageType = VK_IMAGE_TYPE_2D;
-        imageInfo.extent.width = swapChainExtent.width;
-        imageInfo.extent.height = swapChainExtent.height;
+        imageInfo.extent.width = mSwapChainExtent.width;
+        imageInfo.extent.height = mSwapChainExtent.height;
         imageInfo.extent.depth = 1;
         imageInfo.mipLevels = 1;
         imageInfo.arrayLayers = 1;
-        imageInfo.format = depthFormat;
+        imageInfo.format = mSwapChainImageFormat;
         imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
         imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
         imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
         imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
         imageInfo.flags = 0;
@@ -183,31 +178,41 @@ void SwapChain::CreateDepthResources()
         mLogicalDevice.CreateImageFromInfo(
             imageInfo,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            mDepthImages[i],
-            mDepthImageMemorys[i]);
+            mSwapChainImages[i],
+            mOffscreenImageMemorys[i]);
+    }
+
+    MT_LOG_INFO("Rendering offscreen ({}x{}, {} images)", mSwapChainExtent.width, mSwapChainExtent.height, imageCount);
+}
 
+void SwapChain::CreateImageViews() 
+{
+  mSwapChainImageViews.resize(mSwapChainImages.size());
+  for (size_t i = 0; i < mSwapChainImages.size(); i++) 
+  {
         VkImageViewCreateInfo viewInfo{};
         viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-        viewInfo.image = mDepthImages[i];
+        viewInfo.image = mSwapChainImages[i];
         viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-        viewInfo.format = depthFormat;
-        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+        viewInfo.format = mSwapChainImageFormat;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
         viewInfo.subresourceRange.baseMipLevel = 0;
         viewInfo.subresourceRange.levelCount = 1;
         viewInfo.subresourceRange.baseArrayLayer = 0;
         viewInfo.subresourceRange.layerCount = 1;
 
-        if (vkCreateImageView(mLogicalDevice.GetDevice(), &viewInfo, nullptr, &mDepthImageViews[i]) != VK_SUCCESS) 
+        if (vkCreateImageView(mLogicalDevice.GetDevice(), &viewInfo, nullptr, &mSwapChainImageViews[i]) !=
+            VK_SUCCESS) 
         {
             throw std::runtime_error("failed to create texture image view!");
         }
-    }
+  }
 }
 
 void SwapChain::CreateRenderPass() 
 {
     VkAttachmentDescription depthAttachment{};
-    depthAttachment.format = FindDepthFormat();
+    depthAttachment.format = mSwapChainDepthFormat;
     depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
     depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
     depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
@@ -228,7 +233,7 @@ void SwapChain::CreateRenderPass()
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    colorAttachment.finalLayout = mIsOffscreen ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
     VkAttachmentReference colorAttachmentRef = {};
     colorAttachmentRef.attachment = 0;
@@ -238,7 +243,7 @@ void SwapChain::CreateRenderPass()
     subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     subpass.colorAttachmentCount = 1;
     subpass.pColorAttachments = &colorAttachmentRef;
-    subpass.pDepthStencilAttachment = &depthAttachmentRef;
+    subpass.pDepthStencilAttachment = HasDepthBuffer() ? &depthAttachmentRef : nullptr;
 
     VkSubpassDependency dependency = {};
     dependency.dstSubpass = 0;
@@ -251,7 +256,11 @@ void SwapChain::CreateRenderPass()
     dependency.srcStageMask =
         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
 
-    std::array<VkAttachmentDescription, 2> attachments = {colorAttachment, depthAttachment};
+    std::vector<VkAttachmentDescription> attachments = {colorAttachment};
+    if(HasDepthBuffer()) 
+    {
+        attachments.push_back(depthAttachment);
+    }
     VkRenderPassCreateInfo renderPassInfo = {};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
     renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
@@ -267,30 +276,6 @@ void SwapChain::CreateRenderPass()
     }
 }
 
-void SwapChain::CreateFramebuffers() 
-{
-    mSwapChainFramebuffers.resize(GetImageCount());
-    for (size_t i = 0; i < GetImageCount(); i++) 
-    {
-        std::array<VkImageView, 2> attachments = {mSwapChainImageViews[i], mDepthImageViews[i]};
-
-        VkExtent2D swapChainExtent = GetSwapChainExtent();
-        VkFramebufferCreateInfo framebufferInfo = {};
-        framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-        framebufferInfo.renderPass = mRenderPass;
-        framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
-        framebufferInfo.pAttachments = attachments.data();
-        framebufferInfo.width = swapChainExtent.width;
-        framebufferInfo.height = swapChainExtent.height;
-        framebufferInfo.layers = 1;
-
-        if (vkCreateFramebuffer(mLogicalDevice.GetDevice(), &framebufferInfo, nullptr, &mSwapChainFramebuffers[i]) != VK_SUCCESS) 
-        {
-            throw std::runtime_error("failed to create framebuffer!");
-        }
-    }
-}
-
 void SwapChain::CreateSyncObjects() 
 {
     mImageAvailableSemaphores.resize(FRAMES_IN_FLIGHT);
@@ -327,9 +312,20 @@ VkFormat SwapChain::FindDepthFormat()
 
 VkResult SwapChain::AcquireNextImage(uint32_t *imageIndex) 
 {
+    MT_PROFILE_SCOPE("SwapChain::AcquireNextImage");
+
     vkWaitForFences(mLogicalDevice.GetDevice(), 1, &mInFlightFences[mCurrentFrame], VK_TRUE, 
                     std::numeric_limits<uint64_t>::max());
 
+    // Offscreen images are simply handed out round-robin, the fences in SubmitCommandBuffers()
+    // already stop us from reusing one the GPU is still rendering to.
+    if (mIsOffscreen) 
+    {
+        *imageIndex = mNextOffscreenImage;
+        mNextOffscreenImage = (mNextOffscreenImage + 1) % static_cast<uint32_t>(GetImageCount());
+        return VK_SUCCESS;
+    }
+
     VkResult result = vkAcquireNextImageKHR(
         mLogicalDevice.GetDevice(),
         mSwapChain,
@@ -344,6 +340,8 @@ VkResult SwapChain::AcquireNextImage(uint32_t *imageIndex)
 
 VkResult SwapChain::SubmitCommandBuffers(const VkCommandBuffer *buffers, uint32_t *imageIndex) 
 {
+    MT_PROFILE_SCOPE("SwapChain::SubmitCommandBuffers");
+
     if (mImagesInFlight[*imageIndex] != VK_NULL_HANDLE) 
     {
         vkWaitForFences(mLogicalDevice.GetDevice(), 1, &mImagesInFlight[*imageIndex], VK_TRUE, UINT64_MAX);
@@ -354,9 +352,10 @@ VkResult SwapChain::SubmitCommandBuffers(const VkCommandBuffer *buffers, uint32_
     VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
+    // Nothing was acquired (and nothing will be presented) offscreen, so there are no semaphores.
     VkSemaphore waitSemaphores[] = {mImageAvailableSemaphores[mCurrentFrame]};
     VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.waitSemaphoreCount = mIsOffscreen ? 0 : 1;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
 
@@ -364,7 +363,7 @@ VkResult SwapChain::SubmitCommandBuffers(const VkCommandBuffer *buffers, uint32_
     submitInfo.pCommandBuffers = buffers;
 
     VkSemaphore signalSemaphores[] = {mRenderFinishedSemaphores[mCurrentFrame]};
-    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.signalSemaphoreCount = mIsOffscreen ? 0 : 1;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
     vkResetFences(mLogicalDevice.GetDevice(), 1, &mInFlightFences[mCurrentFrame]);
@@ -374,6 +373,12 @@ VkResult SwapChain::SubmitCommandBuffers(const VkCommandBuffer *buffers, uint32_
         throw std::runtime_error("failed to submit draw command buffer!");
     }
 
+    if (mIsOffscreen) 
+    {
+        mCurrentFrame = (mCurrentFrame + 1) % FRAMES_IN_FLIGHT;
+        return VK_SUCCESS;
+    }
+
     VkPresentInfoKHR presentInfo = {};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     presentInfo.waitSemaphoreCount = 1;
@@ -413,19 +418,19 @@ VkPresentModeKHR SwapChain::ChooseSwapPresentMode(const std::vector<VkPresentMod
     for (const auto &availablePresentMode : availablePresentModes) 
     {
         if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-            std::cout << "Present mode: Mailbox" << std::endl;
+            MT_LOG_INFO("Present mode: Mailbox");
             return availablePresentMode;
         }
     }
 
     // for (const auto &availablePresentMode : availablePresentModes) {
     //   if (availablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR) {
-    //     std::cout << "Present mode: Immediate" << std::endl;
+    //     MT_LOG_INFO("Present mode: Immediate");
     //     return availablePresentMode;
     //   }
     // }
 
-    std::cout << "Present mode: V-Sync" << std::endl;
+    MT_LOG_INFO("Present mode: V-Sync");
     return VK_PRESENT_MODE_FIFO_KHR;
 }
 
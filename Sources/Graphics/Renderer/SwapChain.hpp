@@ -1,10 +1,17 @@
 #pragma once
 #include <vulkan/vulkan.hpp>
-#include "Graphics/Devices/LogicalDevice.hpp"
+#include "Graphics/Pipelines/PipelineCache.hpp"
+
+#include <memory>
+#include <vector>
 
 namespace mt 
 {
 
+// The device headers need the structs below, so they can't be included from here.
+class PhysicalDevice;
+class LogicalDevice;
+
 struct SwapChainSupportDetails 
 {
   VkSurfaceCapabilitiesKHR capabilities;
@@ -24,8 +31,12 @@ struct QueueFamilyIndices
 class SwapChain 
 {
 public:
-    SwapChain(const PhysicalDevice& physicalDevice, const LogicalDevice& logicalDevice, VkExtent2D extent);
-    SwapChain(const PhysicalDevice& physicalDevice, const LogicalDevice& logicalDevice, VkExtent2D extent, std::shared_ptr<SwapChain>& previous);
+    /**
+     * @param depthBuffer Whether frames have a depth attachment at all. Without one the depth
+     * format is VK_FORMAT_UNDEFINED, and pipelines are built without depth.
+    */
+    SwapChain(const PhysicalDevice& physicalDevice, const LogicalDevice& logicalDevice, VkExtent2D extent, bool depthBuffer);
+    SwapChain(const PhysicalDevice& physicalDevice, const LogicalDevice& logicalDevice, VkExtent2D extent, bool depthBuffer, std::shared_ptr<SwapChain>& previous);
     ~SwapChain();
 
     SwapChain(const SwapChain& other) = delete;
@@ -48,22 +59,36 @@ public:
         return static_cast<float>(mSwapChainExtent.width) / (mSwapChainExtent.height);
     }
 
-    inline VkFramebuffer GetFrameBuffer(int index) const { return mSwapChainFramebuffers[index]; }
+    /**
+     * @brief Never begun, it's only there for pipelines to be created against. The render graph
+     * creates compatible render passes (same formats and sample counts) for the frame.
+     * VK_NULL_HANDLE with dynamic rendering, where pipelines only need GetRenderPassFormats().
+    */
     inline VkRenderPass GetRenderPass() const { return mRenderPass; }
     inline VkImageView GetImageView(int index) const { return mSwapChainImageViews[index]; }
     inline size_t GetImageCount() const { return mSwapChainImages.size(); }
     inline VkFormat GetSwapChainImageFormat() const { return mSwapChainImageFormat; }
+    inline VkFormat GetSwapChainDepthFormat() const { return mSwapChainDepthFormat; }
+    inline bool HasDepthBuffer() const { return mSwapChainDepthFormat != VK_FORMAT_UNDEFINED; }
+    inline RenderPassFormats GetRenderPassFormats() const { return RenderPassFormats{{mSwapChainImageFormat}, mSwapChainDepthFormat}; }
     inline VkExtent2D GetSwapChainExtent() const { return mSwapChainExtent; }
     inline uint32_t GetWidth() const { return mSwapChainExtent.width; }
     inline uint32_t GetHeight() const { return mSwapChainExtent.height; }
+    inline VkImage GetImage(int index) const { return mSwapChainImages[index]; }
+
+    /**
+     * @brief Whether we're rendering into our own offscreen images rather than a real swapchain
+     * (headless without a surface). Offscreen images finish every frame in
+     * VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, ready to be read back for captures.
+    */
+    inline bool IsOffscreen() const { return mIsOffscreen; }
 
 private:
     void Init();
     void CreateSwapChain();
+    void CreateOffscreenImages();
     void CreateImageViews();
-    void CreateDepthResources();
     void CreateRenderPass();
-    void CreateFramebuffers();
     void CreateSyncObjects();
 
     VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &availableFormats);
@@ -76,17 +101,18 @@ private:
 
     std::shared_ptr<SwapChain> mPreviousSwapChain = nullptr;
     VkExtent2D mWindowExtent;
-    VkSwapchainKHR mSwapChain;
+    VkSwapchainKHR mSwapChain = VK_NULL_HANDLE;
+
+    bool mIsOffscreen = false;
+    bool mDepthBuffer = false;
+    std::vector<VkDeviceMemory> mOffscreenImageMemorys;
+    uint32_t mNextOffscreenImage = 0;
 
     VkFormat mSwapChainImageFormat;
     VkFormat mSwapChainDepthFormat;
     VkExtent2D mSwapChainExtent;
-    VkRenderPass mRenderPass;
+    VkRenderPass mRenderPass = VK_NULL_HANDLE;
 
-    std::vector<VkFramebuffer> mSwapChainFramebuffers;
-    std::vector<VkImage> mDepthImages;
-    std::vector<VkDeviceMemory> mDepthImageMemorys;
-    std::vector<VkImageView> mDepthImageViews;
     std::vector<VkImage> mSwapChainImages;
     std::vector<VkImageView> mSwapChainImageViews;
     std::vector<VkSemaphore> mImageAvailableSemaphores;
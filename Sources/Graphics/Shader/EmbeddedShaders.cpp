@@ -0,0 +1,34 @@
+#include "EmbeddedShaders.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace mt 
+{
+
+#ifdef MAMMOTH_EMBED_SHADERS
+    // Generated into the build directory.
+    #include <EmbeddedShaderData.hpp>
+#else
+    static constexpr size_t sEmbeddedShaderCount = 0;
+    static constexpr EmbeddedShader sEmbeddedShaders[] = {{"", nullptr, 0}};
+#endif
+
+const EmbeddedShader* FindEmbeddedShader(const std::string& path) 
+{
+    std::string name = path.substr(path.find_last_of("/\\") + 1);
+
+    const std::string extension = ".spv";
+    if(name.size() > extension.size() && name.compare(name.size() - extension.size(), extension.size(), extension) == 0) 
+    {
+        name.resize(name.size() - extension.size());
+    }
+
+    const EmbeddedShader* end = sEmbeddedShaders + sEmbeddedShaderCount;
+    const EmbeddedShader* shader = std::lower_bound(sEmbeddedShaders, end, name, 
+        [](const EmbeddedShader& s, const std::string& n) { return std::strcmp(s.name, n.c_str()) < 0; });
+
+    return shader != end && name == shader->name ? shader : nullptr;
+}
+
+}
@@ -0,0 +1,31 @@
+#ifndef MAMMOTH_2D_EMBEDDED_SHADERS_HPP
+#define MAMMOTH_2D_EMBEDDED_SHADERS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace mt 
+{
+
+/**
+ * @brief Optimised SPIR-V compiled into the library by the build (see EmbedShaders.cmake and
+ * the MAMMOTH_EMBED_SHADERS option), so creating a shader module needs no file I/O.
+*/
+struct EmbeddedShader 
+{
+    const char* name;           // The GLSL file name, e.g: "simple.frag".
+    const uint32_t* code;
+    size_t wordCount;
+};
+
+/**
+ * @brief Looks a shader up by the path it would otherwise be loaded from - only the file name
+ * matters, with or without the .spv extension ("Resources/Shaders/simple.frag.spv" finds "simple.frag").
+ * @return The shader, or nullptr if it wasn't embedded (or embedding is disabled).
+*/
+const EmbeddedShader* FindEmbeddedShader(const std::string& path);
+
+}
+
+#endif
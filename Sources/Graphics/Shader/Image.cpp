@@ -1,43 +1,329 @@
 #include "Image.hpp"
 #include "Logging.hpp"
+#include "Profiler/Profiler.hpp"
 #include <stdexcept>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define MAMMOTH_MIPMAP_SSE2
+#endif
 #define STB_IMAGE_IMPLEMENTATION
 #include <StbiImage/stb_image.h>
 
 namespace mt 
 {
 Image::Image(Device& device, std::string imagePath) 
-    : mDevice{device}
+    : Image(device, Decode(imagePath))
 {
+}
 
-    stbi_set_flip_vertically_on_load(true);
+Image::Image(Device& device, const ImageData& data) 
+    : Image(device, data, VK_NULL_HANDLE)
+{
+}
 
-    int width, height, nChannels;
-    stbi_uc* data = stbi_load(imagePath.c_str(), &width, &height, &nChannels, STBI_rgb_alpha);
+Image::Image(Device& device, const ImageData& data, VkCommandBuffer commandBuffer) 
+    : mDevice{device}, mBatchCommandBuffer{commandBuffer}
+{
+    MT_PROFILE_SCOPE("Image::Image");
 
-    VkDeviceSize imageSize = width * height * 4;
+    VkDeviceSize imageSize = static_cast<VkDeviceSize>(data.GetSize());
 
-    if(!data) 
+    std::vector<ImageLevel> levels = data.levels;
+    if(levels.empty()) 
     {
-        throw std::runtime_error("Failed to load image from stbi_load()!");
+        levels.push_back(ImageLevel{0, imageSize, data.width, data.height});
+    }
+
+    // Images that arrive without a mip chain get one, blitted on the GPU where the format allows
+    // it and box filtered on the CPU otherwise.
+    const ImageData* source = &data;
+    ImageData withMipmaps{};
+    bool blitMipmaps = false;
+    uint32_t fullChain = GetMipLevelCount(data.width, data.height);
+
+    if(levels.size() == 1 && fullChain > 1 && data.format == VK_FORMAT_R8G8B8A8_SRGB) 
+    {
+        if(SupportsLinearBlit(mDevice.GetPhysicalDevice(), data.format)) 
+        {
+            blitMipmaps = true;
+        }
+        else {
+            // Level 0 isn't necessarily at the start of the data (e.g: a whole KTX2 file).
+            withMipmaps.width = data.width;
+            withMipmaps.height = data.height;
+            withMipmaps.format = data.format;
+            withMipmaps.pixels.assign(data.GetData() + levels[0].offset, data.GetData() + levels[0].offset + levels[0].size);
+            GenerateMipmaps(withMipmaps);
+            source = &withMipmaps;
+            levels = withMipmaps.levels;
+            imageSize = static_cast<VkDeviceSize>(withMipmaps.pixels.size());
+        }
     }
 
+    mMipLevels = blitMipmaps ? fullChain : static_cast<uint32_t>(levels.size());
+
     mImageBuffer = std::make_unique<UniformBuffer>(
         mDevice,
         imageSize,
         VK_BUFFER_USAGE_TRANSFER_SRC_BIT, // required by the spec since we're copying this buffer.
-        (void*)data
+        (void*)source->GetData()
     );
 
     vkBindBufferMemory(mDevice.GetDevice(), mImageBuffer->GetBuffer(), mImageBuffer->GetBufferMemory(), 0);
 
-    stbi_image_free(data);
+    // Compressed blocks go straight from the staging buffer into the image, no decoding involved.
+    // Blitting reads from the image itself, hence the extra usage.
+    CreateImage(data.width, data.height, data.format, VK_IMAGE_TILING_OPTIMAL, 
+        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | (blitMipmaps ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0), 
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mImage, mImageMemory, levels);
+
+    mBatchCommandBuffer = VK_NULL_HANDLE;
+}
+
+std::vector<std::unique_ptr<Image>> Image::UploadBatch(Device& device, const std::vector<const ImageData*>& images) 
+{
+    MT_PROFILE_FUNCTION();
 
-    CreateImage(width, height, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL, 
-        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mImage, mImageMemory);
+    VkCommandBuffer commandBuffer = BeginCommands(device);
+    std::vector<std::unique_ptr<Image>> uploaded{};
+    uploaded.reserve(images.size());
 
-    mImageBuffer->SetDescriptorImageInfo(mImageSampler, mImageView);
+    try 
+    {
+        // Each image keeps its staging buffer, so they're all still valid when the batch runs.
+        for(const ImageData* data : images) 
+        {
+            uploaded.push_back(std::make_unique<Image>(device, *data, commandBuffer));
+        }
+    }
+    catch(...) 
+    {
+        // Nothing has been submitted, so the half-built images can go straight away.
+        vkEndCommandBuffer(commandBuffer);
+        vkFreeCommandBuffers(device.GetDevice(), device.GetCommandPool(), 1, &commandBuffer);
+        throw;
+    }
+
+    SubmitCommands(device, commandBuffer);
+
+    return uploaded;
+}
+
+ImageData Image::Decode(const std::string& imagePath, const std::vector<TextureCodec>& codecs, bool generateMipmaps, 
+    const std::shared_ptr<const AssetPack>& pack) 
+{
+    MT_PROFILE_SCOPE("Image::Decode");
+
+    for(auto codec : codecs) 
+    {
+        std::string cookedPath = GetCookedTexturePath(imagePath, codec);
+
+        ImageData data{};
+        Ktx2Texture texture{};
+
+        if(const PackEntry* entry = pack ? pack->Find(cookedPath) : nullptr) 
+        {
+            if(entry->flags & PACK_ENTRY_LZ4) 
+            {
+                data.pixels.resize(entry->size);
+                pack->Read(*entry, data.pixels.data());
+            }
+            else {
+                data.mapped = pack->GetPayload(*entry);
+                data.mappedSize = entry->size;
+                data.pack = pack;
+            }
+            texture = ParseKtx2(data.GetData(), data.GetSize(), cookedPath);
+        }
+        else {
+            std::error_code error{};
+            if(!std::filesystem::exists(cookedPath, error)) 
+            {
+                continue;
+            }
+
+            texture = ReadKtx2(cookedPath);
+            data.pixels = std::move(texture.data);
+        }
+
+        data.width = texture.width;
+        data.height = texture.height;
+        data.format = static_cast<VkFormat>(GetTextureCodecInfo(texture.codec).vkFormat);
+
+        for(const auto& level : texture.levels) 
+        {
+            data.levels.push_back(ImageLevel{level.offset, level.size, level.width, level.height});
+        }
+
+        return data;
+    }
+
+    // The thread-local variant, since several workers may be decoding at once.
+    stbi_set_flip_vertically_on_load_thread(true);
+
+    int width, height, nChannels;
+    stbi_uc* pixels = nullptr;
+
+    if(const PackEntry* entry = pack ? pack->Find(imagePath) : nullptr) 
+    {
+        std::vector<uint8_t> storage{};
+        const uint8_t* file = pack->Access(*entry, storage);
+        pixels = stbi_load_from_memory(file, static_cast<int>(entry->size), &width, &height, &nChannels, STBI_rgb_alpha);
+    }
+    else {
+        pixels = stbi_load(imagePath.c_str(), &width, &height, &nChannels, STBI_rgb_alpha);
+    }
+
+    if(!pixels) 
+    {
+        throw std::runtime_error("Failed to load image from stbi_load()!");
+    }
+
+    ImageData data{};
+    data.width = static_cast<uint32_t>(width);
+    data.height = static_cast<uint32_t>(height);
+    data.pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+    data.levels.push_back(ImageLevel{0, data.pixels.size(), data.width, data.height});
+
+    stbi_image_free(pixels);
+
+    if(generateMipmaps) 
+    {
+        GenerateMipmaps(data);
+    }
+
+    return data;
+}
+
+std::vector<TextureCodec> Image::GetSupportedCodecs(VkPhysicalDevice physicalDevice) 
+{
+    // Best quality per bit first. ETC2 and ASTC are mostly mobile/integrated, BC desktop.
+    const TextureCodec preferred[] = {TextureCodec::BC7, TextureCodec::ASTC4x4, TextureCodec::ETC2, TextureCodec::BC3};
+
+    std::vector<TextureCodec> codecs{};
+
+    for(auto codec : preferred) 
+    {
+        VkFormatProperties properties{};
+        vkGetPhysicalDeviceFormatProperties(physicalDevice, static_cast<VkFormat>(GetTextureCodecInfo(codec).vkFormat), &properties);
+
+        if(properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) 
+        {
+            codecs.push_back(codec);
+        }
+    }
+
+    return codecs;
+}
+
+bool Image::SupportsLinearBlit(VkPhysicalDevice physicalDevice, VkFormat format) 
+{
+    VkFormatProperties properties{};
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+
+    const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | 
+        VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+    return (properties.optimalTilingFeatures & required) == required;
+}
+
+uint32_t Image::GetMipLevelCount(uint32_t width, uint32_t height) 
+{
+    uint32_t levels = 1;
+    for(uint32_t size = std::max(width, height); size > 1; size >>= 1) 
+    {
+        levels++;
+    }
+    return levels;
+}
+
+// Averages 2x2 blocks of source texels into one (clamping at odd edges), rounding to nearest.
+// This filters the sRGB encoded values directly, which is slightly darker than filtering in
+// linear space (the cooker and the GPU blit both do), but keeps everything in 16-bit lanes.
+static void DownsampleBox(const unsigned char* source, uint32_t sourceWidth, uint32_t sourceHeight, 
+    unsigned char* destination, uint32_t width, uint32_t height) 
+{
+    for(uint32_t y = 0; y < height; y++) 
+    {
+        const unsigned char* row0 = source + static_cast<size_t>(std::min(y * 2, sourceHeight - 1)) * sourceWidth * 4;
+        const unsigned char* row1 = source + static_cast<size_t>(std::min(y * 2 + 1, sourceHeight - 1)) * sourceWidth * 4;
+        unsigned char* out = destination + static_cast<size_t>(y) * width * 4;
+
+        uint32_t x = 0;
+
+#ifdef MAMMOTH_MIPMAP_SSE2
+        // Two output texels (four source texels from each row) per iteration.
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i two = _mm_set1_epi16(2);
+
+        for(; x + 2 <= width && (x + 2) * 2 <= sourceWidth; x += 2) 
+        {
+            __m128i top = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+            __m128i bottom = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+
+            // Vertical sums, texels 0-1 and 2-3 as 16-bit channels.
+            __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+            __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+
+            // Horizontal sums: texel 0 + 1 and 2 + 3.
+            low = _mm_add_epi16(low, _mm_srli_si128(low, 8));
+            high = _mm_add_epi16(high, _mm_srli_si128(high, 8));
+
+            __m128i sum = _mm_unpacklo_epi64(low, high);
+            __m128i average = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x * 4), _mm_packus_epi16(average, zero));
+        }
+#endif
+
+        for(; x < width; x++) 
+        {
+            uint32_t x0 = std::min(x * 2, sourceWidth - 1);
+            uint32_t x1 = std::min(x * 2 + 1, sourceWidth - 1);
+
+            for(uint32_t c = 0; c < 4; c++) 
+            {
+                uint32_t sum = row0[x0 * 4 + c] + row0[x1 * 4 + c] + row1[x0 * 4 + c] + row1[x1 * 4 + c];
+                out[x * 4 + c] = static_cast<unsigned char>((sum + 2) >> 2);
+            }
+        }
+    }
+}
+
+void Image::GenerateMipmaps(ImageData& data) 
+{
+    MT_PROFILE_SCOPE("Image::GenerateMipmaps");
+
+    uint32_t levelCount = GetMipLevelCount(data.width, data.height);
+
+    data.levels.resize(1);
+    data.levels[0] = ImageLevel{0, static_cast<VkDeviceSize>(data.width) * data.height * 4, data.width, data.height};
+
+    VkDeviceSize totalSize = 0;
+    for(uint32_t i = 0; i < levelCount; i++) 
+    {
+        totalSize += static_cast<VkDeviceSize>(std::max(data.width >> i, 1u)) * std::max(data.height >> i, 1u) * 4;
+    }
+    data.pixels.resize(totalSize);
+
+    for(uint32_t i = 1; i < levelCount; i++) 
+    {
+        const ImageLevel& previous = data.levels[i - 1];
+
+        ImageLevel level{};
+        level.width = std::max(previous.width / 2, 1u);
+        level.height = std::max(previous.height / 2, 1u);
+        level.offset = previous.offset + previous.size;
+        level.size = static_cast<VkDeviceSize>(level.width) * level.height * 4;
+
+        DownsampleBox(data.pixels.data() + previous.offset, previous.width, previous.height, 
+            data.pixels.data() + level.offset, level.width, level.height);
+
+        data.levels.push_back(level);
+    }
 }
 
 Image::~Image() 
@@ -50,7 +336,7 @@ Image::~Image()
 }
 
 
-void Image::CreateImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory) 
+void Image::CreateImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory, const std::vector<ImageLevel>& levels) 
 {
     VkImageCreateInfo imageInfo{};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -58,7 +344,7 @@ void Image::CreateImage(uint32_t width, uint32_t height, VkFormat format, VkImag
     imageInfo.extent.width = static_cast<uint32_t>(width);
     imageInfo.extent.height = static_cast<uint32_t>(height);
     imageInfo.extent.depth = 1;
-    imageInfo.mipLevels = 1;
+    imageInfo.mipLevels = mMipLevels;
     imageInfo.arrayLayers = 1;
     imageInfo.format = format;
     imageInfo.tiling = tiling;
@@ -92,22 +378,103 @@ void Image::CreateImage(uint32_t width, uint32_t height, VkFormat format, VkImag
     //
     // Firstly, we tranition the image layout from undefined to the intermediate
     // "TRANSFER_DST_OPTIMAL" layout.
-    TransitionImageLayout(mImage, VK_FORMAT_R8G8B8A8_SRGB, 
+    TransitionImageLayout(mImage, format, 
         VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
-    CopyBufferToImage(mImageBuffer->GetBuffer(), mImage, 
-        static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+    CopyBufferToImage(mImageBuffer->GetBuffer(), mImage, levels);
 
     // Lastly, we transition the image layout to the layout type that's most optimal
-    // to be used as read only by the shaders.
-    TransitionImageLayout(mImage, VK_FORMAT_R8G8B8A8_SRGB, 
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    // to be used as read only by the shaders (blitting the missing mips does this as it goes).
+    if(mMipLevels > levels.size()) 
+    {
+        BlitMipmaps(width, height);
+    }
+    else {
+        TransitionImageLayout(mImage, format, 
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
 
 
     // Next, we create the imageView that will be used by descriptor sets.
     CreateTextureImageView(format);
 }
 
+void Image::BlitMipmaps(uint32_t width, uint32_t height) 
+{
+    VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.image = mImage;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.subresourceRange.levelCount = 1;
+
+    int32_t mipWidth = static_cast<int32_t>(width);
+    int32_t mipHeight = static_cast<int32_t>(height);
+
+    // Each level is blitted from the one above it, which is then done with and handed to the shaders.
+    for(uint32_t i = 1; i < mMipLevels; i++) 
+    {
+        barrier.subresourceRange.baseMipLevel = i - 1;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 
+            0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        int32_t nextWidth = std::max(mipWidth / 2, 1);
+        int32_t nextHeight = std::max(mipHeight / 2, 1);
+
+        VkImageBlit blit{};
+        blit.srcOffsets[0] = {0, 0, 0};
+        blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
+        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel = i - 1;
+        blit.srcSubresource.baseArrayLayer = 0;
+        blit.srcSubresource.layerCount = 1;
+        blit.dstOffsets[0] = {0, 0, 0};
+        blit.dstOffsets[1] = {nextWidth, nextHeight, 1};
+        blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.dstSubresource.mipLevel = i;
+        blit.dstSubresource.baseArrayLayer = 0;
+        blit.dstSubresource.layerCount = 1;
+
+        vkCmdBlitImage(commandBuffer, 
+            mImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 
+            mImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 
+            1, &blit, VK_FILTER_LINEAR);
+
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 
+            0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        mipWidth = nextWidth;
+        mipHeight = nextHeight;
+    }
+
+    // The smallest level was only ever written to.
+    barrier.subresourceRange.baseMipLevel = mMipLevels - 1;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 
+        0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    EndSingleTimeCommands(commandBuffer);
+}
+
 void Image::CreateTextureImageView(VkFormat format) 
 {
     VkImageViewCreateInfo viewInfo{};
@@ -117,7 +484,7 @@ void Image::CreateTextureImageView(VkFormat format)
     viewInfo.format = format;
     viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     viewInfo.subresourceRange.baseMipLevel = 0;
-    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.levelCount = mMipLevels;
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount = 1;
 
@@ -151,7 +518,7 @@ void Image::CreateTextureSampler()
     samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
     samplerInfo.mipLodBias = 0.0f;
     samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = 0.0f;
+    samplerInfo.maxLod = static_cast<float>(mMipLevels);
     // This may not be available on all devices, but in Device.cpp we already make
     // sure that the device does support anisotropy. 
     samplerInfo.anisotropyEnable = VK_FALSE;
@@ -168,15 +535,36 @@ void Image::CreateTextureSampler()
 // Utility functions.
 //
 VkCommandBuffer Image::BeginSingleTimeCommands() 
+{
+    if(mBatchCommandBuffer) 
+    {
+        return mBatchCommandBuffer;
+    }
+
+    return BeginCommands(mDevice);
+}
+
+void Image::EndSingleTimeCommands(VkCommandBuffer commandBuffer) 
+{
+    // Batches are submitted once, by UploadBatch().
+    if(commandBuffer == mBatchCommandBuffer) 
+    {
+        return;
+    }
+
+    SubmitCommands(mDevice, commandBuffer);
+}
+
+VkCommandBuffer Image::BeginCommands(Device& device) 
 {
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = mDevice.GetCommandPool();
+    allocInfo.commandPool = device.GetCommandPool();
     allocInfo.commandBufferCount = 1;
 
     VkCommandBuffer commandBuffer;
-    vkAllocateCommandBuffers(mDevice.GetDevice(), &allocInfo, &commandBuffer);
+    vkAllocateCommandBuffers(device.GetDevice(), &allocInfo, &commandBuffer);
 
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -187,7 +575,7 @@ VkCommandBuffer Image::BeginSingleTimeCommands()
     return commandBuffer;
 }
 
-void Image::EndSingleTimeCommands(VkCommandBuffer commandBuffer) 
+void Image::SubmitCommands(Device& device, VkCommandBuffer commandBuffer) 
 {
     vkEndCommandBuffer(commandBuffer);
 
@@ -196,10 +584,10 @@ void Image::EndSingleTimeCommands(VkCommandBuffer commandBuffer)
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffer;
 
-    vkQueueSubmit(mDevice.GetGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(mDevice.GetGraphicsQueue());
+    vkQueueSubmit(device.GetGraphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE);
+    vkQueueWaitIdle(device.GetGraphicsQueue());
 
-    vkFreeCommandBuffers(mDevice.GetDevice(), mDevice.GetCommandPool(), 1, &commandBuffer);
+    vkFreeCommandBuffers(device.GetDevice(), device.GetCommandPool(), 1, &commandBuffer);
 }
 
 void Image::TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout) 
@@ -215,7 +603,7 @@ void Image::TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout
     barrier.image = image;
     barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.levelCount = mMipLevels;
     barrier.subresourceRange.baseArrayLayer = 0;
     barrier.subresourceRange.layerCount = 1;
     barrier.srcAccessMask = 0; // TODO
@@ -282,5 +670,39 @@ void Image::CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, ui
     EndSingleTimeCommands(commandBuffer);
 }
 
+void Image::CopyBufferToImage(VkBuffer buffer, VkImage image, const std::vector<ImageLevel>& levels) 
+{
+    std::vector<VkBufferImageCopy> regions(levels.size());
+
+    for(uint32_t i = 0; i < levels.size(); i++) 
+    {
+        // Tightly packed, so row length and image height of 0 (the extent's) apply to blocks too.
+        regions[i].bufferOffset = levels[i].offset;
+        regions[i].bufferRowLength = 0;
+        regions[i].bufferImageHeight = 0;
+
+        regions[i].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        regions[i].imageSubresource.mipLevel = i;
+        regions[i].imageSubresource.baseArrayLayer = 0;
+        regions[i].imageSubresource.layerCount = 1;
+
+        regions[i].imageOffset = {0, 0, 0};
+        regions[i].imageExtent = {levels[i].width, levels[i].height, 1};
+    }
+
+    VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
+
+    vkCmdCopyBufferToImage(
+        commandBuffer,
+        buffer,
+        image,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        static_cast<uint32_t>(regions.size()),
+        regions.data()
+    );
+
+    EndSingleTimeCommands(commandBuffer);
+}
+
 
 }
\ No newline at end of file
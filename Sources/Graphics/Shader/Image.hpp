@@ -3,22 +3,116 @@
 
 #include <vulkan/vulkan.hpp>
 #include "Graphics/Buffers/UniformBuffer.hpp"
-#include "Device.hpp"
+#include "Graphics/Devices/Device.hpp"
+#include "Resources/Ktx2.hpp"
+#include "Resources/AssetPack.hpp"
 
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace mt 
 {
+
+struct ImageLevel 
+{
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+/**
+ * @brief Texel data ready to be uploaded: either RGBA8 pixels decoded from a PNG, or the
+ * blocks of a cooked KTX2 texture copied as is. Levels index into GetData(), largest first.
+*/
+struct ImageData 
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+    std::vector<ImageLevel> levels{};
+    std::vector<unsigned char> pixels{};
+
+    // Set instead of pixels when the texels are used in place from a mapped asset pack, which
+    // pack keeps alive until the upload is done.
+    const unsigned char* mapped = nullptr;
+    size_t mappedSize = 0;
+    std::shared_ptr<const AssetPack> pack = nullptr;
+
+    inline const unsigned char* GetData() const { return mapped ? mapped : pixels.data(); }
+    inline size_t GetSize() const { return mapped ? mappedSize : pixels.size(); }
+};
+
 class Image 
 {
 public:
     Image(Device& device, std::string imagePath);
+    Image(Device& device, const ImageData& data);
+
+    /**
+     * @brief Records the upload (layout transitions, copies and mip blits) into commandBuffer
+     * instead of submitting and waiting on it, so the image can't be used until the caller has
+     * submitted commandBuffer and it has finished. See UploadBatch().
+    */
+    Image(Device& device, const ImageData& data, VkCommandBuffer commandBuffer);
     ~Image();
 
+    /**
+     * @brief Creates every image with a single submission and a single wait, instead of the
+     * handful per image that the constructors need. This is what loading a whole level goes
+     * through (see ResourceManager::SetImageBatchUploader()). Main thread only.
+    */
+    static std::vector<std::unique_ptr<Image>> UploadBatch(Device& device, const std::vector<const ImageData*>& images);
+
+    /**
+     * @brief Reads and decodes an image file without touching the device, so unlike the 
+     * constructors this is safe to call from any thread (the asset loader runs it on workers).
+     * Cooked versions of the image (see Tools/TextureCooker) are tried first, in the order given,
+     * before falling back to decoding the file itself. Throws if nothing could be loaded.
+     * @param codecs Usually the result of GetSupportedCodecs().
+     * @param generateMipmaps Builds the mip chain of decoded source files on the CPU, for devices
+     * that can't blit it (see SupportsLinearBlit()). Cooked textures already have theirs.
+     * @param pack Looked in before the filesystem. Uncompressed cooked textures aren't copied out
+     * of it, the returned data points straight into the mapping.
+    */
+    static ImageData Decode(const std::string& imagePath, const std::vector<TextureCodec>& codecs = {}, bool generateMipmaps = false, 
+        const std::shared_ptr<const AssetPack>& pack = nullptr);
+
+    /**
+     * @brief Returns the compressed codecs the device can sample from, best first. RGBA8 is
+     * always supported and so never included.
+    */
+    static std::vector<TextureCodec> GetSupportedCodecs(VkPhysicalDevice physicalDevice);
+
+    /**
+     * @brief Whether mips of this format can be generated on the GPU with linear vkCmdBlitImage().
+    */
+    static bool SupportsLinearBlit(VkPhysicalDevice physicalDevice, VkFormat format);
+
+    /**
+     * @brief Appends the rest of the mip chain to a single level RGBA8 image, using a 2x2 box
+     * filter (SSE2 where available).
+    */
+    static void GenerateMipmaps(ImageData& data);
+
+    /**
+     * @return The number of levels in a full mip chain, down to 1x1.
+    */
+    static uint32_t GetMipLevelCount(uint32_t width, uint32_t height);
+
     // Getters
     //
     inline std::unique_ptr<UniformBuffer>& GetUniformBuffer() {return mImageBuffer; }
 
+    /**
+     * @brief What a combined image sampler descriptor needs to sample the image in shaders.
+    */
+    inline VkDescriptorImageInfo GetDescriptorImageInfo() const 
+    {
+        return VkDescriptorImageInfo{mImageSampler, mImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    }
+
     // Utility functions for creating submitting commands before the main rendering loop
     // to change the image layout of an image.
     // note: "SingleTimeCommands" - this has no effect on the main rendering command buffer.
@@ -27,9 +121,15 @@ public:
     void EndSingleTimeCommands(VkCommandBuffer);
     void TransitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
     void CopyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
+    void CopyBufferToImage(VkBuffer buffer, VkImage image, const std::vector<ImageLevel>& levels);
 
 private:
-    void CreateImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
+    // Allocates and begins a one time submit command buffer / ends, submits and waits on it.
+    static VkCommandBuffer BeginCommands(Device& device);
+    static void SubmitCommands(Device& device, VkCommandBuffer commandBuffer);
+
+    void CreateImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory, const std::vector<ImageLevel>& levels);
+    void BlitMipmaps(uint32_t width, uint32_t height);
     void CreateTextureImageView(VkFormat format);
     void CreateTextureSampler();
     Device& mDevice;
@@ -40,6 +140,10 @@ private:
     VkImageView mImageView = VK_NULL_HANDLE;
     VkSampler mImageSampler = VK_NULL_HANDLE;
     VkDeviceMemory mImageMemory = VK_NULL_HANDLE;
+    uint32_t mMipLevels = 1;
+
+    // Only set while a batched upload is being recorded.
+    VkCommandBuffer mBatchCommandBuffer = VK_NULL_HANDLE;
 };
 }
 
@@ -1,50 +1,94 @@
 #include "Shader.hpp"
+#include "EmbeddedShaders.hpp"
 #include <fstream>
-#include <cassert>
+#include <stdexcept>
 
 namespace mt 
 {
+
+static bool sUseEmbeddedShaders = true;
+
 Shader::Shader(Device& device, const char* vertSrc, const char* fragSrc)
     : mDevice{device}
 {
     CreateShaderStages(vertSrc, fragSrc);
 }
 
+Shader::Shader(Device& device, const char* compSrc)
+    : mDevice{device}
+{
+    CreateComputeStage(compSrc);
+}
+
 Shader::~Shader() 
 {
     vkDestroyShaderModule(mDevice.GetDevice(), mVertexModule, nullptr);
     vkDestroyShaderModule(mDevice.GetDevice(), mFragmentModule, nullptr);
+    vkDestroyShaderModule(mDevice.GetDevice(), mComputeModule, nullptr);
 }
 
-void Shader::ParseGLSL(const char* filePath) 
+void Shader::SetEmbeddedShadersEnabled(bool enabled) 
 {
-
+    sUseEmbeddedShaders = enabled;
 }
 
-const std::vector<char> Shader::ReadFromFile(const char* filePath) const 
+const std::vector<uint32_t> Shader::ReadFromFile(const char* filePath) const 
 {
     std::ifstream file{filePath, std::ios::ate | std::ios::binary};
 
-    assert(file.is_open() && "File could not be opened!"); // check for errors - if thrown, double check file path.
+    if(!file.is_open()) 
+    {
+        throw std::runtime_error(std::string("Failed to open shader ") + filePath + " (check the working directory)!");
+    }
 
     size_t fileSize = static_cast<size_t>(file.tellg());
 
-    std::vector<char> buffer(fileSize);
+    if(fileSize == 0 || fileSize % sizeof(uint32_t) != 0) 
+    {
+        throw std::runtime_error(std::string(filePath) + " isn't a valid SPIR-V binary!");
+    }
+
+    // Read straight into words, since pCode has to be 4 byte aligned.
+    std::vector<uint32_t> buffer(fileSize / sizeof(uint32_t));
 
     file.seekg(0);
-    file.read(buffer.data(), fileSize);
+    file.read(reinterpret_cast<char*>(buffer.data()), fileSize);
 
     file.close();
 
     return buffer;
 }
 
-void Shader::CreateShaderModule(const std::vector<char> code, VkShaderModule* module) 
+void Shader::CreateShaderModule(const char* filePath, VkShaderModule* module) 
+{
+    if(sUseEmbeddedShaders) 
+    {
+        if(const EmbeddedShader* embedded = FindEmbeddedShader(filePath)) 
+        {
+            CreateShaderModule(embedded->code, embedded->wordCount, module);
+            MergeShaderReflection(mReflection, ReflectShader(embedded->code, embedded->wordCount));
+            return;
+        }
+    }
+
+    auto code = ReadFromFile(filePath);
+    CreateShaderModule(code.data(), code.size(), module);
+    MergeShaderReflection(mReflection, ReflectShader(code.data(), code.size()));
+}
+
+void Shader::CreateShaderModule(const uint32_t* code, size_t wordCount, VkShaderModule* module) 
 {
+    // FNV-1a over every stage in turn.
+    for(size_t i = 0; i < wordCount; i++) 
+    {
+        mId ^= code[i];
+        mId *= 1099511628211ull;
+    }
+
     VkShaderModuleCreateInfo createInfo{};
-    createInfo.codeSize = code.size();
+    createInfo.codeSize = wordCount * sizeof(uint32_t);
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+    createInfo.pCode = code;
 
     if(vkCreateShaderModule(mDevice.GetDevice(), &createInfo, nullptr, module) != VK_SUCCESS) 
     {
@@ -55,12 +99,8 @@ void Shader::CreateShaderModule(const std::vector<char> code, VkShaderModule* mo
 
 void Shader::CreateShaderStages(const char* vertSrc, const char* fragSrc) 
 {
-    auto vertCode = ReadFromFile(vertSrc);
-    auto fragCode = ReadFromFile(fragSrc);
-
-
-    CreateShaderModule(vertCode, &mVertexModule);
-    CreateShaderModule(fragCode, &mFragmentModule);
+    CreateShaderModule(vertSrc, &mVertexModule);
+    CreateShaderModule(fragSrc, &mFragmentModule);
 
     // Vertex shader.
     //
@@ -86,4 +126,19 @@ void Shader::CreateShaderStages(const char* vertSrc, const char* fragSrc)
     mStages.push_back(std::move(fragment));
 
 }
+
+void Shader::CreateComputeStage(const char* compSrc) 
+{
+    CreateShaderModule(compSrc, &mComputeModule);
+
+    VkPipelineShaderStageCreateInfo compute{};
+    compute.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    compute.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    compute.module = mComputeModule;
+    compute.pName = "main";
+    compute.flags = 0;
+    compute.pSpecializationInfo = nullptr;
+    compute.pNext = nullptr;
+    mStages.push_back(std::move(compute));
+}
 }
\ No newline at end of file
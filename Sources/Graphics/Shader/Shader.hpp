@@ -1,37 +1,70 @@
 #pragma once
 #include <vulkan/vulkan.hpp>
-#include "Device.hpp"
+#include "Graphics/Devices/Device.hpp"
 #include "VertexInput.hpp"
 #include "Uniform.hpp"
-#include "Constant.hpp"
-
-#include <Cross/spirv_glsl.hpp>
+#include "ShaderReflection.hpp"
 
 namespace mt 
 {
 class Shader 
 {
 public:
+    /**
+     * @param vertSrc, fragSrc Paths to the compiled stages. Shaders embedded in the library
+     * (see EmbeddedShaders.hpp) are looked up by file name first, and only missing ones are
+     * read from disk. Throws if a stage can't be found or isn't valid SPIR-V.
+    */
     Shader(Device& device, const char* vertSrc, const char* fragSrc);
 
+    /**
+     * @brief A compute shader, found the same way as the graphics stages.
+    */
+    Shader(Device& device, const char* compSrc);
+
     ~Shader();
 
     inline const std::vector<VkPipelineShaderStageCreateInfo>& GetShaderStages() const {return mStages; } 
 
-    static void ParseGLSL(const char* filePath);
+    /**
+     * @brief The resources, push constants and vertex inputs of every stage, reflected from the
+     * SPIR-V when the shader was created. Pipelines build their layouts from this.
+    */
+    inline const ShaderReflection& GetReflection() const { return mReflection; }
+
+    /**
+     * @brief A hash of the SPIR-V of every stage: shaders with the same code have the same id,
+     * however many times they're loaded. PipelineCache keys on this.
+    */
+    inline uint64_t GetId() const { return mId; }
+
+    /**
+     * @brief Turning this off makes every shader load from disk, which is what hot reloading
+     * needs (the embedded copies are only as recent as the last build). On by default.
+    */
+    static void SetEmbeddedShadersEnabled(bool enabled);
 
 private:
-    const std::vector<char> ReadFromFile(const char* filePath) const;
+    const std::vector<uint32_t> ReadFromFile(const char* filePath) const;
 
-    void CreateShaderModule(const std::vector<char> code, VkShaderModule* module);
+    // Also merges the stage into mReflection.
+    void CreateShaderModule(const char* filePath, VkShaderModule* module);
+
+    void CreateShaderModule(const uint32_t* code, size_t wordCount, VkShaderModule* module);
 
     void CreateShaderStages(const char* vertSrc, const char* fragSrc);
+    void CreateComputeStage(const char* compSrc);
 
 private:
     Device& mDevice;
 
     VkShaderModule mVertexModule = VK_NULL_HANDLE;
     VkShaderModule mFragmentModule = VK_NULL_HANDLE;
+    VkShaderModule mComputeModule = VK_NULL_HANDLE;
     std::vector<VkPipelineShaderStageCreateInfo> mStages{};
+
+    ShaderReflection mReflection{};
+
+    uint64_t mId = 14695981039346656037ull;
 };
 }
\ No newline at end of file
@@ -0,0 +1,319 @@
+#include "ShaderReflection.hpp"
+
+#include <Cross/spirv_cross_c.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace mt
+{
+
+// Helper Functions.
+//---
+
+// Frees everything SPIRV-Cross allocated, whichever way ReflectShader() leaves.
+struct ReflectionContext
+{
+    spvc_context context = nullptr;
+
+    ~ReflectionContext()
+    {
+        if(context)
+        {
+            spvc_context_destroy(context);
+        }
+    }
+
+    void Check(spvc_result result) const
+    {
+        if(result != SPVC_SUCCESS)
+        {
+            throw std::runtime_error(std::string("Failed to reflect shader: ") + spvc_context_get_last_error_string(context));
+        }
+    }
+};
+
+static VkShaderStageFlags GetShaderStage(SpvExecutionModel model)
+{
+    switch(model)
+    {
+        case SpvExecutionModelVertex: return VK_SHADER_STAGE_VERTEX_BIT;
+        case SpvExecutionModelFragment: return VK_SHADER_STAGE_FRAGMENT_BIT;
+        case SpvExecutionModelGLCompute: return VK_SHADER_STAGE_COMPUTE_BIT;
+        case SpvExecutionModelGeometry: return VK_SHADER_STAGE_GEOMETRY_BIT;
+        case SpvExecutionModelTessellationControl: return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+        case SpvExecutionModelTessellationEvaluation: return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+        default: throw std::runtime_error("Failed to reflect shader: unsupported execution model!");
+    }
+}
+
+static VkFormat GetVertexFormat(spvc_basetype type, uint32_t components)
+{
+    static constexpr VkFormat floats[] = {VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT};
+    static constexpr VkFormat ints[] = {VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT};
+    static constexpr VkFormat uints[] = {VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT};
+
+    if(components < 1 || components > 4)
+    {
+        throw std::runtime_error("Failed to reflect shader: vertex input with an invalid vector size!");
+    }
+
+    switch(type)
+    {
+        case SPVC_BASETYPE_FP32: return floats[components - 1];
+        case SPVC_BASETYPE_INT32: return ints[components - 1];
+        case SPVC_BASETYPE_UINT32: return uints[components - 1];
+        default: throw std::runtime_error("Failed to reflect shader: vertex inputs must be 32 bit floats or integers!");
+    }
+}
+
+static uint32_t GetArraySize(spvc_type type)
+{
+    uint32_t count = 1;
+
+    for(unsigned i = 0; i < spvc_type_get_num_array_dimensions(type); i++)
+    {
+        SpvId size = spvc_type_get_array_dimension(type, i);
+
+        // Sized by a specialisation constant (not literal), or a runtime array (0).
+        if(!spvc_type_array_dimension_is_literal(type, i) || size == 0)
+        {
+            throw std::runtime_error("Failed to reflect shader: descriptor arrays must have a fixed size!");
+        }
+        count *= size;
+    }
+
+    return count;
+}
+
+static void ReflectBindings(ReflectionContext& reflection, spvc_compiler compiler, spvc_resources resources, ShaderReflection& result)
+{
+    static constexpr struct
+    {
+        spvc_resource_type resource;
+        VkDescriptorType descriptor;
+        VkDescriptorType texelBuffer;   // When the image's dimension is Buffer.
+    } types[] = {
+        {SPVC_RESOURCE_TYPE_UNIFORM_BUFFER, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER},
+        {SPVC_RESOURCE_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER},
+        {SPVC_RESOURCE_TYPE_SAMPLED_IMAGE, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER},
+        {SPVC_RESOURCE_TYPE_SEPARATE_IMAGE, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER},
+        {SPVC_RESOURCE_TYPE_SEPARATE_SAMPLERS, VK_DESCRIPTOR_TYPE_SAMPLER, VK_DESCRIPTOR_TYPE_SAMPLER},
+        {SPVC_RESOURCE_TYPE_STORAGE_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER},
+        {SPVC_RESOURCE_TYPE_SUBPASS_INPUT, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT}
+    };
+
+    for(const auto& type : types)
+    {
+        const spvc_reflected_resource* list = nullptr;
+        size_t count = 0;
+        reflection.Check(spvc_resources_get_resource_list_for_type(resources, type.resource, &list, &count));
+
+        for(size_t i = 0; i < count; i++)
+        {
+            spvc_type handle = spvc_compiler_get_type_handle(compiler, list[i].type_id);
+
+            bool isImage = type.resource != SPVC_RESOURCE_TYPE_UNIFORM_BUFFER && type.resource != SPVC_RESOURCE_TYPE_STORAGE_BUFFER &&
+                type.resource != SPVC_RESOURCE_TYPE_SEPARATE_SAMPLERS;
+
+            ShaderBinding binding{};
+            binding.set = spvc_compiler_get_decoration(compiler, list[i].id, SpvDecorationDescriptorSet);
+            binding.binding = spvc_compiler_get_decoration(compiler, list[i].id, SpvDecorationBinding);
+            binding.type = isImage && spvc_type_get_image_dimension(handle) == SpvDimBuffer ? type.texelBuffer : type.descriptor;
+            binding.count = GetArraySize(handle);
+            binding.stages = result.stages;
+
+            result.bindings.push_back(binding);
+        }
+    }
+
+    std::sort(result.bindings.begin(), result.bindings.end(), [](const ShaderBinding& a, const ShaderBinding& b)
+    {
+        return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+    });
+}
+
+static void ReflectPushConstants(ReflectionContext& reflection, spvc_compiler compiler, spvc_resources resources, ShaderReflection& result)
+{
+    const spvc_reflected_resource* list = nullptr;
+    size_t count = 0;
+    reflection.Check(spvc_resources_get_resource_list_for_type(resources, SPVC_RESOURCE_TYPE_PUSH_CONSTANT, &list, &count));
+
+    // There can only be one push constant block per stage.
+    if(count == 0)
+    {
+        return;
+    }
+
+    spvc_type type = spvc_compiler_get_type_handle(compiler, list[0].base_type_id);
+
+    size_t size = 0;
+    reflection.Check(spvc_compiler_get_declared_struct_size(compiler, type, &size));
+
+    // Blocks can start part way in, when a stage only declares the members it uses.
+    unsigned offset = 0;
+    if(spvc_type_get_num_member_types(type) > 0)
+    {
+        reflection.Check(spvc_compiler_type_struct_member_offset(compiler, type, 0, &offset));
+    }
+
+    VkPushConstantRange range{};
+    range.stageFlags = result.stages;
+    range.offset = offset;
+    range.size = static_cast<uint32_t>(size) - offset;
+
+    result.pushConstants.push_back(range);
+}
+
+static void ReflectVertexInputs(ReflectionContext& reflection, spvc_compiler compiler, spvc_resources resources, ShaderReflection& result)
+{
+    const spvc_reflected_resource* list = nullptr;
+    size_t count = 0;
+    reflection.Check(spvc_resources_get_resource_list_for_type(resources, SPVC_RESOURCE_TYPE_STAGE_INPUT, &list, &count));
+
+    for(size_t i = 0; i < count; i++)
+    {
+        if(spvc_compiler_has_decoration(compiler, list[i].id, SpvDecorationBuiltIn))
+        {
+            continue;
+        }
+
+        spvc_type type = spvc_compiler_get_type_handle(compiler, list[i].type_id);
+        uint32_t location = spvc_compiler_get_decoration(compiler, list[i].id, SpvDecorationLocation);
+        VkFormat format = GetVertexFormat(spvc_type_get_basetype(type), spvc_type_get_vector_size(type));
+
+        // Matrices take up one location per column.
+        for(unsigned column = 0; column < std::max(spvc_type_get_columns(type), 1u); column++)
+        {
+            result.vertexAttributes.push_back(ShaderVertexAttribute{location + column, format});
+        }
+    }
+
+    std::sort(result.vertexAttributes.begin(), result.vertexAttributes.end(), [](const ShaderVertexAttribute& a, const ShaderVertexAttribute& b)
+    {
+        return a.location < b.location;
+    });
+}
+
+//---
+
+uint32_t ShaderReflection::GetSetCount() const
+{
+    // Bindings are sorted, so the last one has the highest set.
+    return bindings.empty() ? 0 : bindings.back().set + 1;
+}
+
+ShaderReflection ReflectShader(const uint32_t* code, size_t wordCount)
+{
+    ReflectionContext reflection{};
+    if(spvc_context_create(&reflection.context) != SPVC_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create a SPIRV-Cross context!");
+    }
+
+    spvc_parsed_ir ir = nullptr;
+    reflection.Check(spvc_context_parse_spirv(reflection.context, code, wordCount, &ir));
+
+    spvc_compiler compiler = nullptr;
+    reflection.Check(spvc_context_create_compiler(reflection.context, SPVC_BACKEND_NONE, ir, SPVC_CAPTURE_MODE_TAKE_OWNERSHIP, &compiler));
+
+    spvc_resources resources = nullptr;
+    reflection.Check(spvc_compiler_create_shader_resources(compiler, &resources));
+
+    ShaderReflection result{};
+    result.stages = GetShaderStage(spvc_compiler_get_execution_model(compiler));
+
+    ReflectBindings(reflection, compiler, resources, result);
+    ReflectPushConstants(reflection, compiler, resources, result);
+
+    if(result.stages == VK_SHADER_STAGE_VERTEX_BIT)
+    {
+        ReflectVertexInputs(reflection, compiler, resources, result);
+    }
+
+    return result;
+}
+
+void MergeShaderReflection(ShaderReflection& pipeline, const ShaderReflection& stage)
+{
+    pipeline.stages |= stage.stages;
+
+    for(const auto& binding : stage.bindings)
+    {
+        auto existing = std::lower_bound(pipeline.bindings.begin(), pipeline.bindings.end(), binding, [](const ShaderBinding& a, const ShaderBinding& b)
+        {
+            return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+        });
+
+        if(existing == pipeline.bindings.end() || existing->set != binding.set || existing->binding != binding.binding)
+        {
+            pipeline.bindings.insert(existing, binding);
+            continue;
+        }
+
+        if(existing->type != binding.type)
+        {
+            throw std::runtime_error("Shader stages disagree on the type of set " + std::to_string(binding.set) +
+                ", binding " + std::to_string(binding.binding) + "!");
+        }
+
+        existing->count = std::max(existing->count, binding.count);
+        existing->stages |= binding.stages;
+    }
+
+    for(const auto& range : stage.pushConstants)
+    {
+        if(pipeline.pushConstants.empty())
+        {
+            pipeline.pushConstants.push_back(range);
+            continue;
+        }
+
+        VkPushConstantRange& merged = pipeline.pushConstants[0];
+        uint32_t end = std::max(merged.offset + merged.size, range.offset + range.size);
+
+        merged.offset = std::min(merged.offset, range.offset);
+        merged.size = end - merged.offset;
+        merged.stageFlags |= range.stageFlags;
+    }
+
+    if(!stage.vertexAttributes.empty())
+    {
+        pipeline.vertexAttributes = stage.vertexAttributes;
+    }
+}
+
+std::vector<VkDescriptorPoolSize> GetDescriptorPoolSizes(const ShaderReflection& reflection, uint32_t setCount)
+{
+    std::vector<VkDescriptorPoolSize> sizes{};
+
+    for(const auto& binding : reflection.bindings)
+    {
+        auto existing = std::find_if(sizes.begin(), sizes.end(), [&](const VkDescriptorPoolSize& size) { return size.type == binding.type; });
+
+        if(existing == sizes.end())
+        {
+            sizes.push_back(VkDescriptorPoolSize{binding.type, 0});
+            existing = sizes.end() - 1;
+        }
+
+        existing->descriptorCount += binding.count * setCount;
+    }
+
+    return sizes;
+}
+
+uint32_t GetVertexFormatSize(VkFormat format)
+{
+    switch(format)
+    {
+        case VK_FORMAT_R32_SFLOAT: case VK_FORMAT_R32_SINT: case VK_FORMAT_R32_UINT: return 4;
+        case VK_FORMAT_R32G32_SFLOAT: case VK_FORMAT_R32G32_SINT: case VK_FORMAT_R32G32_UINT: return 8;
+        case VK_FORMAT_R32G32B32_SFLOAT: case VK_FORMAT_R32G32B32_SINT: case VK_FORMAT_R32G32B32_UINT: return 12;
+        case VK_FORMAT_R32G32B32A32_SFLOAT: case VK_FORMAT_R32G32B32A32_SINT: case VK_FORMAT_R32G32B32A32_UINT: return 16;
+        default: return 0;
+    }
+}
+
+}
@@ -0,0 +1,72 @@
+#ifndef MAMMOTH_2D_SHADER_REFLECTION_HPP
+#define MAMMOTH_2D_SHADER_REFLECTION_HPP
+
+#include <vulkan/vulkan.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mt
+{
+
+struct ShaderBinding
+{
+    uint32_t set = 0;
+    uint32_t binding = 0;
+    VkDescriptorType type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    uint32_t count = 1;                 // Array size, 1 when it isn't an array.
+    VkShaderStageFlags stages = 0;
+};
+
+struct ShaderVertexAttribute
+{
+    uint32_t location = 0;
+    VkFormat format = VK_FORMAT_UNDEFINED;
+};
+
+/**
+ * @brief Everything a pipeline layout needs to know about a shader, read from its SPIR-V
+ * rather than written out by hand next to the GLSL.
+*/
+struct ShaderReflection
+{
+    VkShaderStageFlags stages = 0;
+    std::vector<ShaderBinding> bindings{};                  // Sorted by set, then binding.
+    std::vector<VkPushConstantRange> pushConstants{};
+    std::vector<ShaderVertexAttribute> vertexAttributes{};  // Vertex stage only, sorted by location.
+
+    /**
+     * @return One past the highest set used, i.e: how many set layouts the pipeline layout needs.
+    */
+    uint32_t GetSetCount() const;
+};
+
+/**
+ * @brief Reflects a single stage with SPIRV-Cross. Doesn't touch the device, so it's safe to
+ * call from any thread. Throws if the code isn't valid SPIR-V or uses an unbounded
+ * (runtime sized) descriptor array.
+*/
+ShaderReflection ReflectShader(const uint32_t* code, size_t wordCount);
+
+/**
+ * @brief Merges one stage into the reflection of a whole pipeline. Resources both stages use
+ * end up visible to both, and push constant blocks are combined into a single range covering
+ * every stage (so one vkCmdPushConstants() call updates it). Throws if the stages disagree on
+ * the type of a binding.
+*/
+void MergeShaderReflection(ShaderReflection& pipeline, const ShaderReflection& stage);
+
+/**
+ * @brief Exactly the descriptors needed to allocate setCount copies of every set.
+*/
+std::vector<VkDescriptorPoolSize> GetDescriptorPoolSizes(const ShaderReflection& reflection, uint32_t setCount = 1);
+
+/**
+ * @return The size in bytes of a vertex attribute format (0 for anything reflection can't produce).
+*/
+uint32_t GetVertexFormatSize(VkFormat format);
+
+}
+
+#endif
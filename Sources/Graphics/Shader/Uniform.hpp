@@ -1,7 +1,7 @@
 #ifndef MAMMOTH_2D_UNIFORM_HPP
 #define MAMMOTH_2D_UNIFORM_HPP
 
-#include "Device.hpp"
+#include "Graphics/Devices/Device.hpp"
 #include "Graphics/Buffers/UniformBuffer.hpp"
 
 #include <glm/glm.hpp>
@@ -2,6 +2,7 @@
 #define MAMMOTH_2D_VERTEX_INPUT_HPP
 
 #include "Graphics/Buffers/BufferLayout.hpp"
+#include "ShaderReflection.hpp"
 #include "Logging.hpp"
 #include <vulkan/vulkan.hpp>
 
@@ -39,6 +40,36 @@ public:
             mAttribDescriptions.push_back(attribDesc);
         }
     }
+
+    /**
+     * @brief The vertex input a shader expects (see ShaderReflection), as one interleaved buffer
+     * with the attributes packed in location order.
+    */
+    VertexInput(const std::vector<ShaderVertexAttribute>& attributes) 
+    {
+        VkVertexInputBindingDescription bindingDesc{};
+        bindingDesc.binding = 0;
+        bindingDesc.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+        for(const auto& attribute : attributes) 
+        {
+            VkVertexInputAttributeDescription attribDesc{};
+            attribDesc.binding = 0;
+            attribDesc.format = attribute.format;
+            attribDesc.offset = bindingDesc.stride;
+            attribDesc.location = attribute.location;
+
+            mAttribDescriptions.push_back(attribDesc);
+            bindingDesc.stride += GetVertexFormatSize(attribute.format);
+        }
+
+        // A vertex shader without inputs (e.g: a fullscreen triangle) doesn't bind any buffer.
+        if(!attributes.empty()) 
+        {
+            mBindingDescriptions.push_back(bindingDesc);
+        }
+    }
+
     ~VertexInput() {}
 
     inline const std::vector<VkVertexInputBindingDescription>& GetBindingDescriptions() const { return mBindingDescriptions; }
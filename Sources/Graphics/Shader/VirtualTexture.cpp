@@ -0,0 +1,454 @@
+#include "VirtualTexture.hpp"
+#include "Graphics/Renderer/SwapChain.hpp"
+#include "Logging.hpp"
+#include "Profiler/Profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace mt
+{
+
+// Shared with the worker reading the page, which only ever touches this.
+struct VirtualTexture::PendingPage
+{
+    enum Stage : uint8_t
+    {
+        Loading = 0,
+        Loaded = 1,
+        Failed = 2
+    };
+
+    uint32_t page = 0;
+    uint32_t slot = 0;
+    std::atomic<uint8_t> stage{Loading};
+    std::vector<uint8_t> texels{};
+    std::string error = "";
+};
+
+// Helper Functions.
+//---
+
+// The smallest maxImageDimension2D Vulkan allows, so the atlas fits on every device.
+static constexpr uint32_t MAX_ATLAS_SIZE = 4096;
+
+static uint32_t NextPowerOfTwo(uint32_t value)
+{
+    uint32_t result = 1;
+    while(result < value)
+    {
+        result *= 2;
+    }
+    return result;
+}
+
+//---
+
+uint32_t VirtualTexture::GetAtlasColumns(const VirtualTextureLayout& layout, VkDeviceSize budget)
+{
+    uint32_t slotSize = layout.GetStoredPageSize();
+    uint64_t slots = std::max<uint64_t>(budget / layout.GetPageBytes(), 1);
+
+    // Square-ish, and the page table addresses slots with 8 bits per axis.
+    uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(slots))));
+    return std::max(std::min({columns, MAX_ATLAS_SIZE / slotSize, 255u}), 1u);
+}
+
+uint32_t VirtualTexture::GetAtlasRows(const VirtualTextureLayout& layout, VkDeviceSize budget, uint32_t columns)
+{
+    uint64_t slots = std::max<uint64_t>(budget / layout.GetPageBytes(), 1);
+    uint64_t rows = (slots + columns - 1) / columns;
+
+    return static_cast<uint32_t>(std::min<uint64_t>({rows, MAX_ATLAS_SIZE / layout.GetStoredPageSize(), 255}));
+}
+
+VirtualTexture::VirtualTexture(LogicalDevice& logicalDevice, JobSystem& jobSystem, const std::string& path,
+    const std::shared_ptr<const AssetPack>& pack, VkDeviceSize budget, uint32_t uploadsPerFrame)
+    : mLogicalDevice{logicalDevice}, mJobSystem{jobSystem}, mFile{std::make_unique<VirtualTextureFile>(path, pack)},
+      mUploadsPerFrame{std::max(uploadsPerFrame, 1u)},
+      mColumns{GetAtlasColumns(mFile->GetLayout(), budget)},
+      mRows{GetAtlasRows(mFile->GetLayout(), budget, mColumns)},
+      mCache{mFile->GetLayout(), mColumns * mRows}
+{
+    const VirtualTextureLayout& layout = mFile->GetLayout();
+
+    // Power of two, so that halving it level by level always leaves room for every page.
+    mTableWidth = NextPowerOfTwo(layout.levels[0].pagesX);
+    mTableHeight = NextPowerOfTwo(layout.levels[0].pagesY);
+
+    mFailedPages.assign(layout.pageCount, 0);
+
+    CreateImages();
+    CreateSamplers();
+
+    VkDeviceSize tableSize = 0;
+    for(uint32_t level = 0; level < layout.levels.size(); level++)
+    {
+        tableSize += static_cast<VkDeviceSize>(std::max(mTableWidth >> level, 1u)) * std::max(mTableHeight >> level, 1u) * 4;
+    }
+
+    mStagingFrameSize = static_cast<VkDeviceSize>(mUploadsPerFrame) * layout.GetPageBytes() + tableSize;
+
+    mLogicalDevice.CreateBuffer(mStagingFrameSize * SwapChain::FRAMES_IN_FLIGHT, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, mStaging, mStagingMemory);
+
+    void* mapped = nullptr;
+    vkMapMemory(mLogicalDevice.GetDevice(), mStagingMemory, 0, VK_WHOLE_SIZE, 0, &mapped);
+    mStagingData = static_cast<uint8_t*>(mapped);
+
+    float atlasWidth = static_cast<float>(mColumns * layout.GetStoredPageSize());
+    float atlasHeight = static_cast<float>(mRows * layout.GetStoredPageSize());
+
+    mPushConstant.virtualInfo = glm::vec4(layout.width, layout.height, layout.levels.size(), layout.pageSize);
+    mPushConstant.atlasInfo = glm::vec4(layout.border, layout.GetStoredPageSize(), 1.0f / atlasWidth, 1.0f / atlasHeight);
+
+    MT_LOG_INFO("Virtual texture {} ({}x{}, {} pages) streams through {} slots", path, layout.width, layout.height,
+        layout.pageCount, mCache.GetSlotCount());
+}
+
+VirtualTexture::~VirtualTexture()
+{
+    // In-flight reads still point at the file.
+    mJobSystem.Wait(mLoadCounter);
+
+    VkDevice device = mLogicalDevice.GetDevice();
+
+    vkUnmapMemory(device, mStagingMemory);
+    vkDestroyBuffer(device, mStaging, nullptr);
+    vkFreeMemory(device, mStagingMemory, nullptr);
+
+    vkDestroySampler(device, mPageTableSampler, nullptr);
+    vkDestroyImageView(device, mPageTableView, nullptr);
+    vkDestroyImage(device, mPageTable, nullptr);
+    vkFreeMemory(device, mPageTableMemory, nullptr);
+
+    vkDestroySampler(device, mAtlasSampler, nullptr);
+    vkDestroyImageView(device, mAtlasView, nullptr);
+    vkDestroyImage(device, mAtlas, nullptr);
+    vkFreeMemory(device, mAtlasMemory, nullptr);
+}
+
+void VirtualTexture::CreateImages()
+{
+    const VirtualTextureLayout& layout = mFile->GetLayout();
+
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.extent.width = mColumns * layout.GetStoredPageSize();
+    imageInfo.extent.height = mRows * layout.GetStoredPageSize();
+    imageInfo.extent.depth = 1;
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    mLogicalDevice.CreateImageFromInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mAtlas, mAtlasMemory);
+
+    // Integer, so it's only ever fetched (never filtered) and entries come back exactly.
+    imageInfo.extent.width = mTableWidth;
+    imageInfo.extent.height = mTableHeight;
+    imageInfo.mipLevels = static_cast<uint32_t>(layout.levels.size());
+    imageInfo.format = VK_FORMAT_R8G8B8A8_UINT;
+
+    mLogicalDevice.CreateImageFromInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, mPageTable, mPageTableMemory);
+
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = mAtlas;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = VK_FORMAT_R8G8B8A8_SRGB;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+
+    if(vkCreateImageView(mLogicalDevice.GetDevice(), &viewInfo, nullptr, &mAtlasView) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create virtual texture atlas view!");
+    }
+
+    viewInfo.image = mPageTable;
+    viewInfo.format = VK_FORMAT_R8G8B8A8_UINT;
+    viewInfo.subresourceRange.levelCount = imageInfo.mipLevels;
+
+    if(vkCreateImageView(mLogicalDevice.GetDevice(), &viewInfo, nullptr, &mPageTableView) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create virtual texture page table view!");
+    }
+
+    // An empty page table (nothing resident) until the first Update().
+    VkCommandBuffer commandBuffer = mLogicalDevice.BeginSingleTimeCommands();
+
+    VkImageMemoryBarrier barriers[2]{};
+    for(uint32_t i = 0; i < 2; i++)
+    {
+        barriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barriers[i].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barriers[i].newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[i].subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        barriers[i].subresourceRange.baseMipLevel = 0;
+        barriers[i].subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+        barriers[i].subresourceRange.baseArrayLayer = 0;
+        barriers[i].subresourceRange.layerCount = 1;
+        barriers[i].srcAccessMask = 0;
+        barriers[i].dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    }
+    barriers[0].image = mAtlas;
+    barriers[1].image = mPageTable;
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 0, nullptr, 2, barriers);
+
+    VkClearColorValue clear{};
+    VkImageSubresourceRange range = barriers[1].subresourceRange;
+    vkCmdClearColorImage(commandBuffer, mPageTable, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clear, 1, &range);
+
+    for(uint32_t i = 0; i < 2; i++)
+    {
+        barriers[i].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barriers[i].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barriers[i].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barriers[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    }
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0, 0, nullptr, 0, nullptr, 2, barriers);
+
+    mLogicalDevice.EndSingleTimeCommands(commandBuffer);
+}
+
+void VirtualTexture::CreateSamplers()
+{
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.anisotropyEnable = VK_FALSE;
+    samplerInfo.maxAnisotropy = 1.0f;
+    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.mipLodBias = 0.0f;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = 0.0f;
+
+    // The page borders are what make linear filtering across slots safe.
+    if(vkCreateSampler(mLogicalDevice.GetDevice(), &samplerInfo, nullptr, &mAtlasSampler) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create virtual texture atlas sampler!");
+    }
+
+    samplerInfo.magFilter = VK_FILTER_NEAREST;
+    samplerInfo.minFilter = VK_FILTER_NEAREST;
+    samplerInfo.maxLod = static_cast<float>(mFile->GetLayout().levels.size());
+
+    if(vkCreateSampler(mLogicalDevice.GetDevice(), &samplerInfo, nullptr, &mPageTableSampler) != VK_SUCCESS)
+    {
+        throw std::runtime_error("Failed to create virtual texture page table sampler!");
+    }
+}
+
+void VirtualTexture::Update(VkCommandBuffer commandBuffer, uint32_t frameIndex, const glm::vec4& visible, float texelsPerPixel)
+{
+    MT_PROFILE_SCOPE("VirtualTexture::Update");
+
+    const VirtualTextureLayout& layout = mFile->GetLayout();
+
+    mCache.BeginFrame();
+    mCache.Request(visible.x * layout.width, visible.y * layout.height, visible.z * layout.width, visible.w * layout.height,
+        mCache.SelectLevel(texelsPerPixel));
+
+    VkDeviceSize stagingOffset = static_cast<VkDeviceSize>(frameIndex) * mStagingFrameSize;
+    uint32_t slotSize = layout.GetStoredPageSize();
+    std::vector<VkBufferImageCopy> pageCopies{};
+
+    // Copy in whatever finished loading, oldest first.
+    for(auto it = mPendingPages.begin(); it != mPendingPages.end() && pageCopies.size() < mUploadsPerFrame; )
+    {
+        PendingPage& pending = **it;
+        uint8_t stage = pending.stage.load(std::memory_order_acquire);
+
+        if(stage == PendingPage::Loading)
+        {
+            ++it;
+            continue;
+        }
+
+        if(stage == PendingPage::Failed)
+        {
+            MT_LOG_ERROR("Failed to stream virtual texture page {}: {}", pending.page, pending.error);
+            mFailedPages[pending.page] = 1;
+            mCache.Cancel(pending.slot);
+        }
+        else {
+            VkDeviceSize offset = stagingOffset + pageCopies.size() * layout.GetPageBytes();
+            std::memcpy(mStagingData + offset, pending.texels.data(), pending.texels.size());
+
+            VkBufferImageCopy region{};
+            region.bufferOffset = offset;
+            region.bufferRowLength = 0;
+            region.bufferImageHeight = 0;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = 0;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = {static_cast<int32_t>(pending.slot % mColumns * slotSize), static_cast<int32_t>(pending.slot / mColumns * slotSize), 0};
+            region.imageExtent = {slotSize, slotSize, 1};
+            pageCopies.push_back(region);
+
+            mCache.MakeResident(pending.slot);
+        }
+
+        it = mPendingPages.erase(it);
+    }
+
+    // Keep roughly two frames' worth of reads in flight.
+    for(uint32_t page : mCache.GetMissingPages())
+    {
+        if(mPendingPages.size() >= mUploadsPerFrame * 2)
+        {
+            break;
+        }
+        if(mFailedPages[page])
+        {
+            continue;
+        }
+
+        uint32_t slot = mCache.Reserve(page);
+        if(slot == VirtualPageCache::INVALID)
+        {
+            // Everything resident is on screen: the budget is too small for this view.
+            break;
+        }
+
+        auto pending = std::make_shared<PendingPage>();
+        pending->page = page;
+        pending->slot = slot;
+        mPendingPages.push_back(pending);
+
+        mJobSystem.Submit([pending, file = mFile.get()]()
+        {
+            try
+            {
+                pending->texels.resize(file->GetLayout().GetPageBytes());
+                file->ReadPage(pending->page, pending->texels.data());
+                pending->stage.store(PendingPage::Loaded, std::memory_order_release);
+            }
+            catch(const std::exception& e)
+            {
+                pending->error = e.what();
+                pending->stage.store(PendingPage::Failed, std::memory_order_release);
+            }
+        }, &mLoadCounter);
+    }
+
+    bool updatePageTable = mCache.ConsumeChanges();
+
+    if(!pageCopies.empty() || updatePageTable)
+    {
+        RecordUpload(commandBuffer, stagingOffset, pageCopies, updatePageTable);
+    }
+}
+
+void VirtualTexture::RecordUpload(VkCommandBuffer commandBuffer, VkDeviceSize stagingOffset, const std::vector<VkBufferImageCopy>& pageCopies, bool updatePageTable)
+{
+    const VirtualTextureLayout& layout = mFile->GetLayout();
+
+    // Earlier frames may still be sampling both images, the barriers wait for them.
+    std::vector<VkImageMemoryBarrier> barriers{};
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+    if(!pageCopies.empty())
+    {
+        barrier.image = mAtlas;
+        barriers.push_back(barrier);
+    }
+    if(updatePageTable)
+    {
+        barrier.image = mPageTable;
+        barriers.push_back(barrier);
+    }
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+
+    if(!pageCopies.empty())
+    {
+        vkCmdCopyBufferToImage(commandBuffer, mStaging, mAtlas, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            static_cast<uint32_t>(pageCopies.size()), pageCopies.data());
+    }
+
+    if(updatePageTable)
+    {
+        // The whole table is rebuilt, it's tiny next to a single page.
+        VkDeviceSize offset = stagingOffset + static_cast<VkDeviceSize>(mUploadsPerFrame) * layout.GetPageBytes();
+        std::vector<VkBufferImageCopy> tableCopies{};
+
+        for(uint32_t level = 0; level < layout.levels.size(); level++)
+        {
+            uint32_t width = std::max(mTableWidth >> level, 1u);
+            uint32_t height = std::max(mTableHeight >> level, 1u);
+
+            mCache.BuildPageTable(level, width, height, mColumns, reinterpret_cast<uint32_t*>(mStagingData + offset));
+
+            VkBufferImageCopy region{};
+            region.bufferOffset = offset;
+            region.bufferRowLength = 0;
+            region.bufferImageHeight = 0;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = level;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = {0, 0, 0};
+            region.imageExtent = {width, height, 1};
+            tableCopies.push_back(region);
+
+            offset += static_cast<VkDeviceSize>(width) * height * 4;
+        }
+
+        vkCmdCopyBufferToImage(commandBuffer, mStaging, mPageTable, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            static_cast<uint32_t>(tableCopies.size()), tableCopies.data());
+    }
+
+    for(auto& imageBarrier : barriers)
+    {
+        imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        imageBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        imageBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    }
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+}
+
+}
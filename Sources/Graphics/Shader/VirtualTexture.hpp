@@ -0,0 +1,121 @@
+#ifndef MAMMOTH_2D_VIRTUAL_TEXTURE_HPP
+#define MAMMOTH_2D_VIRTUAL_TEXTURE_HPP
+
+#include <vulkan/vulkan.hpp>
+#include "Graphics/Devices/LogicalDevice.hpp"
+#include "Jobs/JobSystem.hpp"
+#include "Resources/VirtualTextureFile.hpp"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mt
+{
+
+/**
+ * @brief What virtual.frag reads from its push constant block, at VIRTUAL_TEXTURE_PUSH_OFFSET.
+*/
+struct VirtualTexturePushConstant
+{
+    glm::vec4 virtualInfo{};    // xy: size of level 0 in texels, z: level count, w: page size.
+    glm::vec4 atlasInfo{};      // x: page border, y: slot size, zw: 1 / atlas size.
+};
+
+constexpr uint32_t VIRTUAL_TEXTURE_PUSH_OFFSET = 16;
+
+/**
+ * @brief A texture far too large to keep in VRAM (world maps, huge backgrounds), streamed in a
+ * page at a time from a .vtex file (see Tools/TextureCooker --virtual). Resident pages live in
+ * the slots of a fixed size atlas, the budget, and a page table image (one mip per level of the
+ * virtual texture) tells virtual.frag which slot holds each page. Bind the page table at
+ * binding 0 and the atlas at binding 1.
+ * Pages are read and decompressed on the job system. Main thread only.
+*/
+class VirtualTexture
+{
+public:
+    /**
+     * @param budget The most VRAM the atlas may use, which decides the number of slots.
+     * @param uploadsPerFrame The most pages copied into the atlas by a single Update().
+    */
+    VirtualTexture(LogicalDevice& logicalDevice, JobSystem& jobSystem, const std::string& path,
+        const std::shared_ptr<const AssetPack>& pack = nullptr, VkDeviceSize budget = 64ull << 20, uint32_t uploadsPerFrame = 8);
+    ~VirtualTexture();
+
+    VirtualTexture(const VirtualTexture& other) = delete;
+    VirtualTexture& operator=(const VirtualTexture& other) = delete;
+
+    /**
+     * @brief Requests the visible pages, starts loading the missing ones and records the copies of
+     * those that have finished (and the page table, if it changed) into commandBuffer. Call once
+     * per frame, outside of the render pass that samples the texture.
+     * @param visible The visible part of the texture in texture coordinates (x0, y0, x1, y1).
+     * @param texelsPerPixel Level 0 texels covered by one screen pixel, which picks the level.
+     * @param frameIndex The frame in flight, whose slice of the staging buffer is reused.
+    */
+    void Update(VkCommandBuffer commandBuffer, uint32_t frameIndex, const glm::vec4& visible, float texelsPerPixel);
+
+    // Getters
+    //
+    inline const VkImageView& GetPageTableView() const { return mPageTableView; }
+    inline const VkSampler& GetPageTableSampler() const { return mPageTableSampler; }
+    inline const VkImageView& GetAtlasView() const { return mAtlasView; }
+    inline const VkSampler& GetAtlasSampler() const { return mAtlasSampler; }
+    inline const VirtualTexturePushConstant& GetPushConstant() const { return mPushConstant; }
+    inline const VirtualPageCache& GetCache() const { return mCache; }
+
+private:
+    struct PendingPage;
+
+    // The atlas is as close to budget as it can get (never over), within the limits of the page table.
+    static uint32_t GetAtlasColumns(const VirtualTextureLayout& layout, VkDeviceSize budget);
+    static uint32_t GetAtlasRows(const VirtualTextureLayout& layout, VkDeviceSize budget, uint32_t columns);
+
+    void CreateImages();
+    void CreateSamplers();
+
+    void RecordUpload(VkCommandBuffer commandBuffer, VkDeviceSize stagingOffset, const std::vector<VkBufferImageCopy>& pageCopies, bool updatePageTable);
+
+private:
+    LogicalDevice& mLogicalDevice;
+    JobSystem& mJobSystem;
+
+    std::unique_ptr<VirtualTextureFile> mFile = nullptr;
+
+    uint32_t mUploadsPerFrame = 8;
+    uint32_t mColumns = 0;          // Atlas slots per row.
+    uint32_t mRows = 0;
+
+    VirtualPageCache mCache;
+
+    uint32_t mTableWidth = 0;
+    uint32_t mTableHeight = 0;
+
+    VkImage mAtlas = VK_NULL_HANDLE;
+    VkDeviceMemory mAtlasMemory = VK_NULL_HANDLE;
+    VkImageView mAtlasView = VK_NULL_HANDLE;
+    VkSampler mAtlasSampler = VK_NULL_HANDLE;
+
+    VkImage mPageTable = VK_NULL_HANDLE;
+    VkDeviceMemory mPageTableMemory = VK_NULL_HANDLE;
+    VkImageView mPageTableView = VK_NULL_HANDLE;
+    VkSampler mPageTableSampler = VK_NULL_HANDLE;
+
+    // Persistently mapped, one slice per frame in flight: the pages, then the page table.
+    VkBuffer mStaging = VK_NULL_HANDLE;
+    VkDeviceMemory mStagingMemory = VK_NULL_HANDLE;
+    uint8_t* mStagingData = nullptr;
+    VkDeviceSize mStagingFrameSize = 0;
+
+    std::vector<std::shared_ptr<PendingPage>> mPendingPages{};
+    std::vector<uint8_t> mFailedPages{};
+    JobCounter mLoadCounter{};
+
+    VirtualTexturePushConstant mPushConstant{};
+};
+}
+
+#endif
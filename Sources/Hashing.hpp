@@ -0,0 +1,59 @@
+#ifndef MAMMOTH_2D_HASHING_HPP
+#define MAMMOTH_2D_HASHING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace mt
+{
+
+/**
+ * @brief 64-bit FNV-1a, folding in one value at a time: the bytes of asset paths, or the words
+ * of the flattened keys the Vulkan object caches look their objects up by.
+*/
+template<typename T>
+inline uint64_t HashFnv1a(const T* values, size_t count)
+{
+    uint64_t hash = 14695981039346656037ull;
+
+    for(size_t i = 0; i < count; i++)
+    {
+        hash ^= values[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Appends a Vulkan handle to a flattened key as two words. Non-dispatchable handles are
+ * pointers on 64 bit platforms and uint64_t everywhere else.
+*/
+template<typename T>
+inline void AppendHandle(std::vector<uint32_t>& key, T handle)
+{
+    static_assert(sizeof(T) <= sizeof(uint64_t), "Handles are at most 64 bits");
+
+    uint64_t value = 0;
+    std::memcpy(&value, &handle, sizeof(handle));
+
+    key.push_back(static_cast<uint32_t>(value));
+    key.push_back(static_cast<uint32_t>(value >> 32));
+}
+
+/**
+ * @brief The hash of the std::unordered_maps keyed by flattened words.
+*/
+struct WordKeyHash
+{
+    inline size_t operator()(const std::vector<uint32_t>& key) const
+    {
+        return static_cast<size_t>(HashFnv1a(key.data(), key.size()));
+    }
+};
+
+}
+
+#endif
@@ -6,13 +6,19 @@ namespace mt
 
 static EventBus* sEventBus = nullptr;
 static Window* sWindow = nullptr;
+static InputRecorder* sRecorder = nullptr;
+static bool sIsReplaying = false;
 
 Input::Input(EventBus* eventBus, Window* window)  
 {
     sEventBus = eventBus;
     sWindow = window;
 
-    glfwSetKeyCallback(window->GetNativeWindow(), KeyPressCallback);
+    // Headless windows have no native window, and therefore no keyboard.
+    if(!window->IsHeadless()) 
+    {
+        glfwSetKeyCallback(window->GetNativeWindow(), KeyPressCallback);
+    }
 }
 
 void Input::ListenToKeyboard(GLFWwindow* window) const 
@@ -26,6 +32,36 @@ void Input::ListenToKeyboard(GLFWwindow* window) const
 }
 
 void Input::KeyPressCallback(GLFWwindow* window, int key, int scancode, int action, int mods) 
+{
+    if(sIsReplaying) 
+    {
+        return;
+    }
+
+    if(sRecorder) 
+    {
+        sRecorder->RecordKey(key, action, mods);
+    }
+
+    HandleKey(key, action, mods);
+}
+
+void Input::SetRecorder(InputRecorder* recorder) 
+{
+    sRecorder = recorder;
+}
+
+void Input::SetReplaying(bool replaying) 
+{
+    sIsReplaying = replaying;
+}
+
+void Input::InjectKey(int key, int action, int mods) const 
+{
+    HandleKey(key, action, mods);
+}
+
+void Input::HandleKey(int key, int action, int mods) 
 {
     switch(key) 
     {
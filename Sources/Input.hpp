@@ -4,6 +4,7 @@
 #include <GLFW/glfw3.h>
 #include "Events/Bus.hpp"
 #include "Window.hpp"
+#include "Replay/InputRecording.hpp"
 
 namespace mt 
 {
@@ -45,6 +46,27 @@ public:
     */
     static void KeyPressCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
 
+    /**
+     * @brief Every key transition from here on is also handed to the recorder (nullptr stops recording).
+    */
+    void SetRecorder(InputRecorder* recorder);
+
+    /**
+     * @brief While replaying, live keyboard input is ignored entirely so that only the recorded
+     * transitions (fed through InjectKey()) can influence the game.
+    */
+    void SetReplaying(bool replaying);
+
+    /**
+     * @brief Handles a key transition exactly as if GLFW had reported it.
+    */
+    void InjectKey(int key, int action, int mods) const;
+
+private:
+    /**
+     * @brief Publishes the events for a key transition, regardless of where it came from.
+    */
+    static void HandleKey(int key, int action, int mods);
 };
 }
 
@@ -0,0 +1,200 @@
+#include "JobSystem.hpp"
+#include "Profiler/Profiler.hpp"
+
+#include <chrono>
+
+namespace mt
+{
+
+// Each thread remembers which job system it belongs to (if any) and which queue it owns,
+// so that Submit() can push straight onto the caller's own queue without any locking.
+static thread_local const JobSystem* sOwner = nullptr;
+static thread_local uint32_t sThreadIndex = 0;
+
+JobSystem::JobSystem(uint32_t workerCount)
+{
+    if(workerCount == 0)
+    {
+        uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    // Queue 0 belongs to the constructing (main) thread.
+    for(uint32_t i = 0; i < workerCount + 1; i++)
+    {
+        mQueues.push_back(std::make_unique<WorkStealingQueue>());
+    }
+
+    sOwner = this;
+    sThreadIndex = 0;
+
+    for(uint32_t i = 1; i < workerCount + 1; i++)
+    {
+        mWorkers.emplace_back(&JobSystem::WorkerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock{mSleepMutex};
+        mIsRunning.store(false);
+    }
+    mWakeCondition.notify_all();
+
+    for(auto& worker : mWorkers)
+    {
+        worker.join();
+    }
+
+    // Anything still queued at this point was never going to be waited on, but it still
+    // owns heap memory.
+    for(auto& queue : mQueues)
+    {
+        while(Job* job = queue->Steal())
+        {
+            delete job;
+        }
+    }
+    for(Job* job : mInjectionQueue)
+    {
+        delete job;
+    }
+
+    if(sOwner == this)
+    {
+        sOwner = nullptr;
+    }
+}
+
+void JobSystem::Submit(JobFunction function, JobCounter* counter)
+{
+    if(counter)
+    {
+        counter->Add();
+    }
+
+    Job* job = new Job{std::move(function), counter};
+
+    if(IsOwnedThread())
+    {
+        if(!mQueues[sThreadIndex]->Push(job))
+        {
+            // Our queue is full - running the job right here is the cheapest form of back-pressure.
+            Execute(job);
+            return;
+        }
+    }
+    else {
+        std::lock_guard<std::mutex> lock{mInjectionMutex};
+        mInjectionQueue.push_back(job);
+        mInjectionCount.fetch_add(1, std::memory_order_release);
+    }
+
+    mQueuedJobs.fetch_add(1, std::memory_order_release);
+    mWakeCondition.notify_one();
+}
+
+void JobSystem::Wait(const JobCounter& counter)
+{
+    uint32_t threadIndex = IsOwnedThread() ? sThreadIndex : 0;
+
+    while(!counter.IsDone())
+    {
+        if(Job* job = FindJob(threadIndex))
+        {
+            Execute(job);
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+uint32_t JobSystem::GetThreadIndex() const
+{
+    return IsOwnedThread() ? sThreadIndex : 0;
+}
+
+void JobSystem::WorkerLoop(uint32_t threadIndex)
+{
+    sOwner = this;
+    sThreadIndex = threadIndex;
+
+    MT_PROFILE_THREAD("Worker");
+
+    while(mIsRunning.load(std::memory_order_acquire))
+    {
+        if(Job* job = FindJob(threadIndex))
+        {
+            Execute(job);
+            continue;
+        }
+
+        // Nothing to do, so sleep until something is submitted. The timeout guards against
+        // the (rare) lost wake-up between checking mQueuedJobs and going to sleep.
+        std::unique_lock<std::mutex> lock{mSleepMutex};
+        mWakeCondition.wait_for(lock, std::chrono::milliseconds(1), [this]()
+        {
+            return mQueuedJobs.load(std::memory_order_acquire) > 0 || !mIsRunning.load(std::memory_order_acquire);
+        });
+    }
+}
+
+Job* JobSystem::FindJob(uint32_t threadIndex)
+{
+    Job* job = nullptr;
+
+    // Only the owner may pop, external threads that end up here (via Wait()) just steal.
+    if(IsOwnedThread())
+    {
+        job = mQueues[threadIndex]->Pop();
+    }
+
+    if(!job && mInjectionCount.load(std::memory_order_acquire) > 0)
+    {
+        std::lock_guard<std::mutex> lock{mInjectionMutex};
+        if(!mInjectionQueue.empty())
+        {
+            job = mInjectionQueue.front();
+            mInjectionQueue.pop_front();
+            mInjectionCount.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    // Owners skip their own queue (it was just popped), everyone else tries all of them.
+    const uint32_t queueCount = static_cast<uint32_t>(mQueues.size());
+    for(uint32_t i = IsOwnedThread() ? 1 : 0; !job && i < queueCount; i++)
+    {
+        job = mQueues[(threadIndex + i) % queueCount]->Steal();
+    }
+
+    if(job)
+    {
+        mQueuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    return job;
+}
+
+void JobSystem::Execute(Job* job)
+{
+    {
+        MT_PROFILE_SCOPE("Job");
+        job->function();
+    }
+
+    if(job->counter)
+    {
+        job->counter->Done();
+    }
+
+    delete job;
+}
+
+bool JobSystem::IsOwnedThread() const
+{
+    return sOwner == this;
+}
+
+}
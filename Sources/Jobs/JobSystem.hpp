@@ -0,0 +1,160 @@
+#ifndef MAMMOTH_2D_JOB_SYSTEM_HPP
+#define MAMMOTH_2D_JOB_SYSTEM_HPP
+
+#include "WorkStealingQueue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mt
+{
+
+/**
+ * @brief Tracks the number of outstanding jobs in a group. A counter is incremented once per
+ * submitted job and decremented once that job has finished, so waiting on a counter is how
+ * you join on everything that was forked with it.
+*/
+class JobCounter
+{
+public:
+    JobCounter() = default;
+
+    JobCounter(const JobCounter& other) = delete;
+    JobCounter& operator=(const JobCounter& other) = delete;
+
+    inline void Add(uint32_t count = 1) { mValue.fetch_add(count, std::memory_order_relaxed); }
+    inline void Done() { mValue.fetch_sub(1, std::memory_order_acq_rel); }
+    inline bool IsDone() const { return mValue.load(std::memory_order_acquire) == 0; }
+
+private:
+    std::atomic<uint32_t> mValue{0};
+};
+
+typedef std::function<void()> JobFunction;
+
+struct Job
+{
+    JobFunction function;
+    JobCounter* counter = nullptr;
+};
+
+/**
+ * @brief Engine-wide pool of worker threads that every subsystem (ECS, asset loading, render
+ * recording...) should submit its work to instead of creating threads of its own.
+ * Each worker owns a WorkStealingQueue and steals from the others once its own runs dry.
+ * The thread that constructs the JobSystem (the main thread) also owns a queue, and helps out
+ * by running jobs whenever it's blocked inside Wait().
+ * You should only interact with this class via the main Engine instance.
+*/
+class JobSystem
+{
+public:
+    /**
+     * @brief Spawns the worker threads.
+     * @param workerCount The number of threads to spawn in addition to the calling thread.
+     * Passing 0 uses one less than the number of hardware threads, leaving a core for the main thread.
+    */
+    explicit JobSystem(uint32_t workerCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem& other) = delete;
+    JobSystem& operator=(const JobSystem& other) = delete;
+
+    /**
+     * @brief Queues a job. When called from the main thread or a worker the job is pushed onto
+     * that thread's own queue, any other thread goes through a shared (locked) injection queue.
+     * @param function The work itself.
+     * @param counter Optional counter that's incremented now and decremented once the job has run.
+    */
+    void Submit(JobFunction function, JobCounter* counter = nullptr);
+
+    /**
+     * @brief Blocks until the counter reaches zero. Rather than sleeping, the calling thread
+     * executes queued jobs itself while it waits, so it's safe to call from inside a job.
+    */
+    void Wait(const JobCounter& counter);
+
+    /**
+     * @brief Splits [begin, end) into chunks of grainSize and runs function(chunkBegin, chunkEnd)
+     * on each chunk in parallel, returning once every chunk has been processed.
+     * @param grainSize The number of elements handed to each job - keep this large enough that
+     * the work per job dwarfs the cost of scheduling it.
+    */
+    template<class F>
+    void ParallelFor(size_t begin, size_t end, size_t grainSize, F&& function)
+    {
+        if(begin >= end)
+        {
+            return;
+        }
+
+        grainSize = std::max<size_t>(grainSize, 1);
+
+        // Not worth going wide for a single chunk.
+        if(end - begin <= grainSize)
+        {
+            function(begin, end);
+            return;
+        }
+
+        JobCounter counter{};
+        for(size_t first = begin; first < end; first += grainSize)
+        {
+            size_t last = std::min(end, first + grainSize);
+            Submit([&function, first, last]() { function(first, last); }, &counter);
+        }
+
+        Wait(counter);
+    }
+
+    /**
+     * @brief The number of threads that execute jobs, including the main thread.
+    */
+    inline uint32_t GetThreadCount() const { return static_cast<uint32_t>(mQueues.size()); }
+
+    /**
+     * @brief Index of the calling thread within this job system - 0 for the main thread,
+     * 1 to GetThreadCount() - 1 for workers. Threads that don't belong to the job system also
+     * report 0, so only use this for indexing per-thread data from the main thread and workers.
+    */
+    uint32_t GetThreadIndex() const;
+
+private:
+    void WorkerLoop(uint32_t threadIndex);
+
+    /**
+     * @brief Looks for work in this order: our own queue, the injection queue, then every
+     * other queue starting from our neighbour.
+    */
+    Job* FindJob(uint32_t threadIndex);
+
+    void Execute(Job* job);
+
+    /**
+     * @brief Whether the calling thread owns one of this job system's queues.
+    */
+    bool IsOwnedThread() const;
+
+private:
+    std::vector<std::unique_ptr<WorkStealingQueue>> mQueues{};
+    std::vector<std::thread> mWorkers{};
+
+    std::mutex mInjectionMutex{};
+    std::deque<Job*> mInjectionQueue{};
+    std::atomic<uint32_t> mInjectionCount{0};
+
+    std::mutex mSleepMutex{};
+    std::condition_variable mWakeCondition{};
+    std::atomic<uint32_t> mQueuedJobs{0};
+    std::atomic<bool> mIsRunning{true};
+};
+}
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef MAMMOTH_2D_WORK_STEALING_QUEUE_HPP
+#define MAMMOTH_2D_WORK_STEALING_QUEUE_HPP
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+
+namespace mt
+{
+
+struct Job;
+
+/**
+ * @brief Fixed capacity Chase-Lev deque. The thread that owns the queue pushes and pops jobs
+ * from the bottom (LIFO, which keeps recently touched data warm in its cache), while any other
+ * thread may steal from the top (FIFO, so thieves take the oldest and usually largest work).
+ * Only Push() and Pop() may be called from the owning thread, Steal() is safe from anywhere.
+*/
+class WorkStealingQueue
+{
+public:
+    static constexpr int64_t CAPACITY = 4096;
+
+    WorkStealingQueue()
+    {
+        for(auto& job : mJobs)
+        {
+            job.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    WorkStealingQueue(const WorkStealingQueue& other) = delete;
+    WorkStealingQueue& operator=(const WorkStealingQueue& other) = delete;
+
+    /**
+     * @brief Pushes a job onto the bottom of the queue. Owner thread only.
+     * @return false if the queue is full, in which case the caller should run the job itself.
+    */
+    bool Push(Job* job)
+    {
+        int64_t bottom = mBottom.load(std::memory_order_relaxed);
+        int64_t top = mTop.load(std::memory_order_acquire);
+
+        if(bottom - top >= CAPACITY)
+        {
+            return false;
+        }
+
+        mJobs[bottom & MASK].store(job, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        mBottom.store(bottom + 1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    /**
+     * @brief Pops the most recently pushed job. Owner thread only.
+     * @return The job, or nullptr if the queue was empty (or a thief won the race for the last job).
+    */
+    Job* Pop()
+    {
+        int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+        mBottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = mTop.load(std::memory_order_relaxed);
+
+        if(top > bottom)
+        {
+            mBottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job* job = mJobs[bottom & MASK].load(std::memory_order_relaxed);
+
+        if(top == bottom)
+        {
+            // Last job in the queue, so we're competing against thieves for it.
+            if(!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                job = nullptr;
+            }
+            mBottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return job;
+    }
+
+    /**
+     * @brief Steals the oldest job from the top of the queue. Safe to call from any thread.
+     * @return The job, or nullptr if the queue was empty or another thread got there first.
+    */
+    Job* Steal()
+    {
+        int64_t top = mTop.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = mBottom.load(std::memory_order_acquire);
+
+        if(top >= bottom)
+        {
+            return nullptr;
+        }
+
+        Job* job = mJobs[top & MASK].load(std::memory_order_relaxed);
+
+        if(!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return nullptr;
+        }
+
+        return job;
+    }
+
+    inline bool IsEmpty() const
+    {
+        return mBottom.load(std::memory_order_relaxed) <= mTop.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr int64_t MASK = CAPACITY - 1;
+    static_assert((CAPACITY & MASK) == 0, "WorkStealingQueue capacity must be a power of two!");
+
+    // Kept on separate cache lines so that thieves hammering mTop don't invalidate the
+    // owner's mBottom on every steal.
+    alignas(64) std::atomic<int64_t> mTop{0};
+    alignas(64) std::atomic<int64_t> mBottom{0};
+    alignas(64) std::array<std::atomic<Job*>, CAPACITY> mJobs;
+};
+}
+
+#endif
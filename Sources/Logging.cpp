@@ -1,28 +1,461 @@
 #include "Logging.hpp"
 
-namespace mt 
+#include <chrono>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace mt
 {
-    
-void LOG_INT(int i, std::string name) 
+
+// Formatting (shared with the offline decoder).
+//----------------------------------------------------------------
+const char* GetLogLevelName(LogLevel level)
 {
-    std::cout << name << " | " << i << std::endl;
+    switch(level)
+    {
+        case LogLevel::Trace: return "TRACE";
+        case LogLevel::Debug: return "DEBUG";
+        case LogLevel::Info: return "INFO";
+        case LogLevel::Warn: return "WARN";
+        case LogLevel::Error: return "ERROR";
+        case LogLevel::Fatal: return "FATAL";
+    }
+    return "?";
 }
 
-void LOG_FLOAT(float f, std::string name) 
+// Reads the next packed argument and appends its text to the output.
+// Returns false once the payload runs out (e.g: after truncation).
+static bool AppendNextArg(std::string& out, const unsigned char*& cursor, const unsigned char* end)
 {
-    std::cout << name << " | " << f << std::endl;
+    if(cursor >= end)
+    {
+        return false;
+    }
+
+    LogArgType type = static_cast<LogArgType>(*cursor++);
+
+    auto read = [&](void* value, size_t size)
+    {
+        if(static_cast<size_t>(end - cursor) < size)
+        {
+            cursor = end;
+            return false;
+        }
+        std::memcpy(value, cursor, size);
+        cursor += size;
+        return true;
+    };
 
+    switch(type)
+    {
+        case LogArgType::Int:
+        {
+            int64_t value = 0;
+            if(!read(&value, sizeof(value))) return false;
+            out += std::to_string(value);
+            return true;
+        }
+        case LogArgType::UInt:
+        {
+            uint64_t value = 0;
+            if(!read(&value, sizeof(value))) return false;
+            out += std::to_string(value);
+            return true;
+        }
+        case LogArgType::Double:
+        {
+            double value = 0.0;
+            if(!read(&value, sizeof(value))) return false;
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%g", value);
+            out += buffer;
+            return true;
+        }
+        case LogArgType::Bool:
+        {
+            uint8_t value = 0;
+            if(!read(&value, sizeof(value))) return false;
+            out += value ? "true" : "false";
+            return true;
+        }
+        case LogArgType::String:
+        {
+            uint16_t length = 0;
+            if(!read(&length, sizeof(length))) return false;
+            length = static_cast<uint16_t>(std::min<size_t>(length, end - cursor));
+            out.append(reinterpret_cast<const char*>(cursor), length);
+            cursor += length;
+            return true;
+        }
+    }
+
+    cursor = end;
+    return false;
 }
 
-void LOG_VEC2(glm::vec2 v, std::string name) 
+std::string FormatLogMessage(const char* format, const unsigned char* payload, uint16_t payloadSize, uint8_t argCount)
 {
-    std::cout << name << " | " << "x: " << v.x << "   " << "y: " << v.y << std::endl;
+    std::string out{};
+    out.reserve(128);
+
+    const unsigned char* cursor = payload;
+    const unsigned char* end = payload + payloadSize;
+    uint8_t argsUsed = 0;
+
+    for(const char* c = format; *c; c++)
+    {
+        if(c[0] == '{' && c[1] == '}')
+        {
+            if(argsUsed < argCount && AppendNextArg(out, cursor, end))
+            {
+                argsUsed++;
+            }
+            else {
+                out += "{}";
+            }
+            c++;
+        }
+        else {
+            out += *c;
+        }
+    }
+
+    return out;
+}
+
+std::string FormatLogLine(const LogRecord& record)
+{
+    char prefix[64];
+    std::snprintf(prefix, sizeof(prefix), "[%10.4f] [%-5s] [T%u] ",
+        record.timestamp / 1e9, GetLogLevelName(record.level), record.threadId);
+
+    std::string line = prefix;
+    line += FormatLogMessage(record.format, record.payload, record.payloadSize, record.argCount);
+    line += '\n';
+
+    return line;
 }
 
-void LOG_VEC3(glm::vec3 v, std::string name) 
+template<typename T>
+static bool ReadBinary(std::istream& in, T& value)
 {
-    std::cout << name << " | " << "x: " << v.x << "   " << "y: " << v.y << "   " << v.z << std::endl;
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+uint64_t DecodeBinaryLog(std::istream& in, std::ostream& out)
+{
+    char magic[sizeof(BINARY_LOG_MAGIC)];
+    if(!in.read(magic, sizeof(magic)) || std::memcmp(magic, BINARY_LOG_MAGIC, sizeof(magic)) != 0)
+    {
+        throw std::runtime_error("Not a binary log (bad magic)");
+    }
+
+    std::unordered_map<uint64_t, std::string> formats{};
+    uint64_t recordCount = 0;
+
+    uint8_t tag = 0;
+    while(ReadBinary(in, tag))
+    {
+        if(tag == static_cast<uint8_t>(BinaryLogTag::Format))
+        {
+            uint64_t id = 0;
+            uint32_t length = 0;
+            if(!ReadBinary(in, id) || !ReadBinary(in, length)) break;
+
+            std::string format(length, '\0');
+            if(!in.read(format.data(), length)) break;
+
+            formats[id] = std::move(format);
+        }
+        else if(tag == static_cast<uint8_t>(BinaryLogTag::Record))
+        {
+            uint64_t formatId = 0;
+            uint8_t level = 0;
+            LogRecord record{};
+
+            if(!ReadBinary(in, formatId) || !ReadBinary(in, record.timestamp) || !ReadBinary(in, record.threadId) ||
+               !ReadBinary(in, level) || !ReadBinary(in, record.argCount) || !ReadBinary(in, record.payloadSize)) break;
+
+            if(record.payloadSize > LogRecord::PAYLOAD_SIZE)
+            {
+                throw std::runtime_error("Corrupt log: record payload of " + std::to_string(record.payloadSize) + " bytes");
+            }
+            if(!in.read(reinterpret_cast<char*>(record.payload), record.payloadSize)) break;
+
+            auto format = formats.find(formatId);
+            record.format = format != formats.end() ? format->second.c_str() : "<unknown format>";
+            record.level = static_cast<LogLevel>(level);
+
+            out << FormatLogLine(record);
+            recordCount++;
+        }
+        else {
+            throw std::runtime_error("Corrupt log: unknown block tag " + std::to_string(tag));
+        }
+    }
+
+    return recordCount;
 }
+//----------------------------------------------------------------
 
 
-}
\ No newline at end of file
+Logger& Logger::Get()
+{
+    static Logger logger{};
+    return logger;
+}
+
+Logger::Logger()
+    : mSlots(CAPACITY)
+{
+    // Vyukov's bounded queue: each slot's sequence number tells producers and the consumer
+    // whose turn it is. A slot is free for the producer at position p when sequence == p,
+    // and readable by the consumer when sequence == p + 1.
+    for(uint64_t i = 0; i < CAPACITY; i++)
+    {
+        mSlots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    mWriter = std::thread(&Logger::WriterLoop, this);
+}
+
+Logger::~Logger()
+{
+    Flush();
+
+    {
+        std::lock_guard<std::mutex> lock{mWriterMutex};
+        mIsRunning = false;
+    }
+    mWriterCondition.notify_all();
+    mWriter.join();
+}
+
+void Logger::Configure(const LogDesc& desc)
+{
+    Flush();
+
+    std::lock_guard<std::mutex> lock{mWriterMutex};
+
+    if(mFile.is_open())
+    {
+        mFile.close();
+    }
+
+    mDesc = desc;
+    mWrittenFormats.clear();
+    mMinLevel.store(desc.minLevel, std::memory_order_relaxed);
+
+    if(mDesc.filePath)
+    {
+        mFile.open(mDesc.filePath, std::ios::out | std::ios::trunc | (mDesc.binary ? std::ios::binary : std::ios::openmode{}));
+
+        if(!mFile.is_open())
+        {
+            // Falling back to the console is more useful than losing every message.
+            mDesc.filePath = nullptr;
+            mDesc.binary = false;
+        }
+        else if(mDesc.binary)
+        {
+            mFile.write(BINARY_LOG_MAGIC, sizeof(BINARY_LOG_MAGIC));
+        }
+    }
+    else {
+        mDesc.binary = false;
+    }
+}
+
+void Logger::Flush()
+{
+    uint64_t target = mEnqueuePosition.load(std::memory_order_acquire);
+
+    {
+        std::lock_guard<std::mutex> lock{mWriterMutex};
+        mFlushRequested = true;
+    }
+    mWriterCondition.notify_one();
+
+    while(mDequeuePosition.load(std::memory_order_acquire) < target)
+    {
+        std::this_thread::yield();
+    }
+
+    std::lock_guard<std::mutex> lock{mWriterMutex};
+    if(mFile.is_open())
+    {
+        mFile.flush();
+    }
+    else {
+        std::fflush(stdout);
+    }
+}
+
+LogRecord* Logger::Claim(uint64_t& position)
+{
+    position = mEnqueuePosition.load(std::memory_order_relaxed);
+
+    while(true)
+    {
+        Slot& slot = mSlots[position & (CAPACITY - 1)];
+        uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        int64_t difference = static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+
+        if(difference == 0)
+        {
+            if(mEnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                return &slot.record;
+            }
+        }
+        else if(difference < 0)
+        {
+            return nullptr;
+        }
+        else {
+            position = mEnqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void Logger::Publish(uint64_t position)
+{
+    mSlots[position & (CAPACITY - 1)].sequence.store(position + 1, std::memory_order_release);
+}
+
+void Logger::WriterLoop()
+{
+    while(true)
+    {
+        bool wroteAnything = false;
+
+        {
+            std::unique_lock<std::mutex> lock{mWriterMutex};
+
+            uint64_t position = mDequeuePosition.load(std::memory_order_relaxed);
+            while(true)
+            {
+                Slot& slot = mSlots[position & (CAPACITY - 1)];
+                if(slot.sequence.load(std::memory_order_acquire) != position + 1)
+                {
+                    break;
+                }
+
+                Write(slot.record);
+                wroteAnything = true;
+
+                slot.sequence.store(position + CAPACITY, std::memory_order_release);
+                position++;
+                mDequeuePosition.store(position, std::memory_order_release);
+            }
+
+            // Flushing once per batch rather than per line is the whole point of std::endl's absence.
+            if(wroteAnything)
+            {
+                if(mFile.is_open())
+                {
+                    mFile.flush();
+                }
+                else {
+                    std::fflush(stdout);
+                }
+            }
+
+            if(!mIsRunning && !wroteAnything)
+            {
+                return;
+            }
+
+            mFlushRequested = false;
+
+            // Producers never signal (that would cost them a syscall), so we poll.
+            mWriterCondition.wait_for(lock, std::chrono::milliseconds(2), [this]()
+            {
+                return mFlushRequested || !mIsRunning;
+            });
+        }
+    }
+}
+
+void Logger::Write(const LogRecord& record)
+{
+    if(mDesc.binary)
+    {
+        uint64_t formatId = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(record.format));
+
+        // Each distinct format string is written once, records then refer to it by id.
+        if(mWrittenFormats.insert(record.format).second)
+        {
+            uint8_t tag = static_cast<uint8_t>(BinaryLogTag::Format);
+            uint32_t length = static_cast<uint32_t>(std::strlen(record.format));
+            mFile.write(reinterpret_cast<const char*>(&tag), sizeof(tag));
+            mFile.write(reinterpret_cast<const char*>(&formatId), sizeof(formatId));
+            mFile.write(reinterpret_cast<const char*>(&length), sizeof(length));
+            mFile.write(record.format, length);
+        }
+
+        uint8_t tag = static_cast<uint8_t>(BinaryLogTag::Record);
+        uint8_t level = static_cast<uint8_t>(record.level);
+        mFile.write(reinterpret_cast<const char*>(&tag), sizeof(tag));
+        mFile.write(reinterpret_cast<const char*>(&formatId), sizeof(formatId));
+        mFile.write(reinterpret_cast<const char*>(&record.timestamp), sizeof(record.timestamp));
+        mFile.write(reinterpret_cast<const char*>(&record.threadId), sizeof(record.threadId));
+        mFile.write(reinterpret_cast<const char*>(&level), sizeof(level));
+        mFile.write(reinterpret_cast<const char*>(&record.argCount), sizeof(record.argCount));
+        mFile.write(reinterpret_cast<const char*>(&record.payloadSize), sizeof(record.payloadSize));
+        mFile.write(reinterpret_cast<const char*>(record.payload), record.payloadSize);
+        return;
+    }
+
+    mLine = FormatLogLine(record);
+
+    if(mFile.is_open())
+    {
+        mFile.write(mLine.data(), mLine.size());
+    }
+    else {
+        std::fwrite(mLine.data(), 1, mLine.size(), record.level >= LogLevel::Error ? stderr : stdout);
+    }
+}
+
+uint64_t Logger::Now()
+{
+    static const auto epoch = std::chrono::steady_clock::now();
+
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+uint32_t Logger::GetThreadId()
+{
+    // Small sequential ids read far better in a log than std::thread::id hashes.
+    static std::atomic<uint32_t> sNextId{0};
+    thread_local uint32_t id = sNextId.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+
+// Legacy helpers.
+//----------------------------------------------------------------
+void LOG_INT(int i, const char* name)
+{
+    MT_LOG_DEBUG("{} | {}", name, i);
+}
+
+void LOG_FLOAT(float f, const char* name)
+{
+    MT_LOG_DEBUG("{} | {}", name, f);
+}
+
+void LOG_VEC2(const glm::vec2& v, const char* name)
+{
+    MT_LOG_DEBUG("{} | x: {}   y: {}", name, v.x, v.y);
+}
+
+void LOG_VEC3(const glm::vec3& v, const char* name)
+{
+    MT_LOG_DEBUG("{} | x: {}   y: {}   z: {}", name, v.x, v.y, v.z);
+}
+//----------------------------------------------------------------
+
+}
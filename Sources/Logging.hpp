@@ -3,15 +3,335 @@
 
 #include <glm/glm.hpp>
 
-#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
 
-namespace mt 
+// Compile-time severity threshold. Any MT_LOG_* call below this level is removed entirely
+// by the preprocessor, arguments included. Override with -DMAMMOTH_LOG_LEVEL=<0-6>.
+#define MT_LOG_LEVEL_TRACE 0
+#define MT_LOG_LEVEL_DEBUG 1
+#define MT_LOG_LEVEL_INFO 2
+#define MT_LOG_LEVEL_WARN 3
+#define MT_LOG_LEVEL_ERROR 4
+#define MT_LOG_LEVEL_FATAL 5
+#define MT_LOG_LEVEL_OFF 6
+
+#ifndef MAMMOTH_LOG_LEVEL
+    #ifdef NDEBUG
+        #define MAMMOTH_LOG_LEVEL MT_LOG_LEVEL_INFO
+    #else
+        #define MAMMOTH_LOG_LEVEL MT_LOG_LEVEL_DEBUG
+    #endif
+#endif
+
+// Messages use "{}" as the placeholder for each argument, e.g:
+// MT_LOG_INFO("Loaded {} ({}x{})", path, width, height);
+// The format string must be a string literal, since only its address is captured.
+#define MT_LOG(level, format, ...) ::mt::Logger::Get().Log(level, format, ##__VA_ARGS__)
+
+#if MAMMOTH_LOG_LEVEL <= MT_LOG_LEVEL_TRACE
+    #define MT_LOG_TRACE(format, ...) MT_LOG(::mt::LogLevel::Trace, format, ##__VA_ARGS__)
+#else
+    #define MT_LOG_TRACE(format, ...) ((void)0)
+#endif
+#if MAMMOTH_LOG_LEVEL <= MT_LOG_LEVEL_DEBUG
+    #define MT_LOG_DEBUG(format, ...) MT_LOG(::mt::LogLevel::Debug, format, ##__VA_ARGS__)
+#else
+    #define MT_LOG_DEBUG(format, ...) ((void)0)
+#endif
+#if MAMMOTH_LOG_LEVEL <= MT_LOG_LEVEL_INFO
+    #define MT_LOG_INFO(format, ...) MT_LOG(::mt::LogLevel::Info, format, ##__VA_ARGS__)
+#else
+    #define MT_LOG_INFO(format, ...) ((void)0)
+#endif
+#if MAMMOTH_LOG_LEVEL <= MT_LOG_LEVEL_WARN
+    #define MT_LOG_WARN(format, ...) MT_LOG(::mt::LogLevel::Warn, format, ##__VA_ARGS__)
+#else
+    #define MT_LOG_WARN(format, ...) ((void)0)
+#endif
+#if MAMMOTH_LOG_LEVEL <= MT_LOG_LEVEL_ERROR
+    #define MT_LOG_ERROR(format, ...) MT_LOG(::mt::LogLevel::Error, format, ##__VA_ARGS__)
+#else
+    #define MT_LOG_ERROR(format, ...) ((void)0)
+#endif
+#if MAMMOTH_LOG_LEVEL <= MT_LOG_LEVEL_FATAL
+    #define MT_LOG_FATAL(format, ...) MT_LOG(::mt::LogLevel::Fatal, format, ##__VA_ARGS__)
+#else
+    #define MT_LOG_FATAL(format, ...) ((void)0)
+#endif
+
+namespace mt
 {
-void LOG_INT(int i, std::string name = "");
-void LOG_FLOAT(float f, std::string name = "");
-void LOG_VEC2(glm::vec2 v, std::string name = "");
-void LOG_VEC3(glm::vec3 v, std::string name = "");
+
+enum class LogLevel : uint8_t
+{
+    Trace = 0,
+    Debug = 1,
+    Info = 2,
+    Warn = 3,
+    Error = 4,
+    Fatal = 5
+};
+
+enum class LogArgType : uint8_t
+{
+    Int = 0,
+    UInt = 1,
+    Double = 2,
+    Bool = 3,
+    String = 4
+};
+
+/**
+ * @brief A captured but not yet formatted log call. Arguments are packed into the payload as
+ * a type tag followed by the raw value (strings as a 16-bit length followed by the characters,
+ * truncated if they don't fit). The same layout is used by the binary log files.
+*/
+struct LogRecord
+{
+    static constexpr size_t PAYLOAD_SIZE = 192;
+
+    const char* format = nullptr;
+    uint64_t timestamp = 0;     // Nanoseconds since the logger started.
+    uint32_t threadId = 0;
+    LogLevel level = LogLevel::Info;
+    uint8_t argCount = 0;
+    uint16_t payloadSize = 0;
+    unsigned char payload[PAYLOAD_SIZE];
+};
+
+/**
+ * @brief Substitutes the packed arguments into the "{}" placeholders of a format string.
+ * Shared by the logger's background thread and the offline binary log decoder.
+*/
+std::string FormatLogMessage(const char* format, const unsigned char* payload, uint16_t payloadSize, uint8_t argCount);
+
+/**
+ * @brief Formats a complete line, prefixed with the time, level and thread.
+*/
+std::string FormatLogLine(const LogRecord& record);
+
+const char* GetLogLevelName(LogLevel level);
+
+// Header of binary log files, followed by a stream of BinaryLogTag-prefixed blocks.
+constexpr char BINARY_LOG_MAGIC[8] = {'M', 'T', 'L', 'O', 'G', '\0', '\1', '\0'};
+
+enum class BinaryLogTag : uint8_t
+{
+    Format = 0,     // uint64 id, uint32 length, characters.
+    Record = 1      // uint64 format id, uint64 timestamp, uint32 thread, uint8 level, uint8 args, uint16 size, payload.
+};
+
+/**
+ * @brief Turns a binary log back into the lines the text sink would have written (see
+ * Tools/LogDecoder). A log that was cut off mid-block, e.g. by a crash, ends at the last whole
+ * record. Throws if it isn't a binary log or a block is corrupt.
+ * @return The number of records decoded.
+*/
+uint64_t DecodeBinaryLog(std::istream& in, std::ostream& out);
+
+struct LogDesc
+{
+    // Where to write the log. nullptr logs to the console.
+    const char* filePath = nullptr;
+    // Writes the compact binary format (see Tools/LogDecoder) instead of text. Requires filePath.
+    bool binary = false;
+    // Anything below this level is discarded at runtime (on top of MAMMOTH_LOG_LEVEL).
+    LogLevel minLevel = LogLevel::Trace;
+};
+
+/**
+ * @brief Asynchronous logger. Calling threads only capture the format string pointer and the raw
+ * argument values into a lock-free ring buffer, all formatting and I/O happens on a background
+ * thread. If the ring is full the message is dropped (and counted) rather than blocking the caller,
+ * except for Fatal messages, which also wait for the log to be flushed.
+ * Use the MT_LOG_* macros rather than calling Log() directly.
+*/
+class Logger
+{
+public:
+    static constexpr uint32_t CAPACITY = 4096;
+
+    static Logger& Get();
+
+    ~Logger();
+
+    Logger(const Logger& other) = delete;
+    Logger& operator=(const Logger& other) = delete;
+
+    /**
+     * @brief Redirects the output. Anything logged before this call is flushed to the previous sink first.
+    */
+    void Configure(const LogDesc& desc);
+
+    /**
+     * @brief Blocks until every message logged so far has been written out.
+    */
+    void Flush();
+
+    template<typename... Args>
+    void Log(LogLevel level, const char* format, const Args&... args)
+    {
+        if(level < mMinLevel.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        uint64_t position = 0;
+        LogRecord* record = Claim(position);
+
+        if(!record)
+        {
+            mDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        record->format = format;
+        record->level = level;
+        record->timestamp = Now();
+        record->threadId = GetThreadId();
+        record->argCount = static_cast<uint8_t>(sizeof...(Args));
+        record->payloadSize = 0;
+        (Encode(*record, args), ...);
+
+        Publish(position);
+
+        if(level == LogLevel::Fatal)
+        {
+            Flush();
+        }
+    }
+
+    inline uint64_t GetDroppedCount() const { return mDropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence{0};
+        LogRecord record{};
+    };
+
+    Logger();
+
+    /**
+     * @brief Reserves the next slot in the ring (multi-producer, lock-free).
+     * @return The record to fill in, or nullptr if the ring is full.
+    */
+    LogRecord* Claim(uint64_t& position);
+
+    /**
+     * @brief Hands a filled-in slot over to the background thread.
+    */
+    void Publish(uint64_t position);
+
+    void WriterLoop();
+
+    void Write(const LogRecord& record);
+
+    static uint64_t Now();
+    static uint32_t GetThreadId();
+
+    // Argument encoding.
+    //
+    static void Append(LogRecord& record, const void* data, size_t size)
+    {
+        size = std::min(size, LogRecord::PAYLOAD_SIZE - record.payloadSize);
+        std::memcpy(record.payload + record.payloadSize, data, size);
+        record.payloadSize += static_cast<uint16_t>(size);
+    }
+
+    static void EncodeTag(LogRecord& record, LogArgType type)
+    {
+        uint8_t tag = static_cast<uint8_t>(type);
+        Append(record, &tag, 1);
+    }
+
+    static void EncodeString(LogRecord& record, std::string_view text)
+    {
+        EncodeTag(record, LogArgType::String);
+        size_t space = LogRecord::PAYLOAD_SIZE - std::min<size_t>(record.payloadSize + 2, LogRecord::PAYLOAD_SIZE);
+        uint16_t length = static_cast<uint16_t>(std::min(text.size(), space));
+        Append(record, &length, sizeof(length));
+        Append(record, text.data(), length);
+    }
+
+    template<typename T>
+    static void Encode(LogRecord& record, const T& value)
+    {
+        if constexpr (std::is_same<T, bool>::value)
+        {
+            EncodeTag(record, LogArgType::Bool);
+            uint8_t b = value ? 1 : 0;
+            Append(record, &b, 1);
+        }
+        else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value)
+        {
+            EncodeTag(record, LogArgType::Int);
+            int64_t v = static_cast<int64_t>(value);
+            Append(record, &v, sizeof(v));
+        }
+        else if constexpr (std::is_integral<T>::value || std::is_enum<T>::value)
+        {
+            EncodeTag(record, LogArgType::UInt);
+            uint64_t v = static_cast<uint64_t>(value);
+            Append(record, &v, sizeof(v));
+        }
+        else if constexpr (std::is_floating_point<T>::value)
+        {
+            EncodeTag(record, LogArgType::Double);
+            double v = static_cast<double>(value);
+            Append(record, &v, sizeof(v));
+        }
+        else if constexpr (std::is_convertible<const T&, std::string_view>::value)
+        {
+            EncodeString(record, std::string_view{value});
+        }
+        else {
+            static_assert(std::is_pointer<T>::value, "Unsupported log argument type!");
+            EncodeTag(record, LogArgType::UInt);
+            uint64_t v = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+            Append(record, &v, sizeof(v));
+        }
+    }
+
+private:
+    std::vector<Slot> mSlots;
+    std::atomic<uint64_t> mEnqueuePosition{0};
+    std::atomic<uint64_t> mDequeuePosition{0};
+    std::atomic<uint64_t> mDropped{0};
+    std::atomic<LogLevel> mMinLevel{LogLevel::Trace};
+
+    std::mutex mWriterMutex{};
+    std::condition_variable mWriterCondition{};
+    std::thread mWriter{};
+    bool mIsRunning = true;
+    bool mFlushRequested = false;
+
+    // Sink state - only touched by the writer thread (or under mWriterMutex).
+    LogDesc mDesc{};
+    std::ofstream mFile{};
+    std::unordered_set<const char*> mWrittenFormats{};
+    std::string mLine{};
+};
+
+// Legacy helpers, now forwarded to the asynchronous logger at debug level.
+void LOG_INT(int i, const char* name = "");
+void LOG_FLOAT(float f, const char* name = "");
+void LOG_VEC2(const glm::vec2& v, const char* name = "");
+void LOG_VEC3(const glm::vec3& v, const char* name = "");
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,64 @@
+#include "FrameAllocator.hpp"
+#include "Logging.hpp"
+
+#include <cassert>
+
+namespace mt 
+{
+
+FrameAllocator::FrameAllocator(const JobSystem& jobSystem, uint32_t frameCount, size_t mainCapacity, size_t workerCapacity)
+    : mJobSystem{jobSystem}
+{
+    mArenas.resize(frameCount);
+
+    for(auto& frame : mArenas) 
+    {
+        // Thread index 0 is always the main thread.
+        frame.push_back(std::make_unique<LinearArena>(mainCapacity));
+
+        for(uint32_t i = 1; i < mJobSystem.GetThreadCount(); i++) 
+        {
+            frame.push_back(std::make_unique<LinearArena>(workerCapacity));
+        }
+    }
+}
+
+void FrameAllocator::BeginFrame(uint32_t frameIndex) 
+{
+    assert(frameIndex < mArenas.size() && "Frame index is larger than the number of frames in flight!");
+
+    mCurrentFrame = frameIndex;
+
+    size_t used = 0;
+    size_t overflow = 0;
+
+    for(auto& arena : mArenas[mCurrentFrame]) 
+    {
+        used += arena->GetStats().used;
+        overflow += arena->GetStats().overflow;
+        arena->Reset();
+    }
+
+    mStats.used = used;
+    mStats.overflow = overflow;
+
+#ifdef MAMMOTH_ARENA_DEBUG
+    // Only report new high-water marks (or overflows), otherwise this would print every frame.
+    if(used > mStats.peak || overflow > 0) 
+    {
+        MT_LOG_DEBUG("FrameAllocator | peak: {} bytes, overflow: {} bytes", used, overflow);
+    }
+#endif
+
+    if(used > mStats.peak) 
+    {
+        mStats.peak = used;
+    }
+}
+
+LinearArena& FrameAllocator::GetArena() 
+{
+    return *mArenas[mCurrentFrame][mJobSystem.GetThreadIndex()];
+}
+
+}
@@ -0,0 +1,73 @@
+#ifndef MAMMOTH_2D_FRAME_ALLOCATOR_HPP
+#define MAMMOTH_2D_FRAME_ALLOCATOR_HPP
+
+#include "LinearArena.hpp"
+#include "Jobs/JobSystem.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace mt 
+{
+
+struct FrameMemoryStats 
+{
+    size_t used = 0;        // Bytes handed out across every thread's arena last frame.
+    size_t overflow = 0;    // Bytes that didn't fit and went to the heap instead.
+    size_t peak = 0;        // Highest value of used seen so far.
+};
+
+/**
+ * @brief Owns one set of LinearArenas per frame in flight - a large one for the main thread
+ * plus a smaller sub-arena for each job system worker, so that jobs can allocate without any
+ * synchronization. BeginFrame() resets the set belonging to the frame that's about to be
+ * recorded, which by then the GPU has finished with.
+ * You should only interact with this class via the main Engine instance.
+*/
+class FrameAllocator 
+{
+public:
+    /**
+     * @param jobSystem Used to size the per-thread arenas and to find the calling thread's index.
+     * @param frameCount The number of frames in flight (one set of arenas each).
+     * @param mainCapacity Size in bytes of the main thread's arena per frame.
+     * @param workerCapacity Size in bytes of each worker's arena per frame.
+    */
+    FrameAllocator(const JobSystem& jobSystem, uint32_t frameCount, size_t mainCapacity, size_t workerCapacity);
+    ~FrameAllocator() {}
+
+    FrameAllocator(const FrameAllocator& other) = delete;
+    FrameAllocator& operator=(const FrameAllocator& other) = delete;
+
+    /**
+     * @brief Gathers last frame's statistics for this slot and resets every arena in it.
+     * Must be called from the main thread while no jobs are allocating from the slot.
+     * @param frameIndex The frame in flight index (0 to frameCount - 1).
+    */
+    void BeginFrame(uint32_t frameIndex);
+
+    /**
+     * @brief The calling thread's arena for the current frame. Main thread and job system workers only.
+    */
+    LinearArena& GetArena();
+
+    /**
+     * @brief Same as GetArena() but as a std::pmr::memory_resource, for handing to pmr containers.
+    */
+    inline std::pmr::memory_resource* GetResource() { return &GetArena(); }
+
+    inline const FrameMemoryStats& GetStats() const { return mStats; }
+
+private:
+    const JobSystem& mJobSystem;
+
+    // mArenas[frameIndex][threadIndex]
+    std::vector<std::vector<std::unique_ptr<LinearArena>>> mArenas{};
+
+    uint32_t mCurrentFrame = 0;
+
+    FrameMemoryStats mStats{};
+};
+}
+
+#endif
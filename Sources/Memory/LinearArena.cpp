@@ -0,0 +1,82 @@
+#include "LinearArena.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <new>
+
+namespace mt 
+{
+
+LinearArena::LinearArena(size_t capacity)
+    : mCapacity{capacity}
+{
+    mBlock = static_cast<unsigned char*>(::operator new(mCapacity, std::align_val_t{alignof(std::max_align_t)}));
+}
+
+LinearArena::~LinearArena() 
+{
+    Reset();
+    ::operator delete(mBlock, std::align_val_t{alignof(std::max_align_t)});
+}
+
+void* LinearArena::Allocate(size_t size, size_t alignment) 
+{
+    assert((alignment & (alignment - 1)) == 0 && "LinearArena alignment must be a power of two!");
+
+    uintptr_t current = reinterpret_cast<uintptr_t>(mBlock) + mOffset;
+    uintptr_t aligned = (current + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    size_t newOffset = (aligned - reinterpret_cast<uintptr_t>(mBlock)) + size;
+
+    mStats.allocations++;
+
+    if(newOffset > mCapacity) 
+    {
+        // Out of room - fall back to the heap for the rest of the frame rather than failing.
+        void* pointer = ::operator new(size, std::align_val_t{alignment});
+        mOverflowAllocations.emplace_back(pointer, alignment);
+        mStats.overflow += size;
+        return pointer;
+    }
+
+    mOffset = newOffset;
+    mStats.used = mOffset;
+
+    return reinterpret_cast<void*>(aligned);
+}
+
+void LinearArena::Reset() 
+{
+#ifdef MAMMOTH_ARENA_DEBUG
+    std::memset(mBlock, ARENA_RESET_PATTERN, mOffset);
+#endif
+
+    for(const auto& [pointer, alignment] : mOverflowAllocations) 
+    {
+        ::operator delete(pointer, std::align_val_t{alignment});
+    }
+    mOverflowAllocations.clear();
+
+    mOffset = 0;
+    mStats = ArenaStats{};
+}
+
+void* LinearArena::do_allocate(size_t bytes, size_t alignment) 
+{
+    return Allocate(bytes, alignment);
+}
+
+void LinearArena::do_deallocate([[maybe_unused]] void* pointer, [[maybe_unused]] size_t bytes, [[maybe_unused]] size_t alignment) 
+{
+    // Memory is only ever reclaimed by Reset(), but in debug builds we still scribble over it
+    // so that dangling pointers into a container's old storage are easy to spot.
+#ifdef MAMMOTH_ARENA_DEBUG
+    std::memset(pointer, ARENA_FREED_PATTERN, bytes);
+#endif
+}
+
+bool LinearArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept 
+{
+    return this == &other;
+}
+
+}
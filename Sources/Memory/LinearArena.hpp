@@ -0,0 +1,89 @@
+#ifndef MAMMOTH_2D_LINEAR_ARENA_HPP
+#define MAMMOTH_2D_LINEAR_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mt
+{
+
+// Byte patterns written over arena memory when MAMMOTH_ARENA_DEBUG is defined, so that use of
+// memory after it was freed (or after the arena was reset) shows up as obvious garbage.
+constexpr unsigned char ARENA_FREED_PATTERN = 0xDD;
+constexpr unsigned char ARENA_RESET_PATTERN = 0xCD;
+
+struct ArenaStats 
+{
+    size_t used = 0;
+    size_t overflow = 0;
+    size_t allocations = 0;
+};
+
+/**
+ * @brief Bump-pointer allocator over a single fixed block of memory. Allocating is a pointer
+ * increment, individual frees are no-ops and Reset() releases everything at once in O(1),
+ * which makes it ideal for temporaries that only live for a frame.
+ * It derives from std::pmr::memory_resource so that standard containers can live inside it, e.g:
+ * std::pmr::vector<EntityID> entities{&arena};
+ * An arena is not thread-safe - use one per thread (see FrameAllocator).
+*/
+class LinearArena : public std::pmr::memory_resource 
+{
+public:
+    /**
+     * @brief Allocates the backing block up front.
+     * @param capacity Size of the block in bytes. Anything past this is served by the heap
+     * (and counted as overflow in the stats) until the next Reset(), so size it with some headroom.
+    */
+    explicit LinearArena(size_t capacity);
+    ~LinearArena();
+
+    LinearArena(const LinearArena& other) = delete;
+    LinearArena& operator=(const LinearArena& other) = delete;
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * @brief Constructs a T inside the arena. T must be trivially destructible since the arena
+     * never runs destructors.
+    */
+    template<class T, typename... Args>
+    T* New(Args&&... args) 
+    {
+        static_assert(std::is_trivially_destructible<T>::value, 
+            "LinearArena never calls destructors, so only trivially destructible types can be created in it!");
+
+        return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Rewinds the bump pointer to the start of the block and frees any overflow allocations.
+     * Everything previously allocated from this arena becomes invalid.
+    */
+    void Reset();
+
+    inline size_t GetCapacity() const { return mCapacity; }
+    inline size_t GetUsed() const { return mOffset; }
+    inline const ArenaStats& GetStats() const { return mStats; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    unsigned char* mBlock = nullptr;
+    size_t mCapacity = 0;
+    size_t mOffset = 0;
+
+    std::vector<std::pair<void*, size_t>> mOverflowAllocations{};
+
+    ArenaStats mStats{};
+};
+}
+
+#endif
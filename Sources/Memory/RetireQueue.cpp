@@ -0,0 +1,45 @@
+#include "RetireQueue.hpp"
+
+namespace mt 
+{
+
+RetireQueue::RetireQueue(uint32_t latency)
+    : mLatency{latency}
+{
+
+}
+
+RetireQueue::~RetireQueue() 
+{
+    Flush();
+}
+
+void RetireQueue::Retire(std::function<void()> destroy) 
+{
+    mRetired.push_back(Retired{mFrameNumber, std::move(destroy)});
+}
+
+void RetireQueue::BeginFrame(uint64_t frameNumber) 
+{
+    mFrameNumber = frameNumber;
+
+    while(!mRetired.empty() && mRetired.front().frame + mLatency <= frameNumber) 
+    {
+        // Popped first, in case destroying it retires something else.
+        auto destroy = std::move(mRetired.front().destroy);
+        mRetired.pop_front();
+        destroy();
+    }
+}
+
+void RetireQueue::Flush() 
+{
+    while(!mRetired.empty()) 
+    {
+        auto destroy = std::move(mRetired.front().destroy);
+        mRetired.pop_front();
+        destroy();
+    }
+}
+
+}
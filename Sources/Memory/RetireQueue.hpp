@@ -0,0 +1,74 @@
+#ifndef MAMMOTH_2D_RETIRE_QUEUE_HPP
+#define MAMMOTH_2D_RETIRE_QUEUE_HPP
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+
+namespace mt 
+{
+
+/**
+ * @brief Delays the destruction of GPU objects that are being replaced (e.g: hot reloaded
+ * assets) until no frame in flight can still be using them, rather than stalling on
+ * vkDeviceWaitIdle(). Objects retired during frame N are destroyed at the start of frame
+ * N + latency.
+ * You should only interact with this class via the main Engine instance. Main thread only.
+*/
+class RetireQueue 
+{
+public:
+    /**
+     * @param latency Frames to keep retired objects alive for. One more than the number of
+     * frames in flight, since the oldest frame's fence is only waited on once the next
+     * swapchain image is acquired - after BeginFrame() has run.
+    */
+    RetireQueue(uint32_t latency);
+    ~RetireQueue();
+
+    RetireQueue(const RetireQueue& other) = delete;
+    RetireQueue& operator=(const RetireQueue& other) = delete;
+
+    /**
+     * @brief Queues a function that destroys something.
+    */
+    void Retire(std::function<void()> destroy);
+
+    template<typename T>
+    void Retire(std::unique_ptr<T> object) 
+    {
+        // std::function has to be copyable, unique_ptr isn't.
+        std::shared_ptr<T> shared = std::move(object);
+        Retire([shared]() mutable { shared.reset(); });
+    }
+
+    /**
+     * @brief Destroys whatever has waited long enough. Called once per frame by the engine.
+     * @param frameNumber The frame that's about to be recorded.
+    */
+    void BeginFrame(uint64_t frameNumber);
+
+    /**
+     * @brief Destroys everything straight away. Only safe once the device is idle.
+    */
+    void Flush();
+
+    inline size_t GetPendingCount() const { return mRetired.size(); }
+
+private:
+    struct Retired 
+    {
+        uint64_t frame = 0;
+        std::function<void()> destroy = nullptr;
+    };
+
+    uint32_t mLatency = 0;
+    uint64_t mFrameNumber = 0;
+
+    // Always ordered by frame, since frame numbers only go up.
+    std::deque<Retired> mRetired{};
+};
+}
+
+#endif
@@ -0,0 +1,54 @@
+#include "FrameTimes.hpp"
+#include "Logging.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+namespace mt 
+{
+
+void FrameTimes::WriteCSV(const char* path) const 
+{
+    std::ofstream file{path, std::ios::out | std::ios::trunc};
+
+    if(!file.is_open()) 
+    {
+        MT_LOG_ERROR("Failed to open {} for the frame times", path);
+        return;
+    }
+
+    file << "frame,timestep_ms,cpu_ms\n";
+    for(const auto& sample : mSamples) 
+    {
+        file << sample.frameNumber << "," << sample.timestep * 1000.0 << "," << sample.cpuTime * 1000.0 << "\n";
+    }
+
+    if(mSamples.empty()) 
+    {
+        return;
+    }
+
+    std::vector<double> cpuTimes{};
+    cpuTimes.reserve(mSamples.size());
+
+    double total = 0.0;
+    for(const auto& sample : mSamples) 
+    {
+        cpuTimes.push_back(sample.cpuTime);
+        total += sample.cpuTime;
+    }
+
+    std::sort(cpuTimes.begin(), cpuTimes.end());
+
+    auto percentile = [&cpuTimes](double p) 
+    {
+        size_t index = static_cast<size_t>(p * static_cast<double>(cpuTimes.size() - 1) + 0.5);
+        return cpuTimes[index] * 1000.0;
+    };
+
+    MT_LOG_INFO("Frame times ({} frames): mean {}ms, p50 {}ms, p95 {}ms, p99 {}ms, max {}ms",
+        cpuTimes.size(), total / cpuTimes.size() * 1000.0, 
+        percentile(0.5), percentile(0.95), percentile(0.99), cpuTimes.back() * 1000.0);
+}
+
+}
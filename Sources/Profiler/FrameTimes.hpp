@@ -0,0 +1,46 @@
+#ifndef MAMMOTH_2D_FRAME_TIMES_HPP
+#define MAMMOTH_2D_FRAME_TIMES_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace mt 
+{
+
+struct FrameTimeSample 
+{
+    uint64_t frameNumber = 0;
+    double timestep = 0.0;  // Simulation timestep handed to the game, in seconds.
+    double cpuTime = 0.0;   // Time spent on the CPU for the frame (update + recording/submission), in seconds.
+};
+
+/**
+ * @brief Collects per-frame CPU times, mainly so that replays of the same recording can be
+ * compared between builds. Unlike the profiler this is always compiled in - it's one sample
+ * per frame, which costs next to nothing.
+*/
+class FrameTimes 
+{
+public:
+    FrameTimes() {}
+    ~FrameTimes() {}
+
+    inline void Record(uint64_t frameNumber, double timestep, double cpuTime) 
+    {
+        mSamples.push_back(FrameTimeSample{frameNumber, timestep, cpuTime});
+    }
+
+    /**
+     * @brief Writes every sample as CSV (frame, timestep_ms, cpu_ms) and logs a summary
+     * (mean, median, 95th/99th percentile and worst frame).
+    */
+    void WriteCSV(const char* path) const;
+
+    inline const std::vector<FrameTimeSample>& GetSamples() const { return mSamples; }
+
+private:
+    std::vector<FrameTimeSample> mSamples{};
+};
+}
+
+#endif
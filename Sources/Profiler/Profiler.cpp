@@ -0,0 +1,163 @@
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace mt 
+{
+
+std::mutex Profiler::sRegistryMutex{};
+std::vector<std::unique_ptr<ProfileThreadBuffer>> Profiler::sBuffers{};
+
+static const char* FRAME_MARKER_NAME = "Frame";
+
+void ProfileThreadBuffer::Read(std::vector<ProfileEvent>& events) const 
+{
+    uint64_t writeCount = mWriteCount.load(std::memory_order_acquire);
+    uint64_t begin = writeCount > CAPACITY ? writeCount - CAPACITY : 0;
+
+    events.clear();
+    events.reserve(static_cast<size_t>(writeCount - begin));
+
+    for(uint64_t i = begin; i < writeCount; i++) 
+    {
+        const Slot& slot = mSlots[i & (CAPACITY - 1)];
+        events.push_back(ProfileEvent{
+            slot.name.load(std::memory_order_relaxed),
+            slot.start.load(std::memory_order_relaxed),
+            slot.end.load(std::memory_order_relaxed)
+        });
+    }
+
+    // Pairs with the fence in Record(): any write that reached the slots above has been announced.
+    // Writing event n overwrites event n - CAPACITY, so everything up to there may be torn.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t startedCount = mStartedCount.load(std::memory_order_relaxed);
+    uint64_t firstIntact = startedCount > CAPACITY ? startedCount - CAPACITY : 0;
+
+    if(firstIntact > begin) 
+    {
+        size_t torn = static_cast<size_t>(std::min(firstIntact - begin, writeCount - begin));
+        events.erase(events.begin(), events.begin() + torn);
+    }
+}
+
+uint64_t Profiler::Now() 
+{
+    static const auto epoch = std::chrono::steady_clock::now();
+
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+void Profiler::Record(const char* name, uint64_t start, uint64_t end) 
+{
+    GetThreadBuffer().Record(name, start, end);
+}
+
+void Profiler::MarkFrame() 
+{
+    uint64_t now = Now();
+    GetThreadBuffer().Record(FRAME_MARKER_NAME, now, now);
+}
+
+void Profiler::SetThreadName(const char* name) 
+{
+    auto& buffer = GetThreadBuffer();
+
+    std::lock_guard<std::mutex> lock{sRegistryMutex};
+    buffer.name = name;
+}
+
+ProfileThreadBuffer& Profiler::GetThreadBuffer() 
+{
+    // The registry owns the buffers (they outlive their threads so that late exports still
+    // see them), the thread just caches a pointer to its own.
+    thread_local ProfileThreadBuffer* buffer = nullptr;
+
+    if(!buffer) 
+    {
+        std::lock_guard<std::mutex> lock{sRegistryMutex};
+        sBuffers.push_back(std::make_unique<ProfileThreadBuffer>(static_cast<uint32_t>(sBuffers.size())));
+        buffer = sBuffers.back().get();
+    }
+
+    return *buffer;
+}
+
+// Minimal JSON string escaping - zone names are almost always identifiers, but __func__ and
+// user-provided thread names can contain anything.
+static void WriteEscaped(std::ofstream& file, const char* text) 
+{
+    for(const char* c = text; *c; c++) 
+    {
+        switch(*c) 
+        {
+            case '"': file << "\\\""; break;
+            case '\\': file << "\\\\"; break;
+            case '\n': file << "\\n"; break;
+            default: if(static_cast<unsigned char>(*c) >= 0x20) file << *c; break;
+        }
+    }
+}
+
+bool Profiler::WriteChromeTrace(const char* filePath) 
+{
+    std::ofstream file{filePath, std::ios::out | std::ios::trunc};
+
+    if(!file.is_open()) 
+    {
+        return false;
+    }
+
+    // Chrome traces use microseconds.
+    file.setf(std::ios::fixed);
+    file.precision(3);
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+    uint64_t frameNumber = 0;
+
+    std::lock_guard<std::mutex> lock{sRegistryMutex};
+
+    std::vector<ProfileEvent> events{};
+
+    for(const auto& buffer : sBuffers) 
+    {
+        if(!buffer->name.empty()) 
+        {
+            file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" 
+                << buffer->GetThreadId() << ",\"args\":{\"name\":\"";
+            WriteEscaped(file, buffer->name.c_str());
+            file << "\"}}";
+            first = false;
+        }
+
+        buffer->Read(events);
+
+        for(const ProfileEvent& event : events) 
+        {
+            file << (first ? "" : ",") << "\n{\"name\":\"";
+            first = false;
+
+            if(event.name == FRAME_MARKER_NAME) 
+            {
+                file << "Frame " << frameNumber++ << "\",\"ph\":\"i\",\"s\":\"g\"";
+            }
+            else {
+                WriteEscaped(file, event.name);
+                file << "\",\"ph\":\"X\",\"dur\":" << (event.end - event.start) / 1000.0;
+            }
+
+            file << ",\"ts\":" << event.start / 1000.0 << ",\"pid\":1,\"tid\":" << buffer->GetThreadId() << "}";
+        }
+    }
+
+    file << "\n]}\n";
+
+    return file.good();
+}
+
+}
@@ -0,0 +1,167 @@
+#ifndef MAMMOTH_2D_PROFILER_HPP
+#define MAMMOTH_2D_PROFILER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Instrumentation macros. These compile to nothing unless MAMMOTH_PROFILER is defined
+// (see the MAMMOTH_PROFILER CMake option), so they can be left in hot paths permanently.
+// Names must be string literals (or otherwise outlive the profiler), since only the pointer is recorded.
+#ifdef MAMMOTH_PROFILER
+    #define MT_PROFILE_CONCAT_INNER(a, b) a##b
+    #define MT_PROFILE_CONCAT(a, b) MT_PROFILE_CONCAT_INNER(a, b)
+    #define MT_PROFILE_SCOPE(name) ::mt::ProfileScope MT_PROFILE_CONCAT(profileScope, __LINE__){name}
+    #define MT_PROFILE_FUNCTION() MT_PROFILE_SCOPE(__func__)
+    #define MT_PROFILE_FRAME() ::mt::Profiler::MarkFrame()
+    #define MT_PROFILE_THREAD(name) ::mt::Profiler::SetThreadName(name)
+    #define MT_PROFILE_EXPORT(path) ::mt::Profiler::WriteChromeTrace(path)
+#else
+    #define MT_PROFILE_SCOPE(name) ((void)0)
+    #define MT_PROFILE_FUNCTION() ((void)0)
+    #define MT_PROFILE_FRAME() ((void)0)
+    #define MT_PROFILE_THREAD(name) ((void)0)
+    #define MT_PROFILE_EXPORT(path) ((void)0)
+#endif
+
+namespace mt 
+{
+
+struct ProfileEvent 
+{
+    const char* name = nullptr;
+    uint64_t start = 0;     // Nanoseconds since the profiler's epoch.
+    uint64_t end = 0;       // Equal to start for instant events (frame markers).
+};
+
+/**
+ * @brief Ring buffer of events recorded by a single thread. Only the owning thread writes to it,
+ * so recording is a few relaxed stores and a release increment of the write counter - no locks
+ * and no contention between threads. Once full, the oldest events are overwritten.
+ *
+ * Other threads can Read() it at any time. Before the owner writes a slot it announces which
+ * event it's about to overwrite, so readers drop the events that may have changed under them
+ * instead of exporting torn ones.
+*/
+class ProfileThreadBuffer 
+{
+public:
+    static constexpr uint32_t CAPACITY = 1 << 16;
+
+    ProfileThreadBuffer(uint32_t threadId) 
+        : mThreadId{threadId}, mSlots(CAPACITY) 
+    {}
+
+    inline void Record(const char* name, uint64_t start, uint64_t end) 
+    {
+        uint64_t index = mWriteCount.load(std::memory_order_relaxed);
+
+        // Ordered before the slot's stores, so a reader that sees any of them also sees this.
+        mStartedCount.store(index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        Slot& slot = mSlots[index & (CAPACITY - 1)];
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.start.store(start, std::memory_order_relaxed);
+        slot.end.store(end, std::memory_order_relaxed);
+
+        mWriteCount.store(index + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Copies the events still in the buffer into events, oldest first. Safe while the
+     * owning thread keeps recording: events it records meanwhile are missed, and the oldest
+     * events it may have been overwriting are dropped.
+    */
+    void Read(std::vector<ProfileEvent>& events) const;
+
+    /**
+     * @brief The order the thread first recorded in (0 for the first), which traces use as the
+     * thread's tid. Not the OS thread id.
+    */
+    inline uint32_t GetThreadId() const { return mThreadId; }
+
+    std::string name = "";
+
+private:
+    struct Slot
+    {
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> start{0};
+        std::atomic<uint64_t> end{0};
+    };
+
+    uint32_t mThreadId = 0;
+    std::atomic<uint64_t> mWriteCount{0};
+    std::atomic<uint64_t> mStartedCount{0};
+    std::vector<Slot> mSlots;
+};
+
+/**
+ * @brief Collects scoped zones (name, thread, start, end) from every thread and exports them in
+ * the Chrome trace event format, which can be opened with chrome://tracing or ui.perfetto.dev.
+ * Use the MT_PROFILE_* macros rather than calling this class directly.
+*/
+class Profiler 
+{
+public:
+    /**
+     * @brief Nanoseconds since the first call to this function.
+    */
+    static uint64_t Now();
+
+    static void Record(const char* name, uint64_t start, uint64_t end);
+
+    /**
+     * @brief Records an instant event that marks the start of a new frame.
+    */
+    static void MarkFrame();
+
+    static void SetThreadName(const char* name);
+
+    /**
+     * @brief Writes every recorded event to a Chrome trace JSON file, with each thread's tid being
+     * its ProfileThreadBuffer::GetThreadId(). Threads are free to keep recording while this runs,
+     * although any events they record meanwhile are missed (see ProfileThreadBuffer::Read()).
+     * @return Whether the file could be written.
+    */
+    static bool WriteChromeTrace(const char* filePath);
+
+private:
+    /**
+     * @brief Returns the calling thread's buffer, creating and registering it on first use.
+    */
+    static ProfileThreadBuffer& GetThreadBuffer();
+
+    static std::mutex sRegistryMutex;
+    static std::vector<std::unique_ptr<ProfileThreadBuffer>> sBuffers;
+};
+
+/**
+ * @brief Records the lifetime of the enclosing scope as a zone.
+*/
+class ProfileScope 
+{
+public:
+    ProfileScope(const char* name) 
+        : mName{name}, mStart{Profiler::Now()} 
+    {}
+
+    ~ProfileScope() 
+    {
+        Profiler::Record(mName, mStart, Profiler::Now());
+    }
+
+    ProfileScope(const ProfileScope& other) = delete;
+    ProfileScope& operator=(const ProfileScope& other) = delete;
+
+private:
+    const char* mName;
+    uint64_t mStart;
+};
+}
+
+#endif
@@ -0,0 +1,110 @@
+#include "InputRecording.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace mt 
+{
+
+// Helper Functions.
+//----------------------------------------------------------------
+template<typename T>
+static void Write(std::ofstream& file, const T& value) 
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+static bool Read(std::ifstream& file, T& value) 
+{
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+//----------------------------------------------------------------
+
+
+InputRecorder::InputRecorder(const char* path) 
+    : mFile{path, std::ios::out | std::ios::binary | std::ios::trunc}
+{
+    if(!mFile.is_open()) 
+    {
+        throw std::runtime_error("Failed to create replay file: " + std::string(path));
+    }
+
+    mFile.write(REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    Write(mFile, REPLAY_VERSION);
+}
+
+void InputRecorder::RecordKey(int key, int action, int mods) 
+{
+    mPendingKeys.push_back(RecordedKey{
+        static_cast<int16_t>(key), 
+        static_cast<uint8_t>(action), 
+        static_cast<uint8_t>(mods)
+    });
+}
+
+void InputRecorder::CommitFrame(uint64_t frameNumber, double timestep) 
+{
+    uint16_t keyCount = static_cast<uint16_t>(mPendingKeys.size());
+
+    Write(mFile, frameNumber);
+    Write(mFile, timestep);
+    Write(mFile, keyCount);
+
+    for(uint16_t i = 0; i < keyCount; i++) 
+    {
+        Write(mFile, mPendingKeys[i].key);
+        Write(mFile, mPendingKeys[i].action);
+        Write(mFile, mPendingKeys[i].mods);
+    }
+
+    mPendingKeys.clear();
+}
+
+
+InputReplayer::InputReplayer(const char* path) 
+    : mFile{path, std::ios::in | std::ios::binary}
+{
+    if(!mFile.is_open()) 
+    {
+        throw std::runtime_error("Failed to open replay file: " + std::string(path));
+    }
+
+    char magic[sizeof(REPLAY_MAGIC)];
+    uint32_t version = 0;
+
+    if(!mFile.read(magic, sizeof(magic)) || std::memcmp(magic, REPLAY_MAGIC, sizeof(magic)) != 0) 
+    {
+        throw std::runtime_error("Not a replay file: " + std::string(path));
+    }
+
+    if(!Read(mFile, version) || version != REPLAY_VERSION) 
+    {
+        throw std::runtime_error("Unsupported replay file version: " + std::string(path));
+    }
+}
+
+bool InputReplayer::ReadFrame(RecordedFrame& frame) 
+{
+    uint16_t keyCount = 0;
+
+    if(!Read(mFile, frame.frameNumber) || !Read(mFile, frame.timestep) || !Read(mFile, keyCount)) 
+    {
+        return false;
+    }
+
+    frame.keys.resize(keyCount);
+
+    for(auto& key : frame.keys) 
+    {
+        if(!Read(mFile, key.key) || !Read(mFile, key.action) || !Read(mFile, key.mods)) 
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,89 @@
+#ifndef MAMMOTH_2D_INPUT_RECORDING_HPP
+#define MAMMOTH_2D_INPUT_RECORDING_HPP
+
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+namespace mt 
+{
+
+// Replay files start with this, followed by a uint32 version and then one block per frame:
+// uint64 frame number, float64 timestep (seconds), uint16 key count, then per key an int16 GLFW
+// key, uint8 action and uint8 modifier bits. Little-endian, unpadded.
+constexpr char REPLAY_MAGIC[8] = {'M', 'T', 'R', 'E', 'P', 'L', 'A', 'Y'};
+constexpr uint32_t REPLAY_VERSION = 1;
+
+struct RecordedKey 
+{
+    int16_t key = 0;
+    uint8_t action = 0;     // GLFW_PRESS, GLFW_RELEASE or GLFW_REPEAT.
+    uint8_t mods = 0;
+};
+
+struct RecordedFrame 
+{
+    uint64_t frameNumber = 0;
+    double timestep = 0.0;
+    std::vector<RecordedKey> keys{};
+};
+
+/**
+ * @brief Writes every key transition along with the simulation timestep of the frame it was
+ * seen in, which is everything that makes one run of a game differ from another. 
+ * Key transitions arrive (from Input) as they happen and are flushed as part of the frame's
+ * block by CommitFrame().
+*/
+class InputRecorder 
+{
+public:
+    /**
+     * @brief Opens (and truncates) the replay file, throws if it can't be created.
+    */
+    InputRecorder(const char* path);
+    ~InputRecorder() {}
+
+    InputRecorder(const InputRecorder& other) = delete;
+    InputRecorder& operator=(const InputRecorder& other) = delete;
+
+    void RecordKey(int key, int action, int mods);
+
+    /**
+     * @brief Writes out the current frame along with any keys recorded since the last commit.
+     * Must be called exactly once per frame, even when nothing was pressed.
+    */
+    void CommitFrame(uint64_t frameNumber, double timestep);
+
+private:
+    std::ofstream mFile{};
+    std::vector<RecordedKey> mPendingKeys{};
+};
+
+/**
+ * @brief Reads back files written by InputRecorder one frame at a time.
+*/
+class InputReplayer 
+{
+public:
+    /**
+     * @brief Opens the replay file and validates its header, throws if it isn't a replay
+     * (or was written by an incompatible version).
+    */
+    InputReplayer(const char* path);
+    ~InputReplayer() {}
+
+    InputReplayer(const InputReplayer& other) = delete;
+    InputReplayer& operator=(const InputReplayer& other) = delete;
+
+    /**
+     * @brief Reads the next frame block.
+     * @return false once the recording has run out (or is truncated).
+    */
+    bool ReadFrame(RecordedFrame& frame);
+
+private:
+    std::ifstream mFile{};
+};
+}
+
+#endif
@@ -1,35 +1,558 @@
 #include "ResourceManager.hpp"
+#include "Graphics/Shader/Image.hpp"
+#include "Graphics/Shader/Shader.hpp"
+#include "Logging.hpp"
+#include "Profiler/Profiler.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <filesystem>
 
-namespace mt 
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace mt
+{
+
+// Helper Functions.
+//---
+namespace
+{
+    // Runs the compiler directly rather than through a shell, so that nothing in the watched
+    // paths can be interpreted as a command.
+    bool CompileShader(const std::string& compiler, const std::string& path)
+    {
+        std::string output = path + ".spv";
+        const char* arguments[] = {compiler.c_str(), "-V", path.c_str(), "-o", output.c_str(), nullptr};
+
+        pid_t child = fork();
+        if(child < 0)
+        {
+            return false;
+        }
+
+        if(child == 0)
+        {
+            execvp(arguments[0], const_cast<char* const*>(arguments));
+            _exit(127);
+        }
+
+        int status = 0;
+        while(waitpid(child, &status, 0) < 0)
+        {
+            if(errno != EINTR)
+            {
+                return false;
+            }
+        }
+
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+}
+
+// Shared between the main thread and the worker decoding it. Workers only ever touch this
+// (never the registry), and the shared_ptr keeps it alive if the image is released mid-decode.
+struct ResourceManager::PendingImage
+{
+    enum Stage : uint8_t
+    {
+        Queued = 0,
+        Decoding = 1,
+        Decoded = 2,
+        Failed = 3
+    };
+
+    ImageHandle handle{};
+    std::string path = "";
+    bool isReload = false;
+    std::atomic<uint8_t> stage{Queued};
+    ImageData data{};
+    std::string error = "";
+};
+
+ResourceManager::ResourceManager(JobSystem& jobSystem, uint32_t uploadsPerFrame)
+    : mJobSystem{jobSystem}, mUploadsPerFrame{uploadsPerFrame}
+{
+
+}
+
+ResourceManager::~ResourceManager()
+{
+    // In-flight jobs still decrement the counters.
+    mJobSystem.Wait(mDecodeCounter);
+    mJobSystem.Wait(mCompileCounter);
+}
+
+ImageHandle ResourceManager::LoadImage(const std::string& imagePath)
+{
+    std::string path = NormaliseAssetPath(imagePath);
+
+    bool isNew = false;
+    ImageHandle handle = mImages.Acquire(path, isNew);
+
+    if(isNew)
+    {
+        QueueDecode(handle, path, false);
+    }
+
+    return handle;
+}
+
+void ResourceManager::QueueDecode(ImageHandle handle, const std::string& path, bool isReload)
+{
+    auto pending = std::make_shared<PendingImage>();
+    pending->handle = handle;
+    pending->path = path;
+    pending->isReload = isReload;
+    mPendingImages.push_back(pending);
+
+    // Reloads come from edits on disk, which are newer than anything in the pack.
+    std::shared_ptr<const AssetPack> pack = isReload ? nullptr : mPack;
+
+    mJobSystem.Submit([pending, codecs = mTextureCodecs, generateMipmaps = mCpuMipmaps, pack]()
+    {
+        pending->stage.store(PendingImage::Decoding, std::memory_order_relaxed);
+
+        try
+        {
+            pending->data = Image::Decode(pending->path, *codecs, generateMipmaps, pack);
+            pending->stage.store(PendingImage::Decoded, std::memory_order_release);
+        }
+        catch(const std::exception& e)
+        {
+            pending->error = e.what();
+            pending->stage.store(PendingImage::Failed, std::memory_order_release);
+        }
+    }, &mDecodeCounter);
+}
+
+ImageHandle ResourceManager::LoadImage(std::string key, std::string imagePath)
+{
+    // Acquired before the old one is released, so that loading a key again with the same path
+    // keeps the image instead of destroying it and loading it all over again.
+    ImageHandle handle = LoadImage(imagePath);
+
+    auto existing = mImageKeys.find(key);
+    if(existing != mImageKeys.end())
+    {
+        Release(existing->second);
+    }
+
+    mImageKeys[key] = handle;
+    return handle;
+}
+
+std::vector<ImageHandle> ResourceManager::LoadImages(const std::vector<std::string>& imagePaths)
 {
-ResourceManager::ResourceManager() 
+    std::vector<ImageHandle> handles{};
+    handles.reserve(imagePaths.size());
+
+    for(const auto& imagePath : imagePaths)
+    {
+        handles.push_back(LoadImage(imagePath));
+    }
+
+    return handles;
+}
+
+ShaderHandle ResourceManager::LoadShader(std::string key, std::string vertexPath, std::string fragmentPath)
 {
-    
+    std::string vertex = NormaliseAssetPath(vertexPath);
+    std::string fragment = NormaliseAssetPath(fragmentPath);
+
+    // A shader is identified by the pair of stages.
+    bool isNew = false;
+    ShaderHandle handle = mShaders.Acquire(vertex + "|" + fragment, isNew);
+
+    if(isNew)
+    {
+        mPendingShaders.push_back(PendingShader{handle, vertex, fragment});
+    }
+
+    // Same as with images, released only once the new one has been acquired.
+    auto existing = mShaderKeys.find(key);
+    if(existing != mShaderKeys.end())
+    {
+        Release(existing->second);
+    }
+
+    mShaderKeys[key] = handle;
+    return handle;
+}
+
+void ResourceManager::UnloadShader(std::string key)
+{
+    auto existing = mShaderKeys.find(key);
+    if(existing != mShaderKeys.end())
+    {
+        Release(existing->second);
+        mShaderKeys.erase(existing);
+    }
 }
 
-ResourceManager::~ResourceManager() 
+void ResourceManager::UnloadImage(std::string key)
 {
-    
+    auto existing = mImageKeys.find(key);
+    if(existing != mImageKeys.end())
+    {
+        Release(existing->second);
+        mImageKeys.erase(existing);
+    }
 }
 
-void ResourceManager::LoadImage(std::string key, std::string imagePath) 
+void ResourceManager::Release(ImageHandle handle)
 {
-    
+    // Any pending decode is discarded by ProcessImages() once it sees the handle has gone stale.
+    mImages.Release(handle);
 }
 
-void ResourceManager::LoadShader(std::string key, std::string vertexPath, std::string fragmentPath) 
+void ResourceManager::Release(ShaderHandle handle)
 {
-    
+    mShaders.Release(handle);
 }
 
-void ResourceManager::UnloadShader(std::string key) 
+void ResourceManager::UnloadAll()
 {
-    
+    mJobSystem.Wait(mDecodeCounter);
+
+    mPendingImages.clear();
+    mPendingShaders.clear();
+    mImageKeys.clear();
+    mShaderKeys.clear();
+
+    mImages.Clear();
+    mShaders.Clear();
 }
 
-void ResourceManager::UnloadImage(std::string key) 
+AssetState ResourceManager::GetState(ImageHandle handle) const
 {
-    
+    AssetState state = mImages.GetState(handle);
+
+    if(state == AssetState::Queued)
+    {
+        for(const auto& pending : mPendingImages)
+        {
+            if(pending->handle == handle && pending->stage.load(std::memory_order_relaxed) != PendingImage::Queued)
+            {
+                return AssetState::Loading;
+            }
+        }
+    }
+
+    return state;
+}
+
+AssetState ResourceManager::GetState(ShaderHandle handle) const
+{
+    return mShaders.GetState(handle);
+}
+
+Image* ResourceManager::GetImage(ImageHandle handle) const
+{
+    return mImages.Get(handle);
+}
+
+Shader* ResourceManager::GetShader(ShaderHandle handle) const
+{
+    return mShaders.Get(handle);
+}
+
+ImageHandle ResourceManager::GetImageHandle(const std::string& key) const
+{
+    auto existing = mImageKeys.find(key);
+    return existing != mImageKeys.end() ? existing->second : ImageHandle{};
+}
+
+ShaderHandle ResourceManager::GetShaderHandle(const std::string& key) const
+{
+    auto existing = mShaderKeys.find(key);
+    return existing != mShaderKeys.end() ? existing->second : ShaderHandle{};
+}
+
+void ResourceManager::SetTextureCodecs(const std::vector<TextureCodec>& codecs)
+{
+    mTextureCodecs = std::make_shared<const std::vector<TextureCodec>>(codecs);
+}
+
+void ResourceManager::MountPack(const std::string& packPath, const std::string& mountDirectory)
+{
+    mPack = std::make_shared<const AssetPack>(packPath, mountDirectory);
+
+    MT_LOG_INFO("Mounted asset pack {} ({} entries)", packPath, mPack->GetEntryCount());
+}
+
+void ResourceManager::EnableHotReload(const std::string& directory, const std::string& shaderCompiler)
+{
+    mFileWatcher = std::make_unique<FileWatcher>(directory);
+    mShaderCompiler = shaderCompiler;
+
+    MT_LOG_INFO("Hot reloading assets under {}", directory);
+}
+
+void ResourceManager::Update()
+{
+    MT_PROFILE_FUNCTION();
+
+    if(mFileWatcher)
+    {
+        ProcessChanges();
+    }
+
+    ProcessImages(mUploadsPerFrame);
+    ProcessShaders();
+}
+
+void ResourceManager::FinishLoading()
+{
+    MT_PROFILE_FUNCTION();
+
+    mJobSystem.Wait(mDecodeCounter);
+
+    ProcessImages(UINT32_MAX);
+    ProcessShaders();
+}
+
+void ResourceManager::ProcessImages(uint32_t uploadBudget)
+{
+    std::vector<std::shared_ptr<PendingImage>> decoded{};
+
+    for(size_t i = 0; i < mPendingImages.size();)
+    {
+        PendingImage& pending = *mPendingImages[i];
+        auto* entry = mImages.Find(pending.handle);
+        uint8_t stage = pending.stage.load(std::memory_order_acquire);
+
+        bool isFinished = true;
+
+        if(!entry)
+        {
+            // Released before it finished loading - a running decode finishes into the void.
+        }
+        else if(stage == PendingImage::Failed)
+        {
+            MT_LOG_ERROR("Failed to load image {}: {}", pending.path, pending.error);
+
+            // A broken edit shouldn't take down an image that was working.
+            if(!pending.isReload || !entry->asset)
+            {
+                entry->state = AssetState::Failed;
+            }
+        }
+        else if(stage == PendingImage::Decoded && (mImageUploader || mImageBatchUploader) && uploadBudget > 0)
+        {
+            uploadBudget--;
+            decoded.push_back(mPendingImages[i]);
+        }
+        else {
+            // Reloading images stay Resident (with their old contents) in the meantime.
+            if(stage != PendingImage::Queued && !pending.isReload)
+            {
+                entry->state = AssetState::Loading;
+            }
+            isFinished = false;
+        }
+
+        if(isFinished)
+        {
+            // Order doesn't matter, so swap-and-pop rather than shifting everything down.
+            mPendingImages[i] = std::move(mPendingImages.back());
+            mPendingImages.pop_back();
+        }
+        else {
+            i++;
+        }
+    }
+
+    if(!decoded.empty())
+    {
+        UploadImages(decoded);
+    }
+}
+
+void ResourceManager::UploadImages(const std::vector<std::shared_ptr<PendingImage>>& decoded)
+{
+    MT_PROFILE_FUNCTION();
+
+    std::vector<std::unique_ptr<Image>> images(decoded.size());
+    std::vector<std::string> errors(decoded.size());
+
+    if(mImageBatchUploader)
+    {
+        std::vector<const ImageData*> data{};
+        for(const auto& pending : decoded)
+        {
+            data.push_back(&pending->data);
+        }
+
+        try
+        {
+            images = mImageBatchUploader(data);
+
+            if(images.size() != decoded.size())
+            {
+                throw std::runtime_error("The batch uploader returned the wrong number of images!");
+            }
+        }
+        catch(const std::exception& e)
+        {
+            std::fill(errors.begin(), errors.end(), e.what());
+        }
+    }
+    else {
+        for(size_t i = 0; i < decoded.size(); i++)
+        {
+            try
+            {
+                images[i] = mImageUploader(decoded[i]->data);
+            }
+            catch(const std::exception& e)
+            {
+                errors[i] = e.what();
+            }
+        }
+    }
+
+    for(size_t i = 0; i < decoded.size(); i++)
+    {
+        const PendingImage& pending = *decoded[i];
+        auto* entry = mImages.Find(pending.handle);
+
+        if(!entry)
+        {
+            continue;
+        }
+
+        if(!errors[i].empty())
+        {
+            MT_LOG_ERROR("Failed to upload image {}: {}", pending.path, errors[i]);
+
+            if(!pending.isReload || !entry->asset)
+            {
+                entry->state = AssetState::Failed;
+            }
+            continue;
+        }
+
+        Retire(std::move(entry->asset));
+        entry->asset = std::move(images[i]);
+        entry->state = AssetState::Resident;
+
+        if(pending.isReload)
+        {
+            MT_LOG_INFO("Reloaded image {}", pending.path);
+        }
+    }
+}
+
+void ResourceManager::ProcessShaders()
+{
+    if(!mShaderFactory)
+    {
+        return;
+    }
+
+    // Listeners may load shaders, so work on a copy.
+    std::vector<PendingShader> pendingShaders = std::move(mPendingShaders);
+    mPendingShaders.clear();
+
+    for(const auto& pending : pendingShaders)
+    {
+        auto* entry = mShaders.Find(pending.handle);
+        if(!entry)
+        {
+            continue;
+        }
+
+        try
+        {
+            std::unique_ptr<Shader> shader = mShaderFactory(pending.vertexPath, pending.fragmentPath);
+            Retire(std::move(entry->asset));
+            entry->asset = std::move(shader);
+            entry->state = AssetState::Resident;
+        }
+        catch(const std::exception& e)
+        {
+            MT_LOG_ERROR("Failed to load shader {} / {}: {}", pending.vertexPath, pending.fragmentPath, e.what());
+
+            if(!pending.isReload || !entry->asset)
+            {
+                entry->state = AssetState::Failed;
+            }
+            continue;
+        }
+
+        if(pending.isReload)
+        {
+            MT_LOG_INFO("Reloaded shader {} / {}", pending.vertexPath, pending.fragmentPath);
+        }
+    }
+}
+
+void ResourceManager::ProcessChanges()
+{
+    for(const auto& path : mFileWatcher->Poll())
+    {
+        std::string extension = std::filesystem::path(path).extension().string();
+
+        if(extension == ".vert" || extension == ".frag" || extension == ".comp")
+        {
+            // Same naming as the Shaders target, e.g: simple.frag -> simple.frag.spv. Writing the
+            // output triggers the reload, whoever compiled it.
+            mJobSystem.Submit([compiler = mShaderCompiler, path]()
+            {
+                if(!CompileShader(compiler, path))
+                {
+                    MT_LOG_ERROR("Failed to compile shader {}", path);
+                }
+            }, &mCompileCounter);
+            continue;
+        }
+
+        if(extension == ".spv")
+        {
+            mShaders.ForEach([&](ShaderHandle handle, AssetRegistry<Shader>::Entry& entry)
+            {
+                size_t separator = entry.path.find('|');
+                std::string vertex = entry.path.substr(0, separator);
+                std::string fragment = entry.path.substr(separator + 1);
+
+                if(vertex == path || fragment == path)
+                {
+                    mPendingShaders.push_back(PendingShader{handle, vertex, fragment, true});
+                }
+            });
+
+            for(const auto& listener : mShaderReloadListeners)
+            {
+                listener(path);
+            }
+            continue;
+        }
+
+        // Either a source image or one of its cooked versions.
+        mImages.ForEach([&](ImageHandle handle, AssetRegistry<Image>::Entry& entry)
+        {
+            bool isAffected = entry.path == path;
+            for(size_t i = 0; i < mTextureCodecs->size() && !isAffected; i++)
+            {
+                isAffected = GetCookedTexturePath(entry.path, (*mTextureCodecs)[i]) == path;
+            }
+
+            if(isAffected)
+            {
+                QueueDecode(handle, entry.path, true);
+            }
+        });
+    }
+}
+
+template<typename T>
+void ResourceManager::Retire(std::unique_ptr<T> asset)
+{
+    if(asset && mRetireQueue)
+    {
+        mRetireQueue->Retire(std::move(asset));
+    }
+}
 }
-}
\ No newline at end of file
@@ -1,59 +1,257 @@
 #ifndef MAMMOTH_2D_RESOURCE_MANAGER_HPP
 #define MAMMOTH_2D_RESOURCE_MANAGER_HPP
 
+#include "Resources/AssetRegistry.hpp"
+#include "Resources/AssetPack.hpp"
+#include "Resources/FileWatcher.hpp"
+#include "Resources/Ktx2.hpp"
+#include "Jobs/JobSystem.hpp"
+#include "Memory/RetireQueue.hpp"
+
+#include <functional>
+#include <memory>
 #include <unordered_map>
 #include <string>
+#include <vector>
 
-namespace mt 
+namespace mt
 {
 
+class Image;
+class Shader;
+struct ImageData;
+
+typedef Handle<Image> ImageHandle;
+typedef Handle<Shader> ShaderHandle;
+
+// Creates the GPU side of an image from its decoded pixels (always called on the main thread).
+typedef std::function<std::unique_ptr<Image>(const ImageData& data)> ImageUploader;
+// Same, but for every image that's ready in one go (see Image::UploadBatch()), returning them in order.
+typedef std::function<std::vector<std::unique_ptr<Image>>(const std::vector<const ImageData*>& data)> ImageBatchUploader;
+// Creates a shader from its vertex and fragment paths (always called on the main thread).
+typedef std::function<std::unique_ptr<Shader>(const std::string& vertexPath, const std::string& fragmentPath)> ShaderFactory;
+// Told the (normalised) path of every SPIR-V file that changed on disk, so that whatever was built
+// from it outside the manager (pipelines) can be rebuilt. Called on the main thread.
+typedef std::function<void(const std::string& spirvPath)> ShaderReloadListener;
+
 /**
- * @brief Holds all the resources that are given by the user (in the derived IGame class 
- * instance) and queried by the engine at some point (mostly by the renderer 
- * during graphics preparation). This class is currently undergoin lots of changes as I decide
- * that different variables should be considered as resources. 
- * At the moment, only shader file paths and image files paths are supported, but I may end
- * up changing this.
+ * @brief Holds all the resources that are given by the user (in the derived IGame class
+ * instance) and queried by the engine at some point (mostly by the renderer
+ * during graphics preparation).
+ * Every load returns a handle straight away and the actual work happens in the background:
+ * images are decoded in parallel on the job system, then uploaded on the main thread by Update()
+ * (a limited number per frame, so that streaming never causes a hitch). Loading the same file
+ * twice, however it's spelled, just adds a reference to the first load, and an asset is only
+ * destroyed once every reference has been released.
+ * Loads, unloads and queries are main thread only.
 */
 class ResourceManager
 {
 public:
-    ResourceManager();
+    /**
+     * @param jobSystem Where decoding jobs are submitted to.
+     * @param uploadsPerFrame The maximum number of images that Update() uploads per call.
+    */
+    ResourceManager(JobSystem& jobSystem, uint32_t uploadsPerFrame = 8);
     ~ResourceManager();
 
+    ResourceManager(const ResourceManager& other) = delete;
+    ResourceManager& operator=(const ResourceManager& other) = delete;
+
     /**
-     * Creates and stores an Image object from a file path
-     * @param key The key that the Image object will be stored as. 
+     * @brief Queues an image for loading (or adds a reference to it if it's already known).
      * @param imagePath Relative or Absolute path to the image/texture.
+     * @return A handle that's valid immediately - check GetState() to see when it's usable.
     */
-    void LoadImage(std::string key, std::string imagePath);
+    ImageHandle LoadImage(const std::string& imagePath);
+
+    /**
+     * @brief Same as above, but also stores the handle under a key so that it can be looked up
+     * (and unloaded) by name.
+     * @param key The key that the Image object will be stored as.
+     * @param imagePath Relative or Absolute path to the image/texture.
+    */
+    ImageHandle LoadImage(std::string key, std::string imagePath);
+
+    /**
+     * @brief Loads a whole set of images at once, e.g: everything a level needs. They're all
+     * decoded in parallel, call FinishLoading() to block until they're resident.
+    */
+    std::vector<ImageHandle> LoadImages(const std::vector<std::string>& imagePaths);
 
     /**
      * Creates and stores a Shader object from paths to a Vertex and Fragment shader
-     * @param key The key that the Image object will be stored as. 
+     * @param key The key that the Image object will be stored as.
      * @param vertexPath Relative or Absolute path to the Vertex shader.
      * @param fragmentPath Relative or Absolute path to the Fragment shader.
     */
-    void LoadShader(std::string key, std::string vertexPath, std::string fragmentPath);
+    ShaderHandle LoadShader(std::string key, std::string vertexPath, std::string fragmentPath);
 
     /**
-     * Attempts to find the key and delete its corresponding shader object.
+     * Attempts to find the key and release its corresponding shader object.
      * @param key key associated with the object that you wish to delete (what you loaded the asset under).
-     * @return Whether the key was succesfully found or not.
     */
     void UnloadShader(std::string key);
 
     /**
-     * Attempts to find the key and delete its corresponding shader object.
+     * Attempts to find the key and release its corresponding image object.
      * @param key key associated with the object that you wish to delete (what you loaded the asset under).
-     * @return Whether the key was succesfully found or not.
     */
     void UnloadImage(std::string key);
 
+    /**
+     * @brief Drops one reference, destroying the asset once no references are left.
+    */
+    void Release(ImageHandle handle);
+    void Release(ShaderHandle handle);
+
+    /**
+     * @brief Destroys every asset, regardless of references. Must happen before the device goes away.
+    */
+    void UnloadAll();
+
+    AssetState GetState(ImageHandle handle) const;
+    AssetState GetState(ShaderHandle handle) const;
+
+    /**
+     * @return The asset, or nullptr if it isn't resident (yet).
+    */
+    Image* GetImage(ImageHandle handle) const;
+    Shader* GetShader(ShaderHandle handle) const;
+
+    ImageHandle GetImageHandle(const std::string& key) const;
+    ShaderHandle GetShaderHandle(const std::string& key) const;
+
+    /**
+     * @brief Hands decoded images over to the uploader (up to the per-frame limit) and creates
+     * any queued shaders. Called once per frame by the engine.
+    */
+    void Update();
+
+    /**
+     * @brief Blocks until everything queued so far has been decoded and uploaded (or has failed).
+     * The main thread helps out with decoding while it waits. Meant for loading screens.
+    */
+    void FinishLoading();
+
+    /**
+     * @brief The renderer provides these once the device exists. Until then decoded images and
+     * queued shaders simply wait in the Loading/Queued states.
+    */
+    inline void SetImageUploader(ImageUploader uploader) { mImageUploader = std::move(uploader); }
+
+    /**
+     * @brief Preferred over the single image uploader when both are set: every image that has
+     * finished decoding (up to the per-frame limit) is uploaded with one submission, rather
+     * than waiting on the queue for each. If the batch throws, every image in it fails.
+    */
+    inline void SetImageBatchUploader(ImageBatchUploader uploader) { mImageBatchUploader = std::move(uploader); }
+    inline void SetShaderFactory(ShaderFactory factory) { mShaderFactory = std::move(factory); }
+
+    /**
+     * @brief Cooked texture codecs to look for before decoding an image's source file, best
+     * first (see Image::GetSupportedCodecs()). Only affects loads queued afterwards.
+    */
+    void SetTextureCodecs(const std::vector<TextureCodec>& codecs);
+
+    /**
+     * @brief Builds the mip chains of decoded images on the workers, for devices that can't
+     * blit them at upload time (see Image::SupportsLinearBlit()).
+    */
+    inline void SetCpuMipmaps(bool enabled) { mCpuMipmaps = enabled; }
+
+    /**
+     * @brief Maps an asset pack (see Tools/PackBuilder) that images are then read from before
+     * falling back to the filesystem. Only affects loads queued afterwards, and replaces any
+     * previously mounted pack. Throws if the pack can't be opened.
+     * @param mountDirectory The directory the pack was built from, paths are matched relative to it.
+    */
+    void MountPack(const std::string& packPath, const std::string& mountDirectory = ".");
+
+    /**
+     * @brief Development only: watches a directory for changes and reloads the affected assets
+     * in place, keeping their handles. Edited GLSL is compiled to SPIR-V on a worker (which then
+     * reloads every shader using it), and edited images (or their cooked versions) are decoded
+     * and uploaded again. Replaced assets go to the retire queue, and a failed reload keeps the
+     * old asset. Throws if the directory can't be watched.
+     * @param shaderCompiler glslangValidator (or anything taking the same -V <in> -o <out> arguments).
+    */
+    void EnableHotReload(const std::string& directory, const std::string& shaderCompiler = "glslangValidator");
+
+    /**
+     * @brief Where assets replaced by hot reloads go to be destroyed once the GPU is done with
+     * them. Without one they're destroyed immediately, which is only safe when nothing's rendering.
+    */
+    inline void SetRetireQueue(RetireQueue* retireQueue) { mRetireQueue = retireQueue; }
+
+    inline void AddShaderReloadListener(ShaderReloadListener listener) { mShaderReloadListeners.push_back(std::move(listener)); }
+
+private:
+    struct PendingImage;
+
+    struct PendingShader
+    {
+        ShaderHandle handle{};
+        std::string vertexPath = "";
+        std::string fragmentPath = "";
+        bool isReload = false;
+    };
+
+    void QueueDecode(ImageHandle handle, const std::string& path, bool isReload);
+
+    /**
+     * @brief Turns file changes reported by the watcher into shader compiles and reloads.
+    */
+    void ProcessChanges();
+
+    template<typename T>
+    void Retire(std::unique_ptr<T> asset);
+
+    /**
+     * @brief Processes finished decodes.
+     * @param uploadBudget The maximum number of images to upload.
+    */
+    void ProcessImages(uint32_t uploadBudget);
+
+    /**
+     * @brief Uploads decoded images (through the batch uploader if there is one) and makes them resident.
+    */
+    void UploadImages(const std::vector<std::shared_ptr<PendingImage>>& decoded);
+
+    void ProcessShaders();
+
 private:
-    std::unordered_map<std::string, std::unique_ptr<std::string>> mShaders{};
-    std::unordered_map<std::string, std::unique_ptr<std::string>> mImages{};
+    JobSystem& mJobSystem;
+    JobCounter mDecodeCounter{};
+    JobCounter mCompileCounter{};
+    uint32_t mUploadsPerFrame = 8;
+
+    AssetRegistry<Image> mImages;
+    AssetRegistry<Shader> mShaders;
+
+    std::vector<std::shared_ptr<PendingImage>> mPendingImages{};
+    std::vector<PendingShader> mPendingShaders{};
+
+    std::unordered_map<std::string, ImageHandle> mImageKeys{};
+    std::unordered_map<std::string, ShaderHandle> mShaderKeys{};
+
+    // Shared with in-flight decode jobs, so replaced rather than modified.
+    std::shared_ptr<const std::vector<TextureCodec>> mTextureCodecs = std::make_shared<const std::vector<TextureCodec>>();
+
+    bool mCpuMipmaps = false;
+
+    // Same as the codecs: in-flight jobs (and images using its memory) keep the old one mapped.
+    std::shared_ptr<const AssetPack> mPack = nullptr;
+
+    ImageUploader mImageUploader = nullptr;
+    ImageBatchUploader mImageBatchUploader = nullptr;
+    ShaderFactory mShaderFactory = nullptr;
+
+    std::unique_ptr<FileWatcher> mFileWatcher = nullptr;
+    std::string mShaderCompiler = "";
+    RetireQueue* mRetireQueue = nullptr;
+    std::vector<ShaderReloadListener> mShaderReloadListeners{};
 };
 }
 
-#endif
\ No newline at end of file
+#endif
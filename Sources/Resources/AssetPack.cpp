@@ -0,0 +1,213 @@
+#include "AssetPack.hpp"
+#include "AssetRegistry.hpp"
+#include "Lz4.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mt
+{
+
+PackFormat GetPackFormat(const std::string& path)
+{
+    std::string extension = std::filesystem::path(path).extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    if(extension == ".ktx2")
+    {
+        return PackFormat::Ktx2;
+    }
+    if(extension == ".spv")
+    {
+        return PackFormat::Spirv;
+    }
+    if(extension == ".vtex")
+    {
+        return PackFormat::VirtualTexture;
+    }
+    if(extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".tga" || extension == ".bmp")
+    {
+        return PackFormat::Image;
+    }
+    return PackFormat::Raw;
+}
+
+void WriteAssetPack(const std::string& packPath, const std::vector<PackSource>& sources)
+{
+    std::vector<PackEntry> entries{};
+    std::vector<uint8_t> payloads{};
+    uint64_t offset = sizeof(PackHeader);
+
+    for(const auto& source : sources)
+    {
+        PackEntry entry{};
+        entry.pathHash = HashAssetPath(source.path);
+        entry.size = source.data.size();
+        entry.format = GetPackFormat(source.path);
+
+        std::vector<uint8_t> compressed{};
+        if(source.compress)
+        {
+            compressed = Lz4Compress(source.data.data(), source.data.size());
+        }
+
+        // Decompressing isn't free, so it has to be worth at least 10%.
+        bool useCompressed = source.compress && compressed.size() < source.data.size() - source.data.size() / 10;
+        const std::vector<uint8_t>& stored = useCompressed ? compressed : source.data;
+
+        entry.flags = useCompressed ? static_cast<uint32_t>(PACK_ENTRY_LZ4) : 0u;
+        entry.storedSize = stored.size();
+
+        uint64_t aligned = (offset + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+        payloads.resize(payloads.size() + (aligned - offset), 0);
+        entry.offset = aligned;
+
+        payloads.insert(payloads.end(), stored.begin(), stored.end());
+        offset = aligned + stored.size();
+
+        entries.push_back(entry);
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const PackEntry& a, const PackEntry& b) { return a.pathHash < b.pathHash; });
+
+    for(size_t i = 1; i < entries.size(); i++)
+    {
+        if(entries[i].pathHash == entries[i - 1].pathHash)
+        {
+            throw std::runtime_error("Two assets in " + packPath + " have the same path hash, rename one of them!");
+        }
+    }
+
+    PackHeader header{};
+    std::memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+    header.version = PACK_VERSION;
+    header.entryCount = static_cast<uint32_t>(entries.size());
+    header.indexOffset = (offset + alignof(PackEntry) - 1) / alignof(PackEntry) * alignof(PackEntry);
+    payloads.resize(payloads.size() + (header.indexOffset - offset), 0);
+
+    std::ofstream stream{packPath, std::ios::binary | std::ios::trunc};
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(payloads.data()), payloads.size());
+    stream.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(PackEntry));
+
+    if(!stream)
+    {
+        throw std::runtime_error("Failed to write asset pack " + packPath);
+    }
+}
+
+AssetPack::AssetPack(const std::string& packPath, const std::string& mountDirectory)
+    : mPath{packPath}
+{
+    mMountDirectory = std::filesystem::absolute(std::filesystem::path(mountDirectory)).lexically_normal().generic_string();
+
+    int file = open(packPath.c_str(), O_RDONLY);
+    if(file < 0)
+    {
+        throw std::runtime_error("Failed to open asset pack " + packPath);
+    }
+
+    struct stat status{};
+    if(fstat(file, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(PackHeader))
+    {
+        close(file);
+        throw std::runtime_error(packPath + " is too small to be an asset pack!");
+    }
+
+    mSize = static_cast<size_t>(status.st_size);
+    void* mapping = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, file, 0);
+
+    // The mapping keeps its own reference to the file.
+    close(file);
+
+    if(mapping == MAP_FAILED)
+    {
+        throw std::runtime_error("Failed to map asset pack " + packPath);
+    }
+
+    mData = static_cast<const uint8_t*>(mapping);
+
+    PackHeader header{};
+    std::memcpy(&header, mData, sizeof(header));
+
+    uint64_t indexSize = static_cast<uint64_t>(header.entryCount) * sizeof(PackEntry);
+
+    if(std::memcmp(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 || header.version != PACK_VERSION ||
+        header.indexOffset % alignof(PackEntry) != 0 || header.indexOffset > mSize || mSize - header.indexOffset < indexSize)
+    {
+        munmap(const_cast<uint8_t*>(mData), mSize);
+        throw std::runtime_error(packPath + " is not a valid asset pack (or was built by a different version)!");
+    }
+
+    mEntries = reinterpret_cast<const PackEntry*>(mData + header.indexOffset);
+    mEntryCount = header.entryCount;
+
+    for(uint32_t i = 0; i < mEntryCount; i++)
+    {
+        const PackEntry& entry = mEntries[i];
+        bool isCompressed = entry.flags & PACK_ENTRY_LZ4;
+
+        if(entry.offset > mSize || mSize - entry.offset < entry.storedSize || (!isCompressed && entry.storedSize != entry.size))
+        {
+            munmap(const_cast<uint8_t*>(mData), mSize);
+            throw std::runtime_error(packPath + " has an entry outside of the file!");
+        }
+    }
+
+    // Lookups hit the index at random.
+    madvise(const_cast<uint8_t*>(mData), mSize, MADV_RANDOM);
+}
+
+AssetPack::~AssetPack()
+{
+    munmap(const_cast<uint8_t*>(mData), mSize);
+}
+
+const PackEntry* AssetPack::Find(const std::string& path) const
+{
+    std::filesystem::path absolute = std::filesystem::absolute(std::filesystem::path(path)).lexically_normal();
+    std::string key = absolute.lexically_relative(mMountDirectory).generic_string();
+
+    uint64_t hash = HashAssetPath(key);
+
+    const PackEntry* end = mEntries + mEntryCount;
+    const PackEntry* entry = std::lower_bound(mEntries, end, hash, [](const PackEntry& e, uint64_t h) { return e.pathHash < h; });
+
+    return entry != end && entry->pathHash == hash ? entry : nullptr;
+}
+
+void AssetPack::Read(const PackEntry& entry, void* destination) const
+{
+    if(entry.flags & PACK_ENTRY_LZ4)
+    {
+        if(!Lz4Decompress(GetPayload(entry), entry.storedSize, static_cast<uint8_t*>(destination), entry.size))
+        {
+            throw std::runtime_error("Corrupt compressed entry in asset pack " + mPath);
+        }
+        return;
+    }
+
+    std::memcpy(destination, GetPayload(entry), entry.size);
+}
+
+const uint8_t* AssetPack::Access(const PackEntry& entry, std::vector<uint8_t>& storage) const
+{
+    if(!(entry.flags & PACK_ENTRY_LZ4))
+    {
+        return GetPayload(entry);
+    }
+
+    storage.resize(entry.size);
+    Read(entry, storage.data());
+    return storage.data();
+}
+
+}
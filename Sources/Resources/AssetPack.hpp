@@ -0,0 +1,128 @@
+#ifndef MAMMOTH_2D_ASSET_PACK_HPP
+#define MAMMOTH_2D_ASSET_PACK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mt
+{
+
+// Pack layout: PackHeader, then the payloads (each aligned to PACK_ALIGNMENT), then the index -
+// PackHeader::entryCount PackEntry records sorted by path hash. Everything is little endian.
+constexpr char PACK_MAGIC[8] = {'M', 'T', 'P', 'A', 'C', 'K', '\0', '\0'};
+constexpr uint32_t PACK_VERSION = 1;
+constexpr uint64_t PACK_ALIGNMENT = 64;
+
+enum class PackFormat : uint32_t
+{
+    Raw = 0,
+    Image = 1,      // Anything stb_image can decode.
+    Ktx2 = 2,
+    Spirv = 3,
+    VirtualTexture = 4
+};
+
+enum PackEntryFlags : uint32_t
+{
+    PACK_ENTRY_LZ4 = 1 << 0     // The payload is a single LZ4 block.
+};
+
+struct PackHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t entryCount;
+    uint64_t indexOffset;
+};
+
+struct PackEntry
+{
+    uint64_t pathHash;      // HashAssetPath() of the path relative to the pack's root.
+    uint64_t offset;
+    uint64_t storedSize;    // Size of the payload in the pack.
+    uint64_t size;          // Size once decompressed.
+    PackFormat format;
+    uint32_t flags;
+};
+
+static_assert(sizeof(PackHeader) == 24, "PackHeader must match the on-disk layout!");
+static_assert(sizeof(PackEntry) == 40, "PackEntry must match the on-disk layout!");
+
+/**
+ * @brief Guesses an entry's format from its file extension.
+*/
+PackFormat GetPackFormat(const std::string& path);
+
+struct PackSource
+{
+    std::string path = "";          // Relative to the pack's root, with forward slashes.
+    std::vector<uint8_t> data{};
+    bool compress = false;          // Only kept compressed if that actually saves space.
+};
+
+/**
+ * @brief Writes a pack file. Throws if two paths hash the same or the file can't be written.
+*/
+void WriteAssetPack(const std::string& packPath, const std::vector<PackSource>& sources);
+
+/**
+ * @brief Read-only, memory-mapped view of a pack file. Nothing is read up front: looking an
+ * entry up is a binary search over the (mapped) index, and uncompressed payloads can be used
+ * in place or copied straight into their final destination (e.g: mapped staging memory).
+ * Every method is const and safe to call from any thread.
+*/
+class AssetPack
+{
+public:
+    /**
+     * @param packPath Path to the .pack file.
+     * @param mountDirectory Asset paths are looked up relative to this directory, which should
+     * correspond to the root the pack was built with.
+    */
+    AssetPack(const std::string& packPath, const std::string& mountDirectory = ".");
+    ~AssetPack();
+
+    AssetPack(const AssetPack& other) = delete;
+    AssetPack& operator=(const AssetPack& other) = delete;
+
+    /**
+     * @param path Any spelling of the asset's path (relative to the working directory, or absolute).
+     * @return The entry, or nullptr if the pack doesn't contain the path.
+    */
+    const PackEntry* Find(const std::string& path) const;
+
+    /**
+     * @return The payload exactly as stored - only usable directly if the entry isn't compressed.
+    */
+    inline const uint8_t* GetPayload(const PackEntry& entry) const { return mData + entry.offset; }
+
+    /**
+     * @brief Copies (or decompresses) an entry into destination, which must hold entry.size bytes.
+     * Throws if the payload is corrupt.
+    */
+    void Read(const PackEntry& entry, void* destination) const;
+
+    /**
+     * @brief Gives access to an entry's bytes with as few copies as possible: uncompressed
+     * entries point straight into the mapping, compressed ones are decompressed into storage.
+     * @return A pointer to entry.size bytes, valid for as long as the pack and storage are.
+    */
+    const uint8_t* Access(const PackEntry& entry, std::vector<uint8_t>& storage) const;
+
+    inline uint32_t GetEntryCount() const { return mEntryCount; }
+
+private:
+    std::string mPath = "";
+    std::string mMountDirectory = "";
+
+    const uint8_t* mData = nullptr;
+    size_t mSize = 0;
+
+    const PackEntry* mEntries = nullptr;
+    uint32_t mEntryCount = 0;
+};
+}
+
+#endif
@@ -0,0 +1,20 @@
+#include "AssetRegistry.hpp"
+#include "Hashing.hpp"
+
+#include <filesystem>
+
+namespace mt 
+{
+
+std::string NormaliseAssetPath(const std::string& path) 
+{
+    std::filesystem::path normalised = std::filesystem::absolute(std::filesystem::path(path)).lexically_normal();
+    return normalised.generic_string();
+}
+
+uint64_t HashAssetPath(const std::string& path) 
+{
+    return HashFnv1a(reinterpret_cast<const unsigned char*>(path.data()), path.size());
+}
+
+}
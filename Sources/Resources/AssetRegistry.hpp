@@ -0,0 +1,225 @@
+#ifndef MAMMOTH_2D_ASSET_REGISTRY_HPP
+#define MAMMOTH_2D_ASSET_REGISTRY_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mt 
+{
+
+/**
+ * @brief Typed, generational reference to an asset. The index picks the registry slot and the
+ * generation tells whether the slot still holds the asset the handle was created for, so a 
+ * handle to an unloaded asset can never resolve to whatever reused its slot. 
+ * Default constructed handles are invalid (generations start at 1).
+*/
+template<typename T>
+struct Handle 
+{
+    uint32_t index = 0;
+    uint32_t generation = 0;
+
+    inline bool IsValid() const { return generation != 0; }
+    inline bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+    inline bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+enum class AssetState : uint8_t 
+{
+    Unloaded = 0,   // Stale or invalid handle.
+    Queued = 1,     // Waiting for a worker to pick it up.
+    Loading = 2,    // Being read/decoded, or waiting for its GPU upload.
+    Resident = 3,   // Ready to use.
+    Failed = 4      // Couldn't be loaded (see the log for why).
+};
+
+/**
+ * @brief Makes a path absolute and lexically normal (no "." or ".." segments, forward slashes),
+ * so that different spellings of the same file share one registry entry.
+*/
+std::string NormaliseAssetPath(const std::string& path);
+
+/**
+ * @brief 64-bit FNV-1a hash of a (normalised) path.
+*/
+uint64_t HashAssetPath(const std::string& path);
+
+/**
+ * @brief Bookkeeping shared by every asset type: slots addressed by generational handles,
+ * de-duplication by path hash and reference counting. It knows nothing about how assets are
+ * loaded, that's up to the ResourceManager. Not thread-safe, main thread only.
+*/
+template<typename T>
+class AssetRegistry 
+{
+public:
+    struct Entry 
+    {
+        std::unique_ptr<T> asset = nullptr;
+        std::string path = "";
+        uint64_t pathHash = 0;
+        uint32_t refCount = 0;
+        uint32_t generation = 1;
+        AssetState state = AssetState::Unloaded;
+    };
+
+    AssetRegistry() {}
+    ~AssetRegistry() {}
+
+    AssetRegistry(const AssetRegistry& other) = delete;
+    AssetRegistry& operator=(const AssetRegistry& other) = delete;
+
+    /**
+     * @brief Returns the handle of the asset already registered under this path (adding a
+     * reference), or registers a new, Queued one.
+     * @param path An already normalised path (see NormaliseAssetPath()).
+     * @param isNew Set to whether a new entry was created, i.e: whether the caller needs to load it.
+    */
+    Handle<T> Acquire(const std::string& path, bool& isNew) 
+    {
+        uint64_t pathHash = HashAssetPath(path);
+
+        auto existing = mIndexByHash.find(pathHash);
+        if(existing != mIndexByHash.end() && mEntries[existing->second].path == path) 
+        {
+            Entry& entry = mEntries[existing->second];
+            entry.refCount++;
+            isNew = false;
+            return Handle<T>{existing->second, entry.generation};
+        }
+
+        uint32_t index = 0;
+        if(!mFreeIndices.empty()) 
+        {
+            index = mFreeIndices.back();
+            mFreeIndices.pop_back();
+        }
+        else {
+            index = static_cast<uint32_t>(mEntries.size());
+            mEntries.emplace_back();
+        }
+
+        Entry& entry = mEntries[index];
+        entry.path = path;
+        entry.pathHash = pathHash;
+        entry.refCount = 1;
+        entry.state = AssetState::Queued;
+
+        // A (vanishingly rare) hash collision just means the second path isn't de-duplicated.
+        if(existing == mIndexByHash.end()) 
+        {
+            mIndexByHash[pathHash] = index;
+        }
+
+        isNew = true;
+        return Handle<T>{index, entry.generation};
+    }
+
+    /**
+     * @brief Drops a reference. Once the last one is gone the asset is destroyed and the slot 
+     * recycled, invalidating every outstanding handle to it.
+     * @return Whether the asset was destroyed.
+    */
+    bool Release(Handle<T> handle) 
+    {
+        Entry* entry = Find(handle);
+        if(!entry || --entry->refCount > 0) 
+        {
+            return false;
+        }
+
+        auto indexed = mIndexByHash.find(entry->pathHash);
+        if(indexed != mIndexByHash.end() && indexed->second == handle.index) 
+        {
+            mIndexByHash.erase(indexed);
+        }
+
+        entry->asset.reset();
+        entry->path.clear();
+        entry->state = AssetState::Unloaded;
+        entry->generation++;
+        mFreeIndices.push_back(handle.index);
+
+        return true;
+    }
+
+    /**
+     * @return The entry the handle refers to, or nullptr if the handle is invalid or stale.
+    */
+    Entry* Find(Handle<T> handle) 
+    {
+        if(!handle.IsValid() || handle.index >= mEntries.size() || mEntries[handle.index].generation != handle.generation) 
+        {
+            return nullptr;
+        }
+        return &mEntries[handle.index];
+    }
+
+    const Entry* Find(Handle<T> handle) const 
+    {
+        return const_cast<AssetRegistry*>(this)->Find(handle);
+    }
+
+    /**
+     * @return The asset, or nullptr unless it's Resident.
+    */
+    T* Get(Handle<T> handle) const 
+    {
+        const Entry* entry = Find(handle);
+        return entry && entry->state == AssetState::Resident ? entry->asset.get() : nullptr;
+    }
+
+    AssetState GetState(Handle<T> handle) const 
+    {
+        const Entry* entry = Find(handle);
+        return entry ? entry->state : AssetState::Unloaded;
+    }
+
+    /**
+     * @brief Destroys every asset regardless of its reference count.
+    */
+    void Clear() 
+    {
+        for(uint32_t i = 0; i < mEntries.size(); i++) 
+        {
+            if(mEntries[i].state != AssetState::Unloaded) 
+            {
+                mEntries[i].asset.reset();
+                mEntries[i].path.clear();
+                mEntries[i].refCount = 0;
+                mEntries[i].state = AssetState::Unloaded;
+                mEntries[i].generation++;
+                mFreeIndices.push_back(i);
+            }
+        }
+        mIndexByHash.clear();
+    }
+
+    /**
+     * @brief Calls function(Handle<T>, Entry&) for every registered asset, whatever its state.
+    */
+    template<typename F>
+    void ForEach(F&& function) 
+    {
+        for(uint32_t i = 0; i < mEntries.size(); i++) 
+        {
+            if(mEntries[i].refCount > 0) 
+            {
+                function(Handle<T>{i, mEntries[i].generation}, mEntries[i]);
+            }
+        }
+    }
+
+    inline size_t GetCount() const { return mEntries.size() - mFreeIndices.size(); }
+
+private:
+    std::vector<Entry> mEntries{};
+    std::vector<uint32_t> mFreeIndices{};
+    std::unordered_map<uint64_t, uint32_t> mIndexByHash{};
+};
+}
+
+#endif
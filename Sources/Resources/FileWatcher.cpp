@@ -0,0 +1,159 @@
+#include "FileWatcher.hpp"
+#include "AssetRegistry.hpp"
+#include "Logging.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+#ifdef __linux__
+    #include <sys/inotify.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif
+
+namespace mt 
+{
+
+#ifdef __linux__
+
+// Editors tend to save by writing a temporary file and renaming it over the original, hence
+// IN_MOVED_TO as well as IN_CLOSE_WRITE.
+static constexpr uint32_t FILE_EVENTS = IN_CLOSE_WRITE | IN_MOVED_TO;
+static constexpr uint32_t DIRECTORY_EVENTS = IN_CREATE | IN_MOVED_TO;
+
+FileWatcher::FileWatcher(const std::string& directory) 
+{
+    mInotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(mInotify < 0) 
+    {
+        throw std::runtime_error("Failed to initialise inotify!");
+    }
+
+    std::error_code error{};
+    if(!std::filesystem::is_directory(directory, error)) 
+    {
+        close(mInotify);
+        throw std::runtime_error("Can't watch " + directory + ", it isn't a directory!");
+    }
+
+    std::string root = NormaliseAssetPath(directory);
+    if(root.size() > 1 && root.back() == '/') 
+    {
+        root.pop_back();
+    }
+
+    AddWatch(root);
+}
+
+FileWatcher::~FileWatcher() 
+{
+    // Closing the instance removes every watch.
+    close(mInotify);
+}
+
+void FileWatcher::AddWatch(const std::string& directory) 
+{
+    int watch = inotify_add_watch(mInotify, directory.c_str(), FILE_EVENTS | DIRECTORY_EVENTS | IN_ONLYDIR);
+    if(watch < 0) 
+    {
+        MT_LOG_WARN("Failed to watch {} for changes", directory);
+        return;
+    }
+
+    mDirectories[watch] = directory;
+
+    std::error_code error{};
+    for(const auto& entry : std::filesystem::directory_iterator(directory, error)) 
+    {
+        if(entry.is_directory(error)) 
+        {
+            AddWatch(entry.path().generic_string());
+        }
+    }
+}
+
+std::vector<std::string> FileWatcher::Poll() 
+{
+    std::vector<std::string> changed{};
+
+    alignas(inotify_event) char buffer[4096];
+
+    while(true) 
+    {
+        ssize_t length = read(mInotify, buffer, sizeof(buffer));
+        if(length <= 0) 
+        {
+            // EAGAIN - nothing (more) to read.
+            break;
+        }
+
+        for(ssize_t offset = 0; offset < length;) 
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            if(event->mask & IN_Q_OVERFLOW) 
+            {
+                MT_LOG_WARN("Too many file changes at once, some of them were missed");
+                continue;
+            }
+            if(event->mask & IN_IGNORED) 
+            {
+                mDirectories.erase(event->wd);
+                continue;
+            }
+
+            auto directory = mDirectories.find(event->wd);
+            if(directory == mDirectories.end() || event->len == 0) 
+            {
+                continue;
+            }
+
+            std::string path = directory->second + "/" + event->name;
+
+            if(event->mask & IN_ISDIR) 
+            {
+                // Anything written into it before the watch existed is missed, which in practice
+                // means files copied in along with the directory.
+                AddWatch(path);
+            }
+            else if(event->mask & FILE_EVENTS) 
+            {
+                changed.push_back(path);
+            }
+        }
+    }
+
+    // Saving a file can generate several events.
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+    return changed;
+}
+
+#else
+
+FileWatcher::FileWatcher(const std::string& directory) 
+{
+    throw std::runtime_error("Watching " + directory + " for changes isn't supported on this platform!");
+}
+
+FileWatcher::~FileWatcher() 
+{
+
+}
+
+void FileWatcher::AddWatch(const std::string& directory) 
+{
+
+}
+
+std::vector<std::string> FileWatcher::Poll() 
+{
+    return {};
+}
+
+#endif
+
+}
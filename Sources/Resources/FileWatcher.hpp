@@ -0,0 +1,43 @@
+#ifndef MAMMOTH_2D_FILE_WATCHER_HPP
+#define MAMMOTH_2D_FILE_WATCHER_HPP
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mt 
+{
+
+/**
+ * @brief Reports files that have been written to anywhere under a directory (subdirectories
+ * included, even ones created later). Backed by inotify, so Linux only - elsewhere the
+ * constructor throws. Nothing happens in the background, changes are picked up by Poll().
+*/
+class FileWatcher 
+{
+public:
+    FileWatcher(const std::string& directory);
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher& other) = delete;
+    FileWatcher& operator=(const FileWatcher& other) = delete;
+
+    /**
+     * @brief Never blocks.
+     * @return Normalised paths (see NormaliseAssetPath()) of the files that have been written
+     * since the last call, each listed once. Files are reported once they're closed or moved
+     * into place, so never half written.
+    */
+    std::vector<std::string> Poll();
+
+private:
+    void AddWatch(const std::string& directory);
+
+    int mInotify = -1;
+
+    // Watch descriptor -> the directory it's watching.
+    std::unordered_map<int, std::string> mDirectories{};
+};
+}
+
+#endif
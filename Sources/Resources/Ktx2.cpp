@@ -0,0 +1,315 @@
+#include "Ktx2.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace mt
+{
+
+static const TextureCodecInfo sCodecInfos[] =
+{
+    {"rgba8", 43, 1, 4},        // VK_FORMAT_R8G8B8A8_SRGB
+    {"bc3", 138, 4, 16},        // VK_FORMAT_BC3_SRGB_BLOCK
+    {"bc7", 146, 4, 16},        // VK_FORMAT_BC7_SRGB_BLOCK
+    {"etc2", 152, 4, 16},       // VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK
+    {"astc", 158, 4, 16}        // VK_FORMAT_ASTC_4x4_SRGB_BLOCK
+};
+
+// File layout constants (all little endian).
+static constexpr size_t HEADER_SIZE = sizeof(KTX2_IDENTIFIER) + 9 * sizeof(uint32_t) + 4 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+static constexpr size_t LEVEL_INDEX_ENTRY_SIZE = 3 * sizeof(uint64_t);
+
+const TextureCodecInfo& GetTextureCodecInfo(TextureCodec codec)
+{
+    return sCodecInfos[static_cast<size_t>(codec)];
+}
+
+bool FindTextureCodec(uint32_t vkFormat, TextureCodec& codec)
+{
+    for(size_t i = 0; i < sizeof(sCodecInfos) / sizeof(sCodecInfos[0]); i++)
+    {
+        if(sCodecInfos[i].vkFormat == vkFormat)
+        {
+            codec = static_cast<TextureCodec>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t GetTextureLevelSize(TextureCodec codec, uint32_t width, uint32_t height)
+{
+    const TextureCodecInfo& info = GetTextureCodecInfo(codec);
+    uint64_t blocksX = (width + info.blockSize - 1) / info.blockSize;
+    uint64_t blocksY = (height + info.blockSize - 1) / info.blockSize;
+    return blocksX * blocksY * info.blockBytes;
+}
+
+std::string GetCookedTexturePath(const std::string& sourcePath, TextureCodec codec)
+{
+    size_t dot = sourcePath.find_last_of('.');
+    size_t slash = sourcePath.find_last_of("/\\");
+
+    std::string stem = sourcePath;
+    if(dot != std::string::npos && (slash == std::string::npos || dot > slash))
+    {
+        stem = sourcePath.substr(0, dot);
+    }
+
+    return stem + "." + GetTextureCodecInfo(codec).name + ".ktx2";
+}
+
+
+// Helper Functions.
+//----------------------------------------------------------------
+template<typename T>
+static T ReadValue(const uint8_t* file, size_t offset)
+{
+    T value{};
+    std::memcpy(&value, file + offset, sizeof(T));
+    return value;
+}
+
+template<typename T>
+static void AppendValue(std::vector<uint8_t>& out, T value)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+static void PadTo(std::vector<uint8_t>& out, size_t alignment)
+{
+    while(out.size() % alignment != 0)
+    {
+        out.push_back(0);
+    }
+}
+
+// Khronos Data Format basic descriptor block (KDF spec, section 5). Only the fields that
+// loaders actually look at vary between our codecs.
+static void AppendDataFormatDescriptor(std::vector<uint8_t>& out, TextureCodec codec)
+{
+    struct Sample
+    {
+        uint16_t bitOffset;
+        uint8_t bitLength;
+        uint8_t channel;
+        uint32_t upper;
+    };
+
+    // Alpha is never sRGB encoded, hence the linear qualifier (0x10) on every alpha sample.
+    constexpr uint8_t LINEAR = 0x10;
+    constexpr uint8_t ALPHA = 15;
+
+    uint8_t colourModel = 0;
+    std::vector<Sample> samples{};
+
+    switch(codec)
+    {
+        case TextureCodec::RGBA8:
+            colourModel = 1;    // RGBSDA
+            samples = {{0, 8, 0, 255}, {8, 8, 1, 255}, {16, 8, 2, 255}, {24, 8, ALPHA | LINEAR, 255}};
+            break;
+        case TextureCodec::BC3:
+            colourModel = 130;
+            samples = {{0, 64, ALPHA | LINEAR, 0xFFFFFFFF}, {64, 64, 0, 0xFFFFFFFF}};
+            break;
+        case TextureCodec::BC7:
+            colourModel = 134;
+            samples = {{0, 128, 0, 0xFFFFFFFF}};
+            break;
+        case TextureCodec::ETC2:
+            colourModel = 161;
+            samples = {{0, 64, ALPHA | LINEAR, 0xFFFFFFFF}, {64, 64, 2, 0xFFFFFFFF}};
+            break;
+        case TextureCodec::ASTC4x4:
+            colourModel = 162;
+            samples = {{0, 128, 0, 0xFFFFFFFF}};
+            break;
+    }
+
+    const TextureCodecInfo& info = GetTextureCodecInfo(codec);
+    uint32_t blockSize = 24 + 16 * static_cast<uint32_t>(samples.size());
+    uint8_t blockDimension = static_cast<uint8_t>(info.blockSize - 1);
+
+    AppendValue<uint32_t>(out, 4 + blockSize);                                  // dfdTotalSize
+    AppendValue<uint32_t>(out, 0);                                              // vendorId, descriptorType
+    AppendValue<uint32_t>(out, 2 | (blockSize << 16));                          // versionNumber, descriptorBlockSize
+    AppendValue<uint32_t>(out, colourModel | (1u << 8) | (2u << 16));           // BT709 primaries, sRGB transfer
+    AppendValue<uint32_t>(out, blockDimension | (blockDimension << 8));         // texelBlockDimension
+    AppendValue<uint32_t>(out, info.blockBytes);                                // bytesPlane0-3
+    AppendValue<uint32_t>(out, 0);                                              // bytesPlane4-7
+
+    for(const auto& sample : samples)
+    {
+        AppendValue<uint32_t>(out, sample.bitOffset | ((sample.bitLength - 1u) << 16) | (uint32_t(sample.channel) << 24));
+        AppendValue<uint32_t>(out, 0);              // samplePosition
+        AppendValue<uint32_t>(out, 0);              // sampleLower
+        AppendValue<uint32_t>(out, sample.upper);   // sampleUpper
+    }
+}
+
+static void AppendKeyValue(std::vector<uint8_t>& out, const char* key, const char* value)
+{
+    uint32_t keyLength = static_cast<uint32_t>(std::strlen(key)) + 1;
+    uint32_t valueLength = static_cast<uint32_t>(std::strlen(value)) + 1;
+
+    AppendValue<uint32_t>(out, keyLength + valueLength);
+    out.insert(out.end(), key, key + keyLength);
+    out.insert(out.end(), value, value + valueLength);
+    PadTo(out, 4);
+}
+//----------------------------------------------------------------
+
+
+Ktx2Texture ReadKtx2(const std::string& path)
+{
+    std::ifstream stream{path, std::ios::binary | std::ios::ate};
+    if(!stream.is_open())
+    {
+        throw std::runtime_error("Failed to open KTX2 file " + path);
+    }
+
+    std::vector<uint8_t> file(static_cast<size_t>(stream.tellg()));
+    stream.seekg(0);
+    stream.read(reinterpret_cast<char*>(file.data()), file.size());
+
+    Ktx2Texture texture = ParseKtx2(file.data(), file.size(), path);
+    texture.data = std::move(file);
+
+    return texture;
+}
+
+Ktx2Texture ParseKtx2(const uint8_t* file, size_t size, const std::string& name)
+{
+    if(size < HEADER_SIZE || std::memcmp(file, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0)
+    {
+        throw std::runtime_error(name + " is not a KTX2 file!");
+    }
+
+    size_t offset = sizeof(KTX2_IDENTIFIER);
+    uint32_t vkFormat = ReadValue<uint32_t>(file, offset);
+    uint32_t width = ReadValue<uint32_t>(file, offset + 8);
+    uint32_t height = ReadValue<uint32_t>(file, offset + 12);
+    uint32_t depth = ReadValue<uint32_t>(file, offset + 16);
+    uint32_t layerCount = ReadValue<uint32_t>(file, offset + 20);
+    uint32_t faceCount = ReadValue<uint32_t>(file, offset + 24);
+    uint32_t levelCount = std::max(ReadValue<uint32_t>(file, offset + 28), 1u);
+    uint32_t supercompression = ReadValue<uint32_t>(file, offset + 32);
+
+    Ktx2Texture texture{};
+
+    if(!FindTextureCodec(vkFormat, texture.codec))
+    {
+        throw std::runtime_error(name + " uses an unsupported format (VkFormat " + std::to_string(vkFormat) + ")!");
+    }
+    if(width == 0 || height == 0 || depth > 1 || layerCount > 1 || faceCount != 1)
+    {
+        throw std::runtime_error(name + " is not a single 2D texture!");
+    }
+    if(supercompression != 0)
+    {
+        throw std::runtime_error(name + " is supercompressed, which isn't supported!");
+    }
+    if(levelCount > 32 || HEADER_SIZE + static_cast<size_t>(levelCount) * LEVEL_INDEX_ENTRY_SIZE > size)
+    {
+        throw std::runtime_error(name + " has a truncated level index!");
+    }
+
+    texture.width = width;
+    texture.height = height;
+
+    for(uint32_t level = 0; level < levelCount; level++)
+    {
+        size_t entry = HEADER_SIZE + level * LEVEL_INDEX_ENTRY_SIZE;
+        uint64_t byteOffset = ReadValue<uint64_t>(file, entry);
+        uint64_t byteLength = ReadValue<uint64_t>(file, entry + 8);
+
+        Ktx2Level out{};
+        out.width = std::max(width >> level, 1u);
+        out.height = std::max(height >> level, 1u);
+        out.size = GetTextureLevelSize(texture.codec, out.width, out.height);
+        out.offset = byteOffset;
+
+        if(byteLength < out.size || byteOffset > size || size - byteOffset < out.size)
+        {
+            throw std::runtime_error(name + " has a truncated or invalid mip level!");
+        }
+
+        texture.levels.push_back(out);
+    }
+
+    return texture;
+}
+
+void WriteKtx2(const std::string& path, const Ktx2Texture& texture)
+{
+    const TextureCodecInfo& info = GetTextureCodecInfo(texture.codec);
+    uint32_t levelCount = static_cast<uint32_t>(texture.levels.size());
+
+    // Everything after the level index is built first, since the index needs its offsets.
+    size_t dfdOffset = HEADER_SIZE + levelCount * LEVEL_INDEX_ENTRY_SIZE;
+
+    std::vector<uint8_t> body{};
+    AppendDataFormatDescriptor(body, texture.codec);
+    uint32_t dfdLength = static_cast<uint32_t>(body.size());
+
+    size_t kvdOffset = dfdOffset + body.size();
+    AppendKeyValue(body, "KTXorientation", "ru");
+    AppendKeyValue(body, "KTXwriter", "Mammoth2D TextureCooker");
+    uint32_t kvdLength = static_cast<uint32_t>(dfdOffset + body.size() - kvdOffset);
+
+    // Level data must be aligned to lcm(texel block size, 4), which is just the block size here.
+    std::vector<uint64_t> levelOffsets(levelCount);
+    for(uint32_t level = levelCount; level-- > 0;)
+    {
+        while((dfdOffset + body.size()) % info.blockBytes != 0)
+        {
+            body.push_back(0);
+        }
+
+        const Ktx2Level& source = texture.levels[level];
+        levelOffsets[level] = dfdOffset + body.size();
+        body.insert(body.end(), texture.data.begin() + source.offset, texture.data.begin() + source.offset + source.size);
+    }
+
+    std::vector<uint8_t> file{};
+    file.reserve(dfdOffset + body.size());
+    file.insert(file.end(), KTX2_IDENTIFIER, KTX2_IDENTIFIER + sizeof(KTX2_IDENTIFIER));
+
+    AppendValue<uint32_t>(file, info.vkFormat);
+    AppendValue<uint32_t>(file, 1);                 // typeSize
+    AppendValue<uint32_t>(file, texture.width);
+    AppendValue<uint32_t>(file, texture.height);
+    AppendValue<uint32_t>(file, 0);                 // pixelDepth
+    AppendValue<uint32_t>(file, 0);                 // layerCount
+    AppendValue<uint32_t>(file, 1);                 // faceCount
+    AppendValue<uint32_t>(file, levelCount);
+    AppendValue<uint32_t>(file, 0);                 // supercompressionScheme
+
+    AppendValue<uint32_t>(file, static_cast<uint32_t>(dfdOffset));
+    AppendValue<uint32_t>(file, dfdLength);
+    AppendValue<uint32_t>(file, static_cast<uint32_t>(kvdOffset));
+    AppendValue<uint32_t>(file, kvdLength);
+    AppendValue<uint64_t>(file, 0);                 // sgdByteOffset
+    AppendValue<uint64_t>(file, 0);                 // sgdByteLength
+
+    for(uint32_t level = 0; level < levelCount; level++)
+    {
+        AppendValue<uint64_t>(file, levelOffsets[level]);
+        AppendValue<uint64_t>(file, texture.levels[level].size);
+        AppendValue<uint64_t>(file, texture.levels[level].size);
+    }
+
+    file.insert(file.end(), body.begin(), body.end());
+
+    std::ofstream stream{path, std::ios::binary | std::ios::trunc};
+    if(!stream.is_open() || !stream.write(reinterpret_cast<const char*>(file.data()), file.size()))
+    {
+        throw std::runtime_error("Failed to write KTX2 file " + path);
+    }
+}
+
+}
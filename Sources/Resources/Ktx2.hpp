@@ -0,0 +1,98 @@
+#ifndef MAMMOTH_2D_KTX2_HPP
+#define MAMMOTH_2D_KTX2_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mt
+{
+
+// «KTX 20»\r\n\x1A\n
+constexpr uint8_t KTX2_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+/**
+ * @brief Texture encodings the engine knows how to load. Every one of them is sRGB, and all
+ * but RGBA8 are block compressed with 4x4 blocks.
+ * Deliberately Vulkan-free (formats are plain VkFormat values) so that offline tools can use it.
+*/
+enum class TextureCodec : uint8_t
+{
+    RGBA8 = 0,
+    BC3 = 1,
+    BC7 = 2,
+    ETC2 = 3,       // ETC2 RGBA8 (ETC2 colour + EAC alpha).
+    ASTC4x4 = 4
+};
+
+struct TextureCodecInfo
+{
+    const char* name;       // Also the file suffix, e.g: "Player.bc7.ktx2".
+    uint32_t vkFormat;
+    uint32_t blockSize;     // Texels along each side of a block (1 for uncompressed).
+    uint32_t blockBytes;
+};
+
+const TextureCodecInfo& GetTextureCodecInfo(TextureCodec codec);
+
+/**
+ * @return Whether the VkFormat matches one of the codecs above (written to codec).
+*/
+bool FindTextureCodec(uint32_t vkFormat, TextureCodec& codec);
+
+/**
+ * @return The size in bytes of a width x height image in this codec.
+*/
+uint64_t GetTextureLevelSize(TextureCodec codec, uint32_t width, uint32_t height);
+
+/**
+ * @brief The path that the cooker writes the given codec of a source texture to,
+ * e.g: "Textures/Player.png" -> "Textures/Player.bc7.ktx2".
+*/
+std::string GetCookedTexturePath(const std::string& sourcePath, TextureCodec codec);
+
+struct Ktx2Level
+{
+    uint64_t offset = 0;    // Into Ktx2Texture::data.
+    uint64_t size = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+/**
+ * @brief A single-layer 2D KTX2 texture with its mip chain, largest level first.
+ * Rows are stored bottom-up, the same as the engine's PNG path (KTXorientation "ru").
+ * When read from a file, data holds the whole file and the level offsets point into it, so
+ * that it can be uploaded as is (regions of one staging buffer) without repacking.
+*/
+struct Ktx2Texture
+{
+    TextureCodec codec = TextureCodec::RGBA8;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<Ktx2Level> levels{};
+    std::vector<uint8_t> data{};
+};
+
+/**
+ * @brief Reads a KTX2 file. Only non-supercompressed, single-layer 2D textures in one of the
+ * formats above are accepted, anything else throws.
+*/
+Ktx2Texture ReadKtx2(const std::string& path);
+
+/**
+ * @brief Same as ReadKtx2(), but for a file that's already in memory (e.g: in a mapped asset
+ * pack). Nothing is copied: data is left empty and the level offsets are relative to file.
+ * @param name Only used in error messages.
+*/
+Ktx2Texture ParseKtx2(const uint8_t* file, size_t size, const std::string& name);
+
+/**
+ * @brief Writes a KTX2 file, including the data format descriptor the spec requires.
+ * Levels are laid out smallest first, as the spec recommends for streaming.
+*/
+void WriteKtx2(const std::string& path, const Ktx2Texture& texture);
+
+}
+
+#endif
@@ -0,0 +1,198 @@
+#include "Lz4.hpp"
+
+#include <cstring>
+
+namespace mt
+{
+
+// Format limits: matches are at least 4 bytes, the last 5 bytes are always literals and the
+// last match has to start at least 12 bytes before the end.
+static constexpr size_t MIN_MATCH = 4;
+static constexpr size_t LAST_LITERALS = 5;
+static constexpr size_t MATCH_FIND_LIMIT = 12;
+static constexpr size_t MAX_OFFSET = 65535;
+static constexpr uint32_t HASH_BITS = 16;
+
+// Helper Functions.
+//----------------------------------------------------------------
+static inline uint32_t Read32(const uint8_t* data)
+{
+    uint32_t value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static inline uint32_t Hash(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static void WriteLength(std::vector<uint8_t>& out, size_t length)
+{
+    while(length >= 255)
+    {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<uint8_t>(length));
+}
+
+static void WriteSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literalLength, size_t offset, size_t matchLength)
+{
+    bool isLast = matchLength == 0;
+    size_t matchCode = isLast ? 0 : matchLength - MIN_MATCH;
+
+    out.push_back(static_cast<uint8_t>(((literalLength < 15 ? literalLength : 15) << 4) | (matchCode < 15 ? matchCode : 15)));
+
+    if(literalLength >= 15)
+    {
+        WriteLength(out, literalLength - 15);
+    }
+    out.insert(out.end(), literals, literals + literalLength);
+
+    if(isLast)
+    {
+        return;
+    }
+
+    out.push_back(static_cast<uint8_t>(offset & 0xFF));
+    out.push_back(static_cast<uint8_t>(offset >> 8));
+
+    if(matchCode >= 15)
+    {
+        WriteLength(out, matchCode - 15);
+    }
+}
+//----------------------------------------------------------------
+
+
+std::vector<uint8_t> Lz4Compress(const uint8_t* source, size_t sourceSize)
+{
+    std::vector<uint8_t> out{};
+    out.reserve(sourceSize / 2 + 16);
+
+    size_t anchor = 0;
+
+    if(sourceSize > MATCH_FIND_LIMIT)
+    {
+        // Positions are stored + 1 so that zero means empty.
+        std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+
+        size_t position = 0;
+        const size_t matchStartLimit = sourceSize - MATCH_FIND_LIMIT;
+        const size_t matchEndLimit = sourceSize - LAST_LITERALS;
+
+        while(position < matchStartLimit)
+        {
+            uint32_t sequence = Read32(source + position);
+            uint32_t& slot = table[Hash(sequence)];
+            size_t candidate = slot;
+            slot = static_cast<uint32_t>(position + 1);
+
+            if(candidate == 0 || position - (candidate - 1) > MAX_OFFSET || Read32(source + candidate - 1) != sequence)
+            {
+                position++;
+                continue;
+            }
+
+            size_t reference = candidate - 1;
+            size_t length = MIN_MATCH;
+            while(position + length < matchEndLimit && source[reference + length] == source[position + length])
+            {
+                length++;
+            }
+
+            WriteSequence(out, source + anchor, position - anchor, position - reference, length);
+
+            position += length;
+            anchor = position;
+        }
+    }
+
+    WriteSequence(out, source + anchor, sourceSize - anchor, 0, 0);
+
+    return out;
+}
+
+bool Lz4Decompress(const uint8_t* source, size_t sourceSize, uint8_t* destination, size_t destinationSize)
+{
+    const uint8_t* in = source;
+    const uint8_t* inEnd = source + sourceSize;
+    size_t written = 0;
+
+    auto readLength = [&](size_t& length)
+    {
+        uint8_t byte = 255;
+        while(byte == 255)
+        {
+            if(in >= inEnd)
+            {
+                return false;
+            }
+            byte = *in++;
+            length += byte;
+        }
+        return true;
+    };
+
+    while(in < inEnd)
+    {
+        uint8_t token = *in++;
+
+        size_t literalLength = token >> 4;
+        if(literalLength == 15 && !readLength(literalLength))
+        {
+            return false;
+        }
+
+        if(static_cast<size_t>(inEnd - in) < literalLength || destinationSize - written < literalLength)
+        {
+            return false;
+        }
+
+        if(literalLength > 0)
+        {
+            std::memcpy(destination + written, in, literalLength);
+        }
+        in += literalLength;
+        written += literalLength;
+
+        // The last sequence has no match.
+        if(in == inEnd)
+        {
+            break;
+        }
+
+        if(inEnd - in < 2)
+        {
+            return false;
+        }
+
+        size_t offset = in[0] | (static_cast<size_t>(in[1]) << 8);
+        in += 2;
+
+        size_t matchLength = token & 15;
+        if(matchLength == 15 && !readLength(matchLength))
+        {
+            return false;
+        }
+        matchLength += MIN_MATCH;
+
+        if(offset == 0 || offset > written || destinationSize - written < matchLength)
+        {
+            return false;
+        }
+
+        // Byte by byte, since the match may overlap what it's writing (that's how runs are encoded).
+        const uint8_t* match = destination + written - offset;
+        for(size_t i = 0; i < matchLength; i++)
+        {
+            destination[written + i] = match[i];
+        }
+        written += matchLength;
+    }
+
+    return written == destinationSize;
+}
+
+}
@@ -0,0 +1,29 @@
+#ifndef MAMMOTH_2D_LZ4_HPP
+#define MAMMOTH_2D_LZ4_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mt
+{
+
+// A self-contained implementation of the LZ4 block format (no frame format), which is all the
+// asset pack needs. The output is compatible with the reference LZ4_decompress_safe().
+
+/**
+ * @brief Greedy single-pass compressor - fast rather than tight, it only runs when packing.
+ * @return The compressed block, which may be larger than the input for incompressible data.
+*/
+std::vector<uint8_t> Lz4Compress(const uint8_t* source, size_t sourceSize);
+
+/**
+ * @brief Decompresses a whole block, never reading or writing out of bounds however corrupt
+ * the input is.
+ * @return Whether the block was valid and decompressed to exactly destinationSize bytes.
+*/
+bool Lz4Decompress(const uint8_t* source, size_t sourceSize, uint8_t* destination, size_t destinationSize);
+
+}
+
+#endif
@@ -0,0 +1,479 @@
+#include "VirtualTextureFile.hpp"
+#include "Lz4.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace mt
+{
+
+VirtualTextureLayout::VirtualTextureLayout(uint32_t width, uint32_t height, uint32_t pageSize, uint32_t border)
+    : width{width}, height{height}, pageSize{pageSize}, border{border}
+{
+    if(width == 0 || height == 0 || pageSize == 0)
+    {
+        throw std::runtime_error("A virtual texture needs a non-zero size and page size!");
+    }
+
+    for(uint32_t level = 0; ; level++)
+    {
+        Level info{};
+        info.width = std::max(width >> level, 1u);
+        info.height = std::max(height >> level, 1u);
+        info.pagesX = (info.width + pageSize - 1) / pageSize;
+        info.pagesY = (info.height + pageSize - 1) / pageSize;
+        info.firstPage = pageCount;
+
+        levels.push_back(info);
+        pageCount += info.pagesX * info.pagesY;
+
+        if(info.pagesX == 1 && info.pagesY == 1)
+        {
+            break;
+        }
+    }
+}
+
+void VirtualTextureLayout::GetPageCoordinates(uint32_t page, uint32_t& level, uint32_t& x, uint32_t& y) const
+{
+    level = 0;
+    while(level + 1 < levels.size() && page >= levels[level + 1].firstPage)
+    {
+        level++;
+    }
+
+    uint32_t index = page - levels[level].firstPage;
+    x = index % levels[level].pagesX;
+    y = index / levels[level].pagesX;
+}
+
+void WriteVirtualTexture(const std::string& path, const std::vector<VirtualTextureLevel>& levels, uint32_t pageSize, uint32_t border, bool compress)
+{
+    if(levels.empty())
+    {
+        throw std::runtime_error("Nothing to write to " + path);
+    }
+
+    VirtualTextureLayout layout{levels[0].width, levels[0].height, pageSize, border};
+
+    if(levels.size() < layout.levels.size())
+    {
+        throw std::runtime_error(path + " needs " + std::to_string(layout.levels.size()) + " levels!");
+    }
+
+    uint32_t storedSize = layout.GetStoredPageSize();
+    std::vector<uint8_t> page(layout.GetPageBytes());
+
+    std::vector<VirtualPageEntry> entries(layout.pageCount);
+    std::vector<uint8_t> payloads{};
+    uint64_t offset = sizeof(VirtualTextureHeader) + entries.size() * sizeof(VirtualPageEntry);
+
+    for(uint32_t l = 0; l < layout.levels.size(); l++)
+    {
+        const VirtualTextureLayout::Level& info = layout.levels[l];
+        const VirtualTextureLevel& level = levels[l];
+
+        if(level.width != info.width || level.height != info.height || level.texels.size() < static_cast<size_t>(level.width) * level.height * 4)
+        {
+            throw std::runtime_error("Level " + std::to_string(l) + " of " + path + " has the wrong size!");
+        }
+
+        for(uint32_t py = 0; py < info.pagesY; py++)
+        {
+            for(uint32_t px = 0; px < info.pagesX; px++)
+            {
+                // Texels past the edge of the texture (border included) repeat the last row/column.
+                for(uint32_t y = 0; y < storedSize; y++)
+                {
+                    int64_t sy = static_cast<int64_t>(py) * pageSize + y - border;
+                    sy = std::min<int64_t>(std::max<int64_t>(sy, 0), level.height - 1);
+
+                    for(uint32_t x = 0; x < storedSize; x++)
+                    {
+                        int64_t sx = static_cast<int64_t>(px) * pageSize + x - border;
+                        sx = std::min<int64_t>(std::max<int64_t>(sx, 0), level.width - 1);
+
+                        std::memcpy(&page[(static_cast<size_t>(y) * storedSize + x) * 4], &level.texels[(static_cast<size_t>(sy) * level.width + sx) * 4], 4);
+                    }
+                }
+
+                VirtualPageEntry& entry = entries[layout.GetPageIndex(l, px, py)];
+                entry.offset = offset + payloads.size();
+
+                std::vector<uint8_t> compressed{};
+                if(compress)
+                {
+                    compressed = Lz4Compress(page.data(), page.size());
+                }
+
+                // Same threshold as the asset pack.
+                bool useCompressed = compress && compressed.size() < page.size() - page.size() / 10;
+                const std::vector<uint8_t>& stored = useCompressed ? compressed : page;
+
+                entry.storedSize = static_cast<uint32_t>(stored.size());
+                entry.flags = useCompressed ? static_cast<uint32_t>(VTEX_PAGE_LZ4) : 0u;
+
+                payloads.insert(payloads.end(), stored.begin(), stored.end());
+            }
+        }
+    }
+
+    VirtualTextureHeader header{};
+    std::memcpy(header.magic, VTEX_MAGIC, sizeof(VTEX_MAGIC));
+    header.version = VTEX_VERSION;
+    header.width = layout.width;
+    header.height = layout.height;
+    header.pageSize = pageSize;
+    header.border = border;
+    header.levelCount = static_cast<uint32_t>(layout.levels.size());
+    header.pageCount = layout.pageCount;
+
+    std::ofstream stream{path, std::ios::binary | std::ios::trunc};
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(VirtualPageEntry));
+    stream.write(reinterpret_cast<const char*>(payloads.data()), payloads.size());
+
+    if(!stream)
+    {
+        throw std::runtime_error("Failed to write virtual texture " + path);
+    }
+}
+
+VirtualTextureFile::VirtualTextureFile(const std::string& path, const std::shared_ptr<const AssetPack>& pack)
+    : mPath{path}
+{
+    const PackEntry* entry = pack ? pack->Find(path) : nullptr;
+
+    if(entry)
+    {
+        // Keeps the mapping alive for as long as we point into it.
+        mPack = pack;
+        mData = mPack->Access(*entry, mStorage);
+        mSize = entry->size;
+    }
+    else {
+        int file = open(path.c_str(), O_RDONLY);
+        if(file < 0)
+        {
+            throw std::runtime_error("Failed to open virtual texture " + path);
+        }
+
+        struct stat status{};
+        if(fstat(file, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(VirtualTextureHeader))
+        {
+            close(file);
+            throw std::runtime_error(path + " is too small to be a virtual texture!");
+        }
+
+        mMappingSize = static_cast<size_t>(status.st_size);
+        mMapping = mmap(nullptr, mMappingSize, PROT_READ, MAP_PRIVATE, file, 0);
+        close(file);
+
+        if(mMapping == MAP_FAILED)
+        {
+            mMapping = nullptr;
+            throw std::runtime_error("Failed to map virtual texture " + path);
+        }
+
+        // Pages are read wherever the camera happens to be.
+        madvise(mMapping, mMappingSize, MADV_RANDOM);
+
+        mData = static_cast<const uint8_t*>(mMapping);
+        mSize = mMappingSize;
+    }
+
+    try
+    {
+        Parse();
+    }
+    catch(...)
+    {
+        if(mMapping)
+        {
+            munmap(mMapping, mMappingSize);
+        }
+        throw;
+    }
+}
+
+VirtualTextureFile::~VirtualTextureFile()
+{
+    if(mMapping)
+    {
+        munmap(mMapping, mMappingSize);
+    }
+}
+
+void VirtualTextureFile::Parse()
+{
+    VirtualTextureHeader header{};
+    if(mSize < sizeof(header))
+    {
+        throw std::runtime_error(mPath + " is too small to be a virtual texture!");
+    }
+    std::memcpy(&header, mData, sizeof(header));
+
+    if(std::memcmp(header.magic, VTEX_MAGIC, sizeof(VTEX_MAGIC)) != 0 || header.version != VTEX_VERSION)
+    {
+        throw std::runtime_error(mPath + " is not a virtual texture (or was built by a different version)!");
+    }
+
+    mLayout = VirtualTextureLayout{header.width, header.height, header.pageSize, header.border};
+
+    uint64_t tableSize = static_cast<uint64_t>(header.pageCount) * sizeof(VirtualPageEntry);
+    if(header.levelCount != mLayout.levels.size() || header.pageCount != mLayout.pageCount || mSize - sizeof(header) < tableSize)
+    {
+        throw std::runtime_error(mPath + " has an inconsistent page table!");
+    }
+
+    // The header is 40 bytes, so the table is 8 byte aligned as long as the file is.
+    mPages = reinterpret_cast<const VirtualPageEntry*>(mData + sizeof(header));
+
+    for(uint32_t i = 0; i < header.pageCount; i++)
+    {
+        const VirtualPageEntry& page = mPages[i];
+        bool isCompressed = page.flags & VTEX_PAGE_LZ4;
+
+        if(page.offset > mSize || mSize - page.offset < page.storedSize || (!isCompressed && page.storedSize != mLayout.GetPageBytes()))
+        {
+            throw std::runtime_error(mPath + " has a page outside of the file!");
+        }
+    }
+}
+
+void VirtualTextureFile::ReadPage(uint32_t page, uint8_t* destination) const
+{
+    const VirtualPageEntry& entry = mPages[page];
+
+    if(entry.flags & VTEX_PAGE_LZ4)
+    {
+        if(!Lz4Decompress(mData + entry.offset, entry.storedSize, destination, mLayout.GetPageBytes()))
+        {
+            throw std::runtime_error("Corrupt page " + std::to_string(page) + " in " + mPath);
+        }
+        return;
+    }
+
+    std::memcpy(destination, mData + entry.offset, entry.storedSize);
+}
+
+VirtualPageCache::VirtualPageCache(const VirtualTextureLayout& layout, uint32_t slotCount)
+    : mLayout{layout}
+{
+    if(slotCount < layout.levels.size())
+    {
+        // Otherwise a single visible page and its ancestors can't all be resident.
+        throw std::runtime_error("A virtual texture page cache needs at least one slot per level!");
+    }
+
+    mSlots.resize(slotCount);
+    mSlotOfPage.assign(layout.pageCount, INVALID);
+    mRequestedFrame.assign(layout.pageCount, 0);
+}
+
+void VirtualPageCache::BeginFrame()
+{
+    mFrame++;
+    mRequested.clear();
+
+    // Pinned: requesting anything also requests the coarsest page, but it has to stay resident
+    // even on frames where nothing is visible.
+    uint32_t coarsest = mLayout.pageCount - 1;
+    mRequestedFrame[coarsest] = mFrame;
+    mRequested.push_back(coarsest);
+
+    if(mSlotOfPage[coarsest] != INVALID)
+    {
+        mSlots[mSlotOfPage[coarsest]].lastUsed = mFrame;
+    }
+}
+
+void VirtualPageCache::Request(float x0, float y0, float x1, float y1, uint32_t level)
+{
+    x0 = std::max(x0, 0.0f);
+    y0 = std::max(y0, 0.0f);
+    x1 = std::min(x1, static_cast<float>(mLayout.width));
+    y1 = std::min(y1, static_cast<float>(mLayout.height));
+
+    if(x1 <= x0 || y1 <= y0)
+    {
+        return;
+    }
+
+    level = std::min(level, static_cast<uint32_t>(mLayout.levels.size()) - 1);
+
+    for(uint32_t l = level; l < mLayout.levels.size(); l++)
+    {
+        const VirtualTextureLayout::Level& info = mLayout.levels[l];
+        float span = static_cast<float>(static_cast<uint64_t>(mLayout.pageSize) << l);
+
+        uint32_t firstX = std::min(static_cast<uint32_t>(x0 / span), info.pagesX - 1);
+        uint32_t firstY = std::min(static_cast<uint32_t>(y0 / span), info.pagesY - 1);
+        uint32_t lastX = std::min(static_cast<uint32_t>(std::ceil(x1 / span)), info.pagesX);
+        uint32_t lastY = std::min(static_cast<uint32_t>(std::ceil(y1 / span)), info.pagesY);
+
+        for(uint32_t y = firstY; y < lastY; y++)
+        {
+            for(uint32_t x = firstX; x < lastX; x++)
+            {
+                uint32_t page = mLayout.GetPageIndex(l, x, y);
+                if(mRequestedFrame[page] == mFrame)
+                {
+                    continue;
+                }
+
+                mRequestedFrame[page] = mFrame;
+                mRequested.push_back(page);
+
+                if(mSlotOfPage[page] != INVALID)
+                {
+                    mSlots[mSlotOfPage[page]].lastUsed = mFrame;
+                }
+            }
+        }
+    }
+}
+
+std::vector<uint32_t> VirtualPageCache::GetMissingPages() const
+{
+    std::vector<uint32_t> missing{};
+
+    for(uint32_t page : mRequested)
+    {
+        if(mSlotOfPage[page] == INVALID)
+        {
+            missing.push_back(page);
+        }
+    }
+
+    // Coarser levels have higher page indices.
+    std::sort(missing.begin(), missing.end(), [](uint32_t a, uint32_t b) { return a > b; });
+    return missing;
+}
+
+uint32_t VirtualPageCache::Reserve(uint32_t page)
+{
+    // A linear scan, but it only runs for the handful of pages loaded each frame.
+    uint32_t best = INVALID;
+    uint64_t bestAge = ~0ull;
+
+    for(uint32_t i = 0; i < mSlots.size(); i++)
+    {
+        const Slot& slot = mSlots[i];
+        if(slot.isLoading || (slot.page != INVALID && slot.lastUsed == mFrame))
+        {
+            continue;
+        }
+
+        uint64_t age = slot.page == INVALID ? 0 : slot.lastUsed + 1;
+        if(age < bestAge)
+        {
+            best = i;
+            bestAge = age;
+
+            if(age == 0)
+            {
+                break;
+            }
+        }
+    }
+
+    if(best == INVALID)
+    {
+        return INVALID;
+    }
+
+    Slot& slot = mSlots[best];
+    if(slot.page != INVALID)
+    {
+        mSlotOfPage[slot.page] = INVALID;
+        mResidentCount--;
+        mHasChanged = true;
+    }
+
+    slot.page = page;
+    slot.lastUsed = mFrame;
+    slot.isLoading = true;
+    mSlotOfPage[page] = best;
+
+    return best;
+}
+
+void VirtualPageCache::MakeResident(uint32_t slot)
+{
+    mSlots[slot].isLoading = false;
+    mResidentCount++;
+    mHasChanged = true;
+}
+
+void VirtualPageCache::Cancel(uint32_t slot)
+{
+    mSlotOfPage[mSlots[slot].page] = INVALID;
+    mSlots[slot] = Slot{};
+}
+
+uint32_t VirtualPageCache::FindResidentSlot(uint32_t level, uint32_t x, uint32_t y, uint32_t& residentLevel) const
+{
+    for(uint32_t l = level; l < mLayout.levels.size(); l++, x /= 2, y /= 2)
+    {
+        uint32_t slot = mSlotOfPage[mLayout.GetPageIndex(l, x, y)];
+
+        if(slot != INVALID && !mSlots[slot].isLoading)
+        {
+            residentLevel = l;
+            return slot;
+        }
+    }
+
+    return INVALID;
+}
+
+void VirtualPageCache::BuildPageTable(uint32_t level, uint32_t tableWidth, uint32_t tableHeight, uint32_t columns, uint32_t* entries) const
+{
+    const VirtualTextureLayout::Level& info = mLayout.levels[level];
+
+    for(uint32_t y = 0; y < tableHeight; y++)
+    {
+        for(uint32_t x = 0; x < tableWidth; x++)
+        {
+            uint32_t entry = 0;
+            uint32_t residentLevel = 0;
+            uint32_t slot = x < info.pagesX && y < info.pagesY ? FindResidentSlot(level, x, y, residentLevel) : INVALID;
+
+            if(slot != INVALID)
+            {
+                entry = (slot % columns) | (slot / columns) << 8 | residentLevel << 16 | 0xFFu << 24;
+            }
+
+            entries[static_cast<size_t>(y) * tableWidth + x] = entry;
+        }
+    }
+}
+
+bool VirtualPageCache::ConsumeChanges()
+{
+    bool hasChanged = mHasChanged;
+    mHasChanged = false;
+    return hasChanged;
+}
+
+uint32_t VirtualPageCache::SelectLevel(float texelsPerPixel) const
+{
+    if(!(texelsPerPixel > 1.0f))
+    {
+        return 0;
+    }
+
+    uint32_t level = static_cast<uint32_t>(std::floor(std::log2(texelsPerPixel)));
+    return std::min(level, static_cast<uint32_t>(mLayout.levels.size()) - 1);
+}
+
+}
@@ -0,0 +1,244 @@
+#ifndef MAMMOTH_2D_VIRTUAL_TEXTURE_FILE_HPP
+#define MAMMOTH_2D_VIRTUAL_TEXTURE_FILE_HPP
+
+#include "AssetPack.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mt
+{
+
+// .vtex layout: VirtualTextureHeader, VirtualPageEntry[pageCount], then the page payloads.
+// Pages are ordered by level (largest first), then row by row. Every page is RGBA8 (sRGB),
+// (pageSize + 2 * border)^2 texels, rows bottom-up like the rest of the engine's images.
+constexpr char VTEX_MAGIC[8] = {'M', 'T', 'V', 'T', 'E', 'X', '\0', '\0'};
+constexpr uint32_t VTEX_VERSION = 1;
+
+enum VirtualPageFlags : uint32_t
+{
+    VTEX_PAGE_LZ4 = 1 << 0      // The payload is a single LZ4 block.
+};
+
+struct VirtualTextureHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t width;         // Of level 0, in texels.
+    uint32_t height;
+    uint32_t pageSize;      // Texels along each side of a page, excluding the border.
+    uint32_t border;        // Texels copied from the neighbouring pages so filtering doesn't bleed.
+    uint32_t levelCount;
+    uint32_t pageCount;
+    uint32_t reserved;
+};
+
+struct VirtualPageEntry
+{
+    uint64_t offset;        // From the start of the file.
+    uint32_t storedSize;
+    uint32_t flags;
+};
+
+static_assert(sizeof(VirtualTextureHeader) == 40, "VirtualTextureHeader must match the on-disk layout!");
+static_assert(sizeof(VirtualPageEntry) == 16, "VirtualPageEntry must match the on-disk layout!");
+
+/**
+ * @brief How a virtual texture is cut into pages. Levels halve until one page covers the whole
+ * texture. Page indices are global: every page of level 0, then every page of level 1 etc.
+*/
+struct VirtualTextureLayout
+{
+    struct Level
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t pagesX = 0;
+        uint32_t pagesY = 0;
+        uint32_t firstPage = 0;
+    };
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t pageSize = 0;
+    uint32_t border = 0;
+    std::vector<Level> levels{};
+    uint32_t pageCount = 0;
+
+    VirtualTextureLayout() = default;
+    VirtualTextureLayout(uint32_t width, uint32_t height, uint32_t pageSize, uint32_t border);
+
+    inline uint32_t GetPageIndex(uint32_t level, uint32_t x, uint32_t y) const { return levels[level].firstPage + y * levels[level].pagesX + x; }
+
+    /**
+     * @brief The inverse of GetPageIndex().
+    */
+    void GetPageCoordinates(uint32_t page, uint32_t& level, uint32_t& x, uint32_t& y) const;
+
+    /**
+     * @return Texels along each side of a stored page, border included.
+    */
+    inline uint32_t GetStoredPageSize() const { return pageSize + 2 * border; }
+    inline size_t GetPageBytes() const { return static_cast<size_t>(GetStoredPageSize()) * GetStoredPageSize() * 4; }
+};
+
+struct VirtualTextureLevel
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> texels{};      // RGBA8.
+};
+
+/**
+ * @brief Cuts a mip chain into pages and writes a .vtex file. levels must hold at least as many
+ * levels as the layout needs (extra ones are ignored), each half the size of the previous one.
+ * Throws if it can't write the file.
+ * @param compress LZ4 every page that shrinks by at least 10%.
+*/
+void WriteVirtualTexture(const std::string& path, const std::vector<VirtualTextureLevel>& levels, uint32_t pageSize, uint32_t border, bool compress);
+
+/**
+ * @brief Read-only view of a .vtex file, either memory-mapped from disk or pointing into an
+ * asset pack (which should store it uncompressed - pages are compressed individually, so they
+ * can be read on their own). Nothing but the page table is touched up front. ReadPage() is
+ * const and safe to call from any thread.
+*/
+class VirtualTextureFile
+{
+public:
+    /**
+     * @param pack Looked in first, like every other asset. The file on disk is used if the pack
+     * doesn't have it.
+    */
+    VirtualTextureFile(const std::string& path, const std::shared_ptr<const AssetPack>& pack = nullptr);
+    ~VirtualTextureFile();
+
+    VirtualTextureFile(const VirtualTextureFile& other) = delete;
+    VirtualTextureFile& operator=(const VirtualTextureFile& other) = delete;
+
+    /**
+     * @brief Copies (or decompresses) a page into destination, which must hold
+     * GetLayout().GetPageBytes() bytes. Throws if the page is corrupt.
+    */
+    void ReadPage(uint32_t page, uint8_t* destination) const;
+
+    inline const VirtualTextureLayout& GetLayout() const { return mLayout; }
+
+private:
+    void Parse();
+
+private:
+    std::string mPath = "";
+    std::shared_ptr<const AssetPack> mPack = nullptr;
+
+    // Only set when the file was mapped from disk.
+    void* mMapping = nullptr;
+    size_t mMappingSize = 0;
+
+    // Only used when the pack stored the whole file compressed.
+    std::vector<uint8_t> mStorage{};
+
+    const uint8_t* mData = nullptr;
+    size_t mSize = 0;
+
+    const VirtualPageEntry* mPages = nullptr;
+    VirtualTextureLayout mLayout{};
+};
+
+/**
+ * @brief Decides which pages of a virtual texture live in a fixed number of atlas slots.
+ * Each frame the visible region is requested at the level it's drawn at (and every coarser
+ * level, so there's always something to fall back to while finer pages stream in). Missing
+ * pages are reserved a slot - a free one, else the least recently used one that isn't visible
+ * this frame - and made resident once their texels have been uploaded.
+ * The coarsest level is a single page that's requested every frame, so it's never evicted.
+ * Deliberately Vulkan-free, the GPU side is VirtualTexture.
+*/
+class VirtualPageCache
+{
+public:
+    static constexpr uint32_t INVALID = ~0u;
+
+    VirtualPageCache(const VirtualTextureLayout& layout, uint32_t slotCount);
+
+    void BeginFrame();
+
+    /**
+     * @brief Marks the pages overlapping a rect (in level 0 texels) as visible, at level and
+     * every coarser one.
+    */
+    void Request(float x0, float y0, float x1, float y1, uint32_t level);
+
+    /**
+     * @return The pages requested this frame that are neither resident nor being loaded,
+     * coarsest first so that the fallbacks arrive before the detail.
+    */
+    std::vector<uint32_t> GetMissingPages() const;
+
+    /**
+     * @brief Reserves a slot for a page about to be loaded. The page previously in that slot
+     * (if any) is evicted straight away.
+     * @return The slot, or INVALID if every slot is visible this frame or still loading.
+    */
+    uint32_t Reserve(uint32_t page);
+
+    /**
+     * @brief Called once the page's texels are in its slot.
+    */
+    void MakeResident(uint32_t slot);
+
+    /**
+     * @brief Gives up on a reserved slot, e.g: because the page couldn't be read.
+    */
+    void Cancel(uint32_t slot);
+
+    /**
+     * @brief Fills one level of the page table, tableWidth x tableHeight entries (at least
+     * pagesX x pagesY). Each entry is RGBA8: slot x, slot y, the level that's actually resident
+     * and 255, or all zero if nothing covering the page is resident. Pages that aren't resident
+     * point at their closest resident ancestor.
+     * @param columns Slots per row in the atlas.
+    */
+    void BuildPageTable(uint32_t level, uint32_t tableWidth, uint32_t tableHeight, uint32_t columns, uint32_t* entries) const;
+
+    /**
+     * @brief Whether residency changed since the last call.
+    */
+    bool ConsumeChanges();
+
+    /**
+     * @return The level at which texelsPerPixel level 0 texels land on each screen pixel.
+    */
+    uint32_t SelectLevel(float texelsPerPixel) const;
+
+    inline bool IsResident(uint32_t page) const { return mSlotOfPage[page] != INVALID && !mSlots[mSlotOfPage[page]].isLoading; }
+    inline uint32_t GetSlotCount() const { return static_cast<uint32_t>(mSlots.size()); }
+    inline uint32_t GetResidentCount() const { return mResidentCount; }
+
+private:
+    struct Slot
+    {
+        uint32_t page = INVALID;
+        uint64_t lastUsed = 0;
+        bool isLoading = false;
+    };
+
+    uint32_t FindResidentSlot(uint32_t level, uint32_t x, uint32_t y, uint32_t& residentLevel) const;
+
+private:
+    VirtualTextureLayout mLayout{};
+    std::vector<Slot> mSlots{};
+    std::vector<uint32_t> mSlotOfPage{};
+    std::vector<uint64_t> mRequestedFrame{};
+    std::vector<uint32_t> mRequested{};     // This frame's, in request order.
+
+    uint64_t mFrame = 0;
+    uint32_t mResidentCount = 0;
+    bool mHasChanged = true;
+};
+}
+
+#endif
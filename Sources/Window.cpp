@@ -5,15 +5,21 @@ namespace mt
 {
 bool Window::mIsRunning = true;
 
-Window::Window(const char* name, uint32_t width, uint32_t height)
-    : mWidth{width}, mHeight{height}, mName{name}
+Window::Window(const char* name, uint32_t width, uint32_t height, bool headless)
+    : mWidth{width}, mHeight{height}, mIsHeadless{headless}, mName{name}
 {
-    Init();
+    if(!mIsHeadless) 
+    {
+        Init();
+    }
 }
 
 Window::~Window()
 {
-    glfwDestroyWindow(mWindow);
+    if(mWindow) 
+    {
+        glfwDestroyWindow(mWindow);
+    }
 }
 
 
@@ -40,6 +46,21 @@ void Window::CreateWindowSurface(const VkInstance instance, VkSurfaceKHR* surfac
     }
 }
 
+void Window::CreateHeadlessSurface(const VkInstance instance, VkSurfaceKHR* surface) const 
+{
+    auto createHeadlessSurface = (PFN_vkCreateHeadlessSurfaceEXT)vkGetInstanceProcAddr(
+        instance, 
+        "vkCreateHeadlessSurfaceEXT");
+
+    VkHeadlessSurfaceCreateInfoEXT createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_HEADLESS_SURFACE_CREATE_INFO_EXT;
+
+    if(!createHeadlessSurface || createHeadlessSurface(instance, &createInfo, nullptr, surface) != VK_SUCCESS) 
+    {
+        throw std::runtime_error("Failed to create headless surface!");
+    }
+}
+
 void Window::OnWindowCloseCallback(GLFWwindow* window) 
 {
     mIsRunning = false;
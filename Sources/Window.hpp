@@ -14,7 +14,8 @@ namespace mt
 
 /**
  * @brief Responsible for creating the GLFW window as well as the surface that's used
- * by the renderer to display to.
+ * by the renderer to display to. A headless window never touches GLFW at all (so it works
+ * on machines without a display), it just carries the extent that we render offscreen at.
 */
 class Window 
 {
@@ -24,8 +25,9 @@ public:
      * @param name The name of the window (doesn't matter what it is).
      * @param width The width of the window in pixels.
      * @param height The height of the window in pixels. 
+     * @param headless Skips GLFW entirely, see EngineDesc::headless.
     */
-    Window(const char* name, uint32_t width, uint32_t height);
+    Window(const char* name, uint32_t width, uint32_t height, bool headless = false);
     ~Window();
 
     Window(const Window& other) = delete;
@@ -40,7 +42,7 @@ public:
     /**
      * @brief Simple call to glfwPollEvents() which is required for any glfw callbacks to work.
     */
-    void ListenToEvents() { glfwPollEvents(); }
+    void ListenToEvents() { if(!mIsHeadless) glfwPollEvents(); }
 
     /**
      * @brief The vulkan api has no idea where the rendering frustum is on the screen,
@@ -51,6 +53,13 @@ public:
     */
     void CreateWindowSurface(const VkInstance instance, VkSurfaceKHR* surface) const;
 
+    /**
+     * @brief Creates a VK_EXT_headless_surface surface, which behaves like a window surface
+     * (swapchain, present...) but is never displayed. Only valid when the instance was created
+     * with that extension enabled.
+    */
+    void CreateHeadlessSurface(const VkInstance instance, VkSurfaceKHR* surface) const;
+
     /**
      * @brief Sets mIsRunning to false and is only called by GLFW as a callback provided
      * to the glfwSetWindowCloseCallback() function.
@@ -64,12 +73,14 @@ public:
     inline static bool& IsRunning() { return mIsRunning; }
     inline VkExtent2D GetExtent() const { return {mWidth, mHeight}; }
     inline GLFWwindow* GetNativeWindow() const { return mWindow; } 
+    inline bool IsHeadless() const { return mIsHeadless; }
 
 private:
     GLFWwindow* mWindow = nullptr;
 
-    uint32_t& mWidth;
-    uint32_t& mHeight;
+    uint32_t mWidth;
+    uint32_t mHeight;
+    bool mIsHeadless = false;
 
     const char* mName = "";
 
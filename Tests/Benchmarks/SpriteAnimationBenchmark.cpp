@@ -0,0 +1,74 @@
+// Per-frame cost of animating every sprite in a scene: advancing the playback state and picking
+// the frame index that gets uploaded, single threaded and spread over the job system.
+// Usage: SpriteAnimationBenchmark [spriteCount = 100000]
+#include <Animation/SpriteAnimation.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Best of a few runs of 100 frames each, in microseconds per frame.
+template<class F>
+static double Measure(F&& update)
+{
+    double best = 1e30;
+
+    for(int run = 0; run < 5; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for(int frame = 0; frame < 100; frame++)
+        {
+            update();
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        best = std::min(best, std::chrono::duration<double, std::micro>(end - start).count() / 100.0);
+    }
+
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    size_t spriteCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+
+    // A typical character sheet: a handful of clips over one 8x8 grid.
+    mt::SpriteAnimationLibrary library{};
+    uint32_t first = library.AddGrid(8, 8);
+    library.AddClip("idle", mt::AnimationClip{first, 8, 8.0f});
+    library.AddClip("walk", mt::AnimationClip{first + 8, 16, 12.0f});
+    library.AddClip("run", mt::AnimationClip{first + 24, 12, 18.0f});
+    library.AddClip("attack", mt::AnimationClip{first + 36, 6, 24.0f});
+
+    std::vector<mt::SpriteAnimationComp> animations(spriteCount);
+    std::vector<uint32_t> frames(spriteCount);
+
+    for(size_t i = 0; i < spriteCount; i++)
+    {
+        animations[i].clip = static_cast<uint32_t>(i % library.GetClips().size());
+        animations[i].time = (i % 97) * 0.01f;
+        animations[i].speed = 0.75f + (i % 5) * 0.125f;
+        animations[i].loop = static_cast<mt::AnimationLoop>(i % 3);
+    }
+
+    const mt::AnimationClip* clips = library.GetClips().data();
+    const float deltaTime = 1.0f / 60.0f;
+
+    std::printf("%zu sprites\n", spriteCount);
+    std::printf("%-10s %14s %14s\n", "threads", "us/frame", "ns/sprite");
+
+    double single = Measure([&]() { mt::AnimateSprites(clips, deltaTime, animations.data(), frames.data(), spriteCount); });
+    std::printf("%-10u %14.1f %14.2f\n", 1u, single, single * 1000.0 / spriteCount);
+
+    // JobSystem{0} means "one per core", so a single thread is the plain call above.
+    for(uint32_t threadCount : {2u, 4u, 8u})
+    {
+        mt::JobSystem jobSystem{threadCount - 1};
+        double time = Measure([&]() { mt::AnimateSprites(jobSystem, clips, deltaTime, animations.data(), frames.data(), spriteCount); });
+        std::printf("%-10u %14.1f %14.2f\n", threadCount, time, time * 1000.0 / spriteCount);
+    }
+
+    return 0;
+}
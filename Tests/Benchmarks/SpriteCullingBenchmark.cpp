@@ -0,0 +1,108 @@
+// Headless run of the whole sprite path: culled on the GPU by the render graph's Cull pass, then
+// drawn with one indirect draw by Main. Sprites cover four times the screen, so most are culled,
+// and only every 64th moves, so only those are uploaded again. Works on a software ICD (lavapipe).
+// Per-frame CPU times are written to SpriteCullingBenchmark.csv, the last frame to
+// SpriteCullingBenchmark.ppm.
+// Usage: SpriteCullingBenchmark [spriteCount = 50000] [frames = 300]
+#include <Engine.hpp>
+#include <Game.hpp>
+#include <Graphics/Renderer/Sprite2DSystem.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static constexpr uint32_t WIDTH = 800;
+static constexpr uint32_t HEIGHT = 600;
+static constexpr uint32_t MOVING_STRIDE = 64;
+static constexpr float SPRITE_SIZE = 16.0f;
+
+class SpriteCullingGame : public mt::IGame
+{
+public:
+    SpriteCullingGame(mt::Engine& engine, uint32_t spriteCount) 
+        : mt::IGame(engine), mSprites{engine.GetGraphics().GetRenderer()->GetSprites()}, mInstances(spriteCount)
+    {
+        Load(WIDTH, HEIGHT);
+    }
+
+    virtual void Load(uint32_t width, uint32_t height) override
+    {
+        mTexture = mRes.LoadImage(MAMMOTH_TEXTURE_DIR "Box.png");
+        mRes.FinishLoading();
+        mSprites.SetTextures(mRes, {mTexture});
+
+        // Quads at z = 0, which OrthographicCamera's default position would clip.
+        mSprites.SetCamera(glm::ortho(0.0f, static_cast<float>(width), 0.0f, static_cast<float>(height)));
+
+        // A grid from one screen before to two screens past the visible one in both directions.
+        uint32_t columns = static_cast<uint32_t>(3.0f * width / SPRITE_SIZE);
+        for(size_t i = 0; i < mInstances.size(); i++)
+        {
+            glm::vec3 position{
+                (i % columns) * SPRITE_SIZE - static_cast<float>(width), 
+                (i / columns % static_cast<uint32_t>(3.0f * height / SPRITE_SIZE)) * SPRITE_SIZE - static_cast<float>(height), 
+                0.0f
+            };
+            mInstances[i].modelMatrix = glm::scale(glm::translate(glm::mat4{1.0f}, position), glm::vec3{SPRITE_SIZE, SPRITE_SIZE, 1.0f});
+        }
+
+        mSprites.SetInstances(mInstances.data(), static_cast<uint32_t>(mInstances.size()));
+    }
+
+    virtual void Run(std::chrono::duration<double>& ts) override
+    {
+        float distance = static_cast<float>(ts.count()) * 100.0f;
+
+        for(uint32_t i = 0; i < mInstances.size(); i += MOVING_STRIDE)
+        {
+            float& x = mInstances[i].modelMatrix[3][0];
+            x += distance;
+            if(x > 2.0f * WIDTH)
+            {
+                x -= 3.0f * WIDTH;
+            }
+            mSprites.SetInstance(i, mInstances[i]);
+        }
+    }
+
+    virtual void Quit() override
+    {
+        mRes.Release(mTexture);
+    }
+
+private:
+    mt::Sprite2DSystem& mSprites;
+    std::vector<mt::SpriteInstance> mInstances{};
+    mt::ImageHandle mTexture{};
+};
+
+int main(int argc, char** argv)
+{
+    uint32_t spriteCount = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 50000;
+    uint64_t frames = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 300;
+
+    mt::EngineDesc engineDesc{};
+    engineDesc.windowName = "SpriteCullingBenchmark";
+    engineDesc.windowWidth = WIDTH;
+    engineDesc.windowHeight = HEIGHT;
+    engineDesc.headless = true;
+    engineDesc.frameLimit = frames;
+    engineDesc.frameTimesPath = "SpriteCullingBenchmark.csv";
+    engineDesc.capturePath = "SpriteCullingBenchmark.ppm";
+
+    mt::Engine engine{&engineDesc};
+
+    std::unique_ptr<SpriteCullingGame> game = std::make_unique<SpriteCullingGame>(engine, spriteCount);
+    SpriteCullingGame* running = game.get();
+
+    engine.SetGame(std::move(game));
+
+    std::printf("%u sprites, %llu frames\n", spriteCount, static_cast<unsigned long long>(frames));
+    engine.Update();
+    running->Quit();
+
+    std::printf("Frame times written to %s, last frame to %s\n", engineDesc.frameTimesPath, engineDesc.capturePath);
+}
@@ -0,0 +1,122 @@
+// Startup benchmark: how long it takes to get a level's worth of textures decoded, with the
+// decoding spread over 1, 2, 4 and 8 job system threads.
+// Usage: TextureLoadBenchmark [textureCount = 500]
+// The textures are copies of Resources/Textures, each under its own name so that nothing is
+// deduplicated. There's no device here, so the upload is a stub - this measures the decode side
+// of ResourceManager (reading and PNG inflation) plus the batching overhead.
+#include <ResourceManager.hpp>
+#include <Graphics/Shader/Image.hpp>
+#include <Graphics/Shader/Shader.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static std::vector<std::string> CreateTextures(const fs::path& directory, uint32_t count)
+{
+    std::vector<fs::path> sources{};
+    for(const auto& entry : fs::directory_iterator(MAMMOTH_TEXTURE_DIR))
+    {
+        if(entry.path().extension() == ".png")
+        {
+            sources.push_back(entry.path());
+        }
+    }
+
+    if(sources.empty())
+    {
+        throw std::runtime_error(std::string("No textures found in ") + MAMMOTH_TEXTURE_DIR);
+    }
+
+    fs::create_directories(directory);
+
+    std::vector<std::string> paths{};
+    for(uint32_t i = 0; i < count; i++)
+    {
+        fs::path path = directory / ("Texture" + std::to_string(i) + ".png");
+        fs::copy_file(sources[i % sources.size()], path, fs::copy_options::overwrite_existing);
+        paths.push_back(path.string());
+    }
+
+    return paths;
+}
+
+/**
+ * @return Wall time in milliseconds, from queueing the loads to the last texture being resident.
+*/
+static double LoadTextures(const std::vector<std::string>& paths, uint32_t threadCount, uint32_t& batchCount)
+{
+    mt::JobSystem jobSystem{threadCount};
+    mt::ResourceManager resourceManager{jobSystem, UINT32_MAX};
+
+    batchCount = 0;
+    resourceManager.SetImageBatchUploader([&](const std::vector<const mt::ImageData*>& data)
+    {
+        batchCount++;
+        return std::vector<std::unique_ptr<mt::Image>>(data.size());
+    });
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<mt::ImageHandle> handles = resourceManager.LoadImages(paths);
+
+    // Like a loading screen: the main thread keeps ticking (rather than helping out, which
+    // FinishLoading() would do), so the thread count is exactly the number of decoders.
+    for(size_t loaded = 0; loaded < handles.size();)
+    {
+        resourceManager.Update();
+
+        while(loaded < handles.size() && resourceManager.GetState(handles[loaded]) >= mt::AssetState::Resident)
+        {
+            loaded++;
+        }
+
+        std::this_thread::yield();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t textureCount = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 500;
+    fs::path directory = fs::temp_directory_path() / "MammothTextureLoadBenchmark";
+
+    try
+    {
+        std::vector<std::string> paths = CreateTextures(directory, textureCount);
+
+        // Warms the page cache, so that every run reads from memory.
+        uint32_t batchCount = 0;
+        LoadTextures(paths, 1, batchCount);
+
+        std::cout << "Loading " << textureCount << " textures (" << std::thread::hardware_concurrency() << " hardware threads)\n";
+        std::cout << "threads\twall ms\ttextures/s\tspeedup\tbatches\n";
+
+        double baseline = 0.0;
+        for(uint32_t threadCount : {1u, 2u, 4u, 8u})
+        {
+            double milliseconds = LoadTextures(paths, threadCount, batchCount);
+            baseline = threadCount == 1 ? milliseconds : baseline;
+
+            std::cout << threadCount << "\t" << milliseconds << "\t" << textureCount * 1000.0 / milliseconds << "\t" 
+                << baseline / milliseconds << "x\t" << batchCount << "\n";
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << "\n";
+        fs::remove_all(directory);
+        return 1;
+    }
+
+    fs::remove_all(directory);
+    return 0;
+}
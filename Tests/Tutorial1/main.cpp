@@ -1,65 +1,89 @@
 #include <iostream>
 #include <Engine.hpp>
 #include <Game.hpp>
+#include <Graphics/Renderer/Sprite2DSystem.hpp>
 
-int main(int argc, char** argv) 
-{
-    mt::EngineDesc engineDesc;
-    engineDesc.windowName = "DemoGame";
-    engineDesc.windowWidth = 800;
-    engineDesc.windowHeight = 600;
-
-    mt::Engine engine = mt::Engine(&engineDesc);
+#include <glm/gtc/matrix_transform.hpp>
 
-    std::unique_ptr<Game> game = std::make_unique<Game>(engine);
- 
-    engine.SetGame(std::move(game));
-}
+static constexpr uint32_t WIDTH = 800;
+static constexpr uint32_t HEIGHT = 600;
 
-class Game : public mt::IGame 
+class Game : public mt::IGame
 {
 public:
-    Game(mt::Engine& engine, uint32_t windowWidth, uint32_t windowHeight) : mt::IGame(engine) 
+    Game(mt::Engine& engine, uint32_t windowWidth, uint32_t windowHeight)
+        : mt::IGame(engine), mSprites{engine.GetGraphics().GetRenderer()->GetSprites()}
     {
         Load(windowWidth, windowHeight);
     }
 
-    virtual void Load(uint32_t width, uint32_t height) override 
+    virtual void Load(uint32_t width, uint32_t height) override
     {
-        mRes.LoadImage("BackgroundImage", "Resources/Textures/Background.png");
-        mRes.LoadImage("BoxImage", "Resources/Textures/Box.png");
-        mRes.LoadImage("PlatformImage", "Resources/Textures/Platform.png");
-        mRes.LoadImage("PlayerImage", "Resources/Textures/Player.png");
-
-        mRes.LoadShader("SimpleShader", "Resources/Shaders/simple.vert", "Resources/Shaders/simple.frag");
-
-        mCamera = std::make_unique<mt::OrthographicCamera>(width, height, glm::vec3(0.0f, 0.0f, 5.0f));
-
-        mt::TempRenderObj player{};
-        player.color = glm::vec3(1.0f, 0.0f, 0.0f);
-        player.posiiton = glm::vec2(200, 200);
-        player.size = glm::vec2(50, 50);
-        player.camera.projection = mCamera->GetProjectionMatrix();
-        player.camera.view = mCamera->GetViewMatrix();
-        player.textureName = "PlayerImage";
-
-        glm::mat4 model{1.0f};
-        model = glm::scale(model, glm::vec3(player.size, 1.0));
-        model = glm::translate(model, glm::vec3(player.posiiton, 1.0));
-        player.transform.transformMatrix = model;
-
-
+        mBackground = mRes.LoadImage("Resources/Textures/Background.png");
+        mPlayer = mRes.LoadImage("Resources/Textures/Player.png");
+        mRes.FinishLoading();
+
+        // SpriteInstance::texture indexes into these.
+        mSprites.SetTextures(mRes, {mBackground, mPlayer});
+        mSprites.SetCamera(glm::ortho(0.0f, static_cast<float>(width), 0.0f, static_cast<float>(height)));
+
+        // The player's sheet is 2x2 cells, played as a looping four frame clip.
+        mt::SpriteAnimationLibrary library{};
+        uint32_t firstFrame = library.AddGrid(2, 2);
+        uint32_t idle = library.AddClip("PlayerIdle", mt::AnimationClip{firstFrame, 4, 8.0f});
+        uint32_t still = library.AddClip("Still", mt::AnimationClip{0, 1});
+        mSprites.SetAnimationLibrary(library);
+
+        // Sprites are drawn in index order, so the background goes first.
+        mt::SpriteInstance background{};
+        background.modelMatrix = glm::scale(glm::mat4{1.0f}, glm::vec3{static_cast<float>(width), static_cast<float>(height), 1.0f});
+        background.texture = 0;
+
+        mt::SpriteInstance player{};
+        player.modelMatrix = glm::scale(glm::translate(glm::mat4{1.0f}, glm::vec3{200.0f, 200.0f, 0.0f}), glm::vec3{50.0f, 50.0f, 1.0f});
+        player.texture = 1;
+
+        mt::SpriteInstance instances[] = {background, player};
+        mSprites.SetInstances(instances, 2);
+
+        // Animations cover the first sprites in instance order, so the background plays a clip of
+        // frame 0 (the whole texture). The Renderer advances them every frame.
+        mt::SpriteAnimationComp animations[2]{};
+        animations[0].clip = still;
+        animations[1].clip = idle;
+        mSprites.SetAnimations(animations, 2);
     }
 
-    virtual void Run(std::chrono::duration<double>& ts) override 
+    virtual void Run(std::chrono::duration<double>& ts) override
     {
-        
+
     }
 
-    virtual void Quit() override 
+    virtual void Quit() override
     {
-
+        mRes.Release(mBackground);
+        mRes.Release(mPlayer);
     }
 
+private:
+    mt::Sprite2DSystem& mSprites;
+    mt::ImageHandle mBackground{};
+    mt::ImageHandle mPlayer{};
 };
 
+int main(int argc, char** argv)
+{
+    mt::EngineDesc engineDesc{};
+    engineDesc.windowName = "DemoGame";
+    engineDesc.windowWidth = WIDTH;
+    engineDesc.windowHeight = HEIGHT;
+
+    mt::Engine engine{&engineDesc};
+
+    std::unique_ptr<Game> game = std::make_unique<Game>(engine, WIDTH, HEIGHT);
+    Game* running = game.get();
+
+    engine.SetGame(std::move(game));
+    engine.Update();
+    running->Quit();
+}
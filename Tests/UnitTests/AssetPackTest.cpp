@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <Resources/AssetPack.hpp>
+#include <Resources/Lz4.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+static std::vector<uint8_t> MakeCompressible(size_t size) 
+{
+    std::vector<uint8_t> data(size);
+    for(size_t i = 0; i < size; i++) 
+    {
+        data[i] = static_cast<uint8_t>((i / 7) % 13);
+    }
+    return data;
+}
+
+static std::vector<uint8_t> MakeNoise(size_t size) 
+{
+    std::vector<uint8_t> data(size);
+    uint32_t state = 12345;
+    for(auto& value : data) 
+    {
+        state = state * 1664525u + 1013904223u;
+        value = static_cast<uint8_t>(state >> 24);
+    }
+    return data;
+}
+
+TEST(AssetPackTest, Lz4RoundTrips) 
+{
+    for(const auto& data : {std::vector<uint8_t>{}, std::vector<uint8_t>{42}, MakeCompressible(100000), MakeNoise(5000)}) 
+    {
+        std::vector<uint8_t> compressed = mt::Lz4Compress(data.data(), data.size());
+        std::vector<uint8_t> decompressed(data.size());
+
+        ASSERT_TRUE(mt::Lz4Decompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size()));
+        EXPECT_EQ(decompressed, data);
+    }
+
+    std::vector<uint8_t> data = MakeCompressible(100000);
+    EXPECT_LT(mt::Lz4Compress(data.data(), data.size()).size(), data.size() / 10);
+}
+
+TEST(AssetPackTest, Lz4RejectsCorruptBlocks) 
+{
+    std::vector<uint8_t> data = MakeCompressible(4096);
+    std::vector<uint8_t> compressed = mt::Lz4Compress(data.data(), data.size());
+    std::vector<uint8_t> decompressed(data.size());
+
+    // Truncated, or decompressing to the wrong size.
+    EXPECT_FALSE(mt::Lz4Decompress(compressed.data(), compressed.size() / 2, decompressed.data(), decompressed.size()));
+    EXPECT_FALSE(mt::Lz4Decompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size() - 1));
+
+    // A match reaching back before the start of the output.
+    const uint8_t badOffset[] = {0x10, 'a', 0x20, 0x00};
+    EXPECT_FALSE(mt::Lz4Decompress(badOffset, sizeof(badOffset), decompressed.data(), decompressed.size()));
+}
+
+TEST(AssetPackTest, WritesAndFindsEntries) 
+{
+    const char* path = "AssetPackTest.pack";
+
+    std::vector<mt::PackSource> sources(3);
+    sources[0] = {"Textures/Player.png", MakeNoise(1000), true};
+    sources[1] = {"Shaders/simple.vert.spv", MakeCompressible(20000), true};
+    sources[2] = {"Data/level.bin", MakeCompressible(300), false};
+
+    mt::WriteAssetPack(path, sources);
+
+    {
+        mt::AssetPack pack{path, "Resources"};
+        ASSERT_EQ(pack.GetEntryCount(), 3u);
+
+        for(const auto& source : sources) 
+        {
+            // Looked up by any spelling of the path under the mount directory.
+            const mt::PackEntry* entry = pack.Find("Resources/./" + source.path);
+            ASSERT_NE(entry, nullptr) << source.path;
+
+            EXPECT_EQ(entry->offset % mt::PACK_ALIGNMENT, 0u);
+            EXPECT_EQ(entry->size, source.data.size());
+            EXPECT_EQ(entry->format, mt::GetPackFormat(source.path));
+
+            std::vector<uint8_t> storage{};
+            const uint8_t* bytes = pack.Access(*entry, storage);
+            EXPECT_TRUE(std::equal(source.data.begin(), source.data.end(), bytes));
+        }
+
+        // Noise doesn't compress, so it's stored (and read) in place.
+        const mt::PackEntry* noise = pack.Find("Resources/Textures/Player.png");
+        const mt::PackEntry* shader = pack.Find("Resources/Shaders/simple.vert.spv");
+        EXPECT_EQ(noise->flags & mt::PACK_ENTRY_LZ4, 0u);
+        EXPECT_NE(shader->flags & mt::PACK_ENTRY_LZ4, 0u);
+
+        std::vector<uint8_t> storage{};
+        EXPECT_EQ(pack.Access(*noise, storage), pack.GetPayload(*noise));
+        EXPECT_TRUE(storage.empty());
+
+        EXPECT_EQ(pack.Find("Resources/Textures/Box.png"), nullptr);
+        EXPECT_EQ(pack.Find("Textures/Player.png"), nullptr);
+    }
+
+    std::remove(path);
+}
+
+TEST(AssetPackTest, RejectsOtherFiles) 
+{
+    const char* path = "AssetPackTest.bin";
+    {
+        std::ofstream file{path, std::ios::binary};
+        file << "definitely not an asset pack, just some text";
+    }
+
+    EXPECT_THROW(mt::AssetPack{path}, std::runtime_error);
+    EXPECT_THROW(mt::AssetPack{"DoesNotExist.pack"}, std::runtime_error);
+
+    std::remove(path);
+}
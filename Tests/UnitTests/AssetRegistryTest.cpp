@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <Resources/AssetRegistry.hpp>
+
+#include <memory>
+
+TEST(AssetRegistryTest, DeduplicatesNormalisedPaths) 
+{
+    mt::AssetRegistry<int> registry{};
+    bool isNew = false;
+
+    auto first = registry.Acquire(mt::NormaliseAssetPath("a/./b/../c.png"), isNew);
+    EXPECT_TRUE(isNew);
+
+    auto second = registry.Acquire(mt::NormaliseAssetPath("a/c.png"), isNew);
+    EXPECT_FALSE(isNew);
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(registry.GetCount(), 1u);
+
+    registry.Acquire(mt::NormaliseAssetPath("a/d.png"), isNew);
+    EXPECT_TRUE(isNew);
+    EXPECT_EQ(registry.GetCount(), 2u);
+}
+
+TEST(AssetRegistryTest, ReleasesOnLastReference) 
+{
+    mt::AssetRegistry<int> registry{};
+    bool isNew = false;
+
+    auto handle = registry.Acquire("texture.png", isNew);
+    registry.Acquire("texture.png", isNew);
+
+    registry.Find(handle)->asset = std::make_unique<int>(42);
+    registry.Find(handle)->state = mt::AssetState::Resident;
+    ASSERT_NE(registry.Get(handle), nullptr);
+    EXPECT_EQ(*registry.Get(handle), 42);
+
+    EXPECT_FALSE(registry.Release(handle));
+    EXPECT_EQ(registry.GetState(handle), mt::AssetState::Resident);
+
+    EXPECT_TRUE(registry.Release(handle));
+    EXPECT_EQ(registry.GetState(handle), mt::AssetState::Unloaded);
+    EXPECT_EQ(registry.Get(handle), nullptr);
+    EXPECT_EQ(registry.GetCount(), 0u);
+
+    // Stale handles must not drop references belonging to someone else.
+    EXPECT_FALSE(registry.Release(handle));
+}
+
+TEST(AssetRegistryTest, ReusedSlotsInvalidateOldHandles) 
+{
+    mt::AssetRegistry<int> registry{};
+    bool isNew = false;
+
+    auto old = registry.Acquire("old.png", isNew);
+    registry.Release(old);
+
+    auto reused = registry.Acquire("new.png", isNew);
+    EXPECT_TRUE(isNew);
+    EXPECT_EQ(reused.index, old.index);
+    EXPECT_NE(reused.generation, old.generation);
+
+    EXPECT_EQ(registry.Find(old), nullptr);
+    EXPECT_EQ(registry.GetState(reused), mt::AssetState::Queued);
+    EXPECT_FALSE(mt::Handle<int>{}.IsValid());
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <Window.hpp>
+#include <Graphics/Devices/Instance.hpp>
+#include <Graphics/Devices/PhysicalDevice.hpp>
+#include <Graphics/Devices/LogicalDevice.hpp>
+#include <Graphics/Descriptors/DescriptorAllocator.hpp>
+#include <Graphics/Descriptors/DescriptorLayoutCache.hpp>
+
+#include <exception>
+#include <memory>
+
+// Runs on whatever Vulkan device there is, including a software ICD (lavapipe), through a
+// headless window. Skipped on machines without one.
+class DescriptorAllocatorTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        try
+        {
+            mWindow = std::make_unique<mt::Window>("DescriptorAllocatorTest", 64, 64, true);
+            mInstance = std::make_unique<mt::Instance>(*mWindow, true);
+            mPhysicalDevice = std::make_unique<mt::PhysicalDevice>(*mWindow, *mInstance);
+            mLogicalDevice = std::make_unique<mt::LogicalDevice>(*mPhysicalDevice);
+        }
+        catch(const std::exception& e)
+        {
+            GTEST_SKIP() << "No Vulkan device: " << e.what();
+        }
+
+        mLayoutCache = std::make_unique<mt::DescriptorLayoutCache>(*mLogicalDevice);
+
+        VkDescriptorSetLayoutBinding binding{};
+        binding.binding = 0;
+        binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        binding.descriptorCount = 1;
+        binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        mLayout = mLayoutCache->GetSetLayout({binding});
+    }
+
+    // Destroyed the other way round from how they were created.
+    std::unique_ptr<mt::Window> mWindow{};
+    std::unique_ptr<mt::Instance> mInstance{};
+    std::unique_ptr<mt::PhysicalDevice> mPhysicalDevice{};
+    std::unique_ptr<mt::LogicalDevice> mLogicalDevice{};
+    std::unique_ptr<mt::DescriptorLayoutCache> mLayoutCache{};
+    VkDescriptorSetLayout mLayout = VK_NULL_HANDLE;
+};
+
+TEST_F(DescriptorAllocatorTest, GrowsIntoANewPoolWhenOneRunsOut)
+{
+    mt::DescriptorAllocator allocator{*mLogicalDevice, 2};
+
+    EXPECT_NE(allocator.Allocate(mLayout), VK_NULL_HANDLE);
+    EXPECT_NE(allocator.Allocate(mLayout), VK_NULL_HANDLE);
+    EXPECT_EQ(allocator.GetStats().poolCount, 1u);
+    EXPECT_EQ(allocator.GetStats().exhaustedPools, 0u);
+
+    // The first pool only holds two sets, so the third moves on to a second, bigger one.
+    EXPECT_NE(allocator.Allocate(mLayout), VK_NULL_HANDLE);
+    EXPECT_EQ(allocator.GetStats().poolCount, 2u);
+    EXPECT_EQ(allocator.GetStats().exhaustedPools, 1u);
+
+    // Which has room for four more before a third pool is needed.
+    for(int i = 0; i < 4; i++)
+    {
+        EXPECT_NE(allocator.Allocate(mLayout), VK_NULL_HANDLE);
+    }
+    EXPECT_EQ(allocator.GetStats().poolCount, 2u);
+
+    EXPECT_NE(allocator.Allocate(mLayout), VK_NULL_HANDLE);
+    EXPECT_EQ(allocator.GetStats().poolCount, 3u);
+    EXPECT_EQ(allocator.GetStats().exhaustedPools, 2u);
+    EXPECT_EQ(allocator.GetStats().persistentSets, 8u);
+}
+
+TEST_F(DescriptorAllocatorTest, ReusesTransientPoolsOnceTheirFrameComesRound)
+{
+    mt::DescriptorAllocator allocator{*mLogicalDevice, 2};
+
+    // Spills over into a second pool.
+    for(int i = 0; i < 3; i++)
+    {
+        EXPECT_NE(allocator.AllocateTransient(0, mLayout), VK_NULL_HANDLE);
+    }
+    EXPECT_EQ(allocator.GetStats().poolCount, 2u);
+    EXPECT_EQ(allocator.GetStats().transientSets, 3u);
+
+    // Both pools are reset and handed out again, so no more are created.
+    allocator.BeginFrame(0);
+    EXPECT_EQ(allocator.GetStats().poolResets, 2u);
+    EXPECT_EQ(allocator.GetStats().transientSets, 0u);
+
+    for(int i = 0; i < 3; i++)
+    {
+        EXPECT_NE(allocator.AllocateTransient(0, mLayout), VK_NULL_HANDLE);
+    }
+    EXPECT_EQ(allocator.GetStats().poolCount, 2u);
+    EXPECT_EQ(allocator.GetStats().totalTransientSets, 6u);
+}
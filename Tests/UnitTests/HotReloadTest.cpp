@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include <Resources/FileWatcher.hpp>
+#include <Resources/AssetRegistry.hpp>
+#include <Memory/RetireQueue.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+static std::vector<std::string> PollFor(mt::FileWatcher& watcher, size_t count) 
+{
+    std::vector<std::string> changed{};
+    for(int attempt = 0; attempt < 100 && changed.size() < count; attempt++) 
+    {
+        auto polled = watcher.Poll();
+        changed.insert(changed.end(), polled.begin(), polled.end());
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return changed;
+}
+
+TEST(HotReloadTest, RetiresAfterLatency) 
+{
+    mt::RetireQueue queue{3};
+    int destroyed = 0;
+
+    queue.BeginFrame(10);
+    queue.Retire([&destroyed]() { destroyed++; });
+    queue.Retire(std::make_unique<int>(5));
+
+    queue.BeginFrame(11);
+    queue.BeginFrame(12);
+    EXPECT_EQ(destroyed, 0);
+    EXPECT_EQ(queue.GetPendingCount(), 2u);
+
+    queue.BeginFrame(13);
+    EXPECT_EQ(destroyed, 1);
+    EXPECT_EQ(queue.GetPendingCount(), 0u);
+
+    queue.Retire([&destroyed]() { destroyed++; });
+    queue.Flush();
+    EXPECT_EQ(destroyed, 2);
+}
+
+#ifdef __linux__
+TEST(HotReloadTest, WatchesFilesRecursively) 
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "HotReloadTest";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory / "Shaders");
+
+    mt::FileWatcher watcher{directory.string()};
+    EXPECT_TRUE(watcher.Poll().empty());
+
+    std::ofstream{directory / "Shaders" / "simple.frag"} << "void main() {}";
+
+    auto changed = PollFor(watcher, 1);
+    ASSERT_EQ(changed.size(), 1u);
+    EXPECT_EQ(changed[0], mt::NormaliseAssetPath((directory / "Shaders" / "simple.frag").string()));
+
+    // Written to a temporary file and renamed into place, in a directory created afterwards.
+    std::filesystem::create_directories(directory / "Textures");
+    EXPECT_TRUE(watcher.Poll().empty());
+
+    std::ofstream{directory / "Textures" / "Player.png.tmp"} << "png";
+    std::filesystem::rename(directory / "Textures" / "Player.png.tmp", directory / "Textures" / "Player.png");
+
+    changed = PollFor(watcher, 2);
+    EXPECT_NE(std::find(changed.begin(), changed.end(), mt::NormaliseAssetPath((directory / "Textures" / "Player.png").string())), changed.end());
+
+    std::filesystem::remove_all(directory);
+}
+#endif
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include <Replay/InputRecording.hpp>
+
+#include <cstdio>
+#include <stdexcept>
+
+TEST(InputRecordingTest, ReplayMatchesRecording) 
+{
+    const char* path = "InputRecordingTest.replay";
+
+    {
+        mt::InputRecorder recorder{path};
+
+        recorder.RecordKey(87, 1, 0);
+        recorder.CommitFrame(0, 1.0 / 60.0);
+
+        recorder.CommitFrame(1, 0.02);
+
+        recorder.RecordKey(87, 0, 0);
+        recorder.RecordKey(65, 1, 2);
+        recorder.CommitFrame(2, 0.0125);
+    }
+
+    mt::InputReplayer replayer{path};
+    mt::RecordedFrame frame{};
+
+    ASSERT_TRUE(replayer.ReadFrame(frame));
+    EXPECT_EQ(frame.frameNumber, 0u);
+    EXPECT_EQ(frame.timestep, 1.0 / 60.0);
+    ASSERT_EQ(frame.keys.size(), 1u);
+    EXPECT_EQ(frame.keys[0].key, 87);
+    EXPECT_EQ(frame.keys[0].action, 1);
+
+    ASSERT_TRUE(replayer.ReadFrame(frame));
+    EXPECT_EQ(frame.frameNumber, 1u);
+    EXPECT_EQ(frame.timestep, 0.02);
+    EXPECT_TRUE(frame.keys.empty());
+
+    ASSERT_TRUE(replayer.ReadFrame(frame));
+    EXPECT_EQ(frame.frameNumber, 2u);
+    ASSERT_EQ(frame.keys.size(), 2u);
+    EXPECT_EQ(frame.keys[0].action, 0);
+    EXPECT_EQ(frame.keys[1].key, 65);
+    EXPECT_EQ(frame.keys[1].mods, 2);
+
+    EXPECT_FALSE(replayer.ReadFrame(frame));
+
+    std::remove(path);
+}
+
+TEST(InputRecordingTest, RejectsFilesThatArentReplays) 
+{
+    const char* path = "InputRecordingTest.notreplay";
+
+    std::FILE* file = std::fopen(path, "wb");
+    std::fputs("definitely not a replay", file);
+    std::fclose(file);
+
+    EXPECT_THROW(mt::InputReplayer{path}, std::runtime_error);
+
+    std::remove(path);
+}
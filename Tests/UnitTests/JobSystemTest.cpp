@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <Jobs/JobSystem.hpp>
+
+#include <numeric>
+
+TEST(JobSystemTest, ParallelForVisitsEveryElementOnce) 
+{
+    mt::JobSystem jobs{4};
+
+    std::vector<std::atomic<int>> visits(100000);
+    jobs.ParallelFor(0, visits.size(), 256, [&](size_t begin, size_t end) 
+    {
+        for(size_t i = begin; i < end; i++) 
+        {
+            visits[i].fetch_add(1);
+        }
+    });
+
+    for(const auto& visit : visits) 
+    {
+        EXPECT_EQ(visit.load(), 1);
+    }
+}
+
+TEST(JobSystemTest, NestedWaitDoesNotDeadlock) 
+{
+    mt::JobSystem jobs{2};
+
+    std::atomic<int> count{0};
+    mt::JobCounter outer{};
+
+    for(int i = 0; i < 1000; i++) 
+    {
+        jobs.Submit([&]() 
+        {
+            mt::JobCounter inner{};
+            jobs.Submit([&]() { count++; }, &inner);
+            jobs.Wait(inner);
+            count++;
+        }, &outer);
+    }
+
+    jobs.Wait(outer);
+    EXPECT_EQ(count.load(), 2000);
+}
+
+TEST(JobSystemTest, SubmitFromForeignThread) 
+{
+    mt::JobSystem jobs{2};
+
+    std::atomic<int> count{0};
+    std::thread foreign([&]() 
+    {
+        mt::JobCounter counter{};
+        for(int i = 0; i < 100; i++) 
+        {
+            jobs.Submit([&]() { count++; }, &counter);
+        }
+        jobs.Wait(counter);
+    });
+    foreign.join();
+
+    EXPECT_EQ(count.load(), 100);
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <Resources/Ktx2.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+TEST(Ktx2Test, RoundTripsMipChain) 
+{
+    const char* path = "Ktx2Test.ktx2";
+
+    // A non-multiple-of-four size, so the smaller levels are partial blocks.
+    mt::Ktx2Texture texture{};
+    texture.codec = mt::TextureCodec::BC7;
+    texture.width = 10;
+    texture.height = 6;
+
+    for(uint32_t level = 0; level < 4; level++) 
+    {
+        mt::Ktx2Level out{};
+        out.width = std::max(texture.width >> level, 1u);
+        out.height = std::max(texture.height >> level, 1u);
+        out.offset = texture.data.size();
+        out.size = mt::GetTextureLevelSize(texture.codec, out.width, out.height);
+
+        for(uint64_t i = 0; i < out.size; i++) 
+        {
+            texture.data.push_back(static_cast<uint8_t>(level * 31 + i));
+        }
+        texture.levels.push_back(out);
+    }
+
+    EXPECT_EQ(texture.levels[0].size, 3u * 2u * 16u);
+    EXPECT_EQ(texture.levels[3].size, 16u);
+
+    mt::WriteKtx2(path, texture);
+    mt::Ktx2Texture read = mt::ReadKtx2(path);
+
+    EXPECT_EQ(read.codec, mt::TextureCodec::BC7);
+    EXPECT_EQ(read.width, 10u);
+    EXPECT_EQ(read.height, 6u);
+    ASSERT_EQ(read.levels.size(), 4u);
+
+    // Levels are read in place, wherever the writer put them in the file.
+    for(size_t level = 0; level < read.levels.size(); level++)
+    {
+        const auto& written = texture.levels[level];
+        ASSERT_EQ(read.levels[level].size, written.size);
+        ASSERT_LE(read.levels[level].offset + read.levels[level].size, read.data.size());
+        EXPECT_TRUE(std::equal(read.data.begin() + read.levels[level].offset, read.data.begin() + read.levels[level].offset + written.size,
+            texture.data.begin() + written.offset));
+    }
+
+    std::remove(path);
+}
+
+TEST(Ktx2Test, RejectsOtherFiles) 
+{
+    const char* path = "Ktx2Test.png";
+
+    {
+        std::ofstream file{path, std::ios::binary};
+        file << "\x89PNG\r\n\x1a\n not a ktx2 file, but long enough to have a header's worth of bytes in it";
+    }
+
+    EXPECT_THROW(mt::ReadKtx2(path), std::runtime_error);
+    EXPECT_THROW(mt::ReadKtx2("Ktx2Test.missing.ktx2"), std::runtime_error);
+
+    std::remove(path);
+}
+
+TEST(Ktx2Test, CookedPaths) 
+{
+    EXPECT_EQ(mt::GetCookedTexturePath("Resources/Textures/Player.png", mt::TextureCodec::BC7), "Resources/Textures/Player.bc7.ktx2");
+    EXPECT_EQ(mt::GetCookedTexturePath("Resources.d/Player", mt::TextureCodec::ETC2), "Resources.d/Player.etc2.ktx2");
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <Memory/LinearArena.hpp>
+#include <Memory/FrameAllocator.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <vector>
+
+static bool IsInside(const mt::LinearArena& arena, const void* block, const void* pointer)
+{
+    uintptr_t begin = reinterpret_cast<uintptr_t>(block);
+    uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+    return address >= begin && address < begin + arena.GetCapacity();
+}
+
+TEST(LinearArenaTest, AlignsAllocations)
+{
+    mt::LinearArena arena{1024};
+    void* block = arena.Allocate(1, 1);
+
+    // Each one follows an odd-sized allocation, so it has to be padded.
+    for(size_t alignment : {2, 4, 8, 16, 64, 256})
+    {
+        void* pointer = arena.Allocate(alignment + 1, alignment);
+
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(pointer) % alignment, 0u) << alignment;
+        EXPECT_TRUE(IsInside(arena, block, pointer)) << alignment;
+    }
+
+    EXPECT_EQ(arena.GetStats().overflow, 0u);
+    EXPECT_EQ(arena.GetStats().allocations, 7u);
+    EXPECT_EQ(arena.GetStats().used, arena.GetUsed());
+}
+
+TEST(LinearArenaTest, OverflowsToTheHeap)
+{
+    mt::LinearArena arena{64};
+    void* block = arena.Allocate(48);
+
+    // Doesn't fit, so it's served by the heap and the bump pointer stays where it was.
+    void* overflow = arena.Allocate(32, 32);
+    EXPECT_FALSE(IsInside(arena, block, overflow));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(overflow) % 32, 0u);
+    EXPECT_EQ(arena.GetStats().overflow, 32u);
+    EXPECT_EQ(arena.GetUsed(), 48u);
+
+    // Smaller allocations still fit in what's left of the block.
+    void* small = arena.Allocate(8, 8);
+    EXPECT_TRUE(IsInside(arena, block, small));
+    EXPECT_EQ(arena.GetUsed(), 56u);
+
+    // The heap memory has to be usable until the reset frees it.
+    std::memset(overflow, 0xAB, 32);
+    arena.Reset();
+
+    EXPECT_EQ(arena.GetStats().overflow, 0u);
+    EXPECT_EQ(arena.GetUsed(), 0u);
+}
+
+TEST(LinearArenaTest, ResetRewindsToTheStart)
+{
+    mt::LinearArena arena{4096};
+
+    void* first = nullptr;
+    {
+        std::pmr::vector<uint32_t> values{&arena};
+        for(uint32_t i = 0; i < 100; i++)
+        {
+            values.push_back(i);
+        }
+        first = values.data();
+        EXPECT_EQ(values[99], 99u);
+    }
+    EXPECT_GT(arena.GetUsed(), 0u);
+
+    arena.Reset();
+
+    EXPECT_EQ(arena.GetUsed(), 0u);
+    EXPECT_EQ(arena.GetStats().allocations, 0u);
+
+    // The block is reused from its start, ahead of where the vector's storage ended up.
+    uint32_t* value = arena.New<uint32_t>(7u);
+    EXPECT_EQ(*value, 7u);
+    EXPECT_LE(reinterpret_cast<uintptr_t>(value), reinterpret_cast<uintptr_t>(first));
+}
+
+TEST(LinearArenaTest, FrameAllocatorResetsOnlyItsFrame)
+{
+    mt::JobSystem jobs{1};
+    mt::FrameAllocator frames{jobs, 2, 256, 64};
+
+    frames.BeginFrame(0);
+    frames.GetArena().Allocate(100);
+    mt::LinearArena* frame0 = &frames.GetArena();
+
+    frames.BeginFrame(1);
+    frames.GetArena().Allocate(40);
+    frames.GetArena().Allocate(300);
+    EXPECT_NE(&frames.GetArena(), frame0);
+
+    // Frame 0's arena is untouched until its slot comes round again.
+    EXPECT_EQ(frame0->GetUsed(), 100u);
+
+    frames.BeginFrame(0);
+    EXPECT_EQ(frame0->GetUsed(), 0u);
+    EXPECT_EQ(frames.GetStats().used, 100u);
+    EXPECT_EQ(frames.GetStats().overflow, 0u);
+
+    frames.BeginFrame(1);
+    EXPECT_EQ(frames.GetStats().used, 40u);
+    EXPECT_EQ(frames.GetStats().overflow, 300u);
+    EXPECT_EQ(frames.GetStats().peak, 100u);
+}
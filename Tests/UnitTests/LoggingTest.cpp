@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <Logging.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Everything after the "[time] [LEVEL] [Tn] " prefix of each decoded line.
+static std::vector<std::string> DecodeMessages(const char* path, std::vector<std::string>* levels = nullptr)
+{
+    std::ifstream file{path, std::ios::binary};
+    std::stringstream text{};
+    mt::DecodeBinaryLog(file, text);
+
+    std::vector<std::string> messages{};
+    std::string line{};
+    while(std::getline(text, line))
+    {
+        size_t level = line.find("] [") + 3;
+        size_t message = line.find("] ", line.find(" [T")) + 2;
+        if(levels)
+        {
+            levels->push_back(line.substr(level, line.find(']', level) - level));
+        }
+        messages.push_back(line.substr(message));
+    }
+    return messages;
+}
+
+static void LogToBinaryFile(const char* path)
+{
+    mt::LogDesc desc{};
+    desc.filePath = path;
+    desc.binary = true;
+    mt::Logger::Get().Configure(desc);
+}
+
+static void LogToConsole()
+{
+    mt::Logger::Get().Configure(mt::LogDesc{});
+}
+
+TEST(LoggingTest, BinaryLogRoundTrips)
+{
+    const char* path = "LoggingTest.mtlog";
+    LogToBinaryFile(path);
+
+    std::string name = "Box.png";
+    MT_LOG(mt::LogLevel::Info, "Loaded {} ({}x{})", name, 500u, 250);
+    MT_LOG(mt::LogLevel::Warn, "Ratio {}, enabled {}, offset {}", 0.5, true, -42);
+    MT_LOG(mt::LogLevel::Error, "No arguments");
+    MT_LOG(mt::LogLevel::Debug, "Missing {} and {}", "one");
+    MT_LOG(mt::LogLevel::Info, "Loaded {} again", name);
+
+    mt::Logger::Get().Flush();
+    LogToConsole();
+
+    std::vector<std::string> levels{};
+    std::vector<std::string> messages = DecodeMessages(path, &levels);
+
+    // The format strings were written once each, and records refer back to them.
+    std::vector<std::string> expected = {
+        "Loaded Box.png (500x250)",
+        "Ratio 0.5, enabled true, offset -42",
+        "No arguments",
+        "Missing one and {}",
+        "Loaded Box.png again"
+    };
+    EXPECT_EQ(messages, expected);
+    EXPECT_EQ(levels, (std::vector<std::string>{"INFO ", "WARN ", "ERROR", "DEBUG", "INFO "}));
+
+    std::remove(path);
+}
+
+TEST(LoggingTest, ConcurrentProducersLoseNothing)
+{
+    const char* path = "LoggingTest.mtlog";
+    LogToBinaryFile(path);
+
+    // Fewer messages than the ring holds, so none can be dropped even if the writer never
+    // got to run until the end.
+    constexpr uint32_t THREADS = 4;
+    constexpr uint32_t MESSAGES = mt::Logger::CAPACITY / THREADS / 2;
+    uint64_t dropped = mt::Logger::Get().GetDroppedCount();
+
+    std::vector<std::thread> producers{};
+    for(uint32_t t = 0; t < THREADS; t++)
+    {
+        producers.emplace_back([t]()
+        {
+            for(uint32_t i = 0; i < MESSAGES; i++)
+            {
+                MT_LOG(mt::LogLevel::Info, "{} {}", t, i);
+            }
+        });
+    }
+    for(auto& producer : producers)
+    {
+        producer.join();
+    }
+
+    mt::Logger::Get().Flush();
+    LogToConsole();
+
+    EXPECT_EQ(mt::Logger::Get().GetDroppedCount(), dropped);
+
+    // Every message arrives exactly once, and each producer's in the order it logged them.
+    std::vector<std::string> messages = DecodeMessages(path);
+    ASSERT_EQ(messages.size(), THREADS * MESSAGES);
+
+    std::vector<uint32_t> next(THREADS, 0);
+    for(const auto& message : messages)
+    {
+        uint32_t t = 0;
+        uint32_t i = 0;
+        ASSERT_EQ(std::sscanf(message.c_str(), "%u %u", &t, &i), 2) << message;
+        ASSERT_LT(t, THREADS);
+        EXPECT_EQ(i, next[t]) << message;
+        next[t] = i + 1;
+    }
+
+    for(uint32_t count : next)
+    {
+        EXPECT_EQ(count, MESSAGES);
+    }
+
+    std::remove(path);
+}
+
+TEST(LoggingTest, DecoderRejectsOtherFiles)
+{
+    std::stringstream notALog{"Just some text, not a log"};
+    std::stringstream out{};
+    EXPECT_THROW(mt::DecodeBinaryLog(notALog, out), std::runtime_error);
+
+    std::string corrupt(mt::BINARY_LOG_MAGIC, sizeof(mt::BINARY_LOG_MAGIC));
+    corrupt += '\x7F';
+    std::stringstream unknownBlock{corrupt};
+    EXPECT_THROW(mt::DecodeBinaryLog(unknownBlock, out), std::runtime_error);
+}
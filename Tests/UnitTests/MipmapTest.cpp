@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+#include <Graphics/Shader/Image.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// The scalar 2x2 box filter GenerateMipmaps() documents, which its SSE2 path has to match bit
+// for bit (clamping at odd edges, rounding to nearest).
+static std::vector<unsigned char> Downsample(const std::vector<unsigned char>& source, uint32_t sourceWidth, uint32_t sourceHeight,
+    uint32_t width, uint32_t height)
+{
+    std::vector<unsigned char> destination(static_cast<size_t>(width) * height * 4);
+
+    for(uint32_t y = 0; y < height; y++)
+    {
+        uint32_t y0 = std::min(y * 2, sourceHeight - 1);
+        uint32_t y1 = std::min(y * 2 + 1, sourceHeight - 1);
+
+        for(uint32_t x = 0; x < width; x++)
+        {
+            uint32_t x0 = std::min(x * 2, sourceWidth - 1);
+            uint32_t x1 = std::min(x * 2 + 1, sourceWidth - 1);
+
+            for(uint32_t c = 0; c < 4; c++)
+            {
+                uint32_t sum = source[(y0 * sourceWidth + x0) * 4 + c] + source[(y0 * sourceWidth + x1) * 4 + c]
+                    + source[(y1 * sourceWidth + x0) * 4 + c] + source[(y1 * sourceWidth + x1) * 4 + c];
+                destination[(static_cast<size_t>(y) * width + x) * 4 + c] = static_cast<unsigned char>((sum + 2) >> 2);
+            }
+        }
+    }
+
+    return destination;
+}
+
+static mt::ImageData MakeImage(uint32_t width, uint32_t height)
+{
+    mt::ImageData data{};
+    data.width = width;
+    data.height = height;
+    data.pixels.resize(static_cast<size_t>(width) * height * 4);
+
+    // Noise, so that every rounding case turns up somewhere.
+    uint32_t state = width * 7919u + height;
+    for(unsigned char& channel : data.pixels)
+    {
+        state = state * 1664525u + 1013904223u;
+        channel = static_cast<unsigned char>(state >> 24);
+    }
+
+    return data;
+}
+
+TEST(MipmapTest, MatchesScalarBoxFilter)
+{
+    // Odd and non-square sizes, wide enough for the SSE2 loop and its scalar tail, plus the
+    // single texel rows and columns where both source texels are clamped to the same one.
+    const uint32_t sizes[][2] = {{37, 13}, {13, 37}, {64, 1}, {1, 9}, {33, 33}, {255, 3}, {2, 2}, {1, 1}};
+
+    for(const auto& size : sizes)
+    {
+        mt::ImageData data = MakeImage(size[0], size[1]);
+        std::vector<unsigned char> expected = data.pixels;
+
+        mt::Image::GenerateMipmaps(data);
+
+        uint32_t levelCount = mt::Image::GetMipLevelCount(size[0], size[1]);
+        ASSERT_EQ(data.levels.size(), levelCount) << size[0] << "x" << size[1];
+
+        uint64_t offset = 0;
+        for(uint32_t i = 0; i < levelCount; i++)
+        {
+            const mt::ImageLevel& level = data.levels[i];
+            EXPECT_EQ(level.width, std::max(size[0] >> i, 1u)) << size[0] << "x" << size[1] << " level " << i;
+            EXPECT_EQ(level.height, std::max(size[1] >> i, 1u)) << size[0] << "x" << size[1] << " level " << i;
+            EXPECT_EQ(level.offset, offset);
+            ASSERT_EQ(level.size, static_cast<uint64_t>(level.width) * level.height * 4);
+
+            if(i > 0)
+            {
+                const mt::ImageLevel& previous = data.levels[i - 1];
+                expected = Downsample(expected, previous.width, previous.height, level.width, level.height);
+            }
+
+            ASSERT_LE(level.offset + level.size, data.pixels.size());
+            EXPECT_TRUE(std::equal(expected.begin(), expected.end(), data.pixels.begin() + level.offset))
+                << size[0] << "x" << size[1] << " level " << i;
+
+            offset += level.size;
+        }
+
+        EXPECT_EQ(data.pixels.size(), offset);
+    }
+}
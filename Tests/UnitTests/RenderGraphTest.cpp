@@ -0,0 +1,236 @@
+#include <gtest/gtest.h>
+#include <Graphics/Renderer/RenderGraph.hpp>
+
+#include <stdexcept>
+
+static const mt::RenderGraphImageDesc COLOR_DESC{VK_FORMAT_R8G8B8A8_UNORM, 640, 360};
+static const mt::RenderGraphImageDesc DEPTH_DESC{VK_FORMAT_D32_SFLOAT, 640, 360};
+
+// Stands in for the swap chain image, nothing in the graph looks at the handles.
+static mt::RenderGraphResource ImportBackBuffer(mt::RenderGraph& graph)
+{
+    return graph.ImportImage("BackBuffer", COLOR_DESC, VK_NULL_HANDLE, VK_NULL_HANDLE);
+}
+
+static const mt::RenderGraphBarrier* FindBarrier(const mt::RenderGraphStep& step, mt::RenderGraphResource resource)
+{
+    for(const mt::RenderGraphBarrier& barrier : step.barriers)
+    {
+        if(barrier.resource == resource)
+        {
+            return &barrier;
+        }
+    }
+    return nullptr;
+}
+
+TEST(RenderGraphTest, CullsPassesNothingUses)
+{
+    mt::RenderGraph graph{};
+    mt::RenderGraphResource backBuffer = ImportBackBuffer(graph);
+    mt::RenderGraphResource unused = graph.CreateImage("Unused", COLOR_DESC);
+
+    graph.AddPass("Unused").WriteColor(unused, mt::RenderGraphLoadOp::Clear);
+    graph.AddPass("Readback").WriteColor(graph.CreateImage("Readback", COLOR_DESC), mt::RenderGraphLoadOp::Clear).SetSideEffects();
+    graph.AddPass("Main").WriteColor(backBuffer, mt::RenderGraphLoadOp::Clear);
+    graph.Compile();
+
+    ASSERT_EQ(graph.GetSteps().size(), 2u);
+    EXPECT_EQ(graph.GetCulledPassCount(), 1u);
+    EXPECT_EQ(graph.GetPasses()[graph.GetSteps()[0].pass].GetName(), "Readback");
+    EXPECT_EQ(graph.GetPasses()[graph.GetSteps()[1].pass].GetName(), "Main");
+
+    // Culled images don't get memory.
+    EXPECT_EQ(graph.GetImage(unused).aliasSlot, ~0u);
+}
+
+TEST(RenderGraphTest, ClearingOverwritesEarlierWrites)
+{
+    mt::RenderGraph graph{};
+    mt::RenderGraphResource backBuffer = ImportBackBuffer(graph);
+
+    graph.AddPass("Overwritten").WriteColor(backBuffer, mt::RenderGraphLoadOp::Clear);
+    graph.AddPass("Scene").WriteColor(backBuffer, mt::RenderGraphLoadOp::Clear);
+    graph.AddPass("UI").WriteColor(backBuffer, mt::RenderGraphLoadOp::Load);
+    graph.Compile();
+
+    ASSERT_EQ(graph.GetSteps().size(), 2u);
+    const mt::RenderGraphStep& scene = graph.GetSteps()[0];
+    const mt::RenderGraphStep& ui = graph.GetSteps()[1];
+
+    EXPECT_EQ(scene.colorAttachments[0].loadOp, VK_ATTACHMENT_LOAD_OP_CLEAR);
+    EXPECT_EQ(scene.colorAttachments[0].storeOp, VK_ATTACHMENT_STORE_OP_STORE);
+    EXPECT_EQ(ui.colorAttachments[0].loadOp, VK_ATTACHMENT_LOAD_OP_LOAD);
+
+    // Write after write, so the UI waits for the scene without changing layout.
+    const mt::RenderGraphBarrier* barrier = FindBarrier(ui, backBuffer);
+    ASSERT_NE(barrier, nullptr);
+    EXPECT_EQ(barrier->oldLayout, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    EXPECT_EQ(barrier->newLayout, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    EXPECT_EQ(barrier->srcAccess, static_cast<VkAccessFlags>(VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT));
+
+    // Then it's handed back ready to present.
+    ASSERT_EQ(graph.GetFinalBarriers().barriers.size(), 1u);
+    EXPECT_EQ(graph.GetFinalBarriers().barriers[0].newLayout, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    EXPECT_EQ(graph.GetFinalBarriers().srcStages, static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT));
+}
+
+TEST(RenderGraphTest, PlacesBarriersBetweenWritesAndReads)
+{
+    mt::RenderGraph graph{};
+    mt::RenderGraphResource backBuffer = ImportBackBuffer(graph);
+    mt::RenderGraphResource scene = graph.CreateImage("Scene", COLOR_DESC);
+    mt::RenderGraphResource depth = graph.CreateImage("Depth", DEPTH_DESC);
+    mt::RenderGraphResource bloom = graph.CreateImage("Bloom", COLOR_DESC);
+
+    graph.AddPass("Scene")
+        .WriteColor(scene, mt::RenderGraphLoadOp::Clear)
+        .WriteDepth(depth, mt::RenderGraphLoadOp::Clear);
+    graph.AddPass("Bloom")
+        .ReadImage(scene, mt::RenderGraphAccess::ComputeSampled)
+        .WriteImage(bloom, mt::RenderGraphAccess::ComputeStorageWrite);
+    graph.AddPass("Composite")
+        .ReadImage(scene, mt::RenderGraphAccess::FragmentSampled)
+        .ReadImage(bloom, mt::RenderGraphAccess::FragmentSampled)
+        .WriteColor(backBuffer, mt::RenderGraphLoadOp::DontCare);
+    graph.Compile();
+
+    ASSERT_EQ(graph.GetSteps().size(), 3u);
+    const mt::RenderGraphStep& sceneStep = graph.GetSteps()[0];
+    const mt::RenderGraphStep& bloomStep = graph.GetSteps()[1];
+    const mt::RenderGraphStep& compositeStep = graph.GetSteps()[2];
+
+    // Nothing reads the depth buffer after the scene, so it's never stored.
+    ASSERT_TRUE(sceneStep.hasDepthAttachment);
+    EXPECT_EQ(sceneStep.depthAttachment.storeOp, VK_ATTACHMENT_STORE_OP_DONT_CARE);
+    EXPECT_EQ(sceneStep.colorAttachments[0].storeOp, VK_ATTACHMENT_STORE_OP_STORE);
+    EXPECT_EQ(sceneStep.extent.width, 640u);
+
+    // Both of the scene's transients start out undefined.
+    EXPECT_EQ(sceneStep.barriers.size(), 2u);
+    EXPECT_EQ(FindBarrier(sceneStep, depth)->oldLayout, VK_IMAGE_LAYOUT_UNDEFINED);
+
+    const mt::RenderGraphBarrier* sceneRead = FindBarrier(bloomStep, scene);
+    ASSERT_NE(sceneRead, nullptr);
+    EXPECT_EQ(sceneRead->oldLayout, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+    EXPECT_EQ(sceneRead->newLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    EXPECT_EQ(sceneRead->srcAccess, static_cast<VkAccessFlags>(VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT));
+    EXPECT_TRUE(bloomStep.srcStages & VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+    EXPECT_TRUE(bloomStep.dstStages & VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+    // The scene was already made readable for the compute pass, reading it again needs nothing.
+    EXPECT_EQ(FindBarrier(compositeStep, scene), nullptr);
+
+    const mt::RenderGraphBarrier* bloomRead = FindBarrier(compositeStep, bloom);
+    ASSERT_NE(bloomRead, nullptr);
+    EXPECT_EQ(bloomRead->oldLayout, VK_IMAGE_LAYOUT_GENERAL);
+    EXPECT_EQ(bloomRead->srcAccess, static_cast<VkAccessFlags>(VK_ACCESS_SHADER_WRITE_BIT));
+
+    const mt::RenderGraphBarrier* backBufferWrite = FindBarrier(compositeStep, backBuffer);
+    ASSERT_NE(backBufferWrite, nullptr);
+    EXPECT_EQ(backBufferWrite->oldLayout, VK_IMAGE_LAYOUT_UNDEFINED);
+    EXPECT_EQ(compositeStep.colorAttachments[0].loadOp, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+
+    EXPECT_EQ(graph.GetImage(scene).usage, static_cast<VkImageUsageFlags>(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT));
+}
+
+TEST(RenderGraphTest, MarksUnstoredAttachmentsMemoryless)
+{
+    mt::RenderGraph graph{};
+    mt::RenderGraphResource backBuffer = ImportBackBuffer(graph);
+    mt::RenderGraphResource scene = graph.CreateImage("Scene", COLOR_DESC);
+    mt::RenderGraphResource depth = graph.CreateImage("Depth", DEPTH_DESC);
+    mt::RenderGraphResource overlayDepth = graph.CreateImage("OverlayDepth", DEPTH_DESC);
+
+    graph.AddPass("Scene")
+        .WriteColor(scene, mt::RenderGraphLoadOp::Clear)
+        .WriteDepth(depth, mt::RenderGraphLoadOp::Clear);
+    graph.AddPass("Composite")
+        .ReadImage(scene, mt::RenderGraphAccess::FragmentSampled)
+        .WriteColor(backBuffer, mt::RenderGraphLoadOp::DontCare)
+        .WriteDepth(overlayDepth, mt::RenderGraphLoadOp::Clear);
+    graph.AddPass("UI")
+        .WriteColor(backBuffer, mt::RenderGraphLoadOp::Load)
+        .WriteDepth(overlayDepth, mt::RenderGraphLoadOp::Load);
+    graph.Compile();
+
+    // Cleared and thrown away within one pass, so it never needs memory behind it.
+    EXPECT_TRUE(graph.GetImage(depth).memoryless);
+
+    // Sampled afterwards, carried over into the next pass, or the frame's output.
+    EXPECT_FALSE(graph.GetImage(scene).memoryless);
+    EXPECT_FALSE(graph.GetImage(overlayDepth).memoryless);
+    EXPECT_FALSE(graph.GetImage(backBuffer).memoryless);
+}
+
+TEST(RenderGraphTest, WritesWaitForEarlierReads)
+{
+    mt::RenderGraph graph{};
+    mt::RenderGraphResource backBuffer = ImportBackBuffer(graph);
+    mt::RenderGraphResource history = graph.ImportImage("History", COLOR_DESC, VK_NULL_HANDLE, VK_NULL_HANDLE,
+        mt::RenderGraphImport{VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_IMAGE_LAYOUT_GENERAL});
+
+    graph.AddPass("Resolve")
+        .ReadImage(history, mt::RenderGraphAccess::ComputeStorageRead)
+        .WriteColor(backBuffer, mt::RenderGraphLoadOp::Clear);
+    graph.AddPass("Update").WriteImage(history, mt::RenderGraphAccess::ComputeStorageWrite);
+    graph.Compile();
+
+    ASSERT_EQ(graph.GetSteps().size(), 2u);
+
+    // Same layout and nothing to make visible, but the write mustn't overtake the read.
+    const mt::RenderGraphStep& update = graph.GetSteps()[1];
+    const mt::RenderGraphBarrier* barrier = FindBarrier(update, history);
+    ASSERT_NE(barrier, nullptr);
+    EXPECT_EQ(barrier->srcAccess, 0u);
+    EXPECT_EQ(update.srcStages, static_cast<VkPipelineStageFlags>(VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT));
+
+    // Already in the layout it has to end up in.
+    ASSERT_EQ(graph.GetFinalBarriers().barriers.size(), 1u);
+    EXPECT_EQ(graph.GetFinalBarriers().barriers[0].resource, backBuffer);
+}
+
+TEST(RenderGraphTest, AliasesImagesThatDontOverlap)
+{
+    mt::RenderGraph graph{};
+    mt::RenderGraphResource backBuffer = ImportBackBuffer(graph);
+    mt::RenderGraphResource a = graph.CreateImage("A", COLOR_DESC);
+    mt::RenderGraphResource b = graph.CreateImage("B", COLOR_DESC);
+    mt::RenderGraphResource c = graph.CreateImage("C", COLOR_DESC);
+
+    graph.AddPass("1").WriteColor(a, mt::RenderGraphLoadOp::Clear);
+    graph.AddPass("2").ReadImage(a, mt::RenderGraphAccess::FragmentSampled).WriteColor(b, mt::RenderGraphLoadOp::Clear);
+    graph.AddPass("3").ReadImage(b, mt::RenderGraphAccess::FragmentSampled).WriteColor(c, mt::RenderGraphLoadOp::Clear);
+    graph.AddPass("4").ReadImage(c, mt::RenderGraphAccess::FragmentSampled).WriteColor(backBuffer, mt::RenderGraphLoadOp::Clear);
+    graph.Compile();
+
+    // A is done by the time C is written, B overlaps both.
+    EXPECT_EQ(graph.GetAliasSlotCount(), 2u);
+    EXPECT_EQ(graph.GetImage(a).aliasSlot, graph.GetImage(c).aliasSlot);
+    EXPECT_NE(graph.GetImage(a).aliasSlot, graph.GetImage(b).aliasSlot);
+
+    // C's first use has to wait for A's last one, since it's the same memory.
+    const mt::RenderGraphStep& third = graph.GetSteps()[2];
+    const mt::RenderGraphBarrier* barrier = FindBarrier(third, c);
+    ASSERT_NE(barrier, nullptr);
+    EXPECT_EQ(barrier->oldLayout, VK_IMAGE_LAYOUT_UNDEFINED);
+    EXPECT_TRUE(third.srcStages & VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+}
+
+TEST(RenderGraphTest, RejectsInvalidUses)
+{
+    mt::RenderGraph graph{};
+    mt::RenderGraphResource image = graph.CreateImage("Image", COLOR_DESC);
+
+    mt::RenderGraphPass& pass = graph.AddPass("Pass");
+    EXPECT_THROW(pass.ReadImage(image, mt::RenderGraphAccess::ComputeStorageWrite), std::runtime_error);
+    EXPECT_THROW(pass.WriteImage(image, mt::RenderGraphAccess::ColorAttachment), std::runtime_error);
+
+    pass.WriteColor(image, mt::RenderGraphLoadOp::Clear);
+    EXPECT_THROW(pass.ReadImage(image, mt::RenderGraphAccess::FragmentSampled), std::runtime_error);
+
+    graph.AddPass("Mismatched")
+        .WriteColor(graph.CreateImage("Small", mt::RenderGraphImageDesc{VK_FORMAT_R8G8B8A8_UNORM, 16, 16}), mt::RenderGraphLoadOp::Clear)
+        .WriteColor(ImportBackBuffer(graph), mt::RenderGraphLoadOp::Clear);
+    EXPECT_THROW(graph.Compile(), std::runtime_error);
+}
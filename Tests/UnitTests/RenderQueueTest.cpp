@@ -0,0 +1,260 @@
+#include <gtest/gtest.h>
+#include <Graphics/Renderer/RenderQueue.hpp>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+static mt::RenderSubmission MakeSubmission(uint8_t layer, bool translucent, uint32_t pipeline, uint32_t material, float depth, uint32_t firstInstance = 0)
+{
+    mt::RenderSubmission submission{};
+    submission.layer = layer;
+    submission.translucent = translucent;
+    submission.pipeline = pipeline;
+    submission.material = material;
+    submission.depth = depth;
+    submission.draw.firstInstance = firstInstance;
+    return submission;
+}
+
+// Records what executing a queue would have bound and drawn.
+struct RecordedCommands
+{
+    std::vector<uint32_t> pipelines{};
+    std::vector<uint32_t> materials{};
+    std::vector<mt::RenderDraw> draws{};
+
+    mt::RenderQueueCommands Get(uint32_t unreadyPipeline = ~0u)
+    {
+        mt::RenderQueueCommands commands{};
+        commands.bindPipeline = [this, unreadyPipeline](uint32_t pipeline)
+        {
+            pipelines.push_back(pipeline);
+            return pipeline != unreadyPipeline;
+        };
+        commands.bindMaterial = [this](uint32_t, uint32_t material) { materials.push_back(material); };
+        commands.draw = [this](const mt::RenderDraw& draw) { draws.push_back(draw); };
+        return commands;
+    }
+};
+
+TEST(RenderQueueTest, OrdersByLayerThenTranslucencyThenState)
+{
+    mt::RenderQueue queue{};
+    queue.Submit(MakeSubmission(1, false, 0, 0, 0.5f));
+    queue.Submit(MakeSubmission(0, true, 0, 0, 0.5f));
+    queue.Submit(MakeSubmission(0, false, 2, 0, 0.5f));
+    queue.Submit(MakeSubmission(0, false, 1, 7, 0.5f));
+    queue.Submit(MakeSubmission(0, false, 1, 3, 0.9f));
+    queue.Submit(MakeSubmission(0, false, 1, 3, 0.1f));
+    queue.Sort();
+
+    std::vector<mt::RenderSubmission> sorted = queue.GetSortedSubmissions();
+    ASSERT_EQ(sorted.size(), 6);
+
+    // Opaque state first, front to back within it.
+    EXPECT_EQ(sorted[0].material, 3);
+    EXPECT_FLOAT_EQ(sorted[0].depth, 0.1f);
+    EXPECT_EQ(sorted[1].material, 3);
+    EXPECT_FLOAT_EQ(sorted[1].depth, 0.9f);
+    EXPECT_EQ(sorted[2].material, 7);
+    EXPECT_EQ(sorted[3].pipeline, 2);
+    EXPECT_TRUE(sorted[4].translucent);
+    EXPECT_EQ(sorted[5].layer, 1);
+}
+
+TEST(RenderQueueTest, DrawsTranslucentBackToFront)
+{
+    mt::RenderQueue queue{};
+    queue.Submit(MakeSubmission(0, true, 0, 0, 0.2f));
+    queue.Submit(MakeSubmission(0, true, 1, 1, 0.8f));
+    queue.Submit(MakeSubmission(0, true, 0, 0, 0.5f));
+    queue.Sort();
+
+    std::vector<mt::RenderSubmission> sorted = queue.GetSortedSubmissions();
+    EXPECT_FLOAT_EQ(sorted[0].depth, 0.8f);
+    EXPECT_FLOAT_EQ(sorted[1].depth, 0.5f);
+    EXPECT_FLOAT_EQ(sorted[2].depth, 0.2f);
+}
+
+TEST(RenderQueueTest, ParallelSortMatchesStableSort)
+{
+    mt::JobSystem jobs{4};
+
+    std::mt19937 random{1234};
+    std::uniform_int_distribution<uint32_t> pipelines{0, 15};
+    std::uniform_int_distribution<uint32_t> materials{0, 255};
+    std::uniform_int_distribution<uint32_t> layers{0, 3};
+    std::uniform_real_distribution<float> depths{0.0f, 1.0f};
+
+    std::vector<mt::RenderSubmission> submissions{};
+    for(uint32_t i = 0; i < 200000; i++)
+    {
+        // Few distinct depths, so plenty of equal keys to check stability with.
+        float depth = static_cast<float>(static_cast<int>(depths(random) * 8.0f)) / 8.0f;
+        submissions.push_back(MakeSubmission(static_cast<uint8_t>(layers(random)), (i % 5) == 0, pipelines(random), materials(random), depth, i));
+    }
+
+    mt::RenderQueue queue{};
+    for(const mt::RenderSubmission& submission : submissions)
+    {
+        queue.Submit(submission);
+    }
+    queue.Sort(&jobs);
+
+    std::stable_sort(submissions.begin(), submissions.end(), [](const mt::RenderSubmission& a, const mt::RenderSubmission& b)
+    {
+        return mt::MakeRenderKey(a) < mt::MakeRenderKey(b);
+    });
+
+    std::vector<mt::RenderSubmission> sorted = queue.GetSortedSubmissions();
+    ASSERT_EQ(sorted.size(), submissions.size());
+    for(size_t i = 0; i < sorted.size(); i++)
+    {
+        ASSERT_EQ(sorted[i].draw.firstInstance, submissions[i].draw.firstInstance) << "at " << i;
+    }
+}
+
+TEST(RenderQueueTest, SkipsPassesWhereEveryDigitMatches)
+{
+    mt::RenderQueue queue{};
+    for(uint32_t i = 0; i < 100; i++)
+    {
+        queue.Submit(MakeSubmission(0, false, 0, i % 4, 0.0f));
+    }
+    queue.Sort();
+
+    // Only the material's lowest byte differs between keys.
+    EXPECT_EQ(queue.GetStats().sortPasses, 1);
+}
+
+TEST(RenderQueueTest, BindsOnlyWhenStateChanges)
+{
+    mt::RenderQueue queue{};
+    queue.Submit(MakeSubmission(0, false, 1, 1, 0.0f, 10));
+    queue.Submit(MakeSubmission(0, false, 0, 1, 0.0f, 20));
+    queue.Submit(MakeSubmission(0, false, 1, 2, 0.0f, 30));
+    queue.Submit(MakeSubmission(0, false, 0, 1, 0.0f, 40));
+    queue.Submit(MakeSubmission(0, false, 1, 1, 0.0f, 50));
+    queue.Sort();
+
+    RecordedCommands recorded{};
+    queue.Execute(recorded.Get());
+
+    EXPECT_EQ(recorded.pipelines, (std::vector<uint32_t>{0, 1}));
+    EXPECT_EQ(recorded.materials, (std::vector<uint32_t>{1, 1, 2}));
+    EXPECT_EQ(recorded.draws.size(), 5);
+
+    const mt::RenderQueueStats& stats = queue.GetStats();
+    EXPECT_EQ(stats.submissions, 5);
+    EXPECT_EQ(stats.draws, 5);
+    EXPECT_EQ(stats.pipelineBinds, 2);
+    EXPECT_EQ(stats.materialBinds, 3);
+}
+
+TEST(RenderQueueTest, MergesConsecutiveInstances)
+{
+    mt::RenderQueue queue{};
+    for(uint32_t i = 0; i < 8; i++)
+    {
+        queue.Submit(MakeSubmission(0, false, 0, 0, 0.0f, i));
+    }
+    // Same state, but doesn't continue the instances before it.
+    queue.Submit(MakeSubmission(0, false, 0, 0, 0.0f, 100));
+    queue.Sort();
+
+    RecordedCommands recorded{};
+    queue.Execute(recorded.Get());
+
+    ASSERT_EQ(recorded.draws.size(), 2);
+    EXPECT_EQ(recorded.draws[0].firstInstance, 0);
+    EXPECT_EQ(recorded.draws[0].instanceCount, 8);
+    EXPECT_EQ(recorded.draws[1].firstInstance, 100);
+    EXPECT_EQ(queue.GetStats().draws, 2);
+}
+
+TEST(RenderQueueTest, SortingAnEmptyQueueResetsStats)
+{
+    mt::RenderQueue queue{};
+    queue.Submit(MakeSubmission(0, false, 0, 0, 0.0f, 0));
+    queue.Sort();
+
+    RecordedCommands recorded{};
+    queue.Execute(recorded.Get());
+    EXPECT_EQ(queue.GetStats().draws, 1);
+
+    // A frame that submits nothing mustn't keep reporting the last one's draws.
+    queue.Clear();
+    queue.Sort();
+    EXPECT_TRUE(queue.IsSorted());
+    EXPECT_EQ(queue.GetStats().draws, 0);
+    EXPECT_EQ(queue.GetStats().submissions, 0);
+}
+
+TEST(RenderQueueTest, NeverMergesIndirectDraws)
+{
+    mt::RenderQueue queue{};
+    for(uint32_t i = 0; i < 2; i++)
+    {
+        mt::RenderSubmission submission = MakeSubmission(0, false, 0, 0, 0.0f, i);
+        submission.draw.indirect = 1;
+        queue.Submit(submission);
+    }
+    queue.Submit(MakeSubmission(0, false, 0, 0, 0.0f, 2));
+    queue.Sort();
+
+    RecordedCommands recorded{};
+    queue.Execute(recorded.Get());
+
+    // The submitted instances don't describe indirect draws, so they don't say what follows on.
+    ASSERT_EQ(recorded.draws.size(), 3);
+    EXPECT_EQ(recorded.draws[0].indirect, 1);
+    EXPECT_EQ(recorded.draws[1].indirect, 1);
+    EXPECT_EQ(recorded.draws[2].indirect, 0);
+    EXPECT_EQ(recorded.materials.size(), 1);
+}
+
+TEST(RenderQueueTest, SkipsDrawsWhosePipelineIsntReady)
+{
+    mt::RenderQueue queue{};
+    queue.Submit(MakeSubmission(0, false, 0, 0, 0.0f, 0));
+    queue.Submit(MakeSubmission(0, false, 1, 0, 0.0f, 10));
+    queue.Submit(MakeSubmission(0, false, 1, 0, 0.0f, 20));
+    queue.Sort();
+
+    RecordedCommands recorded{};
+    queue.Execute(recorded.Get(1));
+
+    ASSERT_EQ(recorded.draws.size(), 1);
+    EXPECT_EQ(recorded.draws[0].firstInstance, 0);
+    EXPECT_EQ(queue.GetStats().skipped, 2);
+    EXPECT_EQ(queue.GetStats().pipelineBinds, 1);
+}
+
+TEST(RenderQueueTest, AppendsOtherQueues)
+{
+    mt::RenderQueue queue{};
+    mt::RenderQueue other{};
+    queue.Submit(MakeSubmission(1, false, 0, 0, 0.0f, 1));
+    other.Submit(MakeSubmission(0, false, 0, 0, 0.0f, 2));
+    queue.Append(other);
+    queue.Sort();
+
+    EXPECT_EQ(other.GetSize(), 0);
+
+    std::vector<mt::RenderSubmission> sorted = queue.GetSortedSubmissions();
+    ASSERT_EQ(sorted.size(), 2);
+    EXPECT_EQ(sorted[0].draw.firstInstance, 2);
+    EXPECT_EQ(sorted[1].draw.firstInstance, 1);
+}
+
+TEST(RenderQueueTest, RejectsInvalidUse)
+{
+    mt::RenderQueue queue{};
+    EXPECT_THROW(queue.Submit(MakeSubmission(0, false, mt::RenderQueue::MAX_PIPELINES, 0, 0.0f)), std::runtime_error);
+    EXPECT_THROW(queue.Submit(MakeSubmission(0, false, 0, mt::RenderQueue::MAX_MATERIALS, 0.0f)), std::runtime_error);
+
+    queue.Submit(MakeSubmission(0, false, 0, 0, 0.0f));
+    RecordedCommands recorded{};
+    EXPECT_THROW(queue.Execute(recorded.Get()), std::runtime_error);
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <ResourceManager.hpp>
+#include <Graphics/Shader/Image.hpp>
+#include <Graphics/Shader/Shader.hpp>
+
+#include <filesystem>
+#include <fstream>
+
+// A 2x2 binary PPM, which stb_image decodes like any other image.
+static std::string WriteImage(const std::string& name) 
+{
+    std::filesystem::path path = std::filesystem::temp_directory_path() / name;
+    std::ofstream file{path, std::ios::binary};
+    file << "P6\n2 2\n255\n";
+    const unsigned char pixels[12] = {255, 0, 0, 0, 255, 0, 0, 0, 255, 255, 255, 255};
+    file.write(reinterpret_cast<const char*>(pixels), sizeof(pixels));
+    return path.string();
+}
+
+// There's no device here, so these stand in for Image::UploadBatch() and the Shader constructor
+// that Engine hands the manager, and only count what would've been created.
+static void SetUploaders(mt::ResourceManager& resources, uint32_t& uploads, uint32_t& shaders) 
+{
+    resources.SetImageBatchUploader([&uploads](const std::vector<const mt::ImageData*>& data) 
+    {
+        for(const mt::ImageData* image : data) 
+        {
+            EXPECT_EQ(image->width, 2u);
+            EXPECT_EQ(image->height, 2u);
+        }
+        uploads += static_cast<uint32_t>(data.size());
+        return std::vector<std::unique_ptr<mt::Image>>(data.size());
+    });
+    resources.SetShaderFactory([&shaders](const std::string&, const std::string&) 
+    {
+        shaders++;
+        return std::unique_ptr<mt::Shader>{};
+    });
+}
+
+TEST(ResourceManagerTest, LoadsBecomeResident) 
+{
+    std::string path = WriteImage("ResourceManagerTest_Resident.ppm");
+
+    mt::JobSystem jobs{2};
+    mt::ResourceManager resources{jobs};
+    uint32_t uploads = 0;
+    uint32_t shaders = 0;
+    SetUploaders(resources, uploads, shaders);
+
+    mt::ImageHandle image = resources.LoadImage(path);
+    mt::ShaderHandle shader = resources.LoadShader("sprite", "vert.spv", "frag.spv");
+    EXPECT_NE(resources.GetState(image), mt::AssetState::Resident);
+
+    resources.FinishLoading();
+    EXPECT_EQ(resources.GetState(image), mt::AssetState::Resident);
+    EXPECT_EQ(resources.GetState(shader), mt::AssetState::Resident);
+    EXPECT_EQ(uploads, 1u);
+    EXPECT_EQ(shaders, 1u);
+
+    std::filesystem::remove(path);
+}
+
+TEST(ResourceManagerTest, NothingIsResidentWithoutUploaders) 
+{
+    std::string path = WriteImage("ResourceManagerTest_NoUploaders.ppm");
+
+    mt::JobSystem jobs{2};
+    mt::ResourceManager resources{jobs};
+
+    mt::ImageHandle image = resources.LoadImage(path);
+    mt::ShaderHandle shader = resources.LoadShader("sprite", "vert.spv", "frag.spv");
+    resources.FinishLoading();
+    EXPECT_NE(resources.GetState(image), mt::AssetState::Resident);
+    EXPECT_NE(resources.GetState(shader), mt::AssetState::Resident);
+
+    std::filesystem::remove(path);
+}
+
+TEST(ResourceManagerTest, ReloadingAKeyKeepsItsAsset) 
+{
+    std::string path = WriteImage("ResourceManagerTest_Reload.ppm");
+
+    mt::JobSystem jobs{2};
+    mt::ResourceManager resources{jobs};
+    uint32_t uploads = 0;
+    uint32_t shaders = 0;
+    SetUploaders(resources, uploads, shaders);
+
+    mt::ImageHandle image = resources.LoadImage("player", path);
+    mt::ShaderHandle shader = resources.LoadShader("sprite", "vert.spv", "frag.spv");
+    resources.FinishLoading();
+
+    // Released only after acquiring it again, so it's never destroyed and loaded all over again.
+    mt::ImageHandle reloadedImage = resources.LoadImage("player", path);
+    mt::ShaderHandle reloadedShader = resources.LoadShader("sprite", "vert.spv", "frag.spv");
+    EXPECT_EQ(reloadedImage, image);
+    EXPECT_EQ(reloadedShader, shader);
+    EXPECT_EQ(resources.GetState(reloadedImage), mt::AssetState::Resident);
+    EXPECT_EQ(resources.GetState(reloadedShader), mt::AssetState::Resident);
+
+    resources.FinishLoading();
+    EXPECT_EQ(uploads, 1u);
+    EXPECT_EQ(shaders, 1u);
+    EXPECT_EQ(resources.GetImageHandle("player"), image);
+    EXPECT_EQ(resources.GetShaderHandle("sprite"), shader);
+
+    std::filesystem::remove(path);
+}
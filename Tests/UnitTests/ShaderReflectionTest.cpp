@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <Graphics/Shader/ShaderReflection.hpp>
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static std::vector<uint32_t> ReadSpirv(const std::string& name) 
+{
+    std::ifstream file{std::string(MAMMOTH_SHADER_DIR) + name, std::ios::ate | std::ios::binary};
+    std::vector<uint32_t> code(static_cast<size_t>(file.tellg()) / sizeof(uint32_t));
+
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(code.data()), code.size() * sizeof(uint32_t));
+    return code;
+}
+
+TEST(ShaderReflectionTest, ReflectsSpriteShader) 
+{
+    std::vector<uint32_t> vertex = ReadSpirv("simple.vert.spv");
+    std::vector<uint32_t> fragment = ReadSpirv("simple.frag.spv");
+
+    mt::ShaderReflection reflection{};
+    mt::MergeShaderReflection(reflection, mt::ReflectShader(vertex.data(), vertex.size()));
+    mt::MergeShaderReflection(reflection, mt::ReflectShader(fragment.data(), fragment.size()));
+
+    EXPECT_EQ(reflection.stages, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
+
+    // Six samplers in set 0 that only the fragment stage reads, then the vertex stage's frame
+    // table, instance frames, camera, instances and the instances that survived culling.
+    ASSERT_EQ(reflection.bindings.size(), 11u);
+    EXPECT_EQ(reflection.GetSetCount(), 1u);
+    for(uint32_t i = 0; i < 11; i++) 
+    {
+        EXPECT_EQ(reflection.bindings[i].set, 0u);
+        EXPECT_EQ(reflection.bindings[i].binding, i);
+        EXPECT_EQ(reflection.bindings[i].count, 1u);
+    }
+    for(uint32_t i = 0; i < 6; i++) 
+    {
+        EXPECT_EQ(reflection.bindings[i].type, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+        EXPECT_EQ(reflection.bindings[i].stages, static_cast<VkShaderStageFlags>(VK_SHADER_STAGE_FRAGMENT_BIT));
+    }
+    EXPECT_EQ(reflection.bindings[6].type, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+    EXPECT_EQ(reflection.bindings[7].type, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+    EXPECT_EQ(reflection.bindings[8].type, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+    EXPECT_EQ(reflection.bindings[9].type, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+    EXPECT_EQ(reflection.bindings[10].type, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+    for(uint32_t i = 6; i < 11; i++) 
+    {
+        EXPECT_EQ(reflection.bindings[i].stages, static_cast<VkShaderStageFlags>(VK_SHADER_STAGE_VERTEX_BIT));
+    }
+
+    // Just the base instance and frame index, only the vertex stage reads them.
+    ASSERT_EQ(reflection.pushConstants.size(), 1u);
+    EXPECT_EQ(reflection.pushConstants[0].offset, 0u);
+    EXPECT_EQ(reflection.pushConstants[0].size, 8u);
+    EXPECT_EQ(reflection.pushConstants[0].stageFlags, static_cast<VkShaderStageFlags>(VK_SHADER_STAGE_VERTEX_BIT));
+
+    ASSERT_EQ(reflection.vertexAttributes.size(), 2u);
+    EXPECT_EQ(reflection.vertexAttributes[0].location, 0u);
+    EXPECT_EQ(reflection.vertexAttributes[0].format, VK_FORMAT_R32G32_SFLOAT);
+    EXPECT_EQ(reflection.vertexAttributes[1].location, 1u);
+    EXPECT_EQ(reflection.vertexAttributes[1].format, VK_FORMAT_R32G32_SFLOAT);
+
+    std::vector<VkDescriptorPoolSize> poolSizes = mt::GetDescriptorPoolSizes(reflection, 2);
+    ASSERT_EQ(poolSizes.size(), 3u);
+    EXPECT_EQ(poolSizes[0].type, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+    EXPECT_EQ(poolSizes[0].descriptorCount, 12u);
+    EXPECT_EQ(poolSizes[1].type, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+    EXPECT_EQ(poolSizes[1].descriptorCount, 8u);
+    EXPECT_EQ(poolSizes[2].type, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+    EXPECT_EQ(poolSizes[2].descriptorCount, 2u);
+}
+
+TEST(ShaderReflectionTest, ReflectsCullShader) 
+{
+    std::vector<uint32_t> compute = ReadSpirv("cull.comp.spv");
+
+    mt::ShaderReflection reflection{};
+    mt::MergeShaderReflection(reflection, mt::ReflectShader(compute.data(), compute.size()));
+
+    EXPECT_EQ(reflection.stages, static_cast<VkShaderStageFlags>(VK_SHADER_STAGE_COMPUTE_BIT));
+
+    // The camera and instances at the same bindings as simple.vert, then the visible instances,
+    // the draw commands and the workgroups' counts.
+    ASSERT_EQ(reflection.bindings.size(), 5u);
+    EXPECT_EQ(reflection.GetSetCount(), 1u);
+    for(uint32_t i = 0; i < 5; i++) 
+    {
+        EXPECT_EQ(reflection.bindings[i].set, 0u);
+        EXPECT_EQ(reflection.bindings[i].binding, 8u + i);
+        EXPECT_EQ(reflection.bindings[i].type, i == 0 ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+        EXPECT_EQ(reflection.bindings[i].stages, static_cast<VkShaderStageFlags>(VK_SHADER_STAGE_COMPUTE_BIT));
+    }
+
+    // Base instance, frame index, instance count and phase.
+    ASSERT_EQ(reflection.pushConstants.size(), 1u);
+    EXPECT_EQ(reflection.pushConstants[0].offset, 0u);
+    EXPECT_EQ(reflection.pushConstants[0].size, 16u);
+    EXPECT_EQ(reflection.pushConstants[0].stageFlags, static_cast<VkShaderStageFlags>(VK_SHADER_STAGE_COMPUTE_BIT));
+
+    EXPECT_TRUE(reflection.vertexAttributes.empty());
+}
+
+TEST(ShaderReflectionTest, MergesStages) 
+{
+    mt::ShaderReflection vertex{};
+    vertex.stages = VK_SHADER_STAGE_VERTEX_BIT;
+    vertex.bindings.push_back(mt::ShaderBinding{0, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT});
+    vertex.pushConstants.push_back(VkPushConstantRange{VK_SHADER_STAGE_VERTEX_BIT, 0, 64});
+
+    mt::ShaderReflection fragment{};
+    fragment.stages = VK_SHADER_STAGE_FRAGMENT_BIT;
+    fragment.bindings.push_back(mt::ShaderBinding{0, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_FRAGMENT_BIT});
+    fragment.bindings.push_back(mt::ShaderBinding{1, 2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4, VK_SHADER_STAGE_FRAGMENT_BIT});
+    fragment.pushConstants.push_back(VkPushConstantRange{VK_SHADER_STAGE_FRAGMENT_BIT, 64, 16});
+
+    mt::ShaderReflection pipeline{};
+    mt::MergeShaderReflection(pipeline, vertex);
+    mt::MergeShaderReflection(pipeline, fragment);
+
+    ASSERT_EQ(pipeline.bindings.size(), 2u);
+    EXPECT_EQ(pipeline.bindings[0].stages, static_cast<VkShaderStageFlags>(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT));
+    EXPECT_EQ(pipeline.bindings[1].set, 1u);
+    EXPECT_EQ(pipeline.GetSetCount(), 2u);
+
+    ASSERT_EQ(pipeline.pushConstants.size(), 1u);
+    EXPECT_EQ(pipeline.pushConstants[0].offset, 0u);
+    EXPECT_EQ(pipeline.pushConstants[0].size, 80u);
+
+    // The same binding can't be a buffer in one stage and an image in another.
+    mt::ShaderReflection mismatched{};
+    mismatched.bindings.push_back(mt::ShaderBinding{1, 2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT});
+    EXPECT_THROW(mt::MergeShaderReflection(pipeline, mismatched), std::runtime_error);
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <Animation/SpriteAnimation.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+// Steps a single animation and collects the frames it lands on, relative to the clip.
+static std::vector<uint32_t> Play(const mt::SpriteAnimationLibrary& library, mt::SpriteAnimationComp animation, float step, int count)
+{
+    std::vector<uint32_t> frames{};
+    uint32_t first = library.GetClips()[animation.clip].firstFrame;
+
+    for(int i = 0; i < count; i++)
+    {
+        uint32_t frame = 0;
+        mt::AnimateSprites(library.GetClips().data(), step, &animation, &frame, 1);
+        frames.push_back(frame - first);
+    }
+    return frames;
+}
+
+TEST(SpriteAnimationTest, GridFramesStartTopLeft)
+{
+    mt::SpriteAnimationLibrary library{};
+    EXPECT_EQ(library.GetFrames()[0], glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+
+    uint32_t first = library.AddGrid(4, 2, 6);
+    EXPECT_EQ(first, 1u);
+    ASSERT_EQ(library.GetFrames().size(), 7u);
+
+    EXPECT_EQ(library.GetFrames()[first], glm::vec4(0.0f, 0.5f, 0.25f, 0.5f));
+    EXPECT_EQ(library.GetFrames()[first + 3], glm::vec4(0.75f, 0.5f, 0.25f, 0.5f));
+    EXPECT_EQ(library.GetFrames()[first + 4], glm::vec4(0.0f, 0.0f, 0.25f, 0.5f));
+}
+
+TEST(SpriteAnimationTest, LoopModes)
+{
+    mt::SpriteAnimationLibrary library{};
+    uint32_t first = library.AddGrid(4, 1);
+    uint32_t walk = library.AddClip("walk", mt::AnimationClip{first, 4, 10.0f});
+
+    mt::SpriteAnimationComp animation{};
+    animation.clip = walk;
+
+    // A tenth of a second per frame, sampled mid-frame to stay clear of rounding.
+    animation.time = 0.05f;
+    animation.loop = mt::AnimationLoop::Loop;
+    EXPECT_EQ(Play(library, animation, 0.1f, 9), (std::vector<uint32_t>{1, 2, 3, 0, 1, 2, 3, 0, 1}));
+
+    animation.loop = mt::AnimationLoop::Once;
+    EXPECT_EQ(Play(library, animation, 0.1f, 6), (std::vector<uint32_t>{1, 2, 3, 3, 3, 3}));
+
+    animation.loop = mt::AnimationLoop::PingPong;
+    EXPECT_EQ(Play(library, animation, 0.1f, 8), (std::vector<uint32_t>{1, 2, 3, 2, 1, 0, 1, 2}));
+
+    animation.loop = mt::AnimationLoop::Loop;
+    animation.speed = -1.0f;
+    EXPECT_EQ(Play(library, animation, 0.1f, 5), (std::vector<uint32_t>{3, 2, 1, 0, 3}));
+}
+
+TEST(SpriteAnimationTest, TimeStaysWithinOnePeriod)
+{
+    mt::SpriteAnimationLibrary library{};
+    uint32_t idle = library.AddClip("idle", mt::AnimationClip{library.AddGrid(8, 1), 8, 24.0f});
+
+    std::vector<mt::SpriteAnimationComp> animations(1000);
+    std::vector<uint32_t> frames(animations.size());
+    for(size_t i = 0; i < animations.size(); i++)
+    {
+        animations[i].clip = idle;
+        animations[i].speed = 0.5f + (i % 7) * 0.25f;
+    }
+
+    mt::JobSystem jobSystem{2};
+    for(int i = 0; i < 10000; i++)
+    {
+        mt::AnimateSprites(jobSystem, library.GetClips().data(), 1.0f / 60.0f, animations.data(), frames.data(), animations.size());
+    }
+
+    for(size_t i = 0; i < animations.size(); i++)
+    {
+        EXPECT_GE(animations[i].time, 0.0f);
+        EXPECT_LT(animations[i].time, 8.0f / 24.0f + 1e-4f);
+        EXPECT_GE(frames[i], 1u);
+        EXPECT_LE(frames[i], 8u);
+    }
+}
+
+TEST(SpriteAnimationTest, BatchesMatchOneAtATime)
+{
+    mt::SpriteAnimationLibrary library{};
+    uint32_t first = library.AddGrid(8, 8);
+    library.AddClip("idle", mt::AnimationClip{first, 8, 8.0f});
+    library.AddClip("still", mt::AnimationClip{first + 8, 1, 12.0f});
+    library.AddClip("attack", mt::AnimationClip{first + 9, 6, 24.0f});
+
+    // Every combination of clip, loop mode and direction, with a count that leaves a remainder.
+    std::vector<mt::SpriteAnimationComp> batched(103);
+    for(size_t i = 0; i < batched.size(); i++)
+    {
+        batched[i].clip = static_cast<uint32_t>(i % 3);
+        batched[i].time = (i % 11) * 0.037f;
+        batched[i].speed = (i % 2 ? -1.0f : 1.0f) * (0.5f + (i % 5) * 0.25f);
+        batched[i].loop = static_cast<mt::AnimationLoop>(i / 3 % 3);
+    }
+    std::vector<mt::SpriteAnimationComp> single = batched;
+
+    std::vector<uint32_t> batchedFrames(batched.size());
+    std::vector<uint32_t> singleFrames(single.size());
+
+    for(int step = 0; step < 50; step++)
+    {
+        mt::AnimateSprites(library.GetClips().data(), 1.0f / 30.0f, batched.data(), batchedFrames.data(), batched.size());
+        for(size_t i = 0; i < single.size(); i++)
+        {
+            mt::AnimateSprites(library.GetClips().data(), 1.0f / 30.0f, &single[i], &singleFrames[i], 1);
+        }
+
+        for(size_t i = 0; i < batched.size(); i++)
+        {
+            ASSERT_EQ(batched[i].time, single[i].time);
+            ASSERT_EQ(batchedFrames[i], singleFrames[i]);
+        }
+    }
+}
+
+TEST(SpriteAnimationTest, RejectsBadClips)
+{
+    mt::SpriteAnimationLibrary library{};
+    uint32_t first = library.AddGrid(2, 2);
+
+    EXPECT_THROW(library.AddClip("past the end", mt::AnimationClip{first, 5, 10.0f}), std::runtime_error);
+    EXPECT_THROW(library.AddClip("frozen", mt::AnimationClip{first, 4, 0.0f}), std::runtime_error);
+
+    library.AddClip("run", mt::AnimationClip{first, 4, 10.0f});
+    EXPECT_THROW(library.AddClip("run", mt::AnimationClip{first, 4, 10.0f}), std::runtime_error);
+    EXPECT_EQ(library.FindClip("run"), 0u);
+    EXPECT_THROW(library.FindClip("jump"), std::runtime_error);
+}
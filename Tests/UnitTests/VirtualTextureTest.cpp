@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+#include <Resources/VirtualTextureFile.hpp>
+
+#include <cstdio>
+#include <cstring>
+
+// Every texel encodes its own coordinates and level, so pages can be checked exactly.
+static std::vector<mt::VirtualTextureLevel> MakeLevels(uint32_t width, uint32_t height, uint32_t count)
+{
+    std::vector<mt::VirtualTextureLevel> levels{};
+    for(uint32_t l = 0; l < count; l++)
+    {
+        mt::VirtualTextureLevel level{};
+        level.width = std::max(width >> l, 1u);
+        level.height = std::max(height >> l, 1u);
+        level.texels.resize(static_cast<size_t>(level.width) * level.height * 4);
+
+        for(uint32_t y = 0; y < level.height; y++)
+        {
+            for(uint32_t x = 0; x < level.width; x++)
+            {
+                uint8_t* texel = &level.texels[(static_cast<size_t>(y) * level.width + x) * 4];
+                texel[0] = static_cast<uint8_t>(x);
+                texel[1] = static_cast<uint8_t>(y);
+                texel[2] = static_cast<uint8_t>(l);
+                texel[3] = 255;
+            }
+        }
+        levels.push_back(std::move(level));
+    }
+    return levels;
+}
+
+TEST(VirtualTextureTest, LayoutHalvesDownToOnePage)
+{
+    mt::VirtualTextureLayout layout{300, 200, 64, 2};
+
+    // 5x4 pages, 3x2 (150x100), 2x1 (75x50), 1x1.
+    ASSERT_EQ(layout.levels.size(), 4u);
+    EXPECT_EQ(layout.levels[0].pagesX, 5u);
+    EXPECT_EQ(layout.levels[0].pagesY, 4u);
+    EXPECT_EQ(layout.levels[1].pagesX, 3u);
+    EXPECT_EQ(layout.levels[2].pagesX, 2u);
+    EXPECT_EQ(layout.levels[3].pagesX, 1u);
+    EXPECT_EQ(layout.pageCount, 20u + 6u + 2u + 1u);
+    EXPECT_EQ(layout.GetStoredPageSize(), 68u);
+
+    for(uint32_t page = 0; page < layout.pageCount; page++)
+    {
+        uint32_t level, x, y;
+        layout.GetPageCoordinates(page, level, x, y);
+        EXPECT_EQ(layout.GetPageIndex(level, x, y), page);
+    }
+}
+
+TEST(VirtualTextureTest, PagesRoundTripWithBorders)
+{
+    const char* path = "VirtualTextureTest.vtex";
+
+    for(bool compress : {false, true})
+    {
+        mt::WriteVirtualTexture(path, MakeLevels(300, 200, 9), 64, 2, compress);
+
+        mt::VirtualTextureFile file{path};
+        const mt::VirtualTextureLayout& layout = file.GetLayout();
+        ASSERT_EQ(layout.width, 300u);
+        ASSERT_EQ(layout.levels.size(), 4u);
+
+        std::vector<uint8_t> page(layout.GetPageBytes());
+        uint32_t stored = layout.GetStoredPageSize();
+
+        // Page (1, 2) of level 0: texels 62..130 x 126..194, borders included.
+        file.ReadPage(layout.GetPageIndex(0, 1, 2), page.data());
+        EXPECT_EQ(page[0], 62);
+        EXPECT_EQ(page[1], 126);
+        EXPECT_EQ(page[((stored - 1) * stored + stored - 1) * 4], 129);
+
+        // The last page of level 0 clamps at the edges of the texture.
+        file.ReadPage(layout.GetPageIndex(0, 4, 3), page.data());
+        EXPECT_EQ(page[((stored - 1) * stored + stored - 1) * 4 + 0], 299 & 0xFF);
+        EXPECT_EQ(page[((stored - 1) * stored + stored - 1) * 4 + 1], 199);
+
+        // The single page of the coarsest level, with the border clamped to texel 0.
+        file.ReadPage(layout.pageCount - 1, page.data());
+        EXPECT_EQ(page[0], 0);
+        EXPECT_EQ(page[2], 3);
+        EXPECT_EQ(page[(2 * stored + 2) * 4], 0);
+        EXPECT_EQ(page[(2 * stored + 3) * 4], 1);
+    }
+
+    std::remove(path);
+}
+
+TEST(VirtualTextureTest, ReadsFromAnAssetPack)
+{
+    const char* vtexPath = "VirtualTextureTest.vtex";
+    const char* packPath = "VirtualTextureTest.pack";
+
+    mt::WriteVirtualTexture(vtexPath, MakeLevels(128, 128, 2), 64, 1, true);
+
+    mt::PackSource source{};
+    source.path = "Textures/World.vtex";
+    source.compress = false;
+    {
+        std::FILE* stream = std::fopen(vtexPath, "rb");
+        std::fseek(stream, 0, SEEK_END);
+        source.data.resize(static_cast<size_t>(std::ftell(stream)));
+        std::fseek(stream, 0, SEEK_SET);
+        ASSERT_EQ(std::fread(source.data.data(), 1, source.data.size(), stream), source.data.size());
+        std::fclose(stream);
+    }
+    mt::WriteAssetPack(packPath, {source});
+    std::remove(vtexPath);
+
+    {
+        auto pack = std::make_shared<const mt::AssetPack>(packPath, "Resources");
+        mt::VirtualTextureFile file{"Resources/Textures/World.vtex", pack};
+        EXPECT_EQ(file.GetLayout().pageCount, 4u + 1u);
+
+        std::vector<uint8_t> page(file.GetLayout().GetPageBytes());
+        file.ReadPage(file.GetLayout().GetPageIndex(0, 1, 1), page.data());
+        EXPECT_EQ(page[0], 63);
+        EXPECT_EQ(page[1], 63);
+    }
+
+    std::remove(packPath);
+    EXPECT_THROW(mt::VirtualTextureFile{"VirtualTextureTest.missing"}, std::runtime_error);
+}
+
+TEST(VirtualTextureTest, CacheStreamsCoarsestFirst)
+{
+    mt::VirtualTextureLayout layout{1024, 1024, 128, 0};
+    mt::VirtualPageCache cache{layout, 8};
+
+    // Zoomed in on the bottom left corner: one page of every level.
+    cache.BeginFrame();
+    cache.Request(0.0f, 0.0f, 100.0f, 100.0f, 0);
+
+    std::vector<uint32_t> missing = cache.GetMissingPages();
+    ASSERT_EQ(missing.size(), layout.levels.size());
+    EXPECT_EQ(missing.front(), layout.pageCount - 1);
+    EXPECT_EQ(missing.back(), 0u);
+
+    // Nothing resident yet: the table is empty.
+    std::vector<uint32_t> table(8 * 8);
+    cache.BuildPageTable(0, 8, 8, 4, table.data());
+    EXPECT_EQ(table[0], 0u);
+
+    // Only the coarsest page arrives, everything falls back to it.
+    uint32_t slot = cache.Reserve(missing.front());
+    ASSERT_NE(slot, mt::VirtualPageCache::INVALID);
+    EXPECT_EQ(cache.GetMissingPages().size(), layout.levels.size() - 1);
+
+    cache.MakeResident(slot);
+    EXPECT_TRUE(cache.ConsumeChanges());
+    EXPECT_FALSE(cache.ConsumeChanges());
+
+    cache.BuildPageTable(0, 8, 8, 4, table.data());
+    uint32_t coarsest = (slot % 4) | (slot / 4) << 8 | 3u << 16 | 0xFFu << 24;
+    EXPECT_EQ(table[0], coarsest);
+    EXPECT_EQ(table[63], coarsest);
+
+    // Then the finest page, which only replaces its own entry.
+    uint32_t fine = cache.Reserve(0);
+    cache.MakeResident(fine);
+    cache.BuildPageTable(0, 8, 8, 4, table.data());
+    EXPECT_EQ(table[0], (fine % 4) | (fine / 4) << 8 | 0u << 16 | 0xFFu << 24);
+    EXPECT_EQ(table[1], coarsest);
+}
+
+TEST(VirtualTextureTest, CacheEvictsLeastRecentlyUsed)
+{
+    mt::VirtualTextureLayout layout{1024, 1024, 128, 0};
+    mt::VirtualPageCache cache{layout, 4};
+
+    uint32_t coarsest = layout.pageCount - 1;
+
+    auto load = [&](uint32_t page)
+    {
+        uint32_t slot = cache.Reserve(page);
+        ASSERT_NE(slot, mt::VirtualPageCache::INVALID);
+        cache.MakeResident(slot);
+    };
+
+    // Frame 1: the coarsest page plus three pages of level 0.
+    cache.BeginFrame();
+    load(coarsest);
+    load(layout.GetPageIndex(0, 0, 0));
+    load(layout.GetPageIndex(0, 1, 0));
+    load(layout.GetPageIndex(0, 2, 0));
+    EXPECT_EQ(cache.GetResidentCount(), 4u);
+
+    // Frames 2 and 3: only page (1, 0) stays visible, so (0, 0) is the first of the oldest.
+    cache.BeginFrame();
+    cache.Request(128.0f, 0.0f, 256.0f, 128.0f, 0);
+    cache.BeginFrame();
+    cache.Request(128.0f, 0.0f, 200.0f, 100.0f, 0);
+    load(layout.GetPageIndex(0, 3, 0));
+
+    EXPECT_FALSE(cache.IsResident(layout.GetPageIndex(0, 0, 0)));
+    EXPECT_TRUE(cache.IsResident(layout.GetPageIndex(0, 1, 0)));
+    EXPECT_TRUE(cache.IsResident(layout.GetPageIndex(0, 2, 0)) || cache.IsResident(layout.GetPageIndex(0, 3, 0)));
+    EXPECT_TRUE(cache.IsResident(coarsest));
+
+    // Everything left is visible (or pinned) this frame: nothing can be evicted.
+    cache.BeginFrame();
+    cache.Request(128.0f, 0.0f, 512.0f, 128.0f, 0);
+    cache.Request(0.0f, 0.0f, 1024.0f, 1024.0f, 3);
+    uint32_t reserved = cache.Reserve(layout.GetPageIndex(0, 0, 0));
+    EXPECT_EQ(reserved, mt::VirtualPageCache::INVALID);
+}
+
+TEST(VirtualTextureTest, SelectsLevelFromTexelDensity)
+{
+    mt::VirtualTextureLayout layout{4096, 4096, 128, 0};
+    mt::VirtualPageCache cache{layout, 16};
+
+    EXPECT_EQ(cache.SelectLevel(0.5f), 0u);
+    EXPECT_EQ(cache.SelectLevel(1.0f), 0u);
+    EXPECT_EQ(cache.SelectLevel(2.5f), 1u);
+    EXPECT_EQ(cache.SelectLevel(8.0f), 3u);
+    EXPECT_EQ(cache.SelectLevel(1e6f), static_cast<uint32_t>(layout.levels.size()) - 1);
+}
@@ -0,0 +1,43 @@
+// Offline decoder for the logger's compact binary format (LogDesc::binary).
+// Usage: LogDecoder <binary log> [output text file]
+#include <Logging.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+int main(int argc, char** argv) 
+{
+    if(argc < 2) 
+    {
+        std::cerr << "Usage: LogDecoder <binary log> [output text file]\n";
+        return 1;
+    }
+
+    std::ifstream file{argv[1], std::ios::binary};
+    if(!file.is_open()) 
+    {
+        std::cerr << "Failed to open " << argv[1] << "\n";
+        return 1;
+    }
+
+    std::ofstream outFile{};
+    if(argc > 2) 
+    {
+        outFile.open(argv[2], std::ios::out | std::ios::trunc);
+    }
+    std::ostream& out = outFile.is_open() ? outFile : std::cout;
+
+    try 
+    {
+        uint64_t recordCount = mt::DecodeBinaryLog(file, out);
+        std::cerr << "Decoded " << recordCount << " records\n";
+    }
+    catch(const std::exception& e) 
+    {
+        std::cerr << argv[1] << ": " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+// Offline asset packer: bundles files into a single memory-mappable pack (see AssetPack.hpp).
+// Usage: PackBuilder [--lz4] <output.pack> <root> <file|directory>...
+// Entries are keyed by their path relative to root, which is the directory the pack has to be
+// mounted at (ResourceManager::MountPack()) for runtime lookups to find them.
+#include <Resources/AssetPack.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static bool ReadFile(const fs::path& path, std::vector<uint8_t>& data)
+{
+    std::ifstream stream{path, std::ios::binary | std::ios::ate};
+    if(!stream.is_open())
+    {
+        return false;
+    }
+
+    data.resize(static_cast<size_t>(stream.tellg()));
+    stream.seekg(0);
+    stream.read(reinterpret_cast<char*>(data.data()), data.size());
+
+    return static_cast<bool>(stream);
+}
+
+// GLSL sources are only needed to build the SPIR-V, and the pack should never contain itself.
+static bool IsPackable(const fs::path& path)
+{
+    std::string extension = path.extension().string();
+    return extension != ".vert" && extension != ".frag" && extension != ".pack";
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> arguments{};
+    bool compress = false;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+
+        if(argument == "--lz4")
+        {
+            compress = true;
+        }
+        else {
+            arguments.push_back(argument);
+        }
+    }
+
+    if(arguments.size() < 3)
+    {
+        std::cerr << "Usage: PackBuilder [--lz4] <output.pack> <root> <file|directory>...\n";
+        return 1;
+    }
+
+    fs::path root = fs::absolute(arguments[1]).lexically_normal();
+
+    std::vector<fs::path> files{};
+    for(size_t i = 2; i < arguments.size(); i++)
+    {
+        fs::path input = fs::absolute(arguments[i]).lexically_normal();
+
+        if(fs::is_directory(input))
+        {
+            for(const auto& entry : fs::recursive_directory_iterator(input))
+            {
+                if(entry.is_regular_file() && IsPackable(entry.path()))
+                {
+                    files.push_back(entry.path());
+                }
+            }
+        }
+        else {
+            files.push_back(input);
+        }
+    }
+
+    std::vector<mt::PackSource> sources{};
+    uint64_t totalSize = 0;
+
+    for(const auto& file : files)
+    {
+        mt::PackSource source{};
+        source.path = file.lexically_relative(root).generic_string();
+        // Virtual textures compress their pages one by one, so they can be streamed straight from the mapping.
+        source.compress = compress && mt::GetPackFormat(source.path) != mt::PackFormat::VirtualTexture;
+
+        if(source.path.empty() || source.path.rfind("..", 0) == 0)
+        {
+            std::cerr << file << " is outside of the root " << root << "\n";
+            return 1;
+        }
+        if(!ReadFile(file, source.data))
+        {
+            std::cerr << "Failed to read " << file << "\n";
+            return 1;
+        }
+
+        totalSize += source.data.size();
+        sources.push_back(std::move(source));
+    }
+
+    try
+    {
+        mt::WriteAssetPack(arguments[0], sources);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+
+    std::cout << "Packed " << sources.size() << " files (" << totalSize << " bytes) into " << arguments[0]
+        << " (" << fs::file_size(arguments[0]) << " bytes)\n";
+
+    return 0;
+}
@@ -0,0 +1,633 @@
+#include "BlockEncoders.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace mt
+{
+
+// Helper Functions.
+//----------------------------------------------------------------
+static inline int Clamp255(int value)
+{
+    return std::min(std::max(value, 0), 255);
+}
+
+static inline int Square(int value)
+{
+    return value * value;
+}
+
+/**
+ * @brief Fits a line through the block's colours (the principal axis of their covariance) and
+ * returns the two extremes of the projections onto it.
+*/
+static void FitEndpoints(const uint8_t texels[64], int channels, float low[4], float high[4])
+{
+    float mean[4] = {};
+    uint8_t minimum[4] = {255, 255, 255, 255};
+    uint8_t maximum[4] = {};
+
+    for(int i = 0; i < 16; i++)
+    {
+        for(int c = 0; c < channels; c++)
+        {
+            mean[c] += texels[i * 4 + c];
+            minimum[c] = std::min(minimum[c], texels[i * 4 + c]);
+            maximum[c] = std::max(maximum[c], texels[i * 4 + c]);
+        }
+    }
+
+    float covariance[4][4] = {};
+    float axis[4] = {};
+
+    for(int c = 0; c < channels; c++)
+    {
+        mean[c] /= 16.0f;
+        axis[c] = static_cast<float>(maximum[c] - minimum[c]);
+    }
+
+    for(int i = 0; i < 16; i++)
+    {
+        for(int a = 0; a < channels; a++)
+        {
+            for(int b = 0; b < channels; b++)
+            {
+                covariance[a][b] += (texels[i * 4 + a] - mean[a]) * (texels[i * 4 + b] - mean[b]);
+            }
+        }
+    }
+
+    // A few rounds of power iteration, starting from the bounding box diagonal.
+    for(int iteration = 0; iteration < 8; iteration++)
+    {
+        float next[4] = {};
+        float length = 0.0f;
+
+        for(int a = 0; a < channels; a++)
+        {
+            for(int b = 0; b < channels; b++)
+            {
+                next[a] += covariance[a][b] * axis[b];
+            }
+            length = std::max(length, std::fabs(next[a]));
+        }
+
+        if(length < 1e-6f)
+        {
+            break;
+        }
+
+        for(int a = 0; a < channels; a++)
+        {
+            axis[a] = next[a] / length;
+        }
+    }
+
+    float lengthSquared = 0.0f;
+    for(int c = 0; c < channels; c++)
+    {
+        lengthSquared += axis[c] * axis[c];
+    }
+
+    float lowT = 0.0f;
+    float highT = 0.0f;
+
+    if(lengthSquared > 1e-12f)
+    {
+        for(int i = 0; i < 16; i++)
+        {
+            float t = 0.0f;
+            for(int c = 0; c < channels; c++)
+            {
+                t += (texels[i * 4 + c] - mean[c]) * axis[c];
+            }
+            lowT = std::min(lowT, t / lengthSquared);
+            highT = std::max(highT, t / lengthSquared);
+        }
+    }
+
+    for(int c = 0; c < channels; c++)
+    {
+        low[c] = std::min(std::max(mean[c] + axis[c] * lowT, 0.0f), 255.0f);
+        high[c] = std::min(std::max(mean[c] + axis[c] * highT, 0.0f), 255.0f);
+    }
+}
+
+/**
+ * @brief Appends bits least significant first, which is how the BC formats are laid out.
+*/
+class BitWriter
+{
+public:
+    explicit BitWriter(uint8_t* out, size_t size) : mOut{out} { std::memset(out, 0, size); }
+
+    void Write(uint32_t value, uint32_t bits)
+    {
+        for(uint32_t i = 0; i < bits; i++, mPosition++)
+        {
+            mOut[mPosition >> 3] |= static_cast<uint8_t>(((value >> i) & 1) << (mPosition & 7));
+        }
+    }
+
+private:
+    uint8_t* mOut;
+    uint32_t mPosition = 0;
+};
+
+static void WriteBigEndian64(uint8_t out[8], uint64_t value)
+{
+    for(int i = 0; i < 8; i++)
+    {
+        out[i] = static_cast<uint8_t>(value >> (56 - 8 * i));
+    }
+}
+//----------------------------------------------------------------
+
+
+// BC7
+//----------------------------------------------------------------
+static const int sBC7Weights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// Mode 6 endpoints are 7 bits per channel plus one shared low bit (the p-bit) per endpoint.
+static void QuantiseBC7Endpoint(const float endpoint[4], uint8_t quantised[4], uint32_t& pBit)
+{
+    float bestError = 1e30f;
+
+    for(uint32_t p = 0; p < 2; p++)
+    {
+        uint8_t candidate[4];
+        float error = 0.0f;
+
+        for(int c = 0; c < 4; c++)
+        {
+            int q = static_cast<int>(std::lround((endpoint[c] - p) / 2.0f));
+            candidate[c] = static_cast<uint8_t>(std::min(std::max(q, 0), 127));
+            float difference = static_cast<float>((candidate[c] << 1) | p) - endpoint[c];
+            error += difference * difference;
+        }
+
+        if(error < bestError)
+        {
+            bestError = error;
+            pBit = p;
+            std::memcpy(quantised, candidate, 4);
+        }
+    }
+}
+
+struct BC7Mode6Fit
+{
+    uint8_t endpoints[2][4];
+    uint32_t pBits[2];
+    uint32_t indices[16];
+    int error;
+};
+
+static BC7Mode6Fit FitBC7Mode6(const uint8_t texels[64], const float low[4], const float high[4])
+{
+    BC7Mode6Fit fit{};
+    QuantiseBC7Endpoint(low, fit.endpoints[0], fit.pBits[0]);
+    QuantiseBC7Endpoint(high, fit.endpoints[1], fit.pBits[1]);
+
+    int palette[16][4];
+    for(int i = 0; i < 16; i++)
+    {
+        for(int c = 0; c < 4; c++)
+        {
+            int a = (fit.endpoints[0][c] << 1) | fit.pBits[0];
+            int b = (fit.endpoints[1][c] << 1) | fit.pBits[1];
+            palette[i][c] = ((64 - sBC7Weights4[i]) * a + sBC7Weights4[i] * b + 32) >> 6;
+        }
+    }
+
+    for(int i = 0; i < 16; i++)
+    {
+        int bestError = INT32_MAX;
+        for(uint32_t p = 0; p < 16; p++)
+        {
+            int error = 0;
+            for(int c = 0; c < 4; c++)
+            {
+                error += Square(texels[i * 4 + c] - palette[p][c]);
+            }
+            if(error < bestError)
+            {
+                bestError = error;
+                fit.indices[i] = p;
+            }
+        }
+        fit.error += bestError;
+    }
+
+    return fit;
+}
+
+void EncodeBC7Block(const uint8_t texels[64], uint8_t out[16])
+{
+    float low[4];
+    float high[4];
+    FitEndpoints(texels, 4, low, high);
+
+    BC7Mode6Fit best = FitBC7Mode6(texels, low, high);
+
+    // One least squares refit of the endpoints to the chosen weights recovers most of what the
+    // principal axis misses when alpha doesn't follow the colour.
+    float a = 0.0f, b = 0.0f, c = 0.0f;
+    float x[4] = {}, y[4] = {};
+    for(int i = 0; i < 16; i++)
+    {
+        float t = sBC7Weights4[best.indices[i]] / 64.0f;
+        a += (1.0f - t) * (1.0f - t);
+        b += (1.0f - t) * t;
+        c += t * t;
+        for(int channel = 0; channel < 4; channel++)
+        {
+            x[channel] += (1.0f - t) * texels[i * 4 + channel];
+            y[channel] += t * texels[i * 4 + channel];
+        }
+    }
+
+    float determinant = a * c - b * b;
+    if(std::fabs(determinant) > 1e-6f)
+    {
+        for(int channel = 0; channel < 4; channel++)
+        {
+            low[channel] = std::min(std::max((c * x[channel] - b * y[channel]) / determinant, 0.0f), 255.0f);
+            high[channel] = std::min(std::max((a * y[channel] - b * x[channel]) / determinant, 0.0f), 255.0f);
+        }
+
+        BC7Mode6Fit refined = FitBC7Mode6(texels, low, high);
+        if(refined.error < best.error)
+        {
+            best = refined;
+        }
+    }
+
+    auto& endpoints = best.endpoints;
+    auto& pBits = best.pBits;
+    auto& indices = best.indices;
+
+    // The first index is stored with its top bit implied to be zero, so swap the endpoints
+    // (the weights are symmetric) if it's set.
+    if(indices[0] & 8)
+    {
+        std::swap(endpoints[0], endpoints[1]);
+        std::swap(pBits[0], pBits[1]);
+        for(auto& index : indices)
+        {
+            index = 15 - index;
+        }
+    }
+
+    BitWriter writer{out, 16};
+    writer.Write(1 << 6, 7);
+    for(int c = 0; c < 4; c++)
+    {
+        writer.Write(endpoints[0][c], 7);
+        writer.Write(endpoints[1][c], 7);
+    }
+    writer.Write(pBits[0], 1);
+    writer.Write(pBits[1], 1);
+    writer.Write(indices[0], 3);
+    for(int i = 1; i < 16; i++)
+    {
+        writer.Write(indices[i], 4);
+    }
+}
+//----------------------------------------------------------------
+
+
+// BC3
+//----------------------------------------------------------------
+static inline uint16_t PackRGB565(const float colour[3])
+{
+    int r = (static_cast<int>(colour[0] + 0.5f) * 31 + 127) / 255;
+    int g = (static_cast<int>(colour[1] + 0.5f) * 63 + 127) / 255;
+    int b = (static_cast<int>(colour[2] + 0.5f) * 31 + 127) / 255;
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static inline void UnpackRGB565(uint16_t packed, int colour[3])
+{
+    int r = (packed >> 11) & 31;
+    int g = (packed >> 5) & 63;
+    int b = packed & 31;
+    colour[0] = (r << 3) | (r >> 2);
+    colour[1] = (g << 2) | (g >> 4);
+    colour[2] = (b << 3) | (b >> 2);
+}
+
+static void EncodeBC4Alpha(const uint8_t texels[64], uint8_t out[8])
+{
+    uint8_t alpha0 = 0;
+    uint8_t alpha1 = 255;
+    for(int i = 0; i < 16; i++)
+    {
+        alpha0 = std::max(alpha0, texels[i * 4 + 3]);
+        alpha1 = std::min(alpha1, texels[i * 4 + 3]);
+    }
+
+    // alpha0 > alpha1 selects the eight value mode: both endpoints plus six interpolants.
+    int palette[8] = {alpha0, alpha1};
+    for(int i = 1; i < 7; i++)
+    {
+        palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+    }
+
+    BitWriter writer{out, 8};
+    writer.Write(alpha0, 8);
+    writer.Write(alpha1, 8);
+
+    for(int i = 0; i < 16; i++)
+    {
+        uint32_t best = 0;
+        int bestError = INT32_MAX;
+        for(uint32_t p = 0; p < 8 && alpha0 != alpha1; p++)
+        {
+            int error = std::abs(texels[i * 4 + 3] - palette[p]);
+            if(error < bestError)
+            {
+                bestError = error;
+                best = p;
+            }
+        }
+        writer.Write(best, 3);
+    }
+}
+
+void EncodeBC3Block(const uint8_t texels[64], uint8_t out[16])
+{
+    EncodeBC4Alpha(texels, out);
+
+    float low[4];
+    float high[4];
+    FitEndpoints(texels, 3, low, high);
+
+    uint16_t colour0 = PackRGB565(high);
+    uint16_t colour1 = PackRGB565(low);
+
+    // BC3 always decodes its colour block in four colour mode, but keeping colour0 > colour1
+    // keeps it decodable as plain BC1 too.
+    if(colour0 < colour1)
+    {
+        std::swap(colour0, colour1);
+    }
+
+    int palette[4][3];
+    UnpackRGB565(colour0, palette[0]);
+    UnpackRGB565(colour1, palette[1]);
+    for(int c = 0; c < 3; c++)
+    {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    BitWriter writer{out + 8, 8};
+    writer.Write(colour0, 16);
+    writer.Write(colour1, 16);
+
+    for(int i = 0; i < 16; i++)
+    {
+        uint32_t best = 0;
+        int bestError = INT32_MAX;
+        for(uint32_t p = 0; p < 4; p++)
+        {
+            int error = Square(texels[i * 4] - palette[p][0]) + Square(texels[i * 4 + 1] - palette[p][1]) +
+                Square(texels[i * 4 + 2] - palette[p][2]);
+            if(error < bestError)
+            {
+                bestError = error;
+                best = p;
+            }
+        }
+        writer.Write(best, 2);
+    }
+}
+//----------------------------------------------------------------
+
+
+// ETC2
+//----------------------------------------------------------------
+static const int sETC1Modifiers[8][2] =
+{
+    {2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}
+};
+
+static const int sEACModifiers[16][8] =
+{
+    {-3, -6, -9, -15, 2, 5, 8, 14},
+    {-3, -7, -10, -13, 2, 6, 9, 12},
+    {-2, -5, -8, -13, 1, 4, 7, 12},
+    {-2, -4, -6, -13, 1, 3, 5, 12},
+    {-3, -6, -8, -12, 2, 5, 7, 11},
+    {-3, -7, -9, -11, 2, 6, 8, 10},
+    {-4, -7, -8, -11, 3, 6, 7, 10},
+    {-3, -5, -8, -11, 2, 4, 7, 10},
+    {-2, -6, -8, -10, 1, 5, 7, 9},
+    {-2, -5, -8, -10, 1, 4, 7, 9},
+    {-2, -4, -8, -10, 1, 3, 7, 9},
+    {-2, -5, -7, -10, 1, 4, 6, 9},
+    {-3, -4, -7, -10, 2, 3, 6, 9},
+    {-1, -2, -3, -10, 0, 1, 2, 9},
+    {-4, -6, -8, -9, 3, 5, 7, 8},
+    {-3, -5, -7, -9, 2, 4, 6, 8}
+};
+
+// ETC stores texels column by column.
+static inline int GetETCTexelIndex(int x, int y)
+{
+    return x * 4 + y;
+}
+
+static void EncodeEACAlpha(const uint8_t texels[64], uint8_t out[8])
+{
+    int minimum = 255;
+    int maximum = 0;
+    for(int i = 0; i < 16; i++)
+    {
+        minimum = std::min<int>(minimum, texels[i * 4 + 3]);
+        maximum = std::max<int>(maximum, texels[i * 4 + 3]);
+    }
+
+    int bestError = INT32_MAX;
+    int bestBase = maximum;
+    int bestMultiplier = 1;
+    int bestTable = 13;     // Contains a zero modifier, so flat blocks are exact.
+
+    for(int table = 0; table < 16 && minimum != maximum; table++)
+    {
+        const int* modifiers = sEACModifiers[table];
+        for(int multiplier = 1; multiplier < 16; multiplier++)
+        {
+            // Centre the table's range on the block's range, then try its neighbours.
+            int centre = (minimum + maximum - (modifiers[3] + modifiers[7]) * multiplier + 1) / 2;
+            for(int base = std::max(centre - 1, 0); base <= std::min(centre + 1, 255); base++)
+            {
+                int error = 0;
+                for(int i = 0; i < 16 && error < bestError; i++)
+                {
+                    int texelError = INT32_MAX;
+                    for(int m = 0; m < 8; m++)
+                    {
+                        texelError = std::min(texelError, Square(texels[i * 4 + 3] - Clamp255(base + modifiers[m] * multiplier)));
+                    }
+                    error += texelError;
+                }
+
+                if(error < bestError)
+                {
+                    bestError = error;
+                    bestBase = base;
+                    bestMultiplier = multiplier;
+                    bestTable = table;
+                }
+            }
+        }
+    }
+
+    uint64_t bits = (static_cast<uint64_t>(bestBase) << 56) | (static_cast<uint64_t>(bestMultiplier) << 52) |
+        (static_cast<uint64_t>(bestTable) << 48);
+
+    for(int y = 0; y < 4; y++)
+    {
+        for(int x = 0; x < 4; x++)
+        {
+            int alpha = texels[(y * 4 + x) * 4 + 3];
+            int best = 4;
+            int bestTexelError = INT32_MAX;
+            for(int m = 0; m < 8; m++)
+            {
+                int error = Square(alpha - Clamp255(bestBase + sEACModifiers[bestTable][m] * bestMultiplier));
+                if(error < bestTexelError)
+                {
+                    bestTexelError = error;
+                    best = m;
+                }
+            }
+            bits |= static_cast<uint64_t>(best) << (45 - 3 * GetETCTexelIndex(x, y));
+        }
+    }
+
+    WriteBigEndian64(out, bits);
+}
+
+struct ETC1SubBlock
+{
+    int base[3];        // 4 bit.
+    int table;
+    int error;
+    int selectors[16];  // Indexed by GetETCTexelIndex(), only this sub-block's texels are set.
+};
+
+static ETC1SubBlock EncodeETC1SubBlock(const uint8_t texels[64], bool flip, int half)
+{
+    int coordinates[8][2];
+    for(int i = 0; i < 8; i++)
+    {
+        // Not flipped: two 2x4 halves side by side. Flipped: two 4x2 halves stacked.
+        int a = half * 2 + (i & 1);
+        int b = i >> 1;
+        coordinates[i][0] = flip ? b : a;
+        coordinates[i][1] = flip ? a : b;
+    }
+
+    float average[3] = {};
+    for(const auto& coordinate : coordinates)
+    {
+        for(int c = 0; c < 3; c++)
+        {
+            average[c] += texels[(coordinate[1] * 4 + coordinate[0]) * 4 + c] / 8.0f;
+        }
+    }
+
+    ETC1SubBlock result{};
+    result.error = INT32_MAX;
+
+    int expanded[3];
+    for(int c = 0; c < 3; c++)
+    {
+        result.base[c] = std::min(static_cast<int>(std::lround(average[c] * 15.0f / 255.0f)), 15);
+        expanded[c] = result.base[c] * 17;
+    }
+
+    for(int table = 0; table < 8; table++)
+    {
+        const int modifiers[4] = {sETC1Modifiers[table][0], sETC1Modifiers[table][1], -sETC1Modifiers[table][0], -sETC1Modifiers[table][1]};
+        int selectors[16] = {};
+        int error = 0;
+
+        for(const auto& coordinate : coordinates)
+        {
+            const uint8_t* texel = &texels[(coordinate[1] * 4 + coordinate[0]) * 4];
+            int bestTexelError = INT32_MAX;
+
+            for(int s = 0; s < 4; s++)
+            {
+                int texelError = 0;
+                for(int c = 0; c < 3; c++)
+                {
+                    texelError += Square(texel[c] - Clamp255(expanded[c] + modifiers[s]));
+                }
+                if(texelError < bestTexelError)
+                {
+                    bestTexelError = texelError;
+                    selectors[GetETCTexelIndex(coordinate[0], coordinate[1])] = s;
+                }
+            }
+            error += bestTexelError;
+        }
+
+        if(error < result.error)
+        {
+            result.error = error;
+            result.table = table;
+            std::memcpy(result.selectors, selectors, sizeof(selectors));
+        }
+    }
+
+    return result;
+}
+
+void EncodeETC2Block(const uint8_t texels[64], uint8_t out[16])
+{
+    EncodeEACAlpha(texels, out);
+
+    // Individual mode (diff bit clear) is valid ETC1 and decodes identically under ETC2.
+    ETC1SubBlock best[2] = {};
+    bool bestFlip = false;
+    int bestError = INT32_MAX;
+
+    for(int flip = 0; flip < 2; flip++)
+    {
+        ETC1SubBlock halves[2] = {EncodeETC1SubBlock(texels, flip, 0), EncodeETC1SubBlock(texels, flip, 1)};
+        if(halves[0].error + halves[1].error < bestError)
+        {
+            bestError = halves[0].error + halves[1].error;
+            bestFlip = flip;
+            best[0] = halves[0];
+            best[1] = halves[1];
+        }
+    }
+
+    uint64_t bits = 0;
+    bits |= static_cast<uint64_t>(best[0].base[0]) << 60 | static_cast<uint64_t>(best[1].base[0]) << 56;
+    bits |= static_cast<uint64_t>(best[0].base[1]) << 52 | static_cast<uint64_t>(best[1].base[1]) << 48;
+    bits |= static_cast<uint64_t>(best[0].base[2]) << 44 | static_cast<uint64_t>(best[1].base[2]) << 40;
+    bits |= static_cast<uint64_t>(best[0].table) << 37 | static_cast<uint64_t>(best[1].table) << 34;
+    bits |= static_cast<uint64_t>(bestFlip) << 32;
+
+    for(int i = 0; i < 16; i++)
+    {
+        // Each texel belongs to exactly one half, the other has a zero selector for it.
+        int selector = best[0].selectors[i] | best[1].selectors[i];
+        bits |= static_cast<uint64_t>(selector >> 1) << (16 + i);
+        bits |= static_cast<uint64_t>(selector & 1) << i;
+    }
+
+    WriteBigEndian64(out + 8, bits);
+}
+//----------------------------------------------------------------
+
+}
@@ -0,0 +1,30 @@
+#ifndef MAMMOTH_2D_BLOCK_ENCODERS_HPP
+#define MAMMOTH_2D_BLOCK_ENCODERS_HPP
+
+#include <cstdint>
+
+namespace mt
+{
+
+// Every encoder takes one 4x4 block of RGBA8 texels (row-major, 64 bytes) and writes 16 bytes.
+// They favour simplicity and predictable speed over the last fraction of a dB - a single
+// principal-axis fit per block rather than an exhaustive search.
+
+/**
+ * @brief BC7 using mode 6 only (one subset, RGBA endpoints with per-endpoint p-bits, 4-bit indices).
+*/
+void EncodeBC7Block(const uint8_t texels[64], uint8_t out[16]);
+
+/**
+ * @brief BC3 (BC4-style interpolated alpha followed by a four-colour BC1 block).
+*/
+void EncodeBC3Block(const uint8_t texels[64], uint8_t out[16]);
+
+/**
+ * @brief ETC2 RGBA8 (EAC alpha followed by an ETC1-compatible "individual" mode colour block).
+*/
+void EncodeETC2Block(const uint8_t texels[64], uint8_t out[16]);
+
+}
+
+#endif
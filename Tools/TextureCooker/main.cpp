@@ -0,0 +1,318 @@
+// Offline texture cooker: converts images into block-compressed KTX2 files with full mip chains.
+// Usage: TextureCooker [--format bc7|bc3|etc2|rgba8]... [--no-mips] [--output <dir>] <image>...
+// Each image is written once per format, next to the source (or into --output) as
+// "<name>.<format>.ktx2", which is where Image::Decode() looks for it at runtime.
+// With --virtual [--page-size <texels>] [--lz4], images are instead cut into the pages of a
+// virtual texture, "<name>.vtex" (see Graphics/Shader/VirtualTexture.hpp).
+#include "BlockEncoders.hpp"
+#include <Resources/Ktx2.hpp>
+#include <Resources/VirtualTextureFile.hpp>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <StbiImage/stb_image.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct SourceLevel
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> texels{};
+};
+
+static float sSRGBToLinear[256];
+
+static uint8_t LinearToSRGB(float value)
+{
+    value = std::min(std::max(value, 0.0f), 1.0f);
+    float encoded = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    return static_cast<uint8_t>(std::lround(encoded * 255.0f));
+}
+
+// 2x2 box filter. Colour is averaged in linear space (averaging sRGB values darkens every
+// mip), alpha as is. Odd sizes clamp at the edge.
+static SourceLevel Downsample(const SourceLevel& source)
+{
+    SourceLevel level{};
+    level.width = std::max(source.width / 2, 1u);
+    level.height = std::max(source.height / 2, 1u);
+    level.texels.resize(static_cast<size_t>(level.width) * level.height * 4);
+
+    for(uint32_t y = 0; y < level.height; y++)
+    {
+        for(uint32_t x = 0; x < level.width; x++)
+        {
+            float sum[4] = {};
+            for(uint32_t i = 0; i < 4; i++)
+            {
+                uint32_t sx = std::min(x * 2 + (i & 1), source.width - 1);
+                uint32_t sy = std::min(y * 2 + (i >> 1), source.height - 1);
+                const uint8_t* texel = &source.texels[(static_cast<size_t>(sy) * source.width + sx) * 4];
+
+                for(int c = 0; c < 3; c++)
+                {
+                    sum[c] += sSRGBToLinear[texel[c]];
+                }
+                sum[3] += texel[3];
+            }
+
+            uint8_t* out = &level.texels[(static_cast<size_t>(y) * level.width + x) * 4];
+            for(int c = 0; c < 3; c++)
+            {
+                out[c] = LinearToSRGB(sum[c] / 4.0f);
+            }
+            out[3] = static_cast<uint8_t>(std::lround(sum[3] / 4.0f));
+        }
+    }
+
+    return level;
+}
+
+static void EncodeLevel(const SourceLevel& level, mt::TextureCodec codec, std::vector<uint8_t>& out)
+{
+    if(codec == mt::TextureCodec::RGBA8)
+    {
+        out.insert(out.end(), level.texels.begin(), level.texels.end());
+        return;
+    }
+
+    void (*encode)(const uint8_t*, uint8_t*) = nullptr;
+    switch(codec)
+    {
+        case mt::TextureCodec::BC3: encode = mt::EncodeBC3Block; break;
+        case mt::TextureCodec::BC7: encode = mt::EncodeBC7Block; break;
+        case mt::TextureCodec::ETC2: encode = mt::EncodeETC2Block; break;
+        default: return;
+    }
+
+    uint8_t block[64];
+    uint8_t encoded[16];
+
+    for(uint32_t by = 0; by < level.height; by += 4)
+    {
+        for(uint32_t bx = 0; bx < level.width; bx += 4)
+        {
+            // Partial blocks at the edges repeat the last row/column.
+            for(uint32_t i = 0; i < 16; i++)
+            {
+                uint32_t x = std::min(bx + (i & 3), level.width - 1);
+                uint32_t y = std::min(by + (i >> 2), level.height - 1);
+                std::memcpy(&block[i * 4], &level.texels[(static_cast<size_t>(y) * level.width + x) * 4], 4);
+            }
+
+            encode(block, encoded);
+            out.insert(out.end(), encoded, encoded + 16);
+        }
+    }
+}
+
+// Enough for bilinear filtering, which is all virtual.frag does.
+static constexpr uint32_t VIRTUAL_PAGE_BORDER = 1;
+
+static std::string GetOutputPath(const std::string& path, const std::string& outputDirectory)
+{
+    if(outputDirectory.empty())
+    {
+        return path;
+    }
+    return (std::filesystem::path(outputDirectory) / std::filesystem::path(path).filename()).string();
+}
+
+static bool WriteVirtual(const std::string& input, const std::vector<SourceLevel>& levels, uint32_t pageSize, bool compress, const std::string& outputDirectory)
+{
+    std::vector<mt::VirtualTextureLevel> pages{};
+    for(const auto& level : levels)
+    {
+        pages.push_back(mt::VirtualTextureLevel{level.width, level.height, level.texels});
+    }
+
+    std::string outputPath = GetOutputPath(std::filesystem::path(input).replace_extension(".vtex").string(), outputDirectory);
+
+    try
+    {
+        mt::WriteVirtualTexture(outputPath, pages, pageSize, VIRTUAL_PAGE_BORDER, compress);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << "\n";
+        return false;
+    }
+
+    mt::VirtualTextureLayout layout{levels[0].width, levels[0].height, pageSize, VIRTUAL_PAGE_BORDER};
+    std::cout << input << " -> " << outputPath << " (" << layout.levels.size() << " levels, " << layout.pageCount << " pages, "
+        << std::filesystem::file_size(outputPath) / 1024 << " KiB)\n";
+
+    return true;
+}
+
+static bool ParseCodec(const std::string& name, mt::TextureCodec& codec)
+{
+    for(auto candidate : {mt::TextureCodec::RGBA8, mt::TextureCodec::BC3, mt::TextureCodec::BC7, mt::TextureCodec::ETC2})
+    {
+        if(name == mt::GetTextureCodecInfo(candidate).name)
+        {
+            codec = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<mt::TextureCodec> codecs{};
+    std::vector<std::string> inputs{};
+    std::string outputDirectory = "";
+    bool generateMips = true;
+    bool isVirtual = false;
+    bool compress = false;
+    uint32_t pageSize = 128;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+
+        if(argument == "--format" && i + 1 < argc)
+        {
+            mt::TextureCodec codec{};
+            if(!ParseCodec(argv[++i], codec))
+            {
+                // ASTC is loadable at runtime but has no encoder here - use astcenc or toktx.
+                std::cerr << "Unknown or unsupported format " << argv[i] << " (expected bc7, bc3, etc2 or rgba8)\n";
+                return 1;
+            }
+            codecs.push_back(codec);
+        }
+        else if(argument == "--output" && i + 1 < argc)
+        {
+            outputDirectory = argv[++i];
+        }
+        else if(argument == "--no-mips")
+        {
+            generateMips = false;
+        }
+        else if(argument == "--virtual")
+        {
+            isVirtual = true;
+        }
+        else if(argument == "--page-size" && i + 1 < argc)
+        {
+            pageSize = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            if(pageSize == 0)
+            {
+                std::cerr << "Invalid page size " << argv[i] << "\n";
+                return 1;
+            }
+        }
+        else if(argument == "--lz4")
+        {
+            compress = true;
+        }
+        else {
+            inputs.push_back(argument);
+        }
+    }
+
+    if(inputs.empty())
+    {
+        std::cerr << "Usage: TextureCooker [--format bc7|bc3|etc2|rgba8]... [--no-mips] [--output <dir>] <image>...\n"
+            << "       TextureCooker --virtual [--page-size <texels>] [--lz4] [--output <dir>] <image>...\n";
+        return 1;
+    }
+
+    if(codecs.empty())
+    {
+        codecs.push_back(mt::TextureCodec::BC7);
+    }
+
+    for(int i = 0; i < 256; i++)
+    {
+        float value = i / 255.0f;
+        sSRGBToLinear[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    // Bottom-up, to match the engine's PNG path (see Image::Decode()).
+    stbi_set_flip_vertically_on_load(true);
+
+    int failures = 0;
+
+    for(const auto& input : inputs)
+    {
+        int width, height, nChannels;
+        stbi_uc* pixels = stbi_load(input.c_str(), &width, &height, &nChannels, STBI_rgb_alpha);
+
+        if(!pixels)
+        {
+            std::cerr << "Failed to load " << input << ": " << stbi_failure_reason() << "\n";
+            failures++;
+            continue;
+        }
+
+        std::vector<SourceLevel> levels(1);
+        levels[0].width = static_cast<uint32_t>(width);
+        levels[0].height = static_cast<uint32_t>(height);
+        levels[0].texels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+        stbi_image_free(pixels);
+
+        // Virtual textures always need their levels, they're what's shown when zoomed out.
+        while((generateMips || isVirtual) && (levels.back().width > 1 || levels.back().height > 1))
+        {
+            levels.push_back(Downsample(levels.back()));
+        }
+
+        if(isVirtual)
+        {
+            if(!WriteVirtual(input, levels, pageSize, compress, outputDirectory))
+            {
+                failures++;
+            }
+            continue;
+        }
+
+        for(auto codec : codecs)
+        {
+            mt::Ktx2Texture texture{};
+            texture.codec = codec;
+            texture.width = levels[0].width;
+            texture.height = levels[0].height;
+
+            for(const auto& level : levels)
+            {
+                mt::Ktx2Level out{};
+                out.offset = texture.data.size();
+                out.width = level.width;
+                out.height = level.height;
+
+                EncodeLevel(level, codec, texture.data);
+
+                out.size = texture.data.size() - out.offset;
+                texture.levels.push_back(out);
+            }
+
+            std::string outputPath = GetOutputPath(mt::GetCookedTexturePath(input, codec), outputDirectory);
+
+            try
+            {
+                mt::WriteKtx2(outputPath, texture);
+            }
+            catch(const std::exception& e)
+            {
+                std::cerr << e.what() << "\n";
+                failures++;
+                continue;
+            }
+
+            std::cout << input << " -> " << outputPath << " (" << texture.levels.size() << " levels, "
+                << texture.data.size() / 1024 << " KiB)\n";
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
+}